@@ -0,0 +1,141 @@
+#include "./bench.h"
+
+#include <cmath>
+#include <cstdio>
+#include <algorithm>
+
+size_t Bench::Recorder::phase(const std::string& name, const std::string& unit)
+{
+    for (size_t i = 0; i < phases.size(); ++i) if (phases[i].name == name) return i;
+
+    phases.push_back({.name = name, .unit = unit});
+    return phases.size() - 1;
+}
+
+void Bench::Recorder::add(const size_t phase, const double value) { phases[phase].samples.push_back(value); }
+
+void Bench::Recorder::print(const std::string& title) const
+{
+    printf("%s\n", title.c_str());
+    printf("  %-16s %10s %10s %10s %10s %8s\n", "phase", "p50", "p99", "max", "mean", "samples");
+
+    for (const auto& p : phases)
+    {
+        if (p.samples.empty()) continue;
+
+        std::vector<double> sorted = p.samples;
+        std::sort(sorted.begin(), sorted.end());
+
+        auto percentile = [&](const double q)
+        {
+            const auto rank = static_cast<size_t>(std::ceil(q * static_cast<double>(sorted.size())));
+            return sorted[std::clamp<size_t>(rank, 1, sorted.size()) - 1];
+        };
+
+        double sum = 0.0;
+        for (const double v : sorted) sum += v;
+
+        printf("  %-16s %8.1f%-2s %8.1f%-2s %8.1f%-2s %8.1f%-2s %8zu\n", p.name.c_str(), percentile(0.5),
+               p.unit.c_str(), percentile(0.99), p.unit.c_str(), sorted.back(), p.unit.c_str(),
+               sum / static_cast<double>(sorted.size()), p.unit.c_str(), sorted.size());
+    }
+
+    printf("\n");
+}
+
+void Bench::runFrames(Context& ctx, const PadScript& script) { runFrames(ctx.ui, ctx, script); }
+
+void Bench::runFrames(UIRoot& ui, Context& ctx, const PadScript& script)
+{
+    Recorder& rec = ctx.recorder;
+    const size_t layout = rec.phase("ui.layout"), update = rec.phase("ui.update"), route = rec.phase("routeEvent"),
+                 draw = rec.phase("ui.draw"), frame = rec.phase("frame"), submissions = rec.phase("submissions", ""),
+                 texts = rec.phase("text calls", ""), redrawn = rec.phase("redrawn px", "");
+
+    Input::InputFrame inputFrame = {};
+    Input::KeyRepeat keyRepeat;
+    std::vector<Input::InputEvent> events;
+
+    Input::reset();
+    const int warmup = ctx.replay ? 0 : ctx.warmup;
+
+    for (int i = 0; ctx.replay ? ctx.replay->isPlaying() : i < warmup + ctx.frames; ++i)
+    {
+        if (script) script(HostPad::state(), i);
+        HostGfx::resetStats();
+
+        const bool record = i >= warmup;
+        const auto start = std::chrono::steady_clock::now();
+
+        Input::poll(&inputFrame, events, ctx.replay);
+        keyRepeat.generate(inputFrame, ctx.dt, events);
+        if (ctx.traceRecorder) ctx.traceRecorder->record(inputFrame, ctx.dt);
+
+        if (!record)
+        {
+            ui.layout();
+            ui.update(ctx.dt);
+            for (const auto& e : events) ui.routeEvent(e);
+            for (const Rect& r : ui.damage) ui.draw(r);
+            ui.damage.clear();
+            GRRLIB_Render();
+
+            continue;
+        }
+
+        rec.time(layout, [&] { ui.layout(); });
+        rec.time(update, [&] { ui.update(ctx.dt); });
+        rec.time(route, [&] { for (const auto& e : events) ui.routeEvent(e); });
+        rec.time(draw, [&] { for (const Rect& r : ui.damage) ui.draw(r); });
+        rec.add(redrawn, ui.damage.pixels());
+        ui.damage.clear();
+        GRRLIB_Render();
+
+        rec.add(frame, std::chrono::duration<double, std::micro>(std::chrono::steady_clock::now() - start).count());
+        rec.add(submissions, static_cast<double>(HostGfx::stats().submissions));
+        rec.add(texts, static_cast<double>(HostGfx::stats().textCalls));
+    }
+}
+
+std::vector<Bench::Scenario>& Bench::scenarios()
+{
+    static std::vector<Scenario> list;
+    return list;
+}
+
+std::string Bench::writeWorkspaceFile(const std::string& name, const std::string& text)
+{
+    const std::string path = FileSystem::join(FileSystem::workspaceRoot, name);
+    FileSystem::writeFile(path, reinterpret_cast<const uint8_t*>(text.data()), text.size());
+
+    return path;
+}
+
+std::string Bench::sampleSource(const int lines)
+{
+    std::string out;
+    for (int i = 0; i < lines; ++i)
+    {
+        switch (i % 8)
+        {
+        case 0: out += "local function step" + std::to_string(i) + "(dt, state)\n";
+            break;
+        case 1: out += "    local x, y = state.x + state.vx * dt, state.y + state.vy * dt\n";
+            break;
+        case 2: out += "    if x < 0 or x > 640 then state.vx = -state.vx end\n";
+            break;
+        case 3: out += "    if y < 0 or y > 480 then state.vy = -state.vy end\n";
+            break;
+        case 4: out += "    gfx.rect(x, y, 16, 16, 0xFF8040FF, 4) -- draw the sprite\n";
+            break;
+        case 5: out += "    state.x, state.y = x, y\n";
+            break;
+        case 6: out += "end\n";
+            break;
+        default: out += "\n";
+            break;
+        }
+    }
+
+    return out;
+}
@@ -0,0 +1,73 @@
+#pragma once
+
+#include <string>
+#include <vector>
+#include <chrono>
+#include <functional>
+
+#include <wiiuse/wpad.h>
+
+#include "../../src/ui/ui_root.h"
+
+namespace Bench
+{
+    class Recorder
+    {
+    public:
+        size_t phase(const std::string& name, const std::string& unit = "us");
+        void add(size_t phase, double value);
+
+        template <typename F>
+        void time(const size_t phase, F&& fn)
+        {
+            const auto start = std::chrono::steady_clock::now();
+            fn();
+            add(phase, std::chrono::duration<double, std::micro>(std::chrono::steady_clock::now() - start).count());
+        }
+
+        void print(const std::string& title) const;
+
+    private:
+        struct Phase
+        {
+            std::string name, unit;
+            std::vector<double> samples;
+        };
+
+        std::vector<Phase> phases;
+    };
+
+    struct Context
+    {
+        UIRoot& ui;
+        Recorder& recorder;
+        Font &codeFont, &uiFont;
+        ScriptRuntime& script;
+        int frames = 600, warmup = 30;
+        double dt = 1.0 / 60.0;
+        std::string tracePath;
+
+        Input::TracePlayer* replay = nullptr;
+        Input::TraceRecorder* traceRecorder = nullptr;
+    };
+
+    using PadScript = std::function<void(HostPad::State& pad, int frame)>;
+    void runFrames(Context& ctx, const PadScript& script);
+    void runFrames(UIRoot& ui, Context& ctx, const PadScript& script);
+
+    struct Scenario
+    {
+        const char *name = "", *description = "";
+        std::function<void(Context&)> run;
+    };
+
+    std::vector<Scenario>& scenarios();
+
+    struct Register
+    {
+        explicit Register(Scenario s) { scenarios().push_back(std::move(s)); }
+    };
+
+    std::string writeWorkspaceFile(const std::string& name, const std::string& text);
+    std::string sampleSource(int lines);
+}
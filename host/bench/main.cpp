@@ -0,0 +1,101 @@
+#include <cstdio>
+#include <cstdlib>
+#include <cstring>
+#include <algorithm>
+
+#include "./bench.h"
+#include "../../src/debug/memory.h"
+
+static void usage(const char* argv0)
+{
+    printf("Usage: %s [--list] [--frames N] [--warmup N] [--sd DIR] [--trace FILE] [--memory] [scenario...]\n", argv0);
+}
+
+int main(const int argc, char** argv)
+{
+    Thread::init();
+    int frames = 600, warmup = 30;
+    std::string tracePath;
+    bool memory = false;
+    std::vector<std::string> selected;
+#ifdef WIISCRIPT_HOST_SD_ROOT
+    FileSystem::hostSdRoot = WIISCRIPT_HOST_SD_ROOT;
+#endif
+
+    for (int i = 1; i < argc; ++i)
+    {
+        const char* arg = argv[i];
+        if (std::strcmp(arg, "--list") == 0)
+        {
+            for (const auto& s : Bench::scenarios()) printf("%-12s %s\n", s.name, s.description);
+            return EXIT_SUCCESS;
+        }
+        if (std::strcmp(arg, "--frames") == 0 && i + 1 < argc) frames = std::max(1, std::atoi(argv[++i]));
+        else if (std::strcmp(arg, "--warmup") == 0 && i + 1 < argc) warmup = std::max(0, std::atoi(argv[++i]));
+        else if (std::strcmp(arg, "--sd") == 0 && i + 1 < argc) FileSystem::hostSdRoot = argv[++i];
+        else if (std::strcmp(arg, "--trace") == 0 && i + 1 < argc) tracePath = argv[++i];
+        else if (std::strcmp(arg, "--memory") == 0) memory = true;
+        else if (arg[0] == '-')
+        {
+            usage(argv[0]);
+            return EXIT_FAILURE;
+        }
+        else selected.emplace_back(arg);
+    }
+
+    if (!Input::init() || !Time::init())
+    {
+        printf("Failed to initialize platform!\n");
+        return EXIT_FAILURE;
+    }
+    if (!FileSystem::init() || !FileSystem::ensureDir(FileSystem::workspaceRoot))
+    {
+        printf("Failed to open SD root '%s'!\n", FileSystem::hostSdRoot.c_str());
+        return EXIT_FAILURE;
+    }
+
+    Font codeFont, uiFont;
+    if (!codeFont.load(FileSystem::appRoot + "code.ttf", 16) || !uiFont.load(FileSystem::appRoot + "ui.ttf", 14))
+    {
+        printf("Failed to load fonts from '%s'!\n", FileSystem::appRoot.c_str());
+        return EXIT_FAILURE;
+    }
+
+    GXBackend scriptBackend(uiFont);
+    ScriptRuntime script(scriptBackend);
+
+    auto& list = Bench::scenarios();
+    std::sort(list.begin(), list.end(), [](const Bench::Scenario& a, const Bench::Scenario& b)
+    {
+        return std::strcmp(a.name, b.name) < 0;
+    });
+
+    int ran = 0;
+    for (const auto& s : list)
+    {
+        if (!selected.empty() && std::find(selected.begin(), selected.end(), s.name) == selected.end()) continue;
+
+        HostPad::state() = {};
+        UIRoot ui(640, 480, codeFont, uiFont, script);
+        Bench::Recorder recorder;
+        Bench::Context ctx = {
+            .ui = ui, .recorder = recorder, .codeFont = codeFont, .uiFont = uiFont, .script = script, .frames = frames,
+            .warmup = warmup, .tracePath = tracePath
+        };
+
+        s.run(ctx);
+        recorder.print(std::string(s.name) + " (" + std::to_string(frames) + " frames): " + s.description);
+#ifdef WIISCRIPT_MEMORY
+        if (memory) Memory::dump(stdout);
+#endif
+        ran++;
+    }
+
+    if (ran == 0)
+    {
+        printf("No matching scenarios, use --list to see them.\n");
+        return EXIT_FAILURE;
+    }
+
+    return EXIT_SUCCESS;
+}
@@ -0,0 +1,144 @@
+#include "./bench.h"
+#include "../../src/gfx/rounded_rect.h"
+
+static Bench::Register batching({
+    .name = "batching",
+    .description = "UI draw list flushed with adjacent commands of the same state merged",
+    .run = [](Bench::Context& ctx)
+    {
+        ctx.ui.editor->loadFile(Bench::writeWorkspaceFile("bench_batching.lua", Bench::sampleSource(400)));
+        ctx.ui.showConsole = true;
+
+        Bench::Recorder& rec = ctx.recorder;
+        const size_t time = rec.phase("draw"), commands = rec.phase("commands", ""),
+                     submissions = rec.phase("submissions", ""), scissors = rec.phase("scissors", "");
+
+        RecordingBackend backend;
+        for (int frame = 0; frame < ctx.warmup + ctx.frames; ++frame)
+        {
+            ctx.ui.layout();
+            ctx.ui.update(ctx.dt);
+            backend.reset();
+            if (frame < ctx.warmup)
+            {
+                ctx.ui.draw(backend);
+                continue;
+            }
+
+            rec.time(time, [&] { ctx.ui.draw(backend); });
+            rec.add(commands, static_cast<double>(ctx.ui.drawList().lastFlush().commands));
+            rec.add(submissions, static_cast<double>(backend.submissions));
+            rec.add(scissors, static_cast<double>(backend.scissors));
+        }
+    }
+});
+
+static Bench::Register keyboard({
+    .name = "keyboard",
+    .description = "On-screen keyboard drawn from a freshly compiled vs cached display list",
+    .run = [](Bench::Context& ctx)
+    {
+        Bench::Recorder& rec = ctx.recorder;
+        const size_t cold = rec.phase("draw.compile"), warm = rec.phase("draw.cached"),
+                     submissions = rec.phase("submissions", ""), vertices = rec.phase("vertices", "");
+
+        ctx.ui.layout();
+        ctx.ui.update(ctx.dt);
+
+        CommandBuffer list(1024, 4096);
+        RecordingBackend backend;
+        for (int frame = 0; frame < ctx.warmup + ctx.frames; ++frame)
+        {
+            const bool record = frame >= ctx.warmup;
+
+            setTheme(theme());
+            if (record) rec.time(cold, [&] { ctx.ui.keyboard->draw(list); });
+            else ctx.ui.keyboard->draw(list);
+            list.clear();
+
+            backend.reset();
+            if (record) rec.time(warm, [&] { ctx.ui.keyboard->draw(list); });
+            else ctx.ui.keyboard->draw(list);
+            list.flush(backend);
+
+            if (!record) continue;
+            size_t n = 0;
+            for (const auto& e : backend.entries) if (e.command.mesh) n += e.command.mesh->vertices.size();
+            rec.add(submissions, static_cast<double>(backend.submissions));
+            rec.add(vertices, static_cast<double>(n));
+        }
+    }
+});
+
+static Bench::Register rounded({
+    .name = "rounded",
+    .description = "Rounded-rect vertex build with and without the geometry cache, single vs batched submission",
+    .run = [](Bench::Context& ctx)
+    {
+        Bench::Recorder& rec = ctx.recorder;
+        const size_t uncached = rec.phase("build.uncached"), cached = rec.phase("build.cached"),
+                     single = rec.phase("submit.single"), batched = rec.phase("submit.batched"),
+                     singleCalls = rec.phase("calls.single", ""), batchedCalls = rec.phase("calls.batched", "");
+
+        // Roughly the UI's mix: a handful of distinct key, button and panel sizes drawn many times over.
+        std::vector<RoundedRectDraw> rects;
+        for (int i = 0; i < 240; ++i)
+        {
+            const float w = i % 5 == 0 ? 200.0f : 24.0f + static_cast<float>(i % 3) * 12.0f;
+            rects.push_back({.x = static_cast<float>(i % 20) * 30.0f, .y = static_cast<float>(i / 20) * 30.0f, .w = w,
+                             .h = 26.0f, .radiusX = 6.0f, .radiusY = 6.0f, .color = 0x333346FF});
+        }
+
+        std::vector<guVector> vertices;
+        std::vector<uint32_t> colors;
+        vertices.reserve(rects.size() * GeometryCache::MAX_VERTICES);
+        colors.reserve(vertices.capacity());
+
+        auto build = [&]
+        {
+            vertices.clear();
+            colors.clear();
+            for (const auto& r : rects) appendRoundedRect(r, true, vertices, colors);
+        };
+
+        // What every rounded rect cost before the cache: a fresh outline from the trig table, then the fan quads.
+        auto buildUncached = [&]
+        {
+            vertices.clear();
+            colors.clear();
+            RoundedOutline outline = {};
+            for (const auto& r : rects)
+            {
+                roundedRectOutline(r.x, r.y, r.w, r.h, r.radiusX, r.radiusY, outline);
+                for (int k = 1; k + 2 < VERTICES; k += 2)
+                {
+                    vertices.push_back(outline[0]);
+                    for (int j = 0; j < 3; ++j) vertices.push_back(outline[k + j]);
+                    colors.insert(colors.end(), 4, r.color);
+                }
+            }
+        };
+
+        for (int frame = 0; frame < ctx.warmup + ctx.frames; ++frame)
+        {
+            const bool record = frame >= ctx.warmup;
+
+            if (record) rec.time(uncached, buildUncached);
+            if (record) rec.time(cached, build);
+            else build();
+
+            HostGfx::resetStats();
+            if (record) rec.time(single, [&] { for (const auto& r : rects)
+                roundedRectangle(r.x, r.y, r.w, r.h, r.radiusX, r.radiusY, r.color, true); });
+            if (record) rec.add(singleCalls, static_cast<double>(HostGfx::stats().submissions));
+
+            HostGfx::resetStats();
+            if (record) rec.time(batched, [&] { roundedRectangles(rects.data(), rects.size(), true); });
+            if (record) rec.add(batchedCalls, static_cast<double>(HostGfx::stats().submissions));
+        }
+
+        const auto& s = GeometryCache::stats();
+        printf("  geometry cache: %llu hits, %llu misses\n", static_cast<unsigned long long>(s.hits),
+               static_cast<unsigned long long>(s.misses));
+    }
+});
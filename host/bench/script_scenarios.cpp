@@ -0,0 +1,94 @@
+#include "./bench.h"
+#include "../../src/script/modules.h"
+
+// The same particle update written against plain Lua tables and against the vec module, per value and in bulk.
+static constexpr const char* VEC_SOURCE = R"(
+local N = 10000
+local m = vec.rotation(0.3) * vec.translation(1, 2, 3)
+local mt = {}
+for i = 1, 16 do mt[i] = m[i] end
+
+local tp, tv, vp, vv = {}, {}, {}, {}
+local ap, av = vec.array(N, 3), vec.array(N, 3)
+for i = 1, N do
+    tp[i], tv[i] = {x = i, y = -i, z = i * 0.5}, {x = 0.5, y = 0.25, z = -1}
+    vp[i], vv[i] = vec.vec3(i, -i, i * 0.5), vec.vec3(0.5, 0.25, -1)
+    ap:set(i, i, -i, i * 0.5)
+    av:set(i, 0.5, 0.25, -1)
+end
+local dots = vec.array(N, 1)
+
+function table_add()
+    for i = 1, N do
+        local p, v = tp[i], tv[i]
+        p.x, p.y, p.z = p.x + v.x, p.y + v.y, p.z + v.z
+    end
+end
+
+function vec_add_values()
+    for i = 1, N do vec.add(vp[i], vv[i], vp[i]) end
+end
+
+function vec_add_array() vec.add(ap, av, ap) end
+
+function table_transform()
+    for i = 1, N do
+        local p = tp[i]
+        local x, y, z = p.x, p.y, p.z
+        p.x = mt[1] * x + mt[5] * y + mt[9] * z + mt[13]
+        p.y = mt[2] * x + mt[6] * y + mt[10] * z + mt[14]
+        p.z = mt[3] * x + mt[7] * y + mt[11] * z + mt[15]
+    end
+end
+
+function vec_transform_values()
+    for i = 1, N do vec.transform(m, vp[i], vp[i]) end
+end
+
+function vec_transform_array() vec.transform(m, ap, ap) end
+
+function table_dot()
+    local sum = 0
+    for i = 1, N do
+        local p, v = tp[i], tv[i]
+        sum = sum + p.x * v.x + p.y * v.y + p.z * v.z
+    end
+    return sum
+end
+
+function vec_dot_array() vec.dot(ap, av, dots) end
+)";
+
+static Bench::Register vecKernels({
+    .name = "vec",
+    .description = "Updating 10000 vec3s as Lua tables vs vec userdata, per value and as whole arrays",
+    .run = [](Bench::Context& ctx)
+    {
+        // Through the runtime, so the state uses its tracked allocator and --memory charges it to the lua category.
+        if (std::string err; !ctx.script.run(VEC_SOURCE, "=vec", &err))
+        {
+            printf("  %s\n", err.c_str());
+            return;
+        }
+
+        lua_State* L = ctx.script.state();
+        Bench::Recorder& rec = ctx.recorder;
+        for (const char* fn : {"table_add", "vec_add_values", "vec_add_array", "table_transform",
+                               "vec_transform_values", "vec_transform_array", "table_dot", "vec_dot_array"})
+        {
+            const size_t phase = rec.phase(fn);
+            for (int run = 0; run < 20; ++run)
+                rec.time(phase, [&]
+                {
+                    lua_getglobal(L, fn);
+                    if (lua_pcall(L, 0, 0, 0) != LUA_OK)
+                    {
+                        printf("  %s: %s\n", fn, lua_tostring(L, -1));
+                        lua_pop(L, 1);
+                    }
+                });
+        }
+
+        ctx.script.stop();
+    }
+});
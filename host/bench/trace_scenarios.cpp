@@ -0,0 +1,95 @@
+#include "./bench.h"
+
+#include <cstdio>
+
+static std::string editorState(const UIRoot& ui)
+{
+    const std::string text = ui.editor->getText();
+    return std::to_string(text.size()) + ":" + std::to_string(std::hash<std::string>{}(text));
+}
+
+static void recordSession(Bench::Context& ctx, const std::string& path)
+{
+    std::vector<Rect> keys;
+    Input::TraceRecorder recorder;
+    recorder.start(path);
+    ctx.traceRecorder = &recorder;
+
+    Bench::runFrames(ctx, [&](HostPad::State& pad, const int frame)
+    {
+        pad.pointerValid = true;
+        if (frame < 8)
+        {
+            const Rect r = ctx.ui.editor->worldBounds();
+            pad.pointerX = r.x + r.w / 2;
+            pad.pointerY = r.y + r.h / 2;
+            pad.held = frame == 4 ? WPAD_BUTTON_A : 0;
+
+            return;
+        }
+
+        if (keys.empty())
+            for (const auto& c : ctx.ui.keyboard->children)
+                if (dynamic_cast<KeyButton*>(c.get())) keys.push_back(c->worldBounds());
+
+        const Rect& key = keys[frame / 3 % keys.size()];
+        pad.pointerX = key.x + key.w / 2;
+        pad.pointerY = key.y + key.h / 2;
+        pad.held = frame % 3 == 0 ? WPAD_BUTTON_A : 0;
+        pad.nunchuk = frame / 200 % 2 == 1;
+        pad.stickY = pad.nunchuk ? 60 : 0;
+    });
+
+    ctx.traceRecorder = nullptr;
+    if (std::string err; !recorder.stop(&err)) printf("  %s\n", err.c_str());
+}
+
+static Bench::Register replay({
+    .name = "replay",
+    .description = "Replays an input trace (--trace, or a recorded typing session) with a fixed dt",
+    .run = [](Bench::Context& ctx)
+    {
+        const std::string source = Bench::writeWorkspaceFile("bench_replay.lua", Bench::sampleSource(400));
+        ctx.ui.editor->loadFile(source);
+
+        std::string path = ctx.tracePath, expected;
+        if (path.empty())
+        {
+            path = FileSystem::join(FileSystem::workspaceRoot, "traces/bench.wst");
+            Bench::Recorder discard;
+            Bench::Context recordCtx = {
+                .ui = ctx.ui, .recorder = discard, .codeFont = ctx.codeFont, .uiFont = ctx.uiFont,
+                .script = ctx.script, .frames = ctx.frames, .warmup = ctx.warmup
+            };
+
+            recordSession(recordCtx, path);
+            expected = editorState(ctx.ui);
+        }
+
+        Input::TracePlayer player;
+        if (std::string err; !player.load(path, &err))
+        {
+            printf("  %s\n", err.c_str());
+            return;
+        }
+
+        ctx.replay = &player;
+        std::string states[2];
+        for (auto& state : states)
+        {
+            player.rewind();
+            HostPad::state() = {};
+
+            UIRoot ui(640, 480, ctx.codeFont, ctx.uiFont, ctx.script);
+            ui.editor->loadFile(source);
+            Bench::runFrames(ui, ctx, nullptr);
+
+            state = editorState(ui);
+        }
+        ctx.replay = nullptr;
+
+        const bool deterministic = states[0] == states[1] && (expected.empty() || expected == states[0]);
+        printf("  %zu frames (%.1f s recorded), editor state %s: %s\n", player.frameCount(), player.recordedSeconds(),
+               states[0].c_str(), deterministic ? "deterministic" : "MISMATCH");
+    }
+});
@@ -0,0 +1,574 @@
+#include "./bench.h"
+
+#include <algorithm>
+
+#include <thread>
+
+static void pointAt(HostPad::State& pad, const Rect& r)
+{
+    pad.pointerValid = true;
+    pad.pointerX = r.x + r.w / 2;
+    pad.pointerY = r.y + r.h / 2;
+}
+
+static void tap(HostPad::State& pad, const int frame, const int period, const uint32_t button)
+{
+    if (frame % period == 0) pad.held |= button;
+    else pad.held &= ~button;
+}
+
+static void focusEditor(UIRoot& ui, HostPad::State& pad, const int frame)
+{
+    if (frame == 1) pointAt(pad, ui.editor->worldBounds());
+    if (frame == 2) pad.held |= WPAD_BUTTON_A;
+    if (frame == 3) pad.held &= ~WPAD_BUTTON_A;
+}
+
+static Bench::Register idle({
+    .name = "idle",
+    .description = "Editor open on a 400-line file, no input",
+    .run = [](Bench::Context& ctx)
+    {
+        ctx.ui.editor->loadFile(Bench::writeWorkspaceFile("bench_idle.lua", Bench::sampleSource(400)));
+        Bench::runFrames(ctx, nullptr);
+    }
+});
+
+static Bench::Register pointer({
+    .name = "pointer",
+    .description = "Pointer sweeping across the whole screen",
+    .run = [](Bench::Context& ctx)
+    {
+        ctx.ui.editor->loadFile(Bench::writeWorkspaceFile("bench_pointer.lua", Bench::sampleSource(400)));
+        Bench::runFrames(ctx, [](HostPad::State& pad, const int frame)
+        {
+            pad.pointerValid = true;
+            pad.pointerX = static_cast<float>(frame * 7 % 640);
+            pad.pointerY = static_cast<float>(frame * 3 % 480);
+        });
+    }
+});
+
+static Bench::Register typing({
+    .name = "typing",
+    .description = "Typing into the editor through the on-screen keyboard",
+    .run = [](Bench::Context& ctx)
+    {
+        ctx.ui.editor->loadFile(Bench::writeWorkspaceFile("bench_typing.lua", Bench::sampleSource(400)));
+
+        std::vector<Rect> keys;
+        Bench::runFrames(ctx, [&](HostPad::State& pad, const int frame)
+        {
+            if (frame < 4) return focusEditor(ctx.ui, pad, frame);
+            if (keys.empty())
+                for (const auto& c : ctx.ui.keyboard->children)
+                    if (const auto* key = dynamic_cast<KeyButton*>(c.get()))
+                        keys.push_back(key->worldBounds());
+            if (keys.empty()) return;
+
+            pointAt(pad, keys[frame / 2 % keys.size()]);
+            tap(pad, frame, 2, WPAD_BUTTON_A);
+        });
+    }
+});
+
+static Bench::Register scroll({
+    .name = "scroll",
+    .description = "Scrolling a 5000-line file with the nunchuk stick",
+    .run = [](Bench::Context& ctx)
+    {
+        ctx.ui.editor->loadFile(Bench::writeWorkspaceFile("bench_scroll.lua", Bench::sampleSource(5000)));
+        Bench::runFrames(ctx, [&](HostPad::State& pad, const int frame)
+        {
+            if (frame < 4) return focusEditor(ctx.ui, pad, frame);
+
+            pad.nunchuk = true;
+            pad.stickY = frame / 240 % 2 == 0 ? -100 : 100;
+        });
+    }
+});
+
+static Bench::Register caret({
+    .name = "caret",
+    .description = "Moving the caret through a 2000-line file with the D-pad",
+    .run = [](Bench::Context& ctx)
+    {
+        ctx.ui.editor->loadFile(Bench::writeWorkspaceFile("bench_caret.lua", Bench::sampleSource(2000)));
+        Bench::runFrames(ctx, [&](HostPad::State& pad, const int frame)
+        {
+            if (frame < 4) return focusEditor(ctx.ui, pad, frame);
+
+            pad.held &= ~(WPAD_BUTTON_DOWN | WPAD_BUTTON_RIGHT);
+            pad.held |= frame / 120 % 2 == 0 ? WPAD_BUTTON_DOWN : WPAD_BUTTON_RIGHT;
+        });
+    }
+});
+
+static Bench::Register find({
+    .name = "find",
+    .description = "Find in files over 150 files while the results stream in, paced to 60 Hz",
+    .run = [](Bench::Context& ctx)
+    {
+        FileSystem::ensureDir(FileSystem::join(FileSystem::workspaceRoot, "bench_find"));
+        for (int i = 0; i < 150; ++i)
+            Bench::writeWorkspaceFile("bench_find/file" + std::to_string(i) + ".lua", Bench::sampleSource(800));
+
+        // Frames are paced to 60 Hz: on the Wii the background worker only runs while the main thread waits for vsync.
+        ctx.warmup = 0;
+        ctx.ui.findInFiles("step120(");
+        Bench::runFrames(ctx, [](HostPad::State&, int)
+        {
+            std::this_thread::sleep_for(std::chrono::microseconds(16667));
+        });
+        printf("  %s\n", ctx.ui.resultsList->items[0].c_str());
+    }
+});
+
+static Bench::Register bufferSearch({
+    .name = "bufsearch",
+    .description = "Incremental find, edits with highlights on, and replace-all in a 6000-line buffer",
+    .run = [](Bench::Context& ctx)
+    {
+        TextInput& editor = *ctx.ui.editor;
+        editor.loadFile(Bench::writeWorkspaceFile("bench_bufsearch.lua", Bench::sampleSource(6000)));
+        editor.focused = true;
+        const std::string original = editor.getText(), pattern = "state.vx";
+
+        Bench::Recorder& rec = ctx.recorder;
+        const size_t incremental = rec.phase("find.incremental"), rescan = rec.phase("find.rescan"),
+                     edit = rec.phase("edit.sync"), replace = rec.phase("replace.all"),
+                     undo = rec.phase("replace.undo");
+
+        // Per keystroke of the pattern: narrowing the previous hits against searching from scratch.
+        for (int run = 0; run < 20; ++run)
+        {
+            editor.clearSearch();
+            for (size_t n = 1; n <= pattern.size(); ++n)
+                rec.time(incremental, [&] { editor.findIncremental(pattern.substr(0, n), {}); });
+            for (size_t n = 1; n <= pattern.size(); ++n)
+                rec.time(rescan, [&]
+                {
+                    editor.clearSearch();
+                    editor.findIncremental(pattern.substr(0, n), {});
+                });
+        }
+        printf("  '%s': %zu matches\n", pattern.c_str(), editor.search().count());
+
+        editor.select({3001, 4}, {3001, 4});
+        for (int i = 0; i < 100; ++i)
+        {
+            editor.onKey("x", KeyAction::Text);
+            rec.time(edit, [&] { editor.update(ctx.dt); });
+        }
+        for (int i = 0; i < 100; ++i) editor.onKey(nullptr, KeyAction::Backspace);
+        editor.update(ctx.dt);
+
+        size_t replaced = 0;
+        bool restored = true;
+        for (int run = 0; run < 10; ++run)
+        {
+            rec.time(replace, [&] { replaced = editor.replaceAll("state.VX"); });
+            rec.time(undo, [&] { editor.undo(); });
+            restored = restored && editor.getText() == original;
+        }
+        printf("  replaced %zu in one command, undo %s the buffer\n", replaced,
+               restored ? "restores" : "does NOT restore");
+    }
+});
+
+static Bench::Register patternSearch({
+    .name = "pattern",
+    .description = "Lua-pattern and regex search of a 6000-line buffer, whole and in 2 ms frame slices",
+    .run = [](Bench::Context& ctx)
+    {
+        TextBuffer source, hostile, minified;
+        source.setText(Bench::sampleSource(6000));
+        hostile.setText(std::string(2000, 'a') + "\n");
+        for (int i = 0; i < 7; ++i) hostile.setText(hostile.getText() + hostile.getText());
+        std::string oneLine = Bench::sampleSource(6000);
+        std::replace(oneLine.begin(), oneLine.end(), '\n', ' ');
+        minified.setText(oneLine);
+
+        struct Case
+        {
+            const char* name;
+            const char* pattern;
+            Pattern::Syntax syntax;
+            const TextBuffer& buffer;
+        };
+        const Case cases[] = {
+            {"lua", "%f[%w]step%d+%(", Pattern::Syntax::Lua, source},
+            {"regex", "state\\.v[xy]\\b", Pattern::Syntax::Regex, source},
+            {"hostile", "(a|aa)*(a|aa)*c", Pattern::Syntax::Regex, hostile},
+            {"minified", "state\\.v[xy]\\b", Pattern::Syntax::Regex, minified},
+        };
+
+        Bench::Recorder& rec = ctx.recorder;
+        const size_t compile = rec.phase("compile"), slice = rec.phase("slice (2 ms budget)");
+        for (const Case& c : cases)
+        {
+            const size_t whole = rec.phase(std::string("scan.") + c.name);
+            BufferSearch search;
+            size_t frames = 0;
+            for (int run = 0; run < 5; ++run)
+            {
+                rec.time(compile, [&] { Pattern().compile(c.pattern, c.syntax); });
+
+                search.clear();
+                rec.time(whole, [&]
+                {
+                    search.setPattern(c.pattern, c.buffer, c.syntax);
+                    search.resume(c.buffer, 60.0);
+                });
+
+                search.clear();
+                search.setPattern(c.pattern, c.buffer, c.syntax);
+                for (frames = 0; !search.complete(); ++frames)
+                    rec.time(slice, [&] { search.resume(c.buffer, 0.002); });
+            }
+
+            printf("  %-8s %-22s %zu matches, %zu lines, %zu frames at 2 ms\n", c.name, c.pattern, search.count(),
+                   c.buffer.lineCount(), frames);
+        }
+    }
+});
+
+static Bench::Register blockIndex({
+    .name = "blocks",
+    .description = "Bracket/block matching and nesting depth in a 6000-line buffer, and the upkeep per edit",
+    .run = [](Bench::Context& ctx)
+    {
+        TextBuffer buffer;
+        buffer.setText("do\n" + Bench::sampleSource(6000) + "end\n");
+
+        Bench::Recorder& rec = ctx.recorder;
+        const size_t build = rec.phase("build"), match = rec.phase("match"), rescan = rec.phase("match.rescan"),
+                     depth = rec.phase("depth (30 rows)"), edit = rec.phase("edit.sync"),
+                     cascade = rec.phase("edit.long-comment");
+
+        BlockIndex blocks;
+        for (int run = 0; run < 10; ++run)
+            rec.time(build, [&]
+            {
+                blocks.clear();
+                blocks.sync(buffer);
+            });
+
+        // The outer do/end spans the whole buffer, the worst case for a scan and an ordinary one for the tree.
+        BlockIndex::Match m;
+        for (int run = 0; run < 200; ++run) rec.time(match, [&] { blocks.match({0, 0}, m); });
+        printf("  do at line 0 pairs with %s at line %zu\n", m.paired ? "end" : "nothing", m.partner.line);
+        for (int run = 0; run < 10; ++run)
+            rec.time(rescan, [&]
+            {
+                BlockIndex fresh;
+                fresh.sync(buffer);
+                fresh.match({0, 0}, m);
+            });
+
+        size_t deepest = 0;
+        for (int run = 0; run < 200; ++run)
+            rec.time(depth, [&]
+            {
+                for (size_t line = 3000; line < 3030; ++line) deepest = std::max(deepest, blocks.depth(line));
+            });
+        printf("  deepest visible row nests %zu blocks\n", deepest);
+
+        for (int run = 0; run < 100; ++run)
+        {
+            buffer.getLines()[3001].insert(4, "(");
+            buffer.noteEdit(3001, 1, 1);
+            rec.time(edit, [&] { blocks.sync(buffer); });
+            buffer.getLines()[3001].erase(4, 1);
+            buffer.noteEdit(3001, 1, 1);
+            blocks.sync(buffer);
+        }
+
+        // Opening a long comment re-lexes everything after it; closing it again does the same.
+        for (int run = 0; run < 10; ++run)
+        {
+            buffer.getLines()[1].insert(0, "--[[");
+            buffer.noteEdit(1, 1, 1);
+            rec.time(cascade, [&] { blocks.sync(buffer); });
+            buffer.getLines()[1].erase(0, 4);
+            buffer.noteEdit(1, 1, 1);
+            blocks.sync(buffer);
+        }
+
+        blocks.match({0, 0}, m);
+        printf("  after the edits: do at line 0 pairs with line %zu\n", m.partner.line);
+    }
+});
+
+static Bench::Register folding({
+    .name = "folds",
+    .description = "Folding every function in a 6000-line buffer, then row math, edits and caret moves across folds",
+    .run = [](Bench::Context& ctx)
+    {
+        TextInput& editor = *ctx.ui.editor;
+        editor.loadFile(Bench::writeWorkspaceFile("bench_folds.lua", Bench::sampleSource(6000)));
+        editor.focused = true;
+        editor.update(ctx.dt);
+
+        Bench::Recorder& rec = ctx.recorder;
+        const size_t fold = rec.phase("fold (each)"), convert = rec.phase("row<->line x1000"),
+                     type = rec.phase("edit.type"), enter = rec.phase("edit.newline");
+
+        for (size_t line = 0; line < 6000; line += 8)
+        {
+            editor.select({line, 0}, {line, 0});
+            rec.time(fold, [&] { editor.toggleFold(); });
+        }
+
+        const TextCursor& cursor = editor.cursor();
+        size_t checksum = 0;
+        for (int run = 0; run < 50; ++run)
+            rec.time(convert, [&]
+            {
+                for (size_t i = 0; i < 1000; ++i) checksum += cursor.row(cursor.lineAt(i * 7 % cursor.rowCount()));
+            });
+        printf("  %zu lines shown on %zu rows (checksum %zu)\n", editor.buffer().lineCount(), cursor.rowCount(),
+               checksum);
+
+        // Same-line edits leave the rows alone; a new line shifts every fold after it and rebuilds the tree.
+        editor.select({3000, 0}, {3000, 0});
+        for (int i = 0; i < 50; ++i)
+        {
+            editor.onKey("x", KeyAction::Text);
+            rec.time(type, [&] { editor.update(ctx.dt); });
+        }
+        for (int i = 0; i < 50; ++i)
+        {
+            editor.onKey(nullptr, KeyAction::Enter);
+            rec.time(enter, [&] { editor.update(ctx.dt); });
+        }
+        editor.update(ctx.dt);
+        printf("  after edits: %zu rows\n", cursor.rowCount());
+
+        editor.select({0, 0}, {0, 0});
+        Bench::runFrames(ctx, [&](HostPad::State& pad, const int frame)
+        {
+            if (frame < 4) return focusEditor(ctx.ui, pad, frame);
+
+            pad.held &= ~WPAD_BUTTON_DOWN;
+            if (frame % 2 == 0) pad.held |= WPAD_BUTTON_DOWN;
+        });
+        printf("  caret ended on line %zu\n", editor.selection().end.line);
+    }
+});
+
+static Bench::Register softWrap({
+    .name = "wrap",
+    .description = "Soft wrap of a 6000-line buffer with long lines: full and per-edit rewrap, row math, caret moves",
+    .run = [](Bench::Context& ctx)
+    {
+        std::string source = Bench::sampleSource(6000), text;
+        size_t line = 0;
+        for (size_t at = 0, next = 0; at < source.size(); at = next + 1, ++line)
+        {
+            next = std::min(source.find('\n', at), source.size());
+            text.append(source, at, next - at);
+            if (line % 3 == 0)
+                text += " -- a trailing comment long enough to need a second row, and now and then a third";
+            text += '\n';
+        }
+
+        TextInput& editor = *ctx.ui.editor;
+        editor.loadFile(Bench::writeWorkspaceFile("bench_wrap.lua", text));
+        ctx.ui.layout();
+        editor.focused = true;
+        editor.update(ctx.dt);
+
+        Bench::Recorder& rec = ctx.recorder;
+        const size_t full = rec.phase("rewrap all"), convert = rec.phase("row<->line x1000"),
+                     type = rec.phase("edit.type"), enter = rec.phase("edit.newline");
+
+        for (int run = 0; run < 10; ++run)
+        {
+            editor.setSoftWrap(false);
+            editor.update(ctx.dt);
+            editor.setSoftWrap(true);
+            rec.time(full, [&] { editor.update(ctx.dt); });
+        }
+
+        const TextCursor& cursor = editor.cursor();
+        size_t checksum = 0;
+        for (int run = 0; run < 50; ++run)
+            rec.time(convert, [&]
+            {
+                for (size_t i = 0; i < 1000; ++i)
+                {
+                    size_t lineRow = 0;
+                    checksum += cursor.row(cursor.lineAt(i * 7 % cursor.rowCount(), &lineRow)) + lineRow;
+                }
+            });
+        printf("  %zu lines wrapped onto %zu rows (checksum %zu)\n", editor.buffer().lineCount(), cursor.rowCount(),
+               checksum);
+
+        // Typing rewraps one line; a new line also shifts the break points after it.
+        editor.select({3000, 0}, {3000, 0});
+        for (int i = 0; i < 50; ++i)
+        {
+            editor.onKey("x", KeyAction::Text);
+            rec.time(type, [&] { editor.update(ctx.dt); });
+        }
+        for (int i = 0; i < 50; ++i)
+        {
+            editor.onKey(nullptr, KeyAction::Enter);
+            rec.time(enter, [&] { editor.update(ctx.dt); });
+        }
+        editor.update(ctx.dt);
+        printf("  after edits: %zu rows\n", cursor.rowCount());
+
+        editor.select({0, 0}, {0, 0});
+        Bench::runFrames(ctx, [&](HostPad::State& pad, const int frame)
+        {
+            if (frame < 4) return focusEditor(ctx.ui, pad, frame);
+
+            pad.held &= ~WPAD_BUTTON_DOWN;
+            if (frame % 2 == 0) pad.held |= WPAD_BUTTON_DOWN;
+        });
+        printf("  caret ended on line %zu\n", editor.selection().end.line);
+        editor.setSoftWrap(false);
+    }
+});
+
+static Bench::Register completion({
+    .name = "complete",
+    .description = "Identifier completion over a 6000-line buffer: index build, prefix lookups, per-edit upkeep, picks",
+    .run = [](Bench::Context& ctx)
+    {
+        TextBuffer buffer;
+        buffer.setText(Bench::sampleSource(6000));
+        BlockIndex blocks;
+        blocks.sync(buffer);
+        std::vector<std::string> globals;
+        ScriptRuntime::globalNames(globals);
+
+        Bench::Recorder& rec = ctx.recorder;
+        const size_t build = rec.phase("build"), one = rec.phase("lookup 's'"), two = rec.phase("lookup 'st'"),
+                     longer = rec.phase("lookup 'step12'"), edit = rec.phase("edit.sync");
+
+        IdentifierIndex words;
+        for (int run = 0; run < 10; ++run)
+            rec.time(build, [&]
+            {
+                words.clear();
+                words.addNames(globals);
+                words.sync(buffer, blocks);
+            });
+        printf("  %zu distinct words, %zu of them runtime globals\n", words.size(), globals.size());
+
+        // "st" covers "state" and every one of the 750 "stepN" functions, the widest subtree the buffer has.
+        std::vector<std::string> found;
+        for (int run = 0; run < 200; ++run) rec.time(one, [&] { words.complete("s", 6, found); });
+        for (int run = 0; run < 200; ++run) rec.time(two, [&] { words.complete("st", 6, found); });
+        printf("  'st' ->");
+        for (const auto& w : found) printf(" %s", w.c_str());
+        printf("\n");
+        for (int run = 0; run < 200; ++run) rec.time(longer, [&] { words.complete("step12", 6, found); });
+
+        for (int run = 0; run < 100; ++run)
+        {
+            buffer.getLines()[3001] += run % 2 ? " velocity" : " speed";
+            buffer.noteEdit(3001, 1, 1);
+            blocks.sync(buffer);
+            rec.time(edit, [&] { words.sync(buffer, blocks); });
+        }
+
+        // Typing "st" and picking the first suggestion, over and over at the end of the buffer.
+        TextInput& editor = *ctx.ui.editor;
+        editor.loadFile(Bench::writeWorkspaceFile("bench_complete.lua", Bench::sampleSource(6000)));
+        std::vector<std::string> shown;
+        const auto showWords = editor.onCompletions;
+        editor.onCompletions = [&](const std::vector<std::string>& w)
+        {
+            shown = w;
+            if (showWords) showWords(w);
+        };
+
+        size_t picked = 0;
+        Bench::runFrames(ctx, [&](HostPad::State& pad, const int frame)
+        {
+            if (frame < 4) return focusEditor(ctx.ui, pad, frame);
+            if (frame == 4) editor.select({5999, 0}, {5999, 0});
+
+            switch (frame % 4)
+            {
+            case 0: editor.onKey("s", KeyAction::Text); break;
+            case 1: editor.onKey("t", KeyAction::Text); break;
+            case 2: if (!shown.empty() && ctx.ui.suggestions->onPick) ctx.ui.suggestions->onPick(shown[0]), picked++;
+                break;
+            default: editor.onKey(nullptr, KeyAction::Enter); break;
+            }
+        });
+        editor.onCompletions = showWords;
+        printf("  picked %zu suggestions\n", picked);
+    }
+});
+
+static void waitForScan(FindInFiles& finder)
+{
+    while (finder.progress().running) std::this_thread::yield();
+}
+
+static Bench::Register trigramIndex({
+    .name = "index",
+    .description = "Find in files over 300 files: full scan against trigram-index candidates",
+    .run = [](Bench::Context& ctx)
+    {
+        const std::string dir = FileSystem::join(FileSystem::workspaceRoot, "bench_index");
+        FileSystem::ensureDir(dir);
+        for (int i = 0; i < 300; ++i)
+            Bench::writeWorkspaceFile("bench_index/file" + std::to_string(i) + ".lua",
+                                      Bench::sampleSource(400) + "-- marker_" + std::to_string(i) + "\n");
+
+        const std::string indexPath = FileSystem::join(dir, ".index");
+        FileSystem::removePath(indexPath);
+
+        Bench::Recorder& rec = ctx.recorder;
+        const size_t build = rec.phase("index.build"), query = rec.phase("index.candidates");
+        const char* patterns[] = {"marker_137", "state.vx", "no_such_symbol"};
+
+        TrigramIndex index(dir, indexPath);
+        const std::atomic<bool> stop = false;
+        rec.time(build, [&] { index.prepare(stop); });
+
+        FindInFiles full, indexed;
+        indexed.setIndex(&index);
+        for (const char* pattern : patterns)
+        {
+            const size_t scan = rec.phase(std::string("scan.full '") + pattern + "'"),
+                         narrowed = rec.phase(std::string("scan.indexed '") + pattern + "'");
+
+            std::vector<std::string> paths;
+            for (int run = 0; run < 20; ++run)
+            {
+                rec.time(query, [&] { index.candidates(pattern, paths, stop); });
+                rec.time(scan, [&]
+                {
+                    full.start(dir, pattern);
+                    waitForScan(full);
+                });
+                rec.time(narrowed, [&]
+                {
+                    indexed.start(dir, pattern);
+                    waitForScan(indexed);
+                });
+            }
+
+            printf("  '%s': %zu of %zu files are candidates, %zu/%zu matches\n", pattern, paths.size(),
+                   index.fileCount(), indexed.progress().matches, full.progress().matches);
+        }
+
+        // An edit only marks the file dirty; it is searched directly until the next compaction.
+        const std::string edited = FileSystem::join(dir, "file5.lua");
+        const std::string text = Bench::sampleSource(400) + "-- marker_edited\n";
+        FileSystem::writeFile(edited, reinterpret_cast<const uint8_t*>(text.data()), text.size());
+        index.noteChange(FileSystem::Change::Written, FileSystem::normalize(edited), "");
+
+        indexed.start(dir, "marker_edited");
+        waitForScan(indexed);
+        printf("  after edit: %zu match, %zu dirty\n", indexed.progress().matches, index.dirtyCount());
+    }
+});
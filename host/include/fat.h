@@ -0,0 +1,6 @@
+#pragma once
+
+#include <cerrno>
+#include <sys/stat.h>
+
+bool fatInitDefault();
@@ -0,0 +1,68 @@
+#pragma once
+
+#include <cstdint>
+
+typedef uint8_t u8;
+typedef uint16_t u16;
+typedef uint32_t u32;
+typedef int32_t s32;
+typedef float f32;
+
+#define GX_QUADS 0x80
+#define GX_TRIANGLES 0x90
+#define GX_TRIANGLESTRIP 0x98
+#define GX_TRIANGLEFAN 0xA0
+#define GX_LINES 0xA8
+#define GX_LINESTRIP 0xB0
+#define GX_POINTS 0xB8
+
+struct guVector
+{
+    f32 x, y, z;
+};
+
+struct GRRLIB_ttfFont;
+
+struct GRRLIB_texImg
+{
+    u32 w, h;
+    int handlex, handley, offsetx, offsety;
+    bool tiledtex;
+    u32 tilew, tileh, nbtileh, nbtilew, tilestart;
+    void* data;
+};
+
+int GRRLIB_Init();
+void GRRLIB_Exit();
+void GRRLIB_Render();
+void GRRLIB_FillScreen(u32 color);
+void GRRLIB_SetBackgroundColour(u8 r, u8 g, u8 b, u8 a);
+
+void GRRLIB_GXEngine(const guVector v[], const u32 color[], u16 n, u8 fmt);
+void GRRLIB_Rectangle(f32 x, f32 y, f32 width, f32 height, u32 color, bool filled);
+void GRRLIB_Line(f32 x1, f32 y1, f32 x2, f32 y2, u32 color);
+void GRRLIB_Circle(f32 x, f32 y, f32 radius, u32 color, u8 filled);
+
+GRRLIB_ttfFont* GRRLIB_LoadTTF(const u8* file_base, s32 file_size);
+void GRRLIB_FreeTTF(GRRLIB_ttfFont* myFont);
+void GRRLIB_PrintfTTF(int x, int y, GRRLIB_ttfFont* myFont, const char* string, unsigned int fontSize, u32 color);
+unsigned int GRRLIB_WidthTTF(GRRLIB_ttfFont* myFont, const char* string, unsigned int fontSize);
+
+GRRLIB_texImg* GRRLIB_LoadTexture(const u8* my_img);
+void GRRLIB_FreeTexture(GRRLIB_texImg* tex);
+void GRRLIB_DrawImg(f32 xpos, f32 ypos, const GRRLIB_texImg* tex, f32 degrees, f32 scaleX, f32 scaleY, u32 color);
+GRRLIB_texImg* GRRLIB_CreateEmptyTexture(u32 width, u32 height);
+void GRRLIB_Screen2Texture(int posx, int posy, GRRLIB_texImg* tex, bool clear);
+
+void GX_SetScissor(u32 xOrigin, u32 yOrigin, u32 wd, u32 ht);
+
+namespace HostGfx
+{
+    struct Stats
+    {
+        uint64_t submissions = 0, vertices = 0, textCalls = 0, frames = 0, copies = 0;
+    };
+
+    Stats& stats();
+    void resetStats();
+}
@@ -0,0 +1,14 @@
+#pragma once
+
+#include <cstdint>
+
+#define TB_TIMER_CLOCK 1000000
+
+#define ticks_to_secs(ticks) (static_cast<uint64_t>(ticks) / (TB_TIMER_CLOCK * 1000))
+#define ticks_to_millisecs(ticks) (static_cast<uint64_t>(ticks) / TB_TIMER_CLOCK)
+#define ticks_to_microsecs(ticks) (static_cast<uint64_t>(ticks) * 1000 / TB_TIMER_CLOCK)
+#define ticks_to_nanosecs(ticks) (static_cast<uint64_t>(ticks) * 1000000 / TB_TIMER_CLOCK)
+#define millisecs_to_ticks(ms) (static_cast<uint64_t>(ms) * TB_TIMER_CLOCK)
+#define microsecs_to_ticks(us) (static_cast<uint64_t>(us) * TB_TIMER_CLOCK / 1000)
+
+uint64_t gettime();
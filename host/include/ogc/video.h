@@ -0,0 +1,4 @@
+#pragma once
+
+void VIDEO_Init();
+void SYS_STDIO_Report(bool useStdout);
@@ -0,0 +1,77 @@
+#pragma once
+
+#include <cstdint>
+
+#define WPAD_CHAN_0 0
+#define WPAD_ERR_NONE 0
+#define WPAD_ERR_NO_CONTROLLER -1
+#define WPAD_FMT_BTNS_ACC_IR 2
+
+#define WPAD_BUTTON_2 0x0001
+#define WPAD_BUTTON_1 0x0002
+#define WPAD_BUTTON_B 0x0004
+#define WPAD_BUTTON_A 0x0008
+#define WPAD_BUTTON_MINUS 0x0010
+#define WPAD_BUTTON_HOME 0x0080
+#define WPAD_BUTTON_LEFT 0x0100
+#define WPAD_BUTTON_RIGHT 0x0200
+#define WPAD_BUTTON_DOWN 0x0400
+#define WPAD_BUTTON_UP 0x0800
+#define WPAD_BUTTON_PLUS 0x1000
+#define WPAD_NUNCHUK_BUTTON_Z 0x00010000
+#define WPAD_NUNCHUK_BUTTON_C 0x00020000
+
+#define WPAD_EXP_NONE 0
+#define WPAD_EXP_NUNCHUK 1
+
+struct ir_t
+{
+    int valid;
+    float x, y;
+};
+
+struct vec2b_t
+{
+    uint8_t x, y;
+};
+
+struct joystick_t
+{
+    vec2b_t max, min, center, pos;
+};
+
+struct nunchuk_t
+{
+    joystick_t js;
+};
+
+struct expansion_t
+{
+    int type;
+    nunchuk_t nunchuk;
+};
+
+int WPAD_Init();
+int WPAD_Shutdown();
+int WPAD_SetDataFormat(int chan, int fmt);
+int WPAD_SetVRes(int chan, uint32_t xres, uint32_t yres);
+int WPAD_ScanPads();
+int WPAD_Probe(int chan, uint32_t* type);
+uint32_t WPAD_ButtonsDown(int chan);
+uint32_t WPAD_ButtonsHeld(int chan);
+uint32_t WPAD_ButtonsUp(int chan);
+void WPAD_IR(int chan, ir_t* ir);
+void WPAD_Expansion(int chan, expansion_t* exp);
+
+namespace HostPad
+{
+    struct State
+    {
+        bool connected = true, pointerValid = false, nunchuk = false;
+        float pointerX = 0.0f, pointerY = 0.0f;
+        uint32_t held = 0;
+        int stickX = 0, stickY = 0;
+    };
+
+    State& state();
+}
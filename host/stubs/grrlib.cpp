@@ -0,0 +1,69 @@
+#include <grrlib.h>
+
+#include <string_view>
+
+struct GRRLIB_ttfFont
+{
+    s32 size;
+};
+
+static HostGfx::Stats gfxStats;
+
+HostGfx::Stats& HostGfx::stats() { return gfxStats; }
+void HostGfx::resetStats() { gfxStats = {}; }
+
+static void submit(const uint64_t vertices)
+{
+    gfxStats.submissions++;
+    gfxStats.vertices += vertices;
+}
+
+int GRRLIB_Init() { return 0; }
+void GRRLIB_Exit() {}
+void GRRLIB_Render() { gfxStats.frames++; }
+void GRRLIB_FillScreen(u32) { submit(4); }
+void GRRLIB_SetBackgroundColour(u8, u8, u8, u8) {}
+
+void GRRLIB_GXEngine(const guVector[], const u32[], const u16 n, u8) { submit(n); }
+void GRRLIB_Rectangle(f32, f32, f32, f32, u32, const bool filled) { submit(filled ? 4 : 5); }
+void GRRLIB_Line(f32, f32, f32, f32, u32) { submit(2); }
+void GRRLIB_Circle(f32, f32, f32, u32, const u8 filled) { submit(filled ? 38 : 37); }
+
+GRRLIB_ttfFont* GRRLIB_LoadTTF(const u8* file_base, const s32 file_size)
+{
+    return file_base && file_size > 0 ? new GRRLIB_ttfFont{file_size} : nullptr;
+}
+
+void GRRLIB_FreeTTF(GRRLIB_ttfFont* myFont) { delete myFont; }
+
+void GRRLIB_PrintfTTF(int, int, GRRLIB_ttfFont*, const char* string, unsigned int, u32)
+{
+    gfxStats.textCalls++;
+    submit(std::string_view(string ? string : "").size() * 4);
+}
+
+unsigned int GRRLIB_WidthTTF(GRRLIB_ttfFont*, const char* string, const unsigned int fontSize)
+{
+    unsigned int glyphs = 0;
+    for (const char* c = string; c && *c; ++c)
+        if ((static_cast<unsigned char>(*c) & 0xC0) != 0x80) glyphs++;
+
+    return glyphs * fontSize * 3 / 5;
+}
+
+GRRLIB_texImg* GRRLIB_LoadTexture(const u8* my_img)
+{
+    return my_img ? new GRRLIB_texImg{.w = 32, .h = 32} : nullptr;
+}
+
+void GRRLIB_FreeTexture(GRRLIB_texImg* tex) { delete tex; }
+void GRRLIB_DrawImg(f32, f32, const GRRLIB_texImg*, f32, f32, f32, u32) { submit(4); }
+
+GRRLIB_texImg* GRRLIB_CreateEmptyTexture(const u32 width, const u32 height)
+{
+    return new GRRLIB_texImg{.w = width, .h = height};
+}
+
+void GRRLIB_Screen2Texture(int, int, GRRLIB_texImg*, bool) { gfxStats.copies++; }
+
+void GX_SetScissor(u32, u32, u32, u32) {}
@@ -0,0 +1,15 @@
+#include <ogc/video.h>
+#include <ogc/lwp_watchdog.h>
+#include <fat.h>
+
+#include <chrono>
+
+void VIDEO_Init() {}
+void SYS_STDIO_Report(bool) {}
+bool fatInitDefault() { return true; }
+
+uint64_t gettime()
+{
+    const auto now = std::chrono::steady_clock::now().time_since_epoch();
+    return static_cast<uint64_t>(std::chrono::duration_cast<std::chrono::nanoseconds>(now).count());
+}
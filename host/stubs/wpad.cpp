@@ -0,0 +1,43 @@
+#include <wiiuse/wpad.h>
+
+static HostPad::State padState;
+static uint32_t lastHeld = 0, down = 0, up = 0;
+
+HostPad::State& HostPad::state() { return padState; }
+
+int WPAD_Init() { return WPAD_ERR_NONE; }
+int WPAD_Shutdown() { return WPAD_ERR_NONE; }
+int WPAD_SetDataFormat(int, int) { return WPAD_ERR_NONE; }
+int WPAD_SetVRes(int, uint32_t, uint32_t) { return WPAD_ERR_NONE; }
+
+int WPAD_ScanPads()
+{
+    const uint32_t held = padState.connected ? padState.held : 0;
+    down = held & ~lastHeld;
+    up = lastHeld & ~held;
+    lastHeld = held;
+
+    return 0;
+}
+
+int WPAD_Probe(int, uint32_t*) { return padState.connected ? WPAD_ERR_NONE : WPAD_ERR_NO_CONTROLLER; }
+uint32_t WPAD_ButtonsDown(int) { return down; }
+uint32_t WPAD_ButtonsHeld(int) { return lastHeld; }
+uint32_t WPAD_ButtonsUp(int) { return up; }
+
+void WPAD_IR(int, ir_t* ir)
+{
+    *ir = {.valid = padState.pointerValid ? 1 : 0, .x = padState.pointerX, .y = padState.pointerY};
+}
+
+void WPAD_Expansion(int, expansion_t* exp)
+{
+    *exp = {};
+    if (!padState.nunchuk) return;
+
+    exp->type = WPAD_EXP_NUNCHUK;
+    exp->nunchuk.js.center = {128, 128};
+    exp->nunchuk.js.pos = {
+        static_cast<uint8_t>(128 + padState.stickX), static_cast<uint8_t>(128 + padState.stickY)
+    };
+}
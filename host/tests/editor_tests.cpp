@@ -0,0 +1,222 @@
+#include "./test.h"
+
+#include <atomic>
+#include <random>
+#include <algorithm>
+
+#include "../../src/editor/pattern.h"
+#include "../../src/editor/trigram_index.h"
+
+namespace
+{
+    struct PatternCase
+    {
+        Pattern::Syntax syntax;
+        const char *source, *text;
+        long start = -1, end = -1;
+    };
+
+    constexpr auto LUA = Pattern::Syntax::Lua, REGEX = Pattern::Syntax::Regex, LITERAL = Pattern::Syntax::Literal;
+
+    const PatternCase PATTERN_CASES[] = {
+        {LITERAL, "a.b", "axb a.b", 4, 7},
+        {LITERAL, "abc", "ababab", -1, -1},
+        {LUA, "a+", "baaac", 1, 4},
+        {LUA, "a-b", "xaaab", 1, 5},
+        {LUA, "a*", "bbb", 0, 0},
+        {LUA, "x?y", "zy", 1, 2},
+        {LUA, "^ab", "cab", -1, -1},
+        {LUA, "^ab", "abc", 0, 2},
+        {LUA, "b$", "abb", 2, 3},
+        {LUA, "%d+", "ab123c", 2, 5},
+        {LUA, "[%a_][%w_]*", "  foo_1 = 2", 2, 7},
+        {LUA, "%f[%w]%w+", "..hello", 2, 7},
+        {LUA, "[^%s]+", "   word  ", 3, 7},
+        {LUA, "%.%.", "a.b..c", 3, 5},
+        {REGEX, "a|ab", "ab", 0, 1},
+        {REGEX, "ab|a", "ab", 0, 2},
+        {REGEX, "\\bcat\\b", "concat cat", 7, 10},
+        {REGEX, "a.*?c", "abcbc", 0, 3},
+        {REGEX, "a.*c", "abcbc", 0, 5},
+        {REGEX, "(?:ab)+", "xababab", 1, 7},
+        {REGEX, "[^a-c]+", "abcdef", 3, 6},
+        {REGEX, "colou?r", "my color", 3, 8},
+        {REGEX, "\\d+\\s\\w", "x 42 y", 2, 6},
+        {REGEX, "^$", "", 0, 0},
+    };
+
+    std::string describe(const PatternCase& c)
+    {
+        return std::string("'") + c.source + "' in '" + c.text + "'";
+    }
+}
+
+static Test::Register patternMatches({
+    .name = "editor.pattern", .description = "Lua and regex patterns pick the leftmost, priority-ordered match",
+    .run = []
+    {
+        for (const PatternCase& c : PATTERN_CASES)
+        {
+            Pattern p;
+            if (std::string err; !p.compile(c.source, c.syntax, &err))
+            {
+                Test::fail("compile " + describe(c) + ": " + err, __FILE__, __LINE__);
+                continue;
+            }
+
+            const size_t size = std::char_traits<char>::length(c.text);
+            Pattern::Match m;
+            const bool found = p.find(c.text, size, 0, m);
+            if (found != (c.start >= 0) || (found && (static_cast<long>(m.start) != c.start ||
+                                                      static_cast<long>(m.end) != c.end)))
+            {
+                Test::fail(describe(c) + " matched " + (found ? std::to_string(m.start) + ".." +
+                               std::to_string(m.end) : "nothing"), __FILE__, __LINE__);
+            }
+        }
+
+        const std::pair<const char*, Pattern::Syntax> rejected[] = {
+            {"%b()", LUA}, {"(a)%1", LUA}, {"[a", LUA}, {"(ab", REGEX}, {"a)", REGEX}, {"*a", REGEX}
+        };
+        for (const auto& [source, syntax] : rejected)
+        {
+            Pattern p;
+            std::string err;
+            CHECK(!p.compile(source, syntax, &err) && !err.empty());
+        }
+    }
+});
+
+static Test::Register patternScan({
+    .name = "editor.pattern_scan", .description = "a scan resumed in small slices agrees with find()",
+    .run = []
+    {
+        std::string text;
+        std::mt19937 rng(7);
+        for (int i = 0; i < 4000; ++i) text.push_back("ab c1_"[rng() % 6]);
+        text += "needle";
+
+        const std::pair<const char*, Pattern::Syntax> sources[] = {
+            {"needle", LITERAL}, {"c%d_b", LUA}, {"%f[%w]b+%s", LUA}, {"n%a+e$", LUA}, {"\\bc1_a\\w*?b", REGEX},
+            {"(?:ab)+c|needle", REGEX}
+        };
+        size_t slices = 0;
+        for (const auto& [source, syntax] : sources)
+        {
+            Pattern p;
+            if (!CHECK(p.compile(source, syntax))) continue;
+
+            for (size_t from = 0; from < text.size(); from += 997)
+            {
+                Pattern::Match expected, got;
+                const bool found = p.find(text.data(), text.size(), from, expected);
+
+                Pattern::Scan scan;
+                p.begin(scan, from);
+                while (!p.resume(scan, text.data(), text.size(), 16)) slices++;
+
+                CHECK(scan.finished());
+                if (!CHECK_EQ(scan.found(got), found) || !found) continue;
+                CHECK_EQ(got.start, expected.start);
+                CHECK_EQ(got.end, expected.end);
+            }
+        }
+        CHECK(slices > 0);
+    }
+});
+
+static Test::Register trigramIndex({
+    .name = "editor.trigram_index", .description = "index candidates cover every file a linear scan matches",
+    .run = []
+    {
+        const std::string root = Test::scratchDir("index");
+        const std::string indexPath = FileSystem::cacheRoot + "tests.index";
+        Test::writeFile(indexPath, "");
+
+        std::mt19937 rng(11);
+        auto word = [&]
+        {
+            std::string w;
+            for (int i = 0; i < 6; ++i) w.push_back(static_cast<char>('a' + rng() % 26));
+            return w;
+        };
+        auto fileName = [&](const int i)
+        {
+            return FileSystem::join(root, std::string(i % 3 ? "sub/" : "") + (i % 5 ? "f" : ".f") +
+                                          std::to_string(i) + ".lua");
+        };
+
+        FileSystem::ensureDir(FileSystem::join(root, "sub"));
+        std::vector<std::string> queries;
+        for (int i = 0; i < 60; ++i)
+        {
+            std::string text;
+            for (int line = 0; line < 40; ++line)
+            {
+                const std::string w = word();
+                if (line % 13 == 0) queries.push_back(w.substr(0, 3 + line % 4));
+                text += w + " " + word() + "\n";
+            }
+            Test::writeFile(fileName(i), text);
+        }
+        for (int i = 0; i < 40; ++i) queries.push_back(word().substr(0, 4));
+
+        TrigramIndex index(root, indexPath);
+        FileSystem::setChangeListener([&](const FileSystem::Change change, const std::string& path,
+                                          const std::string& to)
+        {
+            index.noteChange(change, path, to);
+        });
+
+        auto agree = [&](const char* phase)
+        {
+            const std::atomic<bool> stop = false;
+            if (std::string err; !index.prepare(stop, &err))
+            {
+                Test::fail(std::string(phase) + ": " + err, __FILE__, __LINE__);
+                return;
+            }
+
+            std::vector<std::string> files, dirs = {root}, out;
+            std::vector<FileSystem::DirEntry> entries;
+            while (!dirs.empty())
+            {
+                const std::string dir = dirs.back();
+                dirs.pop_back();
+                FileSystem::listDir(dir, entries);
+                for (const auto& e : entries) (e.isDir ? dirs : files).push_back(e.path);
+            }
+
+            size_t narrowed = 0;
+            for (const std::string& q : queries)
+            {
+                if (!CHECK(index.candidates(q, out, stop))) continue;
+                if (out.size() < files.size()) narrowed++;
+
+                for (const std::string& path : files)
+                    if (Test::readFile(path).find(q) != std::string::npos &&
+                        std::find(out.begin(), out.end(), path) == out.end())
+                        Test::fail(std::string(phase) + ": '" + q + "' misses " + path, __FILE__, __LINE__);
+            }
+            CHECK(narrowed > queries.size() / 2);
+        };
+
+        agree("fresh");
+        CHECK_EQ(index.fileCount(), 60u);
+
+        // Few enough changes to stay dirty, then enough to force a compaction that reuses unchanged postings.
+        for (int i = 0; i < 10; ++i) Test::writeFile(fileName(i), "changed " + queries[i] + "\n");
+        CHECK_EQ(index.dirtyCount(), 10u);
+        agree("dirty");
+
+        for (int i = 60; i < 60 + static_cast<int>(TrigramIndex::MAX_DIRTY); ++i)
+            Test::writeFile(fileName(i), "added " + word() + "\n");
+        FileSystem::removePath(fileName(20));
+        CHECK(index.dirtyCount() > TrigramIndex::MAX_DIRTY);
+        agree("compacted");
+        CHECK_EQ(index.dirtyCount(), 0u);
+        CHECK_EQ(index.fileCount(), 60u + TrigramIndex::MAX_DIRTY - 1);
+
+        FileSystem::setChangeListener(nullptr);
+    }
+});
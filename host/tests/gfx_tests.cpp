@@ -0,0 +1,112 @@
+#include "./test.h"
+
+#include "../../src/gfx/command_buffer.h"
+
+static Test::Register filledBatch({
+    .name = "gfx.batch", .description = "adjacent rects of one kind and clip share a submission",
+    .run = []
+    {
+        CommandBuffer buffer;
+        RecordingBackend backend;
+        for (int i = 0; i < 100; ++i) buffer.rect(static_cast<float>(i * 4), 10, 3, 3, 0xFFFFFFFF);
+        buffer.flush(backend);
+
+        CHECK_EQ(backend.submissions, 1u);
+        CHECK_EQ(backend.entries.size(), 100u);
+        CHECK_EQ(buffer.lastFlush().commands, 100u);
+        CHECK_EQ(buffer.lastFlush().submissions, 1u);
+        CHECK_EQ(buffer.size(), 0u);
+
+        // Filled shapes never merge with outlines; lines and outlined rects do.
+        backend.reset();
+        buffer.rect(0, 0, 10, 10, 0xFFFFFFFF);
+        buffer.rect(0, 0, 10, 10, 0xFFFFFFFF, 0.0f, false);
+        buffer.line(0, 0, 10, 10, 0xFFFFFFFF);
+        buffer.rect(20, 0, 10, 10, 0xFFFFFFFF);
+        buffer.flush(backend);
+
+        CHECK_EQ(backend.submissions, 3u);
+        CHECK_EQ(backend.entries.size(), 4u);
+        CHECK_EQ(backend.entries[1].submission, backend.entries[2].submission);
+    }
+});
+
+static Test::Register drawOrder({
+    .name = "gfx.order", .description = "batching keeps recorded order and submits text one call at a time",
+    .run = []
+    {
+        CommandBuffer buffer;
+        RecordingBackend backend;
+        buffer.rect(0, 0, 10, 10, 0xFF0000FF);
+        buffer.text("one", 0, 0, 0xFFFFFFFF);
+        buffer.text("two", 0, 20, 0xFFFFFFFF);
+        buffer.rect(0, 0, 10, 10, 0xFF0000FF);
+        buffer.text("three", 0, 40, 0xFFFFFFFF);
+        buffer.flush(backend);
+
+        CHECK_EQ(backend.submissions, 5u);
+        CHECK_EQ(buffer.lastFlush().submissions, 5u);
+        if (!CHECK_EQ(backend.entries.size(), 5u)) return;
+
+        const DrawCommand::Type expected[] = {
+            DrawCommand::Type::Rect, DrawCommand::Type::Text, DrawCommand::Type::Text, DrawCommand::Type::Rect,
+            DrawCommand::Type::Text
+        };
+        for (size_t i = 0; i < std::size(expected); ++i) CHECK(backend.entries[i].command.type == expected[i]);
+        CHECK_EQ(backend.entries[1].text, std::string("one"));
+        CHECK_EQ(backend.entries[2].text, std::string("two"));
+        CHECK_EQ(backend.entries[4].text, std::string("three"));
+    }
+});
+
+static Test::Register scissors({
+    .name = "gfx.scissor", .description = "clip changes cost one scissor each and clipped-out commands are culled",
+    .run = []
+    {
+        CommandBuffer buffer;
+        RecordingBackend backend;
+        buffer.pushScissor(0, 0, 100, 100);
+        buffer.rect(10, 10, 10, 10, 0xFFFFFFFF);
+        buffer.rect(200, 200, 10, 10, 0xFFFFFFFF);
+        buffer.popScissor();
+        buffer.rect(200, 200, 10, 10, 0xFFFFFFFF);
+        buffer.flush(backend);
+
+        CHECK_EQ(backend.entries.size(), 2u);
+        CHECK_EQ(backend.submissions, 2u);
+        CHECK_EQ(backend.scissors, 2u);
+        CHECK_EQ(buffer.lastFlush().scissors, 2u);
+        CHECK_EQ(buffer.lastFlush().culled, 1u);
+    }
+});
+
+static Test::Register displayList({
+    .name = "gfx.display_list", .description = "a compiled display list replays as one mesh submission",
+    .run = []
+    {
+        DisplayList list;
+        CommandBuffer& rec = list.record();
+        for (int i = 0; i < 200; ++i) rec.rect(static_cast<float>(i % 20 * 8), static_cast<float>(i / 20 * 8), 6, 6,
+                                               0xFF00FFFF);
+        list.compile();
+        CHECK(list.valid());
+        CHECK(list.vertexCount() > 0);
+
+        CommandBuffer buffer;
+        RecordingBackend backend;
+        list.replay(buffer);
+        list.replay(buffer);
+        buffer.flush(backend);
+
+        CHECK_EQ(backend.submissions, 2u);
+        if (CHECK_EQ(backend.entries.size(), 2u))
+        {
+            CHECK(backend.entries[0].command.type == DrawCommand::Type::Mesh);
+            CHECK_EQ(backend.entries[0].command.mesh->vertices.size(), list.vertexCount());
+        }
+
+        list.invalidate();
+        list.replay(buffer);
+        CHECK_EQ(buffer.size(), 0u);
+    }
+});
@@ -0,0 +1,96 @@
+#include <cstdio>
+#include <cstdlib>
+#include <cstring>
+#include <algorithm>
+
+#include "./test.h"
+
+static size_t failures = 0;
+
+void Test::fail(const std::string& what, const char* file, const int line)
+{
+    printf("    %s:%d: check failed: %s\n", file, line, what.c_str());
+    failures++;
+}
+
+std::vector<Test::Case>& Test::cases()
+{
+    static std::vector<Case> list;
+    return list;
+}
+
+std::string Test::scratchDir(const std::string& name)
+{
+    const std::string path = FileSystem::join(FileSystem::join(FileSystem::workspaceRoot, "tests"), name);
+    FileSystem::removePath(path);
+    FileSystem::ensureDir(path);
+
+    return path;
+}
+
+std::string Test::writeFile(const std::string& path, const std::string& text)
+{
+    FileSystem::writeFile(path, reinterpret_cast<const uint8_t*>(text.data()), text.size());
+    return path;
+}
+
+std::string Test::readFile(const std::string& path)
+{
+    std::vector<uint8_t> data;
+    FileSystem::readFile(path, data);
+
+    return {data.begin(), data.end()};
+}
+
+int main(const int argc, char** argv)
+{
+    Thread::init();
+#ifdef WIISCRIPT_HOST_SD_ROOT
+    FileSystem::hostSdRoot = WIISCRIPT_HOST_SD_ROOT;
+#endif
+
+    std::vector<std::string> selected;
+    for (int i = 1; i < argc; ++i)
+    {
+        if (std::strcmp(argv[i], "--list") == 0)
+        {
+            for (const auto& c : Test::cases()) printf("%-20s %s\n", c.name, c.description);
+            return EXIT_SUCCESS;
+        }
+        selected.emplace_back(argv[i]);
+    }
+
+    if (!Time::init() || !FileSystem::init() || !FileSystem::ensureDir(FileSystem::workspaceRoot) ||
+        !FileSystem::ensureDir(FileSystem::cacheRoot))
+    {
+        printf("Failed to open SD root '%s'!\n", FileSystem::hostSdRoot.c_str());
+        return EXIT_FAILURE;
+    }
+
+    auto& list = Test::cases();
+    std::sort(list.begin(), list.end(), [](const Test::Case& a, const Test::Case& b)
+    {
+        return std::strcmp(a.name, b.name) < 0;
+    });
+
+    size_t ran = 0, failed = 0;
+    for (const auto& c : list)
+    {
+        if (!selected.empty() && std::find(selected.begin(), selected.end(), c.name) == selected.end()) continue;
+
+        const size_t before = failures;
+        c.run();
+        printf("%-6s %s\n", failures == before ? "ok" : "FAIL", c.name);
+        if (failures != before) failed++;
+        ran++;
+    }
+
+    if (ran == 0)
+    {
+        printf("No matching tests, use --list to see them.\n");
+        return EXIT_FAILURE;
+    }
+
+    printf("%zu/%zu passed\n", ran - failed, ran);
+    return failed == 0 ? EXIT_SUCCESS : EXIT_FAILURE;
+}
@@ -0,0 +1,178 @@
+#include "./test.h"
+
+#include "../../src/script/runtime.h"
+#include "../../src/script/lua_api.h"
+
+static bool runScript(ScriptRuntime& script, const char* source, const char* name)
+{
+    if (std::string err; !script.run(source, name, &err))
+    {
+        Test::fail(err, __FILE__, __LINE__);
+        return false;
+    }
+
+    return true;
+}
+
+static std::string globalString(ScriptRuntime& script, const char* name)
+{
+    lua_State* L = script.state();
+    lua_getglobal(L, name);
+    std::string value = lua_isstring(L, -1) ? lua_tostring(L, -1) : "";
+    lua_pop(L, 1);
+
+    return value;
+}
+
+static constexpr auto BYTES_SOURCE = R"(
+local b = bytes.new(16)
+b:setU8(1, 255) assert(b:u8(1) == 255 and b:i8(1) == -1)
+b:setI8(2, -128) assert(b:u8(2) == 128 and b:i8(2) == -128)
+b:setU16le(3, 0xBEEF) assert(b:u16le(3) == 0xBEEF and b:u8(3) == 0xEF and b:u16be(3) == 0xEFBE)
+b:setI16be(5, -2) assert(b:i16be(5) == -2 and b:u16be(5) == 0xFFFE)
+b:setI32le(7, -123456789) assert(b:i32le(7) == -123456789)
+
+b:setU32le(1, 0xFFFFFFFF) assert(b:u32le(1) == -1 and b:u8(4) == 255)
+local v = b:u32le(1) b:setU32be(5, v) assert(b:u32be(5) == v)
+b:setU32le(1, 3000000000.0) assert(b:u8(1) == 0x00 and b:u8(2) == 0x5E and b:u8(3) == 0xD0 and b:u8(4) == 0xB2)
+b:setU32le(9, b:u32le(1)) assert(b:string(9, 12) == b:string(1, 4))
+assert(not pcall(b.setU32le, b, 1, 4294967296.0))
+assert(not pcall(b.setU32le, b, 1, -1.5))
+assert(not pcall(b.u32le, b, 14))
+
+b:setF32be(13, 1.5) assert(b:f32be(13) == 1.5 and b:u8(13) == 0x3F and b:u8(14) == 0xC0)
+
+local s = b:slice(5, 8)
+assert(#s == 4 and s:u32be(1) == v)
+s:setU8(1, 7) assert(b:u8(5) == 7)
+
+local t = bytes.from("hello, world")
+assert(#t == 12 and t:string() == "hello, world" and t:string(-5) == "world" and t:find("world") == 8)
+assert(t:write("tests/script/bytes.bin"))
+local r = bytes.read("tests/script/bytes.bin", 7)
+assert(r:string() == "world")
+)";
+
+static Test::Register bytesRoundTrip({
+    .name = "script.bytes", .description = "bytes getters and setters round-trip every width, endianness and file",
+    .run = []
+    {
+        Test::scratchDir("script");
+        RecordingBackend backend;
+        ScriptRuntime script(backend);
+        runScript(script, BYTES_SOURCE, "=bytes");
+        CHECK_EQ(Test::readFile(FileSystem::join(FileSystem::workspaceRoot, "tests/script/bytes.bin")),
+                 std::string("hello, world"));
+        script.stop();
+    }
+});
+
+static constexpr auto VEC_SOURCE = R"(
+local n = 37
+local a, b = vec.array(n, 3), vec.array(n, 3)
+for i = 1, n do a:set(i, i, 2 * i, 3 * i) b:set(i, 1, 2, 3) end
+assert(#a == n and a.dim == 3)
+
+local sum, diff, prod = vec.add(a, b), vec.sub(a, b), vec.mul(a, b)
+for i = 1, n do
+    local x, y, z = sum:get(i) assert(x == i + 1 and y == 2 * i + 2 and z == 3 * i + 3)
+    x, y, z = diff:get(i) assert(x == i - 1 and y == 2 * i - 2 and z == 3 * i - 3)
+    x, y, z = prod:get(i) assert(x == i and y == 4 * i and z == 9 * i)
+end
+
+local out = vec.array(n, 3)
+assert(vec.mul(2, a, out) == out and vec.mul(a, 2) ~= out)
+for i = 1, n do local x, y, z = out:get(i) assert(x == 2 * i and y == 4 * i and z == 6 * i) end
+vec.sub(a, a, a)
+for i = 1, n do local x, y, z = a:get(i) assert(x == 0 and y == 0 and z == 0) end
+assert(not pcall(vec.add, a, vec.array(n + 1, 3)))
+
+assert(vec.vec3(1, 2, 3) + vec.vec3(1, 1, 1) == vec.vec3(2, 3, 4))
+assert(vec.sub(vec.vec3(1, 2, 3), vec.vec3(1, 1, 1)) == vec.vec3(0, 1, 2))
+assert(vec.mul(2, vec.vec2(1, 2)) == vec.vec2(2, 4) and vec.vec2(1, 2) * vec.vec2(3, 4) == vec.vec2(3, 8))
+assert(vec.dot(vec.vec3(1, 2, 3), vec.vec3(4, 5, 6)) == 32)
+assert(vec.transform(vec.translation(10, 20, 30), vec.vec4(1, 2, 3, 1)) == vec.vec4(11, 22, 33, 1))
+
+local p = vec.array(5, 4)
+for i = 1, 5 do p:set(i, i, 0, 0, 1) end
+local moved = vec.transform(vec.translation(1, 2, 3), p)
+for i = 1, 5 do local x, y, z, w = moved:get(i) assert(x == i + 1 and y == 2 and z == 3 and w == 1) end
+
+assert(not pcall(vec.array, 0x7FFFFFFF, 4))
+assert(not pcall(vec.array, -1, 2))
+)";
+
+static Test::Register vecRoundTrip({
+    .name = "script.vec", .description = "vec arithmetic over vectors and arrays matches scalar results",
+    .run = []
+    {
+        RecordingBackend backend;
+        ScriptRuntime script(backend);
+        runScript(script, VEC_SOURCE, "=vec");
+        script.stop();
+    }
+});
+
+static constexpr auto TASK_SOURCE = R"(
+log = ""
+local function note(s) log = log .. s .. ";" end
+
+local late = task.spawn(function() task.sleep(2) note("late") end)
+task.spawn(function() task.sleep(1) note("early") end)
+task.spawn(function()
+    note("key " .. task.waitInput("A"))
+    task.cancel(late)
+end)
+
+local waiters = {}
+for i = 1, 100 do waiters[i] = task.spawn(function() task.waitInput("B") note("stale") end) end
+task.spawn(function()
+    task.sleep(0.5)
+    for i = 1, 100 do task.cancel(waiters[i]) end
+    note("key " .. task.waitInput("B"))
+end)
+
+start = task.now()
+)";
+
+static Test::Register scheduler({
+    .name = "script.tasks", .description = "tasks sleep, wait for input and stay cancelled",
+    .run = []
+    {
+        RecordingBackend backend;
+        ScriptRuntime script(backend);
+        if (!runScript(script, TASK_SOURCE, "=tasks")) return;
+
+        TaskScheduler& tasks = script.scheduler();
+        const double t0 = Time::seconds();
+        auto tick = [&](const double at)
+        {
+            if (std::string err; !tasks.tick(t0 + at, &err)) Test::fail(err, __FILE__, __LINE__);
+        };
+        auto press = [&](const Input::Key key)
+        {
+            tasks.dispatch({.type = Input::InputEvent::Type::KeyDown, .key = key});
+        };
+
+        CHECK(std::stod(globalString(script, "start")) < 1.0);
+        CHECK_EQ(tasks.activeCount(), 104u);
+
+        tick(0.0);
+        tick(0.75);
+        CHECK_EQ(tasks.activeCount(), 4u);
+        CHECK_EQ(globalString(script, "log"), std::string(""));
+
+        tick(1.5);
+        CHECK_EQ(globalString(script, "log"), std::string("early;"));
+
+        press(Input::Key::A);
+        press(Input::Key::B);
+        tick(1.6);
+        CHECK_EQ(globalString(script, "log"), std::string("early;key A;key B;"));
+        CHECK_EQ(tasks.activeCount(), 0u);
+
+        tick(3.0);
+        CHECK_EQ(globalString(script, "log"), std::string("early;key A;key B;"));
+        script.stop();
+    }
+});
@@ -0,0 +1,52 @@
+#pragma once
+
+#include <string>
+#include <vector>
+#include <functional>
+#include <type_traits>
+
+#include "../../src/platform/platform.h"
+
+#define CHECK(cond) Test::check((cond), #cond, __FILE__, __LINE__)
+#define CHECK_EQ(a, b) Test::checkEqual((a), (b), #a " == " #b, __FILE__, __LINE__)
+
+namespace Test
+{
+    struct Case
+    {
+        const char *name = "", *description = "";
+        std::function<void()> run;
+    };
+
+    std::vector<Case>& cases();
+
+    struct Register
+    {
+        explicit Register(Case c) { cases().push_back(std::move(c)); }
+    };
+
+    void fail(const std::string& what, const char* file, int line);
+
+    inline bool check(const bool ok, const char* what, const char* file, const int line)
+    {
+        if (!ok) fail(what, file, line);
+        return ok;
+    }
+
+    template <typename A, typename B>
+    bool checkEqual(const A& a, const B& b, const char* what, const char* file, const int line)
+    {
+        if (a == b) return true;
+
+        if constexpr (std::is_arithmetic_v<A> && std::is_arithmetic_v<B>)
+            fail(std::string(what) + " (" + std::to_string(a) + " vs " + std::to_string(b) + ")", file, line);
+        else fail(what, file, line);
+
+        return false;
+    }
+
+    // An empty workspace directory for one case, removed and recreated on every run.
+    std::string scratchDir(const std::string& name);
+    std::string writeFile(const std::string& path, const std::string& text);
+    std::string readFile(const std::string& path);
+}
@@ -0,0 +1,197 @@
+#include "../../src/gfx/font_atlas.h"
+
+#include <ft2build.h>
+#include FT_FREETYPE_H
+
+#include <chrono>
+#include <cstdio>
+#include <cstring>
+#include <fstream>
+#include <iterator>
+#include <algorithm>
+
+static constexpr uint16_t ATLAS_WIDTH = 256;
+static constexpr uint32_t RANGES[][2] = {{32, 126}, {160, 255}};
+
+struct Bitmap
+{
+    FontAtlas::Glyph glyph;
+    std::vector<uint8_t> pixels;
+};
+
+static bool readFile(const char* path, std::vector<uint8_t>& out)
+{
+    std::ifstream in(path, std::ios::binary);
+    if (!in) return false;
+    out.assign(std::istreambuf_iterator<char>(in), std::istreambuf_iterator<char>());
+
+    return true;
+}
+
+static bool rasterize(const std::vector<uint8_t>& ttf, const int size, std::vector<Bitmap>& outGlyphs,
+                      std::vector<FontAtlas::Kerning>& outKerning)
+{
+    FT_Library library;
+    if (FT_Init_FreeType(&library)) return false;
+
+    FT_Face face;
+    if (FT_New_Memory_Face(library, ttf.data(), static_cast<FT_Long>(ttf.size()), 0, &face) ||
+        FT_Set_Pixel_Sizes(face, 0, size))
+    {
+        FT_Done_FreeType(library);
+        return false;
+    }
+
+    outGlyphs.clear();
+    for (const auto& [first, last] : RANGES)
+        for (uint32_t cp = first; cp <= last; ++cp)
+        {
+            const FT_UInt index = FT_Get_Char_Index(face, cp);
+            if (!index || FT_Load_Glyph(face, index, FT_LOAD_RENDER)) continue;
+
+            const FT_GlyphSlot slot = face->glyph;
+            const FT_Bitmap& bm = slot->bitmap;
+            Bitmap b = {.glyph = {
+                .codepoint = cp,
+                .w = static_cast<uint8_t>(bm.width),
+                .h = static_cast<uint8_t>(bm.rows),
+                .left = static_cast<int8_t>(slot->bitmap_left),
+                .top = static_cast<int8_t>(slot->bitmap_top),
+                .advance = static_cast<uint16_t>(slot->advance.x >> 6)
+            }};
+            for (unsigned y = 0; y < bm.rows; ++y)
+                b.pixels.insert(b.pixels.end(), bm.buffer + y * bm.pitch, bm.buffer + y * bm.pitch + bm.width);
+            outGlyphs.push_back(std::move(b));
+        }
+
+    outKerning.clear();
+    if (FT_HAS_KERNING(face))
+        for (const Bitmap& l : outGlyphs)
+            for (const Bitmap& r : outGlyphs)
+            {
+                FT_Vector delta;
+                if (FT_Get_Kerning(face, FT_Get_Char_Index(face, l.glyph.codepoint),
+                                   FT_Get_Char_Index(face, r.glyph.codepoint), FT_KERNING_DEFAULT, &delta) ||
+                    delta.x >> 6 == 0)
+                    continue;
+                outKerning.push_back({l.glyph.codepoint, r.glyph.codepoint, static_cast<int8_t>(delta.x >> 6)});
+            }
+
+    FT_Done_Face(face);
+    FT_Done_FreeType(library);
+
+    return true;
+}
+
+// Shelf packing in codepoint order with a one pixel gutter; the height is rounded up to a power of two.
+static FontAtlas::Data pack(const int size, std::vector<Bitmap>& glyphs, std::vector<FontAtlas::Kerning> kerning)
+{
+    FontAtlas::Data d = {.size = static_cast<uint16_t>(size), .width = ATLAS_WIDTH};
+
+    uint16_t x = 1, y = 1, shelf = 0;
+    for (Bitmap& b : glyphs)
+    {
+        if (x + b.glyph.w + 1 > ATLAS_WIDTH)
+        {
+            x = 1;
+            y += shelf + 1;
+            shelf = 0;
+        }
+        b.glyph.x = x;
+        b.glyph.y = y;
+        x += b.glyph.w + 1;
+        shelf = std::max<uint16_t>(shelf, b.glyph.h);
+    }
+
+    d.height = 4;
+    while (d.height < y + shelf + 1) d.height *= 2;
+    d.coverage.assign(static_cast<size_t>(d.width) * d.height, 0);
+
+    for (const Bitmap& b : glyphs)
+    {
+        for (int row = 0; row < b.glyph.h; ++row)
+            std::memcpy(&d.coverage[(b.glyph.y + row) * d.width + b.glyph.x], &b.pixels[row * b.glyph.w], b.glyph.w);
+        d.glyphs.push_back(b.glyph);
+    }
+
+    std::sort(kerning.begin(), kerning.end(), [](const FontAtlas::Kerning& a, const FontAtlas::Kerning& b)
+    {
+        return a.left != b.left ? a.left < b.left : a.right < b.right;
+    });
+    d.kerning = std::move(kerning);
+
+    return d;
+}
+
+// Startup cost on the host: FreeType init + face load + rasterizing the glyph set, against decoding the baked file.
+static void reportTiming(const std::vector<uint8_t>& ttf, const int size, const std::vector<uint8_t>& baked)
+{
+    using Clock = std::chrono::steady_clock;
+    constexpr int RUNS = 20;
+
+    std::vector<Bitmap> glyphs;
+    std::vector<FontAtlas::Kerning> kerning;
+    FontAtlas::Data decoded;
+
+    const auto t0 = Clock::now();
+    for (int i = 0; i < RUNS; ++i) rasterize(ttf, size, glyphs, kerning);
+    const auto t1 = Clock::now();
+    for (int i = 0; i < RUNS; ++i) FontAtlas::decode(baked, decoded);
+    const auto t2 = Clock::now();
+
+    const auto ms = [](const Clock::duration d) { return std::chrono::duration<double, std::milli>(d).count() / RUNS; };
+    std::printf("  freetype %.3f ms  baked %.3f ms\n", ms(t1 - t0), ms(t2 - t1));
+}
+
+int main(const int argc, char** argv)
+{
+    bool timing = false;
+    int arg = 1;
+    if (arg < argc && std::strcmp(argv[arg], "--time") == 0)
+    {
+        timing = true;
+        arg++;
+    }
+    if (argc - arg != 3)
+    {
+        std::fprintf(stderr, "usage: %s [--time] <font.ttf> <size> <out.wsf>\n", argv[0]);
+        return 2;
+    }
+
+    const char* ttfPath = argv[arg];
+    const int size = std::atoi(argv[arg + 1]);
+    const char* outPath = argv[arg + 2];
+
+    std::vector<uint8_t> ttf;
+    if (!readFile(ttfPath, ttf))
+    {
+        std::fprintf(stderr, "Failed to read %s\n", ttfPath);
+        return 1;
+    }
+
+    std::vector<Bitmap> glyphs;
+    std::vector<FontAtlas::Kerning> kerning;
+    if (size <= 0 || size > 64 || !rasterize(ttf, size, glyphs, kerning))
+    {
+        std::fprintf(stderr, "Failed to rasterize %s at %d px\n", ttfPath, size);
+        return 1;
+    }
+
+    const FontAtlas::Data d = pack(size, glyphs, std::move(kerning));
+    std::vector<uint8_t> baked;
+    FontAtlas::encode(d, baked);
+
+    std::ofstream out(outPath, std::ios::binary);
+    out.write(reinterpret_cast<const char*>(baked.data()), static_cast<std::streamsize>(baked.size()));
+    if (!out)
+    {
+        std::fprintf(stderr, "Failed to write %s\n", outPath);
+        return 1;
+    }
+
+    std::printf("%s: %zu glyphs, %zu kerning pairs, %ux%u atlas, %zu bytes\n", outPath, d.glyphs.size(),
+                d.kerning.size(), d.width, d.height, baked.size());
+    if (timing) reportTiming(ttf, size, baked);
+
+    return 0;
+}
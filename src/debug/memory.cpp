@@ -0,0 +1,275 @@
+#include "./memory.h"
+
+#ifdef WIISCRIPT_MEMORY
+
+#include "../platform/platform.h"
+
+#include <new>
+#include <array>
+#include <cstdlib>
+
+#ifdef WIISCRIPT_HOST
+#include <mutex>
+#else
+#include <malloc.h>
+#include <ogc/system.h>
+#include <ogc/irq.h>
+#include <ogc/lwp.h>
+#endif
+
+struct alignas(std::max_align_t) Header
+{
+    size_t size;
+    Memory::Category category;
+};
+
+static std::array<Memory::Stats, Memory::CATEGORY_COUNT> categories;
+static std::array<uint64_t, Memory::CATEGORY_COUNT> windowAllocs = {}, windowBytes = {};
+static uint64_t windowStart = 0;
+static bool overlay = false;
+
+static constexpr const char* NAMES[] = {"other", "editor text", "undo", "fonts", "file cache", "ui", "lua"};
+static_assert(std::size(NAMES) == Memory::CATEGORY_COUNT);
+
+// Any thread allocates. The counters take a lock on the host; on the Wii a thread only loses the CPU to an
+// interrupt or by blocking, so turning interrupts off is enough.
+class CounterLock
+{
+public:
+#ifdef WIISCRIPT_HOST
+    CounterLock() { mutex.lock(); }
+    ~CounterLock() { mutex.unlock(); }
+
+private:
+    static inline std::mutex mutex;
+#else
+    CounterLock() : level(IRQ_Disable()) {}
+    ~CounterLock() { IRQ_Restore(level); }
+
+private:
+    u32 level;
+#endif
+};
+
+// Each thread charges its own category, so a scope on a worker leaves the main thread's allocations alone.
+#ifdef WIISCRIPT_HOST
+static thread_local Memory::Category active = Memory::Category::Other;
+
+static Memory::Category swapActive(const Memory::Category category)
+{
+    const Memory::Category previous = active;
+    active = category;
+
+    return previous;
+}
+#else
+// Without thread-local storage, workers take a slot keyed by their LWP handle. A slot back at Other is free, so a
+// finished worker never holds one; a worker finding none free charges Other.
+struct Lane
+{
+    lwp_t thread = LWP_THREAD_NULL;
+    Memory::Category category = Memory::Category::Other;
+};
+
+static Memory::Category mainActive = Memory::Category::Other;
+static std::array<Lane, 8> lanes;
+
+static Memory::Category currentActive()
+{
+    if (Thread::isMain()) return mainActive;
+
+    const CounterLock lock;
+    const lwp_t self = LWP_GetSelf();
+    for (const Lane& l : lanes)
+        if (l.category != Memory::Category::Other && l.thread == self) return l.category;
+
+    return Memory::Category::Other;
+}
+
+static Memory::Category swapActive(const Memory::Category category)
+{
+    if (Thread::isMain())
+    {
+        const Memory::Category previous = mainActive;
+        mainActive = category;
+        return previous;
+    }
+
+    const CounterLock lock;
+    const lwp_t self = LWP_GetSelf();
+    Lane* free = nullptr;
+    for (Lane& l : lanes)
+    {
+        if (l.category != Memory::Category::Other && l.thread == self)
+        {
+            const Memory::Category previous = l.category;
+            l.category = category;
+            return previous;
+        }
+        if (!free && l.category == Memory::Category::Other) free = &l;
+    }
+    if (free && category != Memory::Category::Other) *free = {self, category};
+
+    return Memory::Category::Other;
+}
+#endif
+
+static void* allocate(const size_t size) noexcept
+{
+    auto* h = static_cast<Header*>(std::malloc(sizeof(Header) + size));
+    if (!h) return nullptr;
+
+    h->size = size;
+    h->category = Memory::current();
+    Memory::recordAlloc(h->category, size);
+
+    return h + 1;
+}
+
+static void release(void* p) noexcept
+{
+    if (!p) return;
+
+    Header* h = static_cast<Header*>(p) - 1;
+    Memory::recordFree(h->category, h->size);
+    std::free(h);
+}
+
+void Memory::recordAlloc(const Category category, const size_t bytes)
+{
+    const CounterLock lock;
+    Stats& s = categories[static_cast<size_t>(category)];
+    s.live += bytes;
+    s.allocations++;
+    s.allocatedBytes += bytes;
+    if (s.live > s.peak) s.peak = s.live;
+}
+
+void Memory::recordFree(const Category category, const size_t bytes)
+{
+    const CounterLock lock;
+    Stats& s = categories[static_cast<size_t>(category)];
+    s.live -= bytes < s.live ? bytes : s.live;
+    s.frees++;
+}
+
+#ifdef WIISCRIPT_HOST
+Memory::Category Memory::current() { return active; }
+#else
+Memory::Category Memory::current() { return currentActive(); }
+#endif
+
+Memory::Category Memory::setCurrent(const Category category) { return swapActive(category); }
+
+void Memory::frameMark()
+{
+    const uint64_t now = Time::ticks();
+    if (windowStart == 0) windowStart = now;
+
+    const double elapsed = Time::toSeconds(now - windowStart);
+    if (elapsed < 1.0) return;
+
+    const CounterLock lock;
+    for (size_t i = 0; i < CATEGORY_COUNT; ++i)
+    {
+        Stats& s = categories[i];
+        s.allocRate = static_cast<double>(s.allocations - windowAllocs[i]) / elapsed;
+        s.byteRate = static_cast<double>(s.allocatedBytes - windowBytes[i]) / elapsed;
+        windowAllocs[i] = s.allocations;
+        windowBytes[i] = s.allocatedBytes;
+    }
+    windowStart = now;
+}
+
+Memory::Stats Memory::stats(const Category category)
+{
+    const CounterLock lock;
+    return categories[static_cast<size_t>(category)];
+}
+
+Memory::Stats Memory::total()
+{
+    const CounterLock lock;
+    Stats sum;
+    for (const Stats& s : categories)
+    {
+        sum.live += s.live;
+        sum.peak += s.peak;
+        sum.allocations += s.allocations;
+        sum.frees += s.frees;
+        sum.allocatedBytes += s.allocatedBytes;
+        sum.allocRate += s.allocRate;
+        sum.byteRate += s.byteRate;
+    }
+
+    return sum;
+}
+
+Memory::Arenas Memory::arenas()
+{
+    Arenas a;
+#ifndef WIISCRIPT_HOST
+    const auto span = [](void* lo, void* hi)
+    {
+        return static_cast<uint32_t>(reinterpret_cast<uintptr_t>(hi) - reinterpret_cast<uintptr_t>(lo));
+    };
+    const struct mallinfo mi = mallinfo();
+
+    a.mem1Free = span(SYS_GetArena1Lo(), SYS_GetArena1Hi());
+    a.mem2Free = span(SYS_GetArena2Lo(), SYS_GetArena2Hi());
+    a.heapUsed = static_cast<uint32_t>(mi.uordblks);
+    a.heapFree = static_cast<uint32_t>(mi.fordblks);
+#endif
+
+    return a;
+}
+
+const char* Memory::name(const Category category)
+{
+    const auto i = static_cast<size_t>(category);
+    return i < CATEGORY_COUNT ? NAMES[i] : "?";
+}
+
+void Memory::toggleOverlay() { overlay = !overlay; }
+bool Memory::overlayVisible() { return overlay; }
+
+void Memory::dump(FILE* out)
+{
+    fprintf(out, "  %-12s %10s %10s %10s %10s %10s\n", "category", "live KiB", "peak KiB", "allocs", "frees",
+            "total KiB");
+    for (size_t i = 0; i < CATEGORY_COUNT; ++i)
+    {
+        const Stats s = stats(static_cast<Category>(i));
+        fprintf(out, "  %-12s %10.1f %10.1f %10llu %10llu %10.1f\n", NAMES[i], s.live / 1024.0, s.peak / 1024.0,
+                static_cast<unsigned long long>(s.allocations), static_cast<unsigned long long>(s.frees),
+                s.allocatedBytes / 1024.0);
+    }
+}
+
+void* operator new(const size_t size)
+{
+    void* p = allocate(size);
+    if (!p) throw std::bad_alloc();
+
+    return p;
+}
+
+void* operator new[](const size_t size)
+{
+    void* p = allocate(size);
+    if (!p) throw std::bad_alloc();
+
+    return p;
+}
+
+void* operator new(const size_t size, const std::nothrow_t&) noexcept { return allocate(size); }
+void* operator new[](const size_t size, const std::nothrow_t&) noexcept { return allocate(size); }
+
+void operator delete(void* p) noexcept { release(p); }
+void operator delete[](void* p) noexcept { release(p); }
+void operator delete(void* p, size_t) noexcept { release(p); }
+void operator delete[](void* p, size_t) noexcept { release(p); }
+void operator delete(void* p, const std::nothrow_t&) noexcept { release(p); }
+void operator delete[](void* p, const std::nothrow_t&) noexcept { release(p); }
+
+#endif
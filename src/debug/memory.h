@@ -0,0 +1,81 @@
+#pragma once
+
+#include <cstdio>
+#include <cstdint>
+#include <cstddef>
+
+class Font;
+struct Rect;
+
+#ifdef WIISCRIPT_MEMORY
+
+namespace Memory
+{
+    enum class Category : uint8_t
+    {
+        Other,
+        EditorText,
+        Undo,
+        Fonts,
+        FileCache,
+        UI,
+        Lua,
+        Count
+    };
+
+    constexpr size_t CATEGORY_COUNT = static_cast<size_t>(Category::Count);
+
+    struct Stats
+    {
+        uint64_t live = 0, peak = 0, allocations = 0, frees = 0, allocatedBytes = 0;
+        double allocRate = 0.0, byteRate = 0.0;
+    };
+
+    struct Arenas
+    {
+        uint32_t mem1Free = 0, mem2Free = 0, heapUsed = 0, heapFree = 0;
+    };
+
+    void recordAlloc(Category category, size_t bytes);
+    void recordFree(Category category, size_t bytes);
+
+    [[nodiscard]] Category current();
+    Category setCurrent(Category category);
+
+    void frameMark();
+    [[nodiscard]] Stats stats(Category category);
+    [[nodiscard]] Stats total();
+    [[nodiscard]] Arenas arenas();
+    [[nodiscard]] const char* name(Category category);
+
+    void toggleOverlay();
+    [[nodiscard]] bool overlayVisible();
+    [[nodiscard]] Rect overlayBounds(const Font& font);
+    void drawOverlay(const Font& font);
+    void dump(FILE* out);
+
+    class Scope
+    {
+    public:
+        explicit Scope(const Category category) : previous(setCurrent(category)) {}
+        ~Scope() { setCurrent(previous); }
+
+        Scope(const Scope&) = delete;
+        Scope& operator=(const Scope&) = delete;
+
+    private:
+        Category previous;
+    };
+}
+
+#define MEMORY_CONCAT_INNER(a, b) a##b
+#define MEMORY_CONCAT(a, b) MEMORY_CONCAT_INNER(a, b)
+#define MEMORY_SCOPE(category) const Memory::Scope MEMORY_CONCAT(memoryScope, __LINE__)(Memory::Category::category)
+#define MEMORY_FRAME() Memory::frameMark()
+
+#else
+
+#define MEMORY_SCOPE(category) static_cast<void>(0)
+#define MEMORY_FRAME() static_cast<void>(0)
+
+#endif
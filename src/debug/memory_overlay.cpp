@@ -0,0 +1,72 @@
+#include "./memory.h"
+
+#ifdef WIISCRIPT_MEMORY
+
+#include "../gfx/font.h"
+#include "../gfx/drawing.h"
+#include "../ui/theme.h"
+
+#include <iterator>
+
+#include <grrlib.h>
+
+static constexpr float COLUMNS[] = {0.0f, 90.0f, 145.0f, 200.0f, 250.0f};
+
+static void drawRow(const Font& font, const float x, const float y, const uint32_t color, const char* name,
+                    const double live, const double peak, const double allocRate, const double byteRate)
+{
+    char cell[24];
+    font.drawText(name, x + COLUMNS[0], y, color);
+
+    const double values[] = {live / 1024.0, peak / 1024.0, allocRate, byteRate / 1024.0};
+    for (size_t i = 0; i < std::size(values); ++i)
+    {
+        if (values[i] < 0.0) continue;
+        std::snprintf(cell, sizeof(cell), i == 2 ? "%.0f" : "%.1f", values[i]);
+        font.drawText(cell, x + COLUMNS[i + 1], y, color);
+    }
+}
+
+static constexpr float PAD = 6.0f;
+
+Rect Memory::overlayBounds(const Font& font)
+{
+    return {330.0f, 160.0f, 300.0f, PAD * 2 + (font.textHeight() + 2.0f) * static_cast<float>(CATEGORY_COUNT + 3)};
+}
+
+void Memory::drawOverlay(const Font& font)
+{
+    if (!overlayVisible()) return;
+
+    const auto [x, y, w, h] = overlayBounds(font);
+    const float rowH = font.textHeight() + 2.0f, pad = PAD;
+    GRRLIB_Rectangle(x, y, w, h, 0x000000C0, true);
+    GRRLIB_Rectangle(x, y, w, h, theme().panelBorder, false);
+
+    char line[96];
+    float ty = y + pad - 2;
+
+    const Arenas a = arenas();
+    std::snprintf(line, sizeof(line), "MEM1 %u K free  MEM2 %u K free  heap %u/%u K", a.mem1Free / 1024,
+                  a.mem2Free / 1024, a.heapUsed / 1024, (a.heapUsed + a.heapFree) / 1024);
+    font.drawText(line, x + pad, ty, theme().text);
+    ty += rowH;
+
+    const char* headers[] = {"category", "live K", "peak K", "allocs/s", "K/s"};
+    for (size_t i = 0; i < std::size(headers); ++i) font.drawText(headers[i], x + pad + COLUMNS[i], ty, theme().accent);
+    ty += rowH;
+
+    for (size_t i = 0; i < CATEGORY_COUNT; ++i)
+    {
+        const auto c = static_cast<Category>(i);
+        const Stats s = stats(c);
+        drawRow(font, x + pad, ty, s.allocRate > 0.0 ? theme().text : theme().textDisabled, name(c),
+                static_cast<double>(s.live), static_cast<double>(s.peak), s.allocRate, s.byteRate);
+        ty += rowH;
+    }
+
+    const Stats t = total();
+    drawRow(font, x + pad, ty, theme().text, "total", static_cast<double>(t.live), -1.0, t.allocRate, t.byteRate);
+}
+
+#endif
@@ -0,0 +1,80 @@
+#include "./profiler.h"
+
+#ifdef WIISCRIPT_PROFILE
+
+#include "../platform/platform.h"
+
+static std::array<Profiler::Frame, Profiler::HISTORY + 1> frames;
+static size_t current = 0, completed = 0;
+static uint8_t depth = 0;
+static bool overlay = false;
+
+void Profiler::frameMark()
+{
+    const uint64_t now = Time::ticks();
+    Frame& f = frames[current];
+    const Frame* done = nullptr;
+
+    if (f.start != 0)
+    {
+        f.end = now;
+        for (uint16_t i = 0; i < f.zoneCount; ++i) if (f.zones[i].end == 0) f.zones[i].end = now;
+
+        current = (current + 1) % frames.size();
+        completed++;
+        done = &f;
+    }
+
+    Frame& next = frames[current];
+    next.start = now;
+    next.end = 0;
+    next.zoneCount = next.dropped = 0;
+    next.redrawnPixels = 0;
+    depth = 0;
+
+    if (done && isCapturing())
+    {
+        PROFILE_ZONE("trace.write");
+        captureFrame(*done);
+    }
+}
+
+uint16_t Profiler::beginZone(const char* name)
+{
+    Frame& f = frames[current];
+    if (f.start == 0 || !Thread::isMain()) return NO_ZONE;
+    if (f.zoneCount >= MAX_ZONES)
+    {
+        f.dropped++;
+        return NO_ZONE;
+    }
+
+    const uint16_t index = f.zoneCount++;
+    f.zones[index] = {.name = name, .start = Time::ticks(), .end = 0, .depth = depth++};
+
+    return index;
+}
+
+void Profiler::endZone(const uint16_t index)
+{
+    if (index == NO_ZONE) return;
+
+    frames[current].zones[index].end = Time::ticks();
+    if (depth > 0) depth--;
+}
+
+void Profiler::countRedraw(const uint32_t pixels) { frames[current].redrawnPixels += pixels; }
+
+const Profiler::Frame* Profiler::completedFrame(const size_t ago)
+{
+    if (ago >= completedFrames()) return nullptr;
+    return &frames[(current + frames.size() - 1 - ago) % frames.size()];
+}
+
+size_t Profiler::completedFrames() { return completed < HISTORY ? completed : HISTORY; }
+double Profiler::toMilliseconds(const uint64_t ticks) { return Time::toSeconds(ticks) * 1000.0; }
+
+void Profiler::toggleOverlay() { overlay = !overlay; }
+bool Profiler::overlayVisible() { return overlay; }
+
+#endif
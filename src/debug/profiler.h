@@ -0,0 +1,76 @@
+#pragma once
+
+#include <array>
+#include <string>
+#include <cstdint>
+#include <cstddef>
+
+class Font;
+struct Rect;
+
+#ifdef WIISCRIPT_PROFILE
+
+namespace Profiler
+{
+    constexpr size_t MAX_ZONES = 64, HISTORY = 120;
+    constexpr uint16_t NO_ZONE = 0xFFFF;
+
+    struct Zone
+    {
+        const char* name = "";
+        uint64_t start = 0, end = 0;
+        uint8_t depth = 0;
+    };
+
+    struct Frame
+    {
+        uint64_t start = 0, end = 0;
+        uint16_t zoneCount = 0, dropped = 0;
+        uint32_t redrawnPixels = 0;
+        std::array<Zone, MAX_ZONES> zones = {};
+    };
+
+    void frameMark();
+    uint16_t beginZone(const char* name);
+    void endZone(uint16_t index);
+    void countRedraw(uint32_t pixels);
+
+    [[nodiscard]] const Frame* completedFrame(size_t ago = 0);
+    [[nodiscard]] size_t completedFrames();
+    [[nodiscard]] double toMilliseconds(uint64_t ticks);
+
+    bool startCapture(const std::string& path, uint64_t maxBytes = 16 * 1024 * 1024);
+    bool stopCapture(std::string* outError = nullptr);
+    [[nodiscard]] bool isCapturing();
+    void captureFrame(const Frame& frame);
+
+    void toggleOverlay();
+    [[nodiscard]] bool overlayVisible();
+    [[nodiscard]] Rect overlayBounds();
+    void drawOverlay(const Font& font);
+
+    class Scope
+    {
+    public:
+        explicit Scope(const char* name) : index(beginZone(name)) {}
+        ~Scope() { endZone(index); }
+
+        Scope(const Scope&) = delete;
+        Scope& operator=(const Scope&) = delete;
+
+    private:
+        uint16_t index;
+    };
+}
+
+#define PROFILE_CONCAT_INNER(a, b) a##b
+#define PROFILE_CONCAT(a, b) PROFILE_CONCAT_INNER(a, b)
+#define PROFILE_ZONE(name) const Profiler::Scope PROFILE_CONCAT(profileZone, __LINE__)(name)
+#define PROFILE_FRAME() Profiler::frameMark()
+
+#else
+
+#define PROFILE_ZONE(name) static_cast<void>(0)
+#define PROFILE_FRAME() static_cast<void>(0)
+
+#endif
@@ -0,0 +1,103 @@
+#include "./profiler.h"
+
+#ifdef WIISCRIPT_PROFILE
+
+#include "../gfx/font.h"
+#include "../gfx/drawing.h"
+#include "../ui/theme.h"
+
+#include <cstdio>
+#include <algorithm>
+
+#include <grrlib.h>
+
+static constexpr uint32_t ZONE_COLORS[] = {
+    0x4FC3F7FF, 0x81C784FF, 0xFFB74DFF, 0xE57373FF, 0xBA68C8FF, 0xFFF176FF, 0x4DB6ACFF, 0xF06292FF
+};
+static constexpr float BUDGET_MS = 1000.0f / 60.0f;
+static constexpr Rect PANEL = {330.0f, 10.0f, 300.0f, 140.0f};
+
+static uint32_t zoneColor(const char* name)
+{
+    uint32_t h = 2166136261u;
+    for (const char* c = name; *c; ++c) h = (h ^ static_cast<uint8_t>(*c)) * 16777619u;
+
+    return ZONE_COLORS[h % std::size(ZONE_COLORS)];
+}
+
+static void drawTimeline(const Font& font, const Profiler::Frame& f, const float x, const float y, const float w)
+{
+    constexpr float rowH = 12.0f;
+    const double frameMs = Profiler::toMilliseconds(f.end - f.start);
+    const auto scale = static_cast<float>(w / std::max<double>(frameMs, BUDGET_MS));
+
+    GRRLIB_Line(x + BUDGET_MS * scale, y, x + BUDGET_MS * scale, y + rowH * 4, theme().accent);
+
+    char label[48];
+    for (uint16_t i = 0; i < f.zoneCount; ++i)
+    {
+        const Profiler::Zone& z = f.zones[i];
+        const float zx = x + static_cast<float>(Profiler::toMilliseconds(z.start - f.start)) * scale,
+                    zw = std::max(1.0f, static_cast<float>(Profiler::toMilliseconds(z.end - z.start)) * scale),
+                    zy = y + static_cast<float>(std::min<uint8_t>(z.depth, 3)) * rowH;
+
+        GRRLIB_Rectangle(zx, zy, zw, rowH - 1, zoneColor(z.name), true);
+        if (z.depth > 0) continue;
+
+        std::snprintf(label, sizeof(label), "%s %.2f", z.name, Profiler::toMilliseconds(z.end - z.start));
+        if (font.textWidth(label) < zw) font.drawText(label, zx + 2, zy - 2, theme().bg);
+    }
+}
+
+static void drawGraph(const float x, const float y, const float w, const float h)
+{
+    const size_t count = Profiler::completedFrames();
+    const float barW = w / static_cast<float>(Profiler::HISTORY), scale = h / (BUDGET_MS * 2);
+
+    for (size_t ago = 0; ago < count; ++ago)
+    {
+        const Profiler::Frame* f = Profiler::completedFrame(ago);
+        const auto ms = static_cast<float>(Profiler::toMilliseconds(f->end - f->start));
+        const float bh = std::min(h, ms * scale);
+
+        GRRLIB_Rectangle(x + w - static_cast<float>(ago + 1) * barW, y + h - bh, barW, bh,
+                         ms > BUDGET_MS ? 0xE57373FF : 0x81C784FF, true);
+    }
+
+    GRRLIB_Line(x, y + h - BUDGET_MS * scale, x + w, y + h - BUDGET_MS * scale, theme().accent);
+}
+
+Rect Profiler::overlayBounds() { return PANEL; }
+
+void Profiler::drawOverlay(const Font& font)
+{
+    if (!overlayVisible()) return;
+
+    const Frame* last = completedFrame();
+    if (!last) return;
+
+    constexpr float x = PANEL.x, y = PANEL.y, w = PANEL.w, h = PANEL.h, pad = 6.0f;
+    GRRLIB_Rectangle(x, y, w, h, 0x000000C0, true);
+    GRRLIB_Rectangle(x, y, w, h, theme().panelBorder, false);
+
+    double sum = 0.0, worst = 0.0;
+    const size_t count = completedFrames();
+    for (size_t ago = 0; ago < count; ++ago)
+    {
+        const Frame* f = completedFrame(ago);
+        const double ms = toMilliseconds(f->end - f->start);
+        sum += ms;
+        worst = std::max(worst, ms);
+    }
+
+    char line[96];
+    std::snprintf(line, sizeof(line), "frame %.2f ms  avg %.2f  max %.2f  redraw %uK px%s",
+                  toMilliseconds(last->end - last->start), sum / static_cast<double>(count), worst,
+                  (last->redrawnPixels + 512) / 1024, last->dropped ? "  (zones dropped)" : "");
+    font.drawText(line, x + pad, y + pad - 2, theme().text);
+
+    drawTimeline(font, *last, x + pad, y + pad + 20, w - pad * 2);
+    drawGraph(x + pad, y + h - pad - 60, w - pad * 2, 60);
+}
+
+#endif
@@ -0,0 +1,98 @@
+#include "./profiler.h"
+
+#ifdef WIISCRIPT_PROFILE
+
+#include "../platform/platform.h"
+
+#include <cstdio>
+#include <algorithm>
+
+// writeEvent never writes more than this, so captureFrame can budget a whole frame before writing any of it.
+static constexpr size_t EVENT_BYTES = 256;
+static constexpr char TRACE_TAIL[] = "\n],\"displayTimeUnit\":\"ms\"}\n";
+
+static FileSystem::Writer writer(256 * 1024);
+static uint64_t captureStart = 0, byteLimit = 0, frameIndex = 0;
+static bool truncated = false;
+
+static double toMicroseconds(const uint64_t ticks) { return Profiler::toMilliseconds(ticks) * 1000.0; }
+
+static void writeText(const char* text, const size_t length) { writer.write(text, length); }
+
+static void writeEvent(const char* name, const uint64_t start, const uint64_t end, const char* args = "{}")
+{
+    char safe[48];
+    size_t n = 0;
+    for (const char* c = name; *c && n + 1 < sizeof(safe); ++c) safe[n++] = *c == '"' || *c == '\\' ? '_' : *c;
+    safe[n] = '\0';
+
+    char line[EVENT_BYTES];
+    const int length = std::snprintf(line, sizeof(line),
+                                     ",\n{\"name\":\"%s\",\"ph\":\"X\",\"ts\":%.3f,\"dur\":%.3f,\"pid\":0,\"tid\":0,"
+                                     "\"args\":%s}", safe, toMicroseconds(start - captureStart),
+                                     toMicroseconds(end - start), args);
+    if (length > 0) writeText(line, std::min(static_cast<size_t>(length), sizeof(line) - 1));
+}
+
+bool Profiler::startCapture(const std::string& path, const uint64_t maxBytes)
+{
+    if (writer.isOpen() || !writer.open(path)) return false;
+
+    captureStart = Time::ticks();
+    byteLimit = maxBytes;
+    frameIndex = 0;
+    truncated = false;
+
+    static constexpr char head[] = "{\"traceEvents\":[\n"
+        "{\"name\":\"thread_name\",\"ph\":\"M\",\"pid\":0,\"tid\":0,\"args\":{\"name\":\"main\"}}";
+    writeText(head, sizeof(head) - 1);
+
+    return true;
+}
+
+bool Profiler::stopCapture(std::string* outError)
+{
+    if (!writer.isOpen()) return false;
+
+    writeText(TRACE_TAIL, sizeof(TRACE_TAIL) - 1);
+    const uint64_t size = writer.size();
+    if (!writer.close())
+    {
+        if (outError) *outError = "Failed to write trace capture.";
+        return false;
+    }
+
+    if (truncated && outError) *outError = "Trace capture stopped at its size limit.";
+    std::printf("Trace capture saved (%llu frames, %llu bytes)\n", static_cast<unsigned long long>(frameIndex),
+                static_cast<unsigned long long>(size));
+
+    return !truncated;
+}
+
+bool Profiler::isCapturing() { return writer.isOpen(); }
+
+void Profiler::captureFrame(const Frame& frame)
+{
+    if (!writer.isOpen() || frame.start < captureStart) return;
+
+    const uint64_t needed = (frame.zoneCount + 1) * EVENT_BYTES + sizeof(TRACE_TAIL);
+    if (writer.size() + needed > byteLimit)
+    {
+        truncated = true;
+
+        std::string err;
+        if (!stopCapture(&err)) std::printf("%s\n", err.c_str());
+
+        return;
+    }
+
+    char args[80];
+    std::snprintf(args, sizeof(args), "{\"index\":%llu,\"dropped\":%u,\"redrawnPixels\":%u}",
+                  static_cast<unsigned long long>(frameIndex++), frame.dropped, frame.redrawnPixels);
+    writeEvent("frame", frame.start, frame.end, args);
+
+    for (uint16_t i = 0; i < frame.zoneCount; ++i)
+        writeEvent(frame.zones[i].name, frame.zones[i].start, frame.zones[i].end);
+}
+
+#endif
@@ -0,0 +1,508 @@
+#include "./block_index.h"
+#include "../debug/memory.h"
+
+#include <algorithm>
+#include <functional>
+#include <string_view>
+
+// Line entry state: the lexer's state in the low half, and whether a while/for is still waiting for its "do".
+static constexpr uint32_t LEXER_MASK = 0xFFFF, AWAITING_DO = 1u << 16;
+
+bool BlockIndex::sync(const TextBuffer& buffer)
+{
+    if (built && buffer.version() == version) return false;
+    MEMORY_SCOPE(EditorText);
+
+    edits.clear();
+    if (!built || !buffer.editsSince(version, edits))
+    {
+        restart(buffer);
+        return true;
+    }
+
+    // Same bookkeeping as BufferSearch::sync: [first, last) covers every line the edits produced.
+    size_t first = SIZE_MAX, last = 0;
+    for (const auto& e : edits)
+    {
+        const size_t count = lineCount(), at = std::min(e.line, count), removed = std::min(e.removed, count - at);
+
+        // The replacement ends the way the lines it replaces did until it is lexed, so the line after it is only
+        // re-lexed when that actually changes.
+        uint32_t exit = 0;
+        if (removed > 0) exit = nodes[this->at(at + removed - 1)].exit;
+        else if (at > 0) exit = nodes[this->at(at - 1)].exit;
+
+        uint32_t a = NIL, mid = NIL, b = NIL;
+        split(root, at, a, b);
+        split(b, removed, mid, b);
+        release(mid);
+
+        mid = build(e.inserted, [&](const size_t i, Node& n) { if (i + 1 == e.inserted) n.exit = exit; });
+        root = merge(merge(a, mid), b);
+
+        if (first < last)
+        {
+            if (last > at) last = last >= at + removed ? last + e.inserted - removed : at + e.inserted;
+            if (first >= at + removed) first = first + e.inserted - removed;
+        }
+        first = std::min(first, at);
+        last = std::max(last, at + e.inserted);
+    }
+
+    if (lineCount() != buffer.lineCount())
+    {
+        restart(buffer);
+        return true;
+    }
+
+    relex(buffer, first, last);
+    version = buffer.version();
+
+    return true;
+}
+
+void BlockIndex::clear()
+{
+    nodes.clear();
+    nodes.shrink_to_fit();
+    freeNodes.clear();
+    freeNodes.shrink_to_fit();
+    root = NIL;
+    built = false;
+}
+
+bool BlockIndex::match(const TextPos pos, Match& out) const
+{
+    if (pos.line >= lineCount()) return false;
+    const auto& delims = nodes[at(pos.line)].delims;
+
+    // A delimiter starting under the caret wins over one ending just before it.
+    size_t k = delims.size();
+    for (size_t i = 0; i < delims.size(); ++i)
+    {
+        const Delim& d = delims[i];
+        if (d.col <= pos.col && pos.col < d.col + d.length)
+        {
+            k = i;
+            break;
+        }
+        if (d.col + d.length == pos.col) k = i;
+    }
+    if (k == delims.size()) return false;
+
+    const Delim& d = delims[k];
+    out = {};
+    out.at = {pos.line, d.col, d.length};
+
+    // `depth` counts delimiters opened (or, walking back, closed) since `d` that still await their partner.
+    const auto resolve = [&](const size_t line, const std::vector<Delim>& in, const size_t j, uint32_t& depth)
+    {
+        if (in[j].open != d.open)
+        {
+            if (depth > 0)
+            {
+                depth--;
+                return false;
+            }
+
+            out.partner = {line, in[j].col, in[j].length};
+            out.paired = true;
+            out.mismatched = in[j].shape != d.shape;
+            return true;
+        }
+
+        depth++;
+        return false;
+    };
+
+    uint32_t depth = 0;
+    if (d.open)
+    {
+        for (size_t j = k + 1; j < delims.size(); ++j)
+            if (resolve(pos.line, delims, j, depth)) return true;
+
+        Balance acc;
+        const size_t line = findClose(root, 0, pos.line + 1, depth + 1, acc);
+        if (line == SIZE_MAX) return true;
+
+        depth = depth - acc.closes + acc.opens;
+        const auto& in = nodes[at(line)].delims;
+        for (size_t j = 0; j < in.size(); ++j)
+            if (resolve(line, in, j, depth)) return true;
+    }
+    else
+    {
+        for (size_t j = k; j-- > 0;)
+            if (resolve(pos.line, delims, j, depth)) return true;
+
+        Balance acc;
+        const size_t line = findOpen(root, 0, pos.line, depth + 1, acc);
+        if (line == SIZE_MAX) return true;
+
+        depth = depth - acc.opens + acc.closes;
+        const auto& in = nodes[at(line)].delims;
+        for (size_t j = in.size(); j-- > 0;)
+            if (resolve(line, in, j, depth)) return true;
+    }
+
+    return true;
+}
+
+size_t BlockIndex::depth(const size_t line) const
+{
+    if (line >= lineCount()) return 0;
+
+    const uint32_t opens = prefix(line).opens;
+    return opens - std::min(opens, nodes[at(line)].own.closes);
+}
+
+size_t BlockIndex::blockEnd(const size_t line) const
+{
+    if (line >= lineCount()) return SIZE_MAX;
+
+    // The outermost opener left open is the first one that no later closer on the line pairs with.
+    const auto& delims = nodes[at(line)].delims;
+    size_t outer = delims.size(), open = 0;
+    for (size_t i = 0; i < delims.size(); ++i)
+    {
+        if (delims[i].open)
+        {
+            if (open++ == 0) outer = i;
+        }
+        else if (open > 0) open--;
+    }
+    if (open == 0) return SIZE_MAX;
+
+    Match m;
+    return match({line, delims[outer].col}, m) && m.paired ? m.partner.line : SIZE_MAX;
+}
+
+size_t BlockIndex::enclosing(const size_t line) const
+{
+    Balance acc;
+    return findOpen(root, 0, std::min(line, lineCount()), 1, acc);
+}
+
+size_t BlockIndex::lineCount() const { return size(root); }
+
+LuaLexer::State BlockIndex::entry(const size_t line) const
+{
+    if (line == 0 || line > lineCount()) return 0;
+
+    return static_cast<LuaLexer::State>(nodes[at(line - 1)].exit & LEXER_MASK);
+}
+
+void BlockIndex::relexed(size_t& first, size_t& last) const
+{
+    first = relexFirst;
+    last = relexLast;
+}
+
+void BlockIndex::restart(const TextBuffer& buffer)
+{
+    nodes.clear();
+    freeNodes.clear();
+
+    const auto& text = buffer.getLines();
+    uint32_t entry = 0;
+    root = build(text.size(), [&](const size_t i, Node& n) { entry = lex(text[i], entry, n); });
+    relexFirst = 0;
+    relexLast = text.size();
+
+    version = buffer.version();
+    built = true;
+}
+
+uint32_t BlockIndex::lex(const std::string& line, const uint32_t entry, Node& node)
+{
+    const LuaLexer::State state = LuaLexer::lexLine(line, static_cast<LuaLexer::State>(entry & LEXER_MASK), tokens);
+    bool awaitingDo = (entry & AWAITING_DO) != 0;
+
+    node.delims.clear();
+    node.own = {};
+    for (const auto& t : tokens)
+    {
+        Delim d;
+        if (t.kind == LuaLexer::Kind::Punct)
+        {
+            switch (line[t.col])
+            {
+            case '(': d = {t.col, 1, Shape::Paren, true}; break;
+            case ')': d = {t.col, 1, Shape::Paren, false}; break;
+            case '[': d = {t.col, 1, Shape::Bracket, true}; break;
+            case ']': d = {t.col, 1, Shape::Bracket, false}; break;
+            case '{': d = {t.col, 1, Shape::Brace, true}; break;
+            case '}': d = {t.col, 1, Shape::Brace, false}; break;
+            default: continue;
+            }
+        }
+        else if (t.kind == LuaLexer::Kind::Keyword)
+        {
+            const std::string_view word(line.data() + t.col, t.length);
+            d = {t.col, static_cast<uint16_t>(t.length), Shape::Block, false};
+            if (word == "function" || word == "if") d.open = true;
+            else if (word == "while" || word == "for") d.open = awaitingDo = true;
+            else if (word == "do")
+            {
+                // The "do" of a loop belongs to its while/for rather than opening a block of its own.
+                if (awaitingDo)
+                {
+                    awaitingDo = false;
+                    continue;
+                }
+                d.open = true;
+            }
+            else if (word == "repeat") d = {t.col, static_cast<uint16_t>(t.length), Shape::Repeat, true};
+            else if (word == "until") d = {t.col, static_cast<uint16_t>(t.length), Shape::Repeat, false};
+            else if (word != "end") continue;
+        }
+        else continue;
+
+        node.delims.push_back(d);
+        if (d.open) node.own.opens++;
+        else if (node.own.opens > 0) node.own.opens--;
+        else node.own.closes++;
+    }
+
+    node.exit = state | (awaitingDo ? AWAITING_DO : 0);
+    return node.exit;
+}
+
+void BlockIndex::relex(const TextBuffer& buffer, const size_t first, const size_t last)
+{
+    const auto& text = buffer.getLines();
+    uint32_t entry = first == 0 || first > text.size() ? 0 : nodes[at(first - 1)].exit;
+
+    relexFirst = relexLast = std::min(first, text.size());
+    for (size_t i = first; i < text.size(); ++i)
+    {
+        relexLast = i + 1;
+        Node& node = nodes[at(i)];
+        const uint32_t before = node.exit;
+
+        entry = lex(text[i], entry, node);
+        for (size_t p = path.size(); p-- > 0;) pull(path[p]);
+
+        if (i + 1 >= last && entry == before) break;
+    }
+}
+
+uint32_t BlockIndex::allocate()
+{
+    seed ^= seed << 13;
+    seed ^= seed >> 17;
+    seed ^= seed << 5;
+
+    uint32_t t;
+    if (!freeNodes.empty())
+    {
+        t = freeNodes.back();
+        freeNodes.pop_back();
+        nodes[t] = {};
+    }
+    else
+    {
+        t = static_cast<uint32_t>(nodes.size());
+        nodes.emplace_back();
+    }
+
+    nodes[t].priority = seed;
+    return t;
+}
+
+void BlockIndex::release(const uint32_t t)
+{
+    if (t == NIL) return;
+
+    release(nodes[t].left);
+    release(nodes[t].right);
+    std::vector<Delim>().swap(nodes[t].delims);
+    freeNodes.push_back(t);
+}
+
+uint32_t BlockIndex::build(const size_t count, const std::function<void(size_t, Node&)>& fill)
+{
+    // Cartesian tree over `count` new lines in order: each node pops the lower-priority ones off the right spine
+    // and adopts them as its left subtree. A popped node is final, so it can be summed right away.
+    spine.clear();
+    for (size_t i = 0; i < count; ++i)
+    {
+        const uint32_t t = allocate();
+        if (fill) fill(i, nodes[t]);
+
+        uint32_t last = NIL;
+        while (!spine.empty() && nodes[spine.back()].priority < nodes[t].priority)
+        {
+            last = spine.back();
+            spine.pop_back();
+            pull(last);
+        }
+
+        nodes[t].left = last;
+        if (!spine.empty()) nodes[spine.back()].right = t;
+        spine.push_back(t);
+    }
+
+    for (size_t p = spine.size(); p-- > 0;) pull(spine[p]);
+    return spine.empty() ? NIL : spine.front();
+}
+
+void BlockIndex::pull(const uint32_t t)
+{
+    Node& n = nodes[t];
+    n.size = 1 + size(n.left) + size(n.right);
+    n.sum = n.own;
+    if (n.left != NIL) n.sum = combine(nodes[n.left].sum, n.sum);
+    if (n.right != NIL) n.sum = combine(n.sum, nodes[n.right].sum);
+}
+
+void BlockIndex::split(const uint32_t t, const size_t count, uint32_t& a, uint32_t& b)
+{
+    if (t == NIL)
+    {
+        a = b = NIL;
+        return;
+    }
+
+    if (const size_t left = size(nodes[t].left); count <= left)
+    {
+        split(nodes[t].left, count, a, nodes[t].left);
+        b = t;
+    }
+    else
+    {
+        split(nodes[t].right, count - left - 1, nodes[t].right, b);
+        a = t;
+    }
+    pull(t);
+}
+
+uint32_t BlockIndex::merge(const uint32_t a, const uint32_t b)
+{
+    if (a == NIL) return b;
+    if (b == NIL) return a;
+
+    if (nodes[a].priority > nodes[b].priority)
+    {
+        nodes[a].right = merge(nodes[a].right, b);
+        pull(a);
+        return a;
+    }
+
+    nodes[b].left = merge(a, nodes[b].left);
+    pull(b);
+    return b;
+}
+
+uint32_t BlockIndex::size(const uint32_t t) const { return t == NIL ? 0 : nodes[t].size; }
+
+uint32_t BlockIndex::at(size_t line) const
+{
+    // Leaves the nodes walked through in `path`, root first, for callers that change the one found.
+    path.clear();
+    for (uint32_t t = root; t != NIL;)
+    {
+        path.push_back(t);
+        const size_t left = size(nodes[t].left);
+        if (line == left) return t;
+
+        if (line < left) t = nodes[t].left;
+        else
+        {
+            line -= left + 1;
+            t = nodes[t].right;
+        }
+    }
+
+    return NIL;
+}
+
+BlockIndex::Balance BlockIndex::prefix(size_t line) const
+{
+    Balance acc;
+    for (uint32_t t = root; t != NIL;)
+    {
+        const Node& n = nodes[t];
+        const size_t left = size(n.left);
+        if (line <= left)
+        {
+            t = n.left;
+            continue;
+        }
+
+        if (n.left != NIL) acc = combine(acc, nodes[n.left].sum);
+        acc = combine(acc, n.own);
+        line -= left + 1;
+        t = n.right;
+    }
+
+    return acc;
+}
+
+size_t BlockIndex::findClose(const uint32_t t, const size_t base, const size_t from, const uint32_t need,
+                             Balance& acc) const
+{
+    // Folds lines from `from` onwards into `acc` until it holds `need` unmatched closers. Subtrees entirely past
+    // `from` that cannot get there are folded whole, so only one root-to-leaf path is actually descended.
+    if (t == NIL) return SIZE_MAX;
+
+    const Node& n = nodes[t];
+    if (base >= from)
+    {
+        if (const Balance whole = combine(acc, n.sum); whole.closes < need)
+        {
+            acc = whole;
+            return SIZE_MAX;
+        }
+    }
+
+    const size_t index = base + size(n.left);
+    if (from < index)
+        if (const size_t found = findClose(n.left, base, from, need, acc); found != SIZE_MAX) return found;
+
+    if (index >= from)
+    {
+        const Balance next = combine(acc, n.own);
+        if (next.closes >= need) return index;
+        acc = next;
+    }
+
+    return findClose(n.right, index + 1, from, need, acc);
+}
+
+size_t BlockIndex::findOpen(const uint32_t t, const size_t base, const size_t end, const uint32_t need,
+                            Balance& acc) const
+{
+    // findClose mirrored: walks lines before `end` backwards, prepending them to `acc` until it holds `need`
+    // unmatched openers.
+    if (t == NIL) return SIZE_MAX;
+
+    const Node& n = nodes[t];
+    if (base + n.size <= end)
+    {
+        if (const Balance whole = combine(n.sum, acc); whole.opens < need)
+        {
+            acc = whole;
+            return SIZE_MAX;
+        }
+    }
+
+    const size_t index = base + size(n.left);
+    if (index + 1 < end)
+        if (const size_t found = findOpen(n.right, index + 1, end, need, acc); found != SIZE_MAX) return found;
+
+    if (index < end)
+    {
+        const Balance next = combine(n.own, acc);
+        if (next.opens >= need) return index;
+        acc = next;
+    }
+
+    return findOpen(n.left, base, end, need, acc);
+}
+
+BlockIndex::Balance BlockIndex::combine(const Balance& a, const Balance& b)
+{
+    const uint32_t matched = std::min(a.opens, b.closes);
+    return {a.closes + b.closes - matched, a.opens + b.opens - matched};
+}
@@ -0,0 +1,113 @@
+#pragma once
+
+#include "./text.h"
+#include "./lua_lexer.h"
+
+#include <functional>
+
+// Nesting structure of a Lua buffer: block keywords (function/if/do/for/while/repeat ... end/until) and brackets,
+// taken from the LuaLexer token stream. Every line is a node of an implicit treap that sums how many delimiters the
+// line leaves unmatched on each side, so the partner of a delimiter and the nesting depth of a line are found in
+// O(log n) without scanning the text. Buffer edits re-lex the lines they touched, and following lines only while a
+// long string or comment changes how they start.
+class BlockIndex
+{
+public:
+    enum class Shape : uint8_t
+    {
+        Paren,
+        Bracket,
+        Brace,
+        Block,
+        Repeat
+    };
+
+    struct Span
+    {
+        size_t line = 0, col = 0, length = 0;
+    };
+
+    // `partner` is only meaningful when `paired`; `mismatched` pairs close a different shape than they open, like
+    // "( ]" or "repeat ... end".
+    struct Match
+    {
+        Span at, partner;
+        bool paired = false, mismatched = false;
+    };
+
+    // Catches up with the buffer's edits; returns whether any line changed.
+    bool sync(const TextBuffer& buffer);
+    void clear();
+
+    // The delimiter under or just before `pos`, and its partner. False when there is no delimiter there.
+    bool match(TextPos pos, Match& out) const;
+
+    // Blocks open at the start of `line`, less those the line closes before opening any.
+    [[nodiscard]] size_t depth(size_t line) const;
+
+    // The line closing the outermost block that `line` opens and leaves open, or SIZE_MAX.
+    [[nodiscard]] size_t blockEnd(size_t line) const;
+    // The line opening the innermost block still open at the start of `line`, or SIZE_MAX at the top level.
+    [[nodiscard]] size_t enclosing(size_t line) const;
+    [[nodiscard]] size_t lineCount() const;
+
+    // The lexer state `line` starts in, for re-lexing it elsewhere.
+    [[nodiscard]] LuaLexer::State entry(size_t line) const;
+
+    // Lines [first, last) that the last sync() lexed again, so whatever depends on their structure may have moved.
+    void relexed(size_t& first, size_t& last) const;
+
+private:
+    static constexpr uint32_t NIL = UINT32_MAX;
+
+    struct Delim
+    {
+        uint32_t col = 0;
+        uint16_t length = 0;
+        Shape shape = Shape::Paren;
+        bool open = false;
+    };
+
+    // Delimiters left unmatched by a run of lines: closers at its start and openers at its end.
+    struct Balance
+    {
+        uint32_t closes = 0, opens = 0;
+    };
+
+    struct Node
+    {
+        std::vector<Delim> delims;
+        Balance own, sum;
+        uint32_t left = NIL, right = NIL, size = 1, priority = 0, exit = 0;
+    };
+
+    std::vector<Node> nodes;
+    std::vector<uint32_t> freeNodes;
+    std::vector<TextBuffer::LineEdit> edits;
+    std::vector<LuaLexer::Token> tokens;
+    std::vector<uint32_t> spine;
+    mutable std::vector<uint32_t> path;
+    uint32_t root = NIL, seed = 0x2545F491;
+    uint64_t version = 0;
+    size_t relexFirst = 0, relexLast = 0;
+    bool built = false;
+
+    void restart(const TextBuffer& buffer);
+    uint32_t lex(const std::string& line, uint32_t entry, Node& node);
+    void relex(const TextBuffer& buffer, size_t first, size_t last);
+
+    uint32_t allocate();
+    void release(uint32_t t);
+    uint32_t build(size_t count, const std::function<void(size_t, Node&)>& fill = {});
+    void pull(uint32_t t);
+    void split(uint32_t t, size_t count, uint32_t& a, uint32_t& b);
+    uint32_t merge(uint32_t a, uint32_t b);
+
+    [[nodiscard]] uint32_t size(uint32_t t) const;
+    [[nodiscard]] uint32_t at(size_t line) const;
+    [[nodiscard]] Balance prefix(size_t line) const;
+    size_t findClose(uint32_t t, size_t base, size_t from, uint32_t need, Balance& acc) const;
+    size_t findOpen(uint32_t t, size_t base, size_t end, uint32_t need, Balance& acc) const;
+
+    [[nodiscard]] static Balance combine(const Balance& a, const Balance& b);
+};
@@ -4,6 +4,8 @@
 void TextBuffer::setText(const std::string& text)
 {
     lines.clear();
+    edits.clear();
+    editVersion++;
 
     std::string cur;
     cur.reserve(text.size());
@@ -42,3 +44,20 @@ size_t TextBuffer::lineLength(const size_t line) const
 {
     return lines.empty() ? 0 : lines[std::min(line, lines.size() - 1)].size();
 }
+
+void TextBuffer::noteEdit(const size_t line, const size_t removed, const size_t inserted)
+{
+    if (edits.size() == MAX_EDITS) edits.erase(edits.begin());
+    edits.push_back({line, removed, inserted});
+    editVersion++;
+}
+
+uint64_t TextBuffer::version() const { return editVersion; }
+
+bool TextBuffer::editsSince(const uint64_t since, std::vector<LineEdit>& out) const
+{
+    if (since > editVersion || editVersion - since > edits.size()) return false;
+
+    out.insert(out.end(), edits.end() - static_cast<ptrdiff_t>(editVersion - since), edits.end());
+    return true;
+}
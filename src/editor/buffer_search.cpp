@@ -0,0 +1,270 @@
+#include "./buffer_search.h"
+#include "../platform/platform.h"
+#include "../debug/memory.h"
+
+#include <algorithm>
+
+// Text positions the pattern advances between looks at the clock.
+static constexpr size_t SCAN_STEPS = 1024;
+
+bool BufferSearch::setPattern(const std::string& pattern, const TextBuffer& buffer, const Pattern::Syntax syntax,
+                              std::string* outError)
+{
+    if (pattern == source && syntax == mode) return false;
+    if (pattern.empty() || pattern.find('\n') != std::string::npos ||
+        (syntax != Pattern::Syntax::Literal && !compiled.compile(pattern, syntax, outError)))
+    {
+        clear();
+        return true;
+    }
+    MEMORY_SCOPE(EditorText);
+
+    // Bring the hits up to date with the old pattern before narrowing them.
+    sync(buffer);
+    const bool extends = syntax == Pattern::Syntax::Literal && mode == Pattern::Syntax::Literal && active() &&
+        complete() && pattern.size() > source.size() && pattern.compare(0, source.size(), source) == 0;
+
+    source = pattern;
+    mode = syntax;
+    search = SubstringSearch(syntax == Pattern::Syntax::Literal ? pattern : std::string());
+    if (!extends)
+    {
+        restart(buffer);
+        return true;
+    }
+
+    // Every occurrence of the longer pattern is an occurrence of the shorter one, so only old hits need checking.
+    const auto& text = buffer.getLines();
+    total = 0;
+    for (size_t i = 0; i < lines.size(); ++i)
+    {
+        auto& spans = lines[i];
+        if (spans.empty()) continue;
+
+        spans.erase(std::remove_if(spans.begin(), spans.end(), [&](Span& s)
+        {
+            s.length = static_cast<uint32_t>(pattern.size());
+            return text[i].compare(s.col, pattern.size(), pattern) != 0;
+        }), spans.end());
+        total += shown(spans);
+    }
+
+    return true;
+}
+
+void BufferSearch::clear()
+{
+    source.clear();
+    search = SubstringSearch();
+    lines.clear();
+    lines.shrink_to_fit();
+    total = scanned = 0;
+    partial = false;
+}
+
+bool BufferSearch::sync(const TextBuffer& buffer)
+{
+    if (!active() || buffer.version() == version) return false;
+    MEMORY_SCOPE(EditorText);
+
+    // The line a deadline cut short may have changed or moved.
+    partial = false;
+    edits.clear();
+    if (!buffer.editsSince(version, edits))
+    {
+        restart(buffer);
+        return true;
+    }
+
+    // [first, last) covers every line the edits produced, in final line numbers. Lines past `scanned` are left to
+    // resume(), which moves back to the first edited line if an edit reached into what it had already covered.
+    size_t first = SIZE_MAX, last = 0;
+    for (const auto& e : edits)
+    {
+        const size_t at = std::min(e.line, lines.size()), removed = std::min(e.removed, lines.size() - at);
+        for (size_t i = at; i < at + removed; ++i) total -= shown(lines[i]);
+
+        lines.erase(lines.begin() + static_cast<ptrdiff_t>(at), lines.begin() + static_cast<ptrdiff_t>(at + removed));
+        lines.insert(lines.begin() + static_cast<ptrdiff_t>(at), e.inserted, {});
+
+        if (first < last)
+        {
+            if (last > at) last = last >= at + removed ? last + e.inserted - removed : at + e.inserted;
+            if (first >= at + removed) first = first + e.inserted - removed;
+        }
+        first = std::min(first, at);
+        last = std::max(last, at + e.inserted);
+        if (scanned > at) scanned = scanned >= at + removed ? scanned + e.inserted - removed : at;
+    }
+
+    const auto& text = buffer.getLines();
+    if (lines.size() != text.size())
+    {
+        restart(buffer);
+        return true;
+    }
+
+    for (size_t i = first; i < last && i < scanned; ++i)
+    {
+        total -= shown(lines[i]);
+        scanLine(text[i], lines[i]);
+        total += shown(lines[i]);
+    }
+
+    version = buffer.version();
+
+    return true;
+}
+
+bool BufferSearch::resume(const TextBuffer& buffer, const double seconds)
+{
+    if (!active() || complete()) return false;
+    MEMORY_SCOPE(EditorText);
+    sync(buffer);
+
+    const auto& text = buffer.getLines();
+    const double deadline = Time::seconds() + seconds;
+    while (scanned < lines.size() && scanPending(text[scanned], deadline))
+    {
+        total -= shown(lines[scanned]);
+        lines[scanned].swap(pending);
+        total += shown(lines[scanned++]);
+        if (Time::seconds() >= deadline) break;
+    }
+
+    return true;
+}
+
+bool BufferSearch::active() const { return !source.empty(); }
+bool BufferSearch::complete() const { return scanned >= lines.size(); }
+Pattern::Syntax BufferSearch::syntax() const { return mode; }
+const std::string& BufferSearch::pattern() const { return source; }
+size_t BufferSearch::count() const { return total; }
+
+void BufferSearch::lineMatches(const size_t line, std::vector<Span>& out) const
+{
+    out.clear();
+    if (line >= lines.size()) return;
+
+    size_t end = 0;
+    for (const Span& s : lines[line])
+        if (s.col >= end)
+        {
+            out.push_back(s);
+            end = s.col + s.length;
+        }
+}
+
+bool BufferSearch::hasMatches(const size_t line) const { return line < lines.size() && !lines[line].empty(); }
+
+bool BufferSearch::next(const TextPos from, const bool forward, Hit& out) const
+{
+    if (total == 0 || lines.empty()) return false;
+
+    std::vector<Span> spans;
+    const size_t n = lines.size(), start = std::min(from.line, n - 1);
+    for (size_t step = 0; step <= n; ++step)
+    {
+        const size_t line = forward ? (start + step) % n : (start + n - step) % n;
+        if (lines[line].empty()) continue;
+
+        // The starting line is visited twice: first for the hits on the far side of `from`, then, after wrapping, for
+        // the rest.
+        const bool first = step == 0, wrapped = step == n;
+        lineMatches(line, spans);
+        if (!forward) std::reverse(spans.begin(), spans.end());
+
+        for (const Span& s : spans)
+        {
+            if (first && (forward ? s.col < from.col : s.col >= from.col)) continue;
+            if (wrapped && (forward ? s.col >= from.col : s.col < from.col)) continue;
+
+            out = {line, s.col, s.length};
+            return true;
+        }
+    }
+
+    return false;
+}
+
+void BufferSearch::restart(const TextBuffer& buffer)
+{
+    lines.assign(buffer.lineCount(), {});
+    total = scanned = 0;
+    partial = false;
+    version = buffer.version();
+    if (mode != Pattern::Syntax::Literal) return;
+
+    // Literal scans are cheap enough to finish at once, which extending the pattern relies on.
+    const auto& text = buffer.getLines();
+    for (; scanned < lines.size(); ++scanned)
+    {
+        scanLine(text[scanned], lines[scanned]);
+        total += shown(lines[scanned]);
+    }
+}
+
+void BufferSearch::scanLine(const std::string& text, std::vector<Span>& out) const
+{
+    out.clear();
+    if (mode == Pattern::Syntax::Literal)
+    {
+        const auto length = static_cast<uint32_t>(source.size());
+        for (size_t pos = 0; (pos = search.find(text.data(), text.size(), pos)) != SubstringSearch::NPOS; ++pos)
+            out.push_back({static_cast<uint32_t>(pos), length});
+        return;
+    }
+
+    Pattern::Match m;
+    for (size_t pos = 0; pos <= text.size() && compiled.find(text.data(), text.size(), pos, m);)
+    {
+        if (m.end > m.start) out.push_back({static_cast<uint32_t>(m.start), static_cast<uint32_t>(m.end - m.start)});
+        pos = m.end > m.start ? m.end : m.start + 1;
+    }
+}
+
+// Carries on scanning `text` into `pending`; returns false, keeping what it found so far, if the deadline passes first.
+bool BufferSearch::scanPending(const std::string& text, const double deadline)
+{
+    if (mode == Pattern::Syntax::Literal)
+    {
+        scanLine(text, pending);
+        return true;
+    }
+
+    if (!partial)
+    {
+        pending.clear();
+        compiled.begin(lineScan, 0);
+        partial = true;
+    }
+
+    Pattern::Match m;
+    for (;;)
+    {
+        if (compiled.resume(lineScan, text.data(), text.size(), SCAN_STEPS))
+        {
+            if (!lineScan.found(m)) break;
+            if (m.end > m.start)
+                pending.push_back({static_cast<uint32_t>(m.start), static_cast<uint32_t>(m.end - m.start)});
+            compiled.begin(lineScan, m.end > m.start ? m.end : m.start + 1);
+        }
+        if (Time::seconds() >= deadline) return false;
+    }
+    partial = false;
+
+    return true;
+}
+
+size_t BufferSearch::shown(const std::vector<Span>& spans)
+{
+    size_t n = 0, end = 0;
+    for (const Span& s : spans)
+        if (s.col >= end)
+        {
+            n++;
+            end = s.col + s.length;
+        }
+
+    return n;
+}
@@ -0,0 +1,69 @@
+#pragma once
+
+#include "./text.h"
+#include "./search.h"
+#include "./pattern.h"
+
+// Match cache for searching the open buffer while the pattern is typed. Literal searches keep every occurrence per
+// line, overlapping ones included, so extending the pattern only re-checks the previous hits. Lua and regex patterns
+// are scanned a slice of lines at a time through resume(), so a large buffer never stalls a frame. Buffer edits
+// re-scan just the lines they touched. Matches never span lines.
+class BufferSearch
+{
+public:
+    struct Span
+    {
+        uint32_t col = 0, length = 0;
+    };
+
+    struct Hit
+    {
+        size_t line = 0, col = 0, length = 0;
+    };
+
+    // Returns false when nothing changed. An empty pattern, or one that does not compile, clears the search.
+    bool setPattern(const std::string& pattern, const TextBuffer& buffer,
+                    Pattern::Syntax syntax = Pattern::Syntax::Literal, std::string* outError = nullptr);
+    void clear();
+
+    // Catches up with the buffer's edits; returns whether any cached line changed.
+    bool sync(const TextBuffer& buffer);
+
+    // Scans lines not visited yet until `seconds` have passed. The clock is checked between lines and every few
+    // thousand characters within one, where a long line's scan stops and later carries on. Returns whether there was
+    // anything left to scan.
+    bool resume(const TextBuffer& buffer, double seconds);
+
+    [[nodiscard]] bool active() const;
+    [[nodiscard]] bool complete() const;
+    [[nodiscard]] Pattern::Syntax syntax() const;
+    [[nodiscard]] const std::string& pattern() const;
+
+    // Non-overlapping, non-empty matches, which is what gets highlighted and replaced.
+    [[nodiscard]] size_t count() const;
+    void lineMatches(size_t line, std::vector<Span>& out) const;
+    [[nodiscard]] bool hasMatches(size_t line) const;
+
+    // The nearest match starting at or after `from` (backwards: before it), wrapping around the buffer.
+    bool next(TextPos from, bool forward, Hit& out) const;
+
+private:
+    std::string source;
+    Pattern::Syntax mode = Pattern::Syntax::Literal;
+    SubstringSearch search;
+    Pattern compiled;
+    std::vector<std::vector<Span>> lines;
+    std::vector<TextBuffer::LineEdit> edits;
+    uint64_t version = 0;
+    size_t total = 0, scanned = 0;
+
+    // The line at `scanned` while a deadline cut its scan short.
+    Pattern::Scan lineScan;
+    std::vector<Span> pending;
+    bool partial = false;
+
+    void restart(const TextBuffer& buffer);
+    void scanLine(const std::string& text, std::vector<Span>& out) const;
+    bool scanPending(const std::string& text, double deadline);
+    [[nodiscard]] static size_t shown(const std::vector<Span>& spans);
+};
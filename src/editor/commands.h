@@ -4,6 +4,7 @@
 #include <memory>
 
 #include "./text.h"
+#include "../debug/memory.h"
 
 struct EditCommand
 {
@@ -66,6 +67,62 @@ public:
     TextCursor::State before = {}, after = {};
 };
 
+// Replaces many single-line matches as one undo step. Each affected line is rebuilt once, whatever its hit count.
+class ReplaceAllCommand : public EditCommand
+{
+public:
+    struct LineHits
+    {
+        size_t line = 0;
+        std::vector<size_t> cols;
+    };
+
+    ReplaceAllCommand(std::string pattern, std::string replacement, std::vector<LineHits> hits,
+                      const TextCursor::State& before)
+        : pattern(std::move(pattern)), replacement(std::move(replacement)), hits(std::move(hits)), before(before)
+    {
+    }
+
+    void execute(TextEditor& editor) override
+    {
+        for (const auto& h : hits) editor.replaceLine(h.line, splice(editor.buffer().getLines()[h.line], h, false));
+        editor.setCursorState(before);
+        editor.cursor().clearSelection();
+    }
+
+    void undo(TextEditor& editor) override
+    {
+        for (const auto& h : hits) editor.replaceLine(h.line, splice(editor.buffer().getLines()[h.line], h, true));
+        editor.setCursorState(before);
+    }
+
+    std::string pattern, replacement;
+    std::vector<LineHits> hits;
+    TextCursor::State before = {};
+
+private:
+    // Columns are recorded against the original line; after replacing, the k-th hit has moved by k times the
+    // length difference.
+    [[nodiscard]] std::string splice(const std::string& line, const LineHits& h, const bool reverting) const
+    {
+        const std::string &found = reverting ? replacement : pattern, &put = reverting ? pattern : replacement;
+
+        std::string out;
+        out.reserve(line.size() + h.cols.size() * put.size());
+        size_t at = 0;
+        for (size_t k = 0; k < h.cols.size(); ++k)
+        {
+            const size_t col = reverting ? h.cols[k] + k * replacement.size() - k * pattern.size() : h.cols[k];
+            out.append(line, at, col - at);
+            out += put;
+            at = col + found.size();
+        }
+        out.append(line, at);
+
+        return out;
+    }
+};
+
 class CommandHistory
 {
 public:
@@ -80,6 +137,7 @@ public:
     void execute(TextEditor& editor, std::unique_ptr<EditCommand> command)
     {
         if (!command) return;
+        MEMORY_SCOPE(Undo);
 
         command->execute(editor);
         undoStack.push_back(std::move(command));
@@ -94,6 +152,7 @@ public:
     void undo(TextEditor& editor)
     {
         if (undoStack.empty()) return;
+        MEMORY_SCOPE(Undo);
 
         auto command = std::move(undoStack.back());
         undoStack.pop_back();
@@ -104,6 +163,7 @@ public:
     void redo(TextEditor& editor)
     {
         if (redoStack.empty()) return;
+        MEMORY_SCOPE(Undo);
 
         auto command = std::move(redoStack.back());
         redoStack.pop_back();
@@ -1,7 +1,9 @@
 #include "./text.h"
+#include "./row_map.h"
 #include <algorithm>
 
 TextCursor::TextCursor(const TextBuffer& buffer) { textBuffer = &buffer; }
+void TextCursor::setRows(const RowMap* rows) { rowMap = rows; }
 TextPos TextCursor::cursor() const { return cursorPos; }
 
 void TextCursor::setCursor(const TextPos pos, const bool clearSel)
@@ -36,9 +38,9 @@ void TextCursor::moveLeft(const bool extendSelection)
     if (extendSelection && !selecting) startSelection();
 
     if (cursorPos.col > 0) cursorPos.col--;
-    else if (cursorPos.line > 0)
+    else if (const size_t r = row(cursorPos.line); r > 0)
     {
-        cursorPos.line--;
+        cursorPos.line = lineAt(r - 1);
         cursorPos.col = textBuffer->lineLength(cursorPos.line);
     }
 
@@ -51,9 +53,9 @@ void TextCursor::moveRight(const bool extendSelection)
     if (extendSelection && !selecting) startSelection();
 
     if (cursorPos.col < textBuffer->lineLength(cursorPos.line)) cursorPos.col++;
-    else if (cursorPos.line < textBuffer->lineCount() - 1)
+    else if (const size_t r = rowOf(cursorPos); r + 1 < rowCount())
     {
-        cursorPos.line++;
+        cursorPos.line = lineAt(r + 1);
         cursorPos.col = 0;
     }
 
@@ -64,11 +66,7 @@ void TextCursor::moveRight(const bool extendSelection)
 void TextCursor::moveUp(const bool extendSelection)
 {
     if (extendSelection && !selecting) startSelection();
-    if (cursorPos.line > 0)
-    {
-        cursorPos.line--;
-        cursorPos.col = std::min(cursorPos.col, textBuffer->lineLength(cursorPos.line));
-    }
+    if (const size_t r = rowOf(cursorPos); r > 0) moveToRow(r - 1);
 
     if (extendSelection) updateSelection();
     else clearSelection();
@@ -77,11 +75,7 @@ void TextCursor::moveUp(const bool extendSelection)
 void TextCursor::moveDown(const bool extendSelection)
 {
     if (extendSelection && !selecting) startSelection();
-    if (cursorPos.line < textBuffer->lineCount() - 1)
-    {
-        cursorPos.line++;
-        cursorPos.col = std::min(cursorPos.col, textBuffer->lineLength(cursorPos.line));
-    }
+    if (const size_t r = rowOf(cursorPos); r + 1 < rowCount()) moveToRow(r + 1);
 
     if (extendSelection) updateSelection();
     else clearSelection();
@@ -113,3 +107,58 @@ void TextCursor::clampCursor()
     cursorPos.line = std::min(cursorPos.line, textBuffer->lineCount() - 1);
     cursorPos.col = std::min(cursorPos.col, textBuffer->lineLength(cursorPos.line));
 }
+
+size_t TextCursor::row(const size_t line) const
+{
+    const RowMap* rows = rowsInUse();
+    return rows ? rows->toRow(line) : line;
+}
+
+size_t TextCursor::rowOf(const TextPos pos) const
+{
+    const WrapCache* wrap = wrapping();
+    return row(pos.line) + (wrap && !rowMap->hidden(pos.line) ? wrap->rowOf(pos.line, pos.col) : 0);
+}
+
+size_t TextCursor::rowCount() const
+{
+    const RowMap* rows = rowsInUse();
+    return rows ? rows->rowCount() : textBuffer->lineCount();
+}
+
+size_t TextCursor::lineAt(const size_t row, size_t* lineRow) const
+{
+    if (const RowMap* rows = rowsInUse()) return rows->toLine(row, lineRow);
+
+    if (lineRow) *lineRow = 0;
+    return row;
+}
+
+const WrapCache* TextCursor::wrapping() const
+{
+    const RowMap* rows = rowsInUse();
+    const WrapCache* wrap = rows ? rows->wrapping() : nullptr;
+
+    return wrap && wrap->lineCount() == textBuffer->lineCount() ? wrap : nullptr;
+}
+
+void TextCursor::moveToRow(const size_t row)
+{
+    // Keeps the caret's distance from the start of its row when that row is wrapped; otherwise its column.
+    size_t lineRow = 0;
+    const size_t line = lineAt(row, &lineRow);
+    if (const WrapCache* wrap = wrapping())
+    {
+        const auto& lines = textBuffer->getLines();
+        cursorPos.col = wrap->columnAt(lines[line], line, lineRow,
+                                       wrap->offset(lines[cursorPos.line], cursorPos.line, cursorPos.col));
+    }
+    else cursorPos.col = std::min(cursorPos.col, textBuffer->lineLength(line));
+
+    cursorPos.line = line;
+}
+
+const RowMap* TextCursor::rowsInUse() const
+{
+    return rowMap && rowMap->lineCount() == textBuffer->lineCount() ? rowMap : nullptr;
+}
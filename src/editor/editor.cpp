@@ -1,4 +1,5 @@
 #include "./text.h"
+#include "../debug/memory.h"
 
 TextEditor::TextEditor() : textCursor(textBuffer)
 {
@@ -6,6 +7,7 @@ TextEditor::TextEditor() : textCursor(textBuffer)
 
 void TextEditor::setText(const std::string& text)
 {
+    MEMORY_SCOPE(EditorText);
     textBuffer.setText(text);
     textCursor.setCursor({0, 0});
 }
@@ -17,16 +19,21 @@ const TextCursor& TextEditor::cursor() const { return textCursor; }
 
 void TextEditor::insertText(const std::string& text)
 {
+    MEMORY_SCOPE(EditorText);
     deleteAnySelection();
 
     auto& lines = textBuffer.getLines();
     TextPos c = textCursor.cursor();
+    bool touched = false;
 
     for (const char ch : text)
     {
         if (ch == '\r') continue;
         if (ch == '\n')
         {
+            if (touched) textBuffer.noteEdit(c.line, 1, 1);
+            touched = false;
+
             newLine();
             c = textCursor.cursor();
 
@@ -37,13 +44,16 @@ void TextEditor::insertText(const std::string& text)
 
         line.insert(c.col, 1, ch);
         c.col++;
+        touched = true;
     }
 
+    if (touched) textBuffer.noteEdit(c.line, 1, 1);
     textCursor.setCursor(c, true);
 }
 
 void TextEditor::backspace()
 {
+    MEMORY_SCOPE(EditorText);
     if (textCursor.hasSelection())
     {
         deleteAnySelection();
@@ -57,6 +67,7 @@ void TextEditor::backspace()
         auto& line = lines[c.line];
 
         line.erase(c.col - 1, 1);
+        textBuffer.noteEdit(c.line, 1, 1);
         c.col--;
         textCursor.setCursor(c, true);
     }
@@ -66,6 +77,7 @@ void TextEditor::backspace()
 
         lines[c.line - 1] += lines[c.line];
         lines.erase(lines.begin() + static_cast<ptrdiff_t>(c.line));
+        textBuffer.noteEdit(c.line - 1, 2, 1);
         c.line--;
         c.col = prevLine.size();
         textCursor.setCursor(c, true);
@@ -74,6 +86,7 @@ void TextEditor::backspace()
 
 void TextEditor::newLine()
 {
+    MEMORY_SCOPE(EditorText);
     deleteAnySelection();
 
     auto& lines = textBuffer.getLines();
@@ -83,6 +96,7 @@ void TextEditor::newLine()
 
     line.erase(c.col);
     lines.insert(lines.begin() + static_cast<ptrdiff_t>(c.line) + 1, nextLine);
+    textBuffer.noteEdit(c.line, 1, 2);
     c.line++;
     c.col = 0;
     textCursor.setCursor(c, true);
@@ -127,6 +141,7 @@ std::string TextEditor::getTextInRange(const Range& range) const
 
 void TextEditor::deleteRange(const Range& range)
 {
+    MEMORY_SCOPE(EditorText);
     if (textBuffer.getLines().empty()) return;
 
     const TextPos a = minPos(range.start, range.end), b = maxPos(range.start, range.end);
@@ -153,11 +168,13 @@ void TextEditor::deleteRange(const Range& range)
     }
 
     if (lines.empty()) lines = {""};
+    textBuffer.noteEdit(a.line, b.line - a.line + 1, 1);
     textCursor.setCursor(a, true);
 }
 
 void TextEditor::insertTextAt(TextPos pos, const std::string& text)
 {
+    MEMORY_SCOPE(EditorText);
     auto& lines = textBuffer.getLines();
     if (lines.empty()) lines = {""};
 
@@ -188,17 +205,28 @@ void TextEditor::insertTextAt(TextPos pos, const std::string& text)
         cur.col++;
     }
 
+    textBuffer.noteEdit(pos.line, 1, cur.line - pos.line + 1);
     textCursor.setCursor(cur, true);
 }
 
+void TextEditor::replaceLine(const size_t line, std::string text)
+{
+    MEMORY_SCOPE(EditorText);
+    auto& lines = textBuffer.getLines();
+    if (line >= lines.size()) return;
+
+    lines[line] = std::move(text);
+    textBuffer.noteEdit(line, 1, 1);
+}
+
 void TextEditor::deleteAnySelection()
 {
     if (!textCursor.hasSelection()) return;
 
     auto& lines = textBuffer.getLines();
-    const TextPos start = textCursor.selectionStartPos();
+    const TextPos start = textCursor.selectionStartPos(), end = textCursor.selectionEndPos();
 
-    if (const TextPos end = textCursor.selectionEndPos(); start.line == end.line)
+    if (start.line == end.line)
     {
         auto& line = lines[start.line];
         line.erase(start.col, end.col - start.col);
@@ -215,5 +243,6 @@ void TextEditor::deleteAnySelection()
                     lines.begin() + static_cast<ptrdiff_t>(end.line) + 1);
     }
 
+    textBuffer.noteEdit(start.line, end.line - start.line + 1, 1);
     textCursor.setCursor(start, true);
 }
@@ -0,0 +1,216 @@
+#include "./find_in_files.h"
+#include "./trigram_index.h"
+#include "../debug/memory.h"
+
+#include <mutex>
+#include <cstring>
+
+static std::string makePreview(const char* line, const size_t size)
+{
+    size_t start = 0;
+    while (start < size && (line[start] == ' ' || line[start] == '\t')) ++start;
+
+    std::string out;
+    for (size_t i = start; i < size && out.size() < FindInFiles::PREVIEW_CHARS; ++i)
+        if (line[i] != '\r') out.push_back(line[i] == '\t' ? ' ' : line[i]);
+
+    return out;
+}
+
+FindInFiles::~FindInFiles() { cancel(); }
+
+bool FindInFiles::start(const std::string& root, const std::string& pattern, const Pattern::Syntax syntax,
+                        std::string* outError)
+{
+    cancel();
+    if (pattern.empty()) return false;
+    if (syntax != Pattern::Syntax::Literal && !compiled.compile(pattern, syntax, outError)) return false;
+
+    this->root = root;
+    this->syntax = syntax;
+    source = pattern;
+    search = SubstringSearch(syntax == Pattern::Syntax::Literal ? pattern : std::string());
+    pending.clear();
+    stop = cancelled = truncated = split = false;
+    files = matches = 0;
+    running = true;
+
+    // The scope only covers the worker's own allocations; the UI thread keeps charging its own categories.
+    if (!worker.start([this]
+    {
+        MEMORY_SCOPE(FileCache);
+        if (!scanIndexed()) scanDir(this->root);
+        running = false;
+    }, Thread::Priority::Background))
+    {
+        running = false;
+        return false;
+    }
+
+    return true;
+}
+
+void FindInFiles::cancel()
+{
+    if (running) cancelled = true;
+    stop = true;
+    worker.join();
+    running = false;
+}
+
+void FindInFiles::setIndex(TrigramIndex* index)
+{
+    cancel();
+    this->index = index;
+}
+
+bool FindInFiles::poll(std::vector<Match>& out)
+{
+    std::lock_guard lock(mutex);
+    if (pending.empty()) return false;
+
+    out.insert(out.end(), std::make_move_iterator(pending.begin()), std::make_move_iterator(pending.end()));
+    pending.clear();
+
+    return true;
+}
+
+FindInFiles::Progress FindInFiles::progress() const
+{
+    return {.files = files, .matches = matches, .running = running, .cancelled = cancelled, .truncated = truncated,
+            .split = split};
+}
+
+const std::string& FindInFiles::pattern() const { return source; }
+
+bool FindInFiles::scanIndexed()
+{
+    std::vector<std::string> paths;
+    if (!index || syntax != Pattern::Syntax::Literal) return false;
+    if (!index->prepare(stop) || !index->candidates(source, paths, stop)) return stop;
+
+    uint64_t size = 0;
+    for (const auto& path : paths)
+    {
+        if (stop) break;
+        if (FileSystem::fileSize(path, size) && size > 0) scanFile(path, size);
+    }
+
+    return true;
+}
+
+void FindInFiles::scanDir(const std::string& dir)
+{
+    std::vector<FileSystem::DirEntry> entries;
+    if (!FileSystem::listDir(dir, entries, true)) return;
+
+    for (const auto& e : entries)
+    {
+        if (stop) return;
+
+        if (e.isDir) scanDir(e.path);
+        else if (e.size > 0) scanFile(e.path, e.size);
+    }
+}
+
+void FindInFiles::scanFile(const std::string& path, const uint64_t size)
+{
+    files++;
+
+    FileSystem::Reader in;
+    if (!in.open(path)) return;
+
+    std::string buf;
+    Cursor at;
+    for (uint64_t offset = 0; offset < size && !stop;)
+    {
+        const auto n = static_cast<size_t>(std::min<uint64_t>(CHUNK_BYTES, size - offset));
+        const size_t kept = buf.size();
+        buf.resize(kept + n);
+        if (in.read(buf.data() + kept, n) != n) return;
+        if (offset == 0 && std::memchr(buf.data(), 0, n)) return;
+        offset += n;
+
+        // Only whole lines are searched; the partial last line carries over into the next chunk unless it has grown
+        // too long, in which case a literal search keeps just enough of its tail to find a match across the cut.
+        size_t end = buf.size(), keep = 0;
+        if (const size_t nl = buf.rfind('\n'); offset < size && nl != std::string::npos) end = nl + 1;
+        else if (offset < size && buf.size() <= MAX_LINE_BYTES) continue;
+        else if (offset < size)
+        {
+            if (syntax == Pattern::Syntax::Literal) keep = std::min(source.size() - 1, buf.size());
+            else split = true;
+        }
+
+        if (syntax == Pattern::Syntax::Literal) scanLines(path, buf.data(), end, at);
+        else matchLines(path, buf.data(), end, at);
+        if (end == buf.size() && offset < size) at.column += end - keep;
+        buf.erase(0, end - keep);
+    }
+}
+
+void FindInFiles::scanLines(const std::string& path, const char* text, const size_t size, Cursor& at)
+{
+    size_t lineStart = 0, pos = 0;
+    while (!stop && (pos = search.find(text, size, pos)) != SubstringSearch::NPOS)
+    {
+        while (const void* nl = std::memchr(text + lineStart, '\n', pos - lineStart))
+        {
+            lineStart = static_cast<size_t>(static_cast<const char*>(nl) - text) + 1;
+            at.nextLine();
+        }
+
+        const void* nl = std::memchr(text + pos, '\n', size - pos);
+        const size_t lineEnd = nl ? static_cast<size_t>(static_cast<const char*>(nl) - text) : size;
+        if (!at.reported)
+            emit({.path = path, .preview = makePreview(text + lineStart, lineEnd - lineStart), .line = at.line,
+                  .col = at.column + pos - lineStart, .length = source.size()});
+        at.reported = true;
+        pos = lineEnd;
+    }
+
+    for (const char* p = text + lineStart; (p = static_cast<const char*>(std::memchr(p, '\n', text + size - p)));)
+    {
+        ++p;
+        at.nextLine();
+    }
+}
+
+void FindInFiles::matchLines(const std::string& path, const char* text, const size_t size, Cursor& at)
+{
+    for (size_t lineStart = 0; lineStart < size && !stop;)
+    {
+        const void* nl = std::memchr(text + lineStart, '\n', size - lineStart);
+        const size_t next = nl ? static_cast<size_t>(static_cast<const char*>(nl) - text) + 1 : size;
+        size_t lineEnd = nl ? next - 1 : size;
+        if (lineEnd > lineStart && text[lineEnd - 1] == '\r') lineEnd--;
+
+        // Empty matches are skipped, as in the editor's search.
+        Pattern::Match m;
+        for (size_t from = 0; !at.reported && compiled.find(text + lineStart, lineEnd - lineStart, from, m);
+             from = m.start + 1)
+            if (m.end > m.start)
+            {
+                emit({.path = path, .preview = makePreview(text + lineStart, lineEnd - lineStart), .line = at.line,
+                      .col = at.column + m.start, .length = m.end - m.start});
+                at.reported = true;
+            }
+
+        lineStart = next;
+        if (nl) at.nextLine();
+    }
+}
+
+void FindInFiles::emit(Match m)
+{
+    if (matches >= MAX_MATCHES)
+    {
+        truncated = true;
+        stop = true;
+        return;
+    }
+
+    std::lock_guard lock(mutex);
+    pending.push_back(std::move(m));
+    matches++;
+}
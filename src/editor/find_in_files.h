@@ -0,0 +1,87 @@
+#pragma once
+
+#include "./search.h"
+#include "./pattern.h"
+#include "../platform/platform.h"
+
+#include <atomic>
+
+class TrigramIndex;
+
+// Walks a directory tree on a background worker and streams line matches back to the UI thread. Files are read in
+// fixed-size chunks so memory stays bounded whatever their size; a NUL in the first chunk marks a file as binary. With
+// an index attached only its candidate files are read, falling back to the full walk if the index is unusable.
+// Lines longer than MAX_LINE_BYTES are searched in pieces: literal pieces overlap by the pattern's length, while a
+// Lua or regex match across a cut is missed and progress reports that lines were split.
+class FindInFiles
+{
+public:
+    static constexpr size_t CHUNK_BYTES = 32 * 1024, MAX_LINE_BYTES = 4 * 1024, MAX_MATCHES = 5000,
+                            PREVIEW_CHARS = 96;
+
+    struct Match
+    {
+        std::string path, preview;
+        size_t line = 0, col = 0, length = 0;
+    };
+
+    struct Progress
+    {
+        size_t files = 0, matches = 0;
+        bool running = false, cancelled = false, truncated = false, split = false;
+    };
+
+    FindInFiles() = default;
+    ~FindInFiles();
+
+    FindInFiles(const FindInFiles&) = delete;
+    FindInFiles& operator=(const FindInFiles&) = delete;
+
+    // Cancels any scan in progress and starts a new one; one match is reported per matching line. Lua and regex
+    // patterns match line by line and do not use the index.
+    bool start(const std::string& root, const std::string& pattern,
+               Pattern::Syntax syntax = Pattern::Syntax::Literal, std::string* outError = nullptr);
+    void cancel();
+
+    // The index must cover the roots later passed to start(); it is only used from the worker.
+    void setIndex(TrigramIndex* index);
+
+    // Moves the matches found since the last call to the end of out.
+    bool poll(std::vector<Match>& out);
+
+    [[nodiscard]] Progress progress() const;
+    [[nodiscard]] const std::string& pattern() const;
+
+private:
+    // Where the next piece of a file starts: a split line carries its column and whether it already matched.
+    struct Cursor
+    {
+        size_t line = 0, column = 0;
+        bool reported = false;
+
+        void nextLine()
+        {
+            line++;
+            column = 0;
+            reported = false;
+        }
+    };
+
+    Thread::Worker worker;
+    Thread::Mutex mutex;
+    std::vector<Match> pending;
+    SubstringSearch search;
+    Pattern compiled;
+    Pattern::Syntax syntax = Pattern::Syntax::Literal;
+    std::string root, source;
+    TrigramIndex* index = nullptr;
+    std::atomic<bool> stop = false, running = false, cancelled = false, truncated = false, split = false;
+    std::atomic<size_t> files = 0, matches = 0;
+
+    bool scanIndexed();
+    void scanDir(const std::string& dir);
+    void scanFile(const std::string& path, uint64_t size);
+    void scanLines(const std::string& path, const char* text, size_t size, Cursor& at);
+    void matchLines(const std::string& path, const char* text, size_t size, Cursor& at);
+    void emit(Match m);
+};
@@ -0,0 +1,212 @@
+#include "./identifier_index.h"
+#include "../debug/memory.h"
+
+#include <algorithm>
+
+// One- and two-letter words are quicker to type than to pick.
+static constexpr size_t MIN_LENGTH = 3;
+
+void IdentifierIndex::addNames(const std::vector<std::string>& names)
+{
+    MEMORY_SCOPE(EditorText);
+    for (const std::string& name : names)
+    {
+        if (name.size() < MIN_LENGTH || std::find(known.begin(), known.end(), name) != known.end()) continue;
+
+        known.push_back(name);
+        use(insert(name), 1);
+    }
+}
+
+bool IdentifierIndex::sync(const TextBuffer& buffer, const BlockIndex& blocks)
+{
+    if (built && buffer.version() == version) return false;
+    MEMORY_SCOPE(EditorText);
+
+    const auto& text = buffer.getLines();
+    edits.clear();
+    if (!built || !buffer.editsSince(version, edits))
+    {
+        restart(buffer);
+        return true;
+    }
+
+    // Lines the edits removed give their words back; [first, last) ends up covering every line they produced.
+    size_t first = SIZE_MAX, last = 0;
+    for (const auto& e : edits)
+    {
+        const size_t at = std::min(e.line, lineWords.size()), removed = std::min(e.removed, lineWords.size() - at);
+        for (size_t i = at; i < at + removed; ++i) release(lineWords[i]);
+        lineWords.erase(lineWords.begin() + static_cast<ptrdiff_t>(at),
+                        lineWords.begin() + static_cast<ptrdiff_t>(at + removed));
+        lineWords.insert(lineWords.begin() + static_cast<ptrdiff_t>(at), e.inserted, {});
+
+        if (first < last)
+        {
+            if (last > at) last = last >= at + removed ? last + e.inserted - removed : at + e.inserted;
+            if (first >= at + removed) first = first + e.inserted - removed;
+        }
+        first = std::min(first, at);
+        last = std::max(last, at + e.inserted);
+    }
+    if (lineWords.size() != text.size())
+    {
+        restart(buffer);
+        return true;
+    }
+
+    // An edit that opened or closed a long string or comment changed the tokens of lines past it too.
+    size_t relexFirst = 0, relexLast = 0;
+    blocks.relexed(relexFirst, relexLast);
+    if (relexFirst < relexLast)
+    {
+        first = std::min(first, relexFirst);
+        last = std::max(last, relexLast);
+    }
+
+    last = std::min(last, text.size());
+    LuaLexer::State state = first < last ? blocks.entry(first) : 0;
+    for (size_t i = first; i < last; ++i)
+    {
+        release(lineWords[i]);
+        state = collect(text[i], state, lineWords[i]);
+    }
+
+    version = buffer.version();
+    return true;
+}
+
+void IdentifierIndex::clear()
+{
+    nodes.assign(1, {});
+    lineWords.clear();
+    known.clear();
+    built = false;
+}
+
+void IdentifierIndex::complete(const std::string_view prefix, const size_t count, std::vector<std::string>& out) const
+{
+    out.clear();
+    const uint32_t at = prefix.empty() ? NIL : find(prefix);
+    if (at == NIL || count == 0) return;
+
+    // Keeps the `count` most used words seen so far, ties going to the older word.
+    const auto better = [](const Candidate& a, const Candidate& b)
+    {
+        return a.uses != b.uses ? a.uses > b.uses : a.node < b.node;
+    };
+
+    best.clear();
+    stack.assign(1, at);
+    while (!stack.empty())
+    {
+        const uint32_t n = stack.back();
+        stack.pop_back();
+
+        if (const Candidate c = {n, nodes[n].uses}; c.uses > 0 && n != at &&
+            (best.size() < count || better(c, best.back())))
+        {
+            best.insert(std::upper_bound(best.begin(), best.end(), c, better), c);
+            if (best.size() > count) best.pop_back();
+        }
+        for (uint32_t child = nodes[n].child; child != NIL; child = nodes[child].sibling)
+            if (nodes[child].live > 0) stack.push_back(child);
+    }
+
+    for (const Candidate& c : best) out.push_back(spell(c.node));
+}
+
+size_t IdentifierIndex::size() const { return nodes[0].live; }
+
+void IdentifierIndex::restart(const TextBuffer& buffer)
+{
+    const auto& text = buffer.getLines();
+
+    nodes.assign(1, {});
+    for (const std::string& name : known) use(insert(name), 1);
+
+    lineWords.assign(text.size(), {});
+    LuaLexer::State state = 0;
+    for (size_t i = 0; i < text.size(); ++i) state = collect(text[i], state, lineWords[i]);
+
+    version = buffer.version();
+    built = true;
+}
+
+LuaLexer::State IdentifierIndex::collect(const std::string& line, const LuaLexer::State entry,
+                                         std::vector<uint32_t>& words)
+{
+    const LuaLexer::State state = LuaLexer::lexLine(line, entry, tokens);
+
+    words.clear();
+    for (const auto& t : tokens)
+    {
+        if ((t.kind != LuaLexer::Kind::Name && t.kind != LuaLexer::Kind::Keyword) || t.length < MIN_LENGTH) continue;
+
+        const uint32_t node = insert(std::string_view(line).substr(t.col, t.length));
+        use(node, 1);
+        words.push_back(node);
+    }
+
+    return state;
+}
+
+void IdentifierIndex::release(const std::vector<uint32_t>& words)
+{
+    for (const uint32_t node : words) use(node, -1);
+}
+
+uint32_t IdentifierIndex::insert(const std::string_view word)
+{
+    uint32_t n = 0;
+    for (const char c : word)
+    {
+        // Siblings stay sorted by character.
+        uint32_t* link = &nodes[n].child;
+        while (*link != NIL && nodes[*link].c < c) link = &nodes[*link].sibling;
+        if (*link == NIL || nodes[*link].c != c)
+        {
+            const auto added = static_cast<uint32_t>(nodes.size());
+            Node node;
+            node.parent = n;
+            node.sibling = *link;
+            node.c = c;
+            *link = added;
+            nodes.push_back(node);
+            n = added;
+        }
+        else n = *link;
+    }
+
+    return n;
+}
+
+uint32_t IdentifierIndex::find(const std::string_view word) const
+{
+    uint32_t n = 0;
+    for (const char c : word)
+    {
+        n = nodes[n].child;
+        while (n != NIL && nodes[n].c < c) n = nodes[n].sibling;
+        if (n == NIL || nodes[n].c != c) return NIL;
+    }
+
+    return n;
+}
+
+void IdentifierIndex::use(const uint32_t node, const int delta)
+{
+    const bool was = nodes[node].uses > 0;
+    nodes[node].uses = static_cast<uint32_t>(static_cast<int64_t>(nodes[node].uses) + delta);
+    if (const bool is = nodes[node].uses > 0; is != was)
+        for (uint32_t n = node; n != NIL; n = nodes[n].parent) is ? ++nodes[n].live : --nodes[n].live;
+}
+
+std::string IdentifierIndex::spell(uint32_t node) const
+{
+    std::string word;
+    for (; node != 0; node = nodes[node].parent) word.push_back(nodes[node].c);
+    std::reverse(word.begin(), word.end());
+
+    return word;
+}
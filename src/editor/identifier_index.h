@@ -0,0 +1,61 @@
+#pragma once
+
+#include "./text.h"
+#include "./block_index.h"
+
+#include <string_view>
+
+// Words worth completing in a Lua buffer: its identifiers and keywords, counted per occurrence, plus names known up
+// front such as the runtime's globals. They live in a trie whose nodes count the words below them still in use, so
+// completing a prefix only walks the live part of its subtree. Buffer edits re-collect just the lines they produced
+// and those the block index re-lexed.
+class IdentifierIndex
+{
+public:
+    // Names that count as used once each even when the buffer never mentions them.
+    void addNames(const std::vector<std::string>& names);
+
+    // Catches up with the buffer; `blocks` must already be synced with it. Returns whether any count changed.
+    bool sync(const TextBuffer& buffer, const BlockIndex& blocks);
+    void clear();
+
+    // Up to `count` words starting with `prefix` and longer than it, most used first.
+    void complete(std::string_view prefix, size_t count, std::vector<std::string>& out) const;
+
+    // Distinct words currently in use.
+    [[nodiscard]] size_t size() const;
+
+private:
+    static constexpr uint32_t NIL = UINT32_MAX;
+
+    struct Node
+    {
+        uint32_t parent = NIL, child = NIL, sibling = NIL;
+        uint32_t uses = 0, live = 0;
+        char c = 0;
+    };
+
+    struct Candidate
+    {
+        uint32_t node = NIL, uses = 0;
+    };
+
+    std::vector<Node> nodes = {Node{}};
+    std::vector<std::vector<uint32_t>> lineWords;
+    std::vector<std::string> known;
+    std::vector<TextBuffer::LineEdit> edits;
+    std::vector<LuaLexer::Token> tokens;
+    mutable std::vector<uint32_t> stack;
+    mutable std::vector<Candidate> best;
+    uint64_t version = 0;
+    bool built = false;
+
+    void restart(const TextBuffer& buffer);
+    LuaLexer::State collect(const std::string& line, LuaLexer::State entry, std::vector<uint32_t>& words);
+    void release(const std::vector<uint32_t>& words);
+
+    uint32_t insert(std::string_view word);
+    [[nodiscard]] uint32_t find(std::string_view word) const;
+    void use(uint32_t node, int delta);
+    [[nodiscard]] std::string spell(uint32_t node) const;
+};
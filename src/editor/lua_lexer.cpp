@@ -0,0 +1,159 @@
+#include "./lua_lexer.h"
+
+#include <cstring>
+
+// The low byte holds the open long bracket's level plus one; COMMENT marks it as a comment rather than a string.
+static constexpr LuaLexer::State LEVEL_MASK = 0xFF, COMMENT = 0x100;
+static constexpr size_t MAX_LEVEL = LEVEL_MASK - 1;
+
+static constexpr const char* KEYWORDS[] = {
+    "and", "break", "do", "else", "elseif", "end", "false", "for", "function", "goto", "if", "in",
+    "local", "nil", "not", "or", "repeat", "return", "then", "true", "until", "while"
+};
+
+static bool isNameStart(const char c) { return (c >= 'a' && c <= 'z') || (c >= 'A' && c <= 'Z') || c == '_'; }
+static bool isDigit(const char c) { return c >= '0' && c <= '9'; }
+static bool isNameChar(const char c) { return isNameStart(c) || isDigit(c); }
+
+// Level of the long bracket opening at `pos` ("[", "="*, "["), or -1 when there is none.
+static int openLevel(const std::string& s, const size_t pos)
+{
+    if (pos >= s.size() || s[pos] != '[') return -1;
+
+    size_t i = pos + 1;
+    while (i < s.size() && s[i] == '=') ++i;
+    if (i >= s.size() || s[i] != '[' || i - pos - 1 > MAX_LEVEL) return -1;
+
+    return static_cast<int>(i - pos - 1);
+}
+
+// End of the long bracket closing at `level` from `pos`, or npos when the line does not close it.
+static size_t closeLong(const std::string& s, size_t pos, const size_t level)
+{
+    while ((pos = s.find(']', pos)) != std::string::npos)
+    {
+        size_t i = pos + 1;
+        while (i < s.size() && s[i] == '=') ++i;
+        if (i < s.size() && s[i] == ']' && i - pos - 1 == level) return i + 1;
+        pos = i;
+    }
+
+    return std::string::npos;
+}
+
+LuaLexer::State LuaLexer::lexLine(const std::string& line, State state, std::vector<Token>& out)
+{
+    out.clear();
+    const size_t n = line.size();
+    size_t pos = 0;
+
+    const auto push = [&](const size_t start, const size_t end, const Kind kind)
+    {
+        out.push_back({static_cast<uint32_t>(start), static_cast<uint32_t>(end - start), kind});
+    };
+
+    // Continues, or opens, a long string or comment; returns false when it runs past the end of the line.
+    const auto longBracket = [&](const size_t start, const size_t from, const size_t level, const bool comment)
+    {
+        const size_t end = closeLong(line, from, level);
+        push(start, end == std::string::npos ? n : end, comment ? Kind::Comment : Kind::String);
+        if (end == std::string::npos)
+        {
+            state = static_cast<State>((level + 1) | (comment ? COMMENT : 0));
+            return false;
+        }
+
+        pos = end;
+        return true;
+    };
+
+    if (state != 0)
+    {
+        const size_t level = (state & LEVEL_MASK) - 1;
+        const bool comment = (state & COMMENT) != 0;
+        state = 0;
+        if (!longBracket(0, 0, level, comment)) return state;
+    }
+
+    while (pos < n)
+    {
+        const char c = line[pos];
+        const size_t start = pos;
+
+        if (c == ' ' || c == '\t' || c == '\r')
+        {
+            ++pos;
+            continue;
+        }
+
+        if (c == '-' && pos + 1 < n && line[pos + 1] == '-')
+        {
+            if (const int level = openLevel(line, pos + 2); level >= 0)
+            {
+                if (!longBracket(start, pos + 2 + static_cast<size_t>(level) + 2, static_cast<size_t>(level), true))
+                    return state;
+                continue;
+            }
+
+            push(start, n, Kind::Comment);
+            return 0;
+        }
+
+        if (c == '[')
+        {
+            if (const int level = openLevel(line, pos); level >= 0)
+            {
+                if (!longBracket(start, pos + static_cast<size_t>(level) + 2, static_cast<size_t>(level), false))
+                    return state;
+                continue;
+            }
+        }
+
+        if (c == '"' || c == '\'')
+        {
+            // An unterminated short string ends with its line.
+            for (++pos; pos < n && line[pos] != c; ++pos)
+                if (line[pos] == '\\') ++pos;
+            pos = pos < n ? pos + 1 : n;
+            push(start, pos, Kind::String);
+            continue;
+        }
+
+        if (isDigit(c) || (c == '.' && pos + 1 < n && isDigit(line[pos + 1])))
+        {
+            const bool hex = c == '0' && pos + 1 < n && (line[pos + 1] == 'x' || line[pos + 1] == 'X');
+            for (pos += hex ? 2 : 1; pos < n; ++pos)
+            {
+                const char d = line[pos];
+                const bool exponent = hex ? d == 'p' || d == 'P' : d == 'e' || d == 'E';
+                if (exponent && pos + 1 < n && (line[pos + 1] == '+' || line[pos + 1] == '-')) ++pos;
+                else if (!isNameChar(d) && d != '.') break;
+            }
+            push(start, pos, Kind::Number);
+            continue;
+        }
+
+        if (isNameStart(c))
+        {
+            while (pos < n && isNameChar(line[pos])) ++pos;
+            push(start, pos, isKeyword(line.data() + start, pos - start) ? Kind::Keyword : Kind::Name);
+            continue;
+        }
+
+        push(start, ++pos, Kind::Punct);
+    }
+
+    return state;
+}
+
+bool LuaLexer::isKeyword(const char* text, const size_t length)
+{
+    if (length < 2 || length > 8) return false;
+
+    for (const char* k : KEYWORDS)
+        if (std::strlen(k) == length && std::memcmp(k, text, length) == 0) return true;
+
+    return false;
+}
+
+std::vector<std::string> LuaLexer::keywords() { return {std::begin(KEYWORDS), std::end(KEYWORDS)}; }
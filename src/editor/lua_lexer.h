@@ -0,0 +1,36 @@
+#pragma once
+
+#include <string>
+#include <vector>
+#include <cstdint>
+
+// Line-at-a-time Lua tokenizer. Long strings and comments ([[ ]], --[==[ ]==]) may span lines, so each line starts in
+// the state the previous one ended in; re-lexing an edited line only has to continue past it while that end state
+// differs from what the next line was lexed with.
+namespace LuaLexer
+{
+    enum class Kind : uint8_t
+    {
+        Name,
+        Keyword,
+        Number,
+        String,
+        Comment,
+        Punct
+    };
+
+    struct Token
+    {
+        uint32_t col = 0, length = 0;
+        Kind kind = Kind::Punct;
+    };
+
+    // Zero is the state at the top of a file.
+    using State = uint16_t;
+
+    // Replaces `out` with the tokens of `line`, lexed from `state`, and returns the state the next line starts in.
+    State lexLine(const std::string& line, State state, std::vector<Token>& out);
+
+    [[nodiscard]] bool isKeyword(const char* text, size_t length);
+    [[nodiscard]] std::vector<std::string> keywords();
+}
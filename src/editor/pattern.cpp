@@ -0,0 +1,667 @@
+#include "./pattern.h"
+
+#include <cctype>
+#include <cstring>
+#include <algorithm>
+
+namespace
+{
+    using CharSet = std::array<uint32_t, 8>;
+
+    void add(CharSet& set, const int c) { set[static_cast<uint8_t>(c) >> 5] |= 1u << (static_cast<uint8_t>(c) & 31); }
+
+    bool contains(const CharSet& set, const int c)
+    {
+        return set[static_cast<uint8_t>(c) >> 5] >> (static_cast<uint8_t>(c) & 31) & 1;
+    }
+
+    void addRange(CharSet& set, const int lo, const int hi)
+    {
+        for (int c = static_cast<uint8_t>(lo); c <= static_cast<uint8_t>(hi); ++c) add(set, c);
+    }
+
+    void addAll(CharSet& set) { set.fill(~0u); }
+
+    void complement(CharSet& set)
+    {
+        for (uint32_t& word : set) word = ~word;
+    }
+
+    template <typename F>
+    void addWhere(CharSet& set, F&& test, const bool negate)
+    {
+        for (int c = 0; c < 256; ++c)
+            if ((test(c) != 0) != negate) add(set, c);
+    }
+
+    // %a, %d, ... as lstrlib.c's match_class; any other character stands for itself.
+    void addLuaClass(CharSet& set, const int cl)
+    {
+        const bool negate = std::isupper(cl) != 0;
+        switch (std::tolower(cl))
+        {
+        case 'a': return addWhere(set, isalpha, negate);
+        case 'c': return addWhere(set, iscntrl, negate);
+        case 'd': return addWhere(set, isdigit, negate);
+        case 'g': return addWhere(set, isgraph, negate);
+        case 'l': return addWhere(set, islower, negate);
+        case 'p': return addWhere(set, ispunct, negate);
+        case 's': return addWhere(set, isspace, negate);
+        case 'u': return addWhere(set, isupper, negate);
+        case 'w': return addWhere(set, isalnum, negate);
+        case 'x': return addWhere(set, isxdigit, negate);
+        default: return add(set, cl);
+        }
+    }
+
+    int escapedChar(const int c) { return c == 'n' ? '\n' : c == 't' ? '\t' : c == 'r' ? '\r' : c; }
+
+    // \d, \w, \s and their complements; anything else is a single character.
+    bool addRegexClass(CharSet& set, const int c)
+    {
+        switch (c)
+        {
+        case 'd': case 'D': addWhere(set, isdigit, c == 'D');
+            return true;
+        case 's': case 'S': addWhere(set, isspace, c == 'S');
+            return true;
+        case 'w': case 'W': addWhere(set, [](const int ch) { return std::isalnum(ch) || ch == '_'; }, c == 'W');
+            return true;
+        default: return false;
+        }
+    }
+}
+
+// Parses either syntax into a small tree, then emits Thompson-style code for the Pike VM.
+class PatternCompiler
+{
+public:
+    PatternCompiler(Pattern& out, const std::string& src) : out(out), src(src) {}
+
+    bool run(const Pattern::Syntax syntax, std::string* outError)
+    {
+        int root = -1;
+        if (syntax == Pattern::Syntax::Literal)
+            for (const char c : src)
+            {
+                CharSet set = {};
+                add(set, c);
+                root = cat(root, classNode(set));
+            }
+        else root = syntax == Pattern::Syntax::Lua ? lua() : regex();
+
+        if (!error.empty())
+        {
+            if (outError) *outError = error;
+            return false;
+        }
+
+        emit(root);
+        out.program.push_back({.op = Pattern::Op::Match});
+        out.anchored = out.program[0].op == Pattern::Op::LineStart;
+
+        return true;
+    }
+
+private:
+    enum class Kind : uint8_t { Empty, Class, Cat, Alt, Star, Plus, Quest, LineStart, LineEnd, Frontier, WordBoundary };
+
+    struct Node
+    {
+        Kind kind = Kind::Empty;
+        bool lazy = false;
+        uint16_t cls = 0;
+        int a = -1, b = -1;
+    };
+
+    Pattern& out;
+    const std::string& src;
+    std::vector<Node> nodes;
+    size_t pos = 0;
+    std::string error;
+
+    int node(const Node& n)
+    {
+        nodes.push_back(n);
+        return static_cast<int>(nodes.size() - 1);
+    }
+
+    int cat(const int a, const int b)
+    {
+        if (a < 0) return b;
+        if (b < 0) return a;
+        return node({.kind = Kind::Cat, .a = a, .b = b});
+    }
+
+    int classNode(const CharSet& set, const Kind kind = Kind::Class)
+    {
+        auto it = std::find(out.classes.begin(), out.classes.end(), set);
+        if (it == out.classes.end()) it = out.classes.insert(it, set);
+
+        return node({.kind = kind, .cls = static_cast<uint16_t>(it - out.classes.begin())});
+    }
+
+    int fail(std::string message)
+    {
+        if (error.empty()) error = std::move(message);
+        return -1;
+    }
+
+    [[nodiscard]] bool more() const { return error.empty() && pos < src.size(); }
+
+    int lua()
+    {
+        int seq = -1, depth = 0;
+        if (!src.empty() && src[0] == '^')
+        {
+            seq = node({.kind = Kind::LineStart});
+            pos++;
+        }
+
+        while (more())
+        {
+            const char c = src[pos];
+            if (c == '(' || c == ')')
+            {
+                depth += c == '(' ? 1 : -1;
+                if (depth < 0) return fail("invalid pattern capture");
+                pos++;
+                continue;
+            }
+            if (c == '$' && pos + 1 == src.size())
+            {
+                seq = cat(seq, node({.kind = Kind::LineEnd}));
+                pos++;
+                continue;
+            }
+            if (c == '%' && pos + 1 < src.size())
+            {
+                const char d = src[pos + 1];
+                if (d == 'b') return fail("%b is not supported: balanced matches are not a regular pattern");
+                if (std::isdigit(static_cast<uint8_t>(d))) return fail("back-references are not supported");
+                if (d == 'f')
+                {
+                    pos += 2;
+                    if (pos >= src.size() || src[pos] != '[') return fail("missing '[' after '%f' in pattern");
+
+                    CharSet set = {};
+                    luaSet(set);
+                    seq = cat(seq, classNode(set, Kind::Frontier));
+                    continue;
+                }
+            }
+
+            CharSet set = {};
+            luaSingle(set);
+            int atom = classNode(set);
+
+            if (const char q = pos < src.size() ? src[pos] : '\0'; q == '*' || q == '-' || q == '+' || q == '?')
+            {
+                const Kind kind = q == '+' ? Kind::Plus : q == '?' ? Kind::Quest : Kind::Star;
+                atom = node({.kind = kind, .lazy = q == '-', .a = atom});
+                pos++;
+            }
+
+            seq = cat(seq, atom);
+        }
+
+        if (error.empty() && depth != 0) return fail("unfinished capture");
+        return seq;
+    }
+
+    void luaSingle(CharSet& set)
+    {
+        const char c = src[pos++];
+        if (c == '.') addAll(set);
+        else if (c == '[')
+        {
+            pos--;
+            luaSet(set);
+        }
+        else if (c != '%') add(set, c);
+        else if (pos >= src.size()) fail("malformed pattern (ends with '%')");
+        else addLuaClass(set, static_cast<uint8_t>(src[pos++]));
+    }
+
+    // As lstrlib.c: a ']' right after '[' or '[^' is literal, and 'a-z' is a range unless the '-' is last.
+    void luaSet(CharSet& set)
+    {
+        pos++;
+        const bool negate = pos < src.size() && src[pos] == '^';
+        if (negate) pos++;
+
+        for (bool first = true;; first = false)
+        {
+            if (pos >= src.size())
+            {
+                fail("malformed pattern (missing ']')");
+                return;
+            }
+
+            const char c = src[pos];
+            if (c == ']' && !first)
+            {
+                pos++;
+                break;
+            }
+            if (c == '%')
+            {
+                if (pos + 1 >= src.size())
+                {
+                    fail("malformed pattern (ends with '%')");
+                    return;
+                }
+                addLuaClass(set, static_cast<uint8_t>(src[pos + 1]));
+                pos += 2;
+            }
+            else if (pos + 2 < src.size() && src[pos + 1] == '-' && src[pos + 2] != ']')
+            {
+                addRange(set, c, src[pos + 2]);
+                pos += 3;
+            }
+            else
+            {
+                add(set, c);
+                pos++;
+            }
+        }
+
+        if (negate) complement(set);
+    }
+
+    int regex()
+    {
+        const int root = alternation();
+        if (error.empty() && pos < src.size()) return fail("unmatched ')'");
+
+        return root;
+    }
+
+    int alternation()
+    {
+        int left = sequence();
+        while (more() && src[pos] == '|')
+        {
+            pos++;
+            left = node({.kind = Kind::Alt, .a = left, .b = sequence()});
+        }
+
+        return left;
+    }
+
+    int sequence()
+    {
+        int seq = -1;
+        while (more() && src[pos] != '|' && src[pos] != ')') seq = cat(seq, repetition());
+
+        return seq < 0 ? node({.kind = Kind::Empty}) : seq;
+    }
+
+    int repetition()
+    {
+        int atom = this->atom();
+        while (more())
+        {
+            const char c = src[pos];
+            if (c == '{') return fail("counted repetition {m,n} is not supported");
+            if (c != '*' && c != '+' && c != '?') break;
+
+            pos++;
+            const bool lazy = pos < src.size() && src[pos] == '?';
+            if (lazy) pos++;
+
+            atom = node({.kind = c == '*' ? Kind::Star : c == '+' ? Kind::Plus : Kind::Quest, .lazy = lazy, .a = atom});
+        }
+
+        return atom;
+    }
+
+    int atom()
+    {
+        CharSet set = {};
+        switch (const char c = src[pos++])
+        {
+        case '(':
+            {
+                if (src.compare(pos, 2, "?:") == 0) pos += 2;
+                const int inner = alternation();
+                if (pos >= src.size() || src[pos] != ')') return fail("missing ')'");
+                pos++;
+
+                return inner;
+            }
+        case '*': case '+': case '?': return fail(std::string("nothing to repeat before '") + c + "'");
+        case '^': return node({.kind = Kind::LineStart});
+        case '$': return node({.kind = Kind::LineEnd});
+        case '.': addAll(set);
+            break;
+        case '[': regexSet(set);
+            break;
+        case '\\':
+            if (pos >= src.size()) return fail("trailing backslash");
+            if (src[pos] == 'b')
+            {
+                pos++;
+                return node({.kind = Kind::WordBoundary});
+            }
+            if (const int e = static_cast<uint8_t>(src[pos++]); !addRegexClass(set, e)) add(set, escapedChar(e));
+            break;
+        default: add(set, c);
+            break;
+        }
+
+        return classNode(set);
+    }
+
+    void regexSet(CharSet& set)
+    {
+        const bool negate = pos < src.size() && src[pos] == '^';
+        if (negate) pos++;
+
+        for (bool first = true;; first = false)
+        {
+            if (pos >= src.size())
+            {
+                fail("missing ']'");
+                return;
+            }
+
+            int lo = static_cast<uint8_t>(src[pos++]);
+            if (lo == ']' && !first) break;
+            if (lo == '\\' && pos < src.size())
+            {
+                const int e = static_cast<uint8_t>(src[pos++]);
+                if (addRegexClass(set, e)) continue;
+                lo = escapedChar(e);
+            }
+
+            if (pos + 1 < src.size() && src[pos] == '-' && src[pos + 1] != ']')
+            {
+                addRange(set, lo, src[pos + 1]);
+                pos += 2;
+            }
+            else add(set, lo);
+        }
+
+        if (negate) complement(set);
+    }
+
+    uint32_t here() const { return static_cast<uint32_t>(out.program.size()); }
+
+    uint32_t push(const Pattern::Op op, const uint16_t cls = 0)
+    {
+        out.program.push_back({.op = op, .cls = cls});
+        return here() - 1;
+    }
+
+    void branch(const uint32_t at, const uint32_t preferred, const uint32_t other, const bool lazy)
+    {
+        out.program[at].x = lazy ? other : preferred;
+        out.program[at].y = lazy ? preferred : other;
+    }
+
+    void emit(const int n)
+    {
+        if (n < 0) return;
+
+        const Node& e = nodes[n];
+        switch (e.kind)
+        {
+        case Kind::Empty: break;
+        case Kind::Class: push(Pattern::Op::Class, e.cls);
+            break;
+        case Kind::Frontier: push(Pattern::Op::Frontier, e.cls);
+            break;
+        case Kind::LineStart: push(Pattern::Op::LineStart);
+            break;
+        case Kind::LineEnd: push(Pattern::Op::LineEnd);
+            break;
+        case Kind::WordBoundary: push(Pattern::Op::WordBoundary);
+            break;
+        case Kind::Cat:
+            emit(e.a);
+            emit(e.b);
+            break;
+        case Kind::Alt:
+            {
+                const uint32_t split = push(Pattern::Op::Split);
+                emit(e.a);
+                const uint32_t jump = push(Pattern::Op::Jump);
+                branch(split, split + 1, here(), false);
+                emit(e.b);
+                out.program[jump].x = here();
+                break;
+            }
+        case Kind::Star:
+            {
+                const uint32_t split = push(Pattern::Op::Split);
+                emit(e.a);
+                out.program[push(Pattern::Op::Jump)].x = split;
+                branch(split, split + 1, here(), e.lazy);
+                break;
+            }
+        case Kind::Plus:
+            {
+                const uint32_t start = here();
+                emit(e.a);
+                const uint32_t split = push(Pattern::Op::Split);
+                branch(split, start, here(), e.lazy);
+                break;
+            }
+        case Kind::Quest:
+            {
+                const uint32_t split = push(Pattern::Op::Split);
+                emit(e.a);
+                branch(split, split + 1, here(), e.lazy);
+                break;
+            }
+        }
+    }
+};
+
+bool Pattern::compile(const std::string& source, const Syntax syntax, std::string* outError)
+{
+    program.clear();
+    classes.clear();
+    anchored = false;
+
+    if (source.size() > MAX_SOURCE)
+    {
+        if (outError) *outError = "Pattern is longer than " + std::to_string(MAX_SOURCE) + " characters.";
+        return false;
+    }
+    if (!PatternCompiler(*this, source).run(syntax, outError))
+    {
+        program.clear();
+        return false;
+    }
+
+    marks.assign(program.size(), 0);
+    generation = 0;
+    computePrefilter();
+    current.reserve(program.size());
+    next.reserve(program.size());
+
+    return true;
+}
+
+bool Pattern::empty() const { return program.empty(); }
+size_t Pattern::programSize() const { return program.size(); }
+
+static bool isWord(const char c) { return std::isalnum(static_cast<uint8_t>(c)) || c == '_'; }
+
+void Pattern::computePrefilter()
+{
+    firstBytes = {};
+    prefilter = !anchored;
+
+    // Assertions only narrow where a match can start, so they are looked through; a reachable Match means the
+    // pattern can match the empty string anywhere.
+    std::vector<bool> seen(program.size());
+    stack.assign(1, 0);
+    while (!stack.empty() && prefilter)
+    {
+        const uint32_t at = stack.back();
+        stack.pop_back();
+        if (seen[at]) continue;
+        seen[at] = true;
+
+        const Inst& inst = program[at];
+        switch (inst.op)
+        {
+        case Op::Class:
+            for (size_t i = 0; i < firstBytes.size(); ++i) firstBytes[i] |= classes[inst.cls][i];
+            break;
+        case Op::Split: stack.push_back(inst.y);
+            [[fallthrough]];
+        case Op::Jump: stack.push_back(inst.x);
+            break;
+        case Op::Match: prefilter = false;
+            break;
+        default: stack.push_back(at + 1);
+            break;
+        }
+    }
+
+    firstByte = -1;
+    for (int c = 0; c < 256 && prefilter; ++c)
+        if (contains(firstBytes, c)) firstByte = firstByte == -1 ? c : -2;
+}
+
+void Pattern::nextGeneration() const
+{
+    if (++generation != 0) return;
+
+    std::fill(marks.begin(), marks.end(), 0);
+    generation = 1;
+}
+
+bool Pattern::inClass(const uint16_t cls, const int c) const { return contains(classes[cls], c); }
+
+// Follows the empty transitions from `pc` depth first, so threads land in `list` in priority order; a state already
+// reached at this position by a higher-priority thread is not added again.
+void Pattern::addThread(std::vector<Thread>& list, const uint32_t pc, const uint32_t start, const char* text,
+                        const size_t size, const size_t pos) const
+{
+    stack.clear();
+    stack.push_back(pc);
+    while (!stack.empty())
+    {
+        const uint32_t at = stack.back();
+        stack.pop_back();
+        if (marks[at] == generation) continue;
+        marks[at] = generation;
+
+        const Inst& inst = program[at];
+        switch (inst.op)
+        {
+        case Op::Jump: stack.push_back(inst.x);
+            break;
+        case Op::Split:
+            stack.push_back(inst.y);
+            stack.push_back(inst.x);
+            break;
+        case Op::LineStart:
+            if (pos == 0) stack.push_back(at + 1);
+            break;
+        case Op::LineEnd:
+            if (pos == size) stack.push_back(at + 1);
+            break;
+        case Op::Frontier:
+            if (!inClass(inst.cls, pos > 0 ? text[pos - 1] : 0) && inClass(inst.cls, pos < size ? text[pos] : 0))
+                stack.push_back(at + 1);
+            break;
+        case Op::WordBoundary:
+            if (isWord(pos > 0 ? text[pos - 1] : 0) != isWord(pos < size ? text[pos] : 0)) stack.push_back(at + 1);
+            break;
+        case Op::Class:
+        case Op::Match: list.push_back({at, start});
+            break;
+        }
+    }
+}
+
+bool Pattern::find(const char* text, const size_t size, const size_t from, Match& out) const
+{
+    // A single slice long enough for the whole text, run on the pattern's own thread list.
+    Scan scan;
+    scan.threads.swap(current);
+    begin(scan, from);
+    resume(scan, text, size, SIZE_MAX);
+    current.swap(scan.threads);
+
+    return scan.found(out);
+}
+
+void Pattern::begin(Scan& scan, const size_t from) const
+{
+    scan.threads.clear();
+    scan.pos = from;
+    scan.matched = false;
+    scan.done = program.empty();
+}
+
+bool Pattern::resume(Scan& scan, const char* text, const size_t size, const size_t steps) const
+{
+    if (scan.done) return true;
+    if (scan.pos > size)
+    {
+        scan.done = true;
+        return true;
+    }
+
+    scan.done = run(scan, text, size, steps);
+    return scan.done;
+}
+
+bool Pattern::run(Scan& scan, const char* text, const size_t size, size_t steps) const
+{
+    // Threads kept from the last slice were added under a generation that has moved on since.
+    nextGeneration();
+    for (const Thread& t : scan.threads) marks[t.pc] = generation;
+
+    std::vector<Thread>& threads = scan.threads;
+    for (size_t& pos = scan.pos; pos <= size; ++pos)
+    {
+        if (steps-- == 0) return false;
+        if (prefilter && threads.empty() && !scan.matched)
+        {
+            if (firstByte >= 0)
+            {
+                const void* hit = std::memchr(text + pos, firstByte, size - pos);
+                pos = hit ? static_cast<size_t>(static_cast<const char*>(hit) - text) : size;
+            }
+            else
+                while (pos < size && !contains(firstBytes, text[pos])) ++pos;
+            if (pos == size) break;
+        }
+
+        // A new thread per start position, behind every thread that started earlier.
+        if (!scan.matched && (!anchored || pos == 0))
+            addThread(threads, 0, static_cast<uint32_t>(pos), text, size, pos);
+        if (threads.empty())
+        {
+            if (scan.matched || anchored) break;
+            nextGeneration();
+            continue;
+        }
+
+        next.clear();
+        nextGeneration();
+        for (const Thread& t : threads)
+        {
+            const Inst& inst = program[t.pc];
+            if (inst.op == Op::Match)
+            {
+                // Everything after this thread has lower priority.
+                scan.match = {t.start, pos};
+                scan.matched = true;
+                break;
+            }
+            if (pos < size && inClass(inst.cls, text[pos])) addThread(next, t.pc + 1, t.start, text, size, pos + 1);
+        }
+        threads.swap(next);
+    }
+
+    return true;
+}
@@ -0,0 +1,103 @@
+#pragma once
+
+#include <array>
+#include <string>
+#include <vector>
+#include <cstdint>
+#include <cstddef>
+
+// Lua patterns (as in lstrlib.c) and a small regex subset, compiled once to an NFA and run as a Pike VM: every
+// thread advances in lock step over the text, so a search costs at most O(text x program) whatever the pattern and
+// never backtracks. Which match wins follows backtracking rules (leftmost, then greedy/lazy priority). Matching is
+// per line: ^ and $ anchor to the ends of the text passed to find().
+//
+// Not regular and therefore rejected: Lua's %b and back-references %1-%9. Captures only group.
+// Regex subset: . [] [^] \d \w \s (and upper-case complements) \b * + ? with lazy forms, | ( ) (?: ) ^ $.
+class Pattern
+{
+public:
+    enum class Syntax : uint8_t { Literal, Lua, Regex };
+
+    static constexpr size_t MAX_SOURCE = 256;
+
+    struct Match
+    {
+        size_t start = 0, end = 0;
+    };
+
+    bool compile(const std::string& source, Syntax syntax, std::string* outError = nullptr);
+
+    // The state of a find() that stops partway through its text, so one long line never has to be scanned at once.
+    class Scan;
+
+    // Leftmost match starting at or after `from`. Keeps scratch state, so each thread needs its own Pattern.
+    bool find(const char* text, size_t size, size_t from, Match& out) const;
+
+    // find() in slices: begin() starts a search at `from`, then each resume() advances it by at most `steps` text
+    // positions over the same text and returns whether it finished.
+    void begin(Scan& scan, size_t from) const;
+    bool resume(Scan& scan, const char* text, size_t size, size_t steps) const;
+
+    [[nodiscard]] bool empty() const;
+    [[nodiscard]] size_t programSize() const;
+
+private:
+    enum class Op : uint8_t { Class, Split, Jump, LineStart, LineEnd, Frontier, WordBoundary, Match };
+
+    struct Inst
+    {
+        Op op = Op::Match;
+        uint16_t cls = 0;
+        uint32_t x = 0, y = 0;
+    };
+
+    struct Thread
+    {
+        uint32_t pc = 0, start = 0;
+    };
+
+    using CharSet = std::array<uint32_t, 8>;
+
+    std::vector<Inst> program;
+    std::vector<CharSet> classes;
+    bool anchored = false;
+
+    // Bytes a match can start with; while no thread is alive the search skips straight to the next one.
+    CharSet firstBytes = {};
+    int firstByte = -1;
+    bool prefilter = false;
+
+    mutable std::vector<Thread> current, next;
+    mutable std::vector<uint32_t> marks, stack;
+    mutable uint32_t generation = 0;
+
+    friend class PatternCompiler;
+
+    void addThread(std::vector<Thread>& list, uint32_t pc, uint32_t start, const char* text, size_t size,
+                   size_t pos) const;
+    bool run(Scan& scan, const char* text, size_t size, size_t steps) const;
+    void computePrefilter();
+    void nextGeneration() const;
+    [[nodiscard]] bool inClass(uint16_t cls, int c) const;
+};
+
+class Pattern::Scan
+{
+public:
+    [[nodiscard]] bool finished() const { return done; }
+
+    // Once finished: whether there was a match, and where.
+    [[nodiscard]] bool found(Match& out) const
+    {
+        out = match;
+        return done && matched;
+    }
+
+private:
+    friend class Pattern;
+
+    std::vector<Thread> threads;
+    Match match;
+    size_t pos = 0;
+    bool matched = false, done = true;
+};
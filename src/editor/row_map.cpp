@@ -0,0 +1,241 @@
+#include "./row_map.h"
+#include "../debug/memory.h"
+
+#include <algorithm>
+
+static bool headerBefore(const RowMap::Fold& f, const size_t line) { return f.header < line; }
+
+bool RowMap::fold(const size_t header, const size_t end)
+{
+    if (header >= lines || end > lines || end <= header + 1 || folded(header)) return false;
+    MEMORY_SCOPE(EditorText);
+
+    const auto at = std::lower_bound(entries.begin(), entries.end(), header, headerBefore);
+    entries.insert(at, {header, end});
+    if (cover.size() != lines)
+    {
+        rebuild();
+        return true;
+    }
+
+    for (size_t line = header + 1; line < end; ++line)
+        if (cover[line]++ == 0) add(line, -static_cast<long>(height(line)));
+
+    return true;
+}
+
+bool RowMap::unfold(const size_t header)
+{
+    const auto at = std::lower_bound(entries.begin(), entries.end(), header, headerBefore);
+    if (at == entries.end() || at->header != header) return false;
+
+    const Fold f = *at;
+    entries.erase(at);
+    if (entries.empty())
+    {
+        unfoldAll();
+        return true;
+    }
+
+    for (size_t line = f.header + 1; line < f.end; ++line)
+        if (--cover[line] == 0) add(line, height(line));
+
+    return true;
+}
+
+void RowMap::unfoldAll()
+{
+    entries.clear();
+    rebuild();
+}
+
+bool RowMap::reveal(const size_t line)
+{
+    bool any = false;
+    for (size_t i = entries.size(); i-- > 0;)
+        if (entries[i].header < line && line < entries[i].end) any = unfold(entries[i].header) || any;
+
+    return any;
+}
+
+bool RowMap::sync(const TextBuffer& buffer, const BlockIndex& blocks)
+{
+    const size_t count = buffer.lineCount();
+    if (buffer.version() == version && count == lines) return false;
+
+    const uint64_t since = version;
+    version = buffer.version();
+    if (identity())
+    {
+        const bool changed = count != lines;
+        lines = rows = count;
+        return changed;
+    }
+    MEMORY_SCOPE(EditorText);
+
+    edits.clear();
+    const std::vector<Fold> before = entries;
+    if (!buffer.editsSince(since, edits)) entries.clear();
+
+    // Lines inside an edit that kept its line count stay put; otherwise they land on the last line it produced. A
+    // header the edit removed outright drops its fold.
+    for (const auto& e : edits)
+        for (Fold& f : entries)
+            for (size_t* line : {&f.header, &f.end})
+            {
+                if (*line == SIZE_MAX || *line < e.line) continue;
+                if (*line >= e.line + e.removed) *line = *line + e.inserted - e.removed;
+                else if (e.removed != e.inserted)
+                    *line = e.inserted > 0 ? e.line + e.inserted - 1 : line == &f.end ? e.line : SIZE_MAX;
+            }
+
+    // A block's extent only depends on the lines from its header to its end, so only folds overlapping what the index
+    // re-lexed need asking again.
+    size_t first = 0, last = 0;
+    blocks.relexed(first, last);
+    for (Fold& f : entries)
+        if (f.header != SIZE_MAX && f.header < last && f.end >= first) f.end = blocks.blockEnd(f.header);
+
+    entries.erase(std::remove_if(entries.begin(), entries.end(), [](const Fold& f)
+    {
+        return f.header == SIZE_MAX || f.end == SIZE_MAX || f.end <= f.header + 1;
+    }), entries.end());
+    entries.erase(std::unique(entries.begin(), entries.end(),
+                              [](const Fold& a, const Fold& b) { return a.header == b.header; }), entries.end());
+
+    if (count == lines && entries == before) return false;
+
+    lines = count;
+    rebuild();
+    return true;
+}
+
+void RowMap::setWrap(const WrapCache* wrap)
+{
+    this->wrap = wrap;
+    rebuild();
+}
+
+void RowMap::rewrapped(const size_t first, size_t last)
+{
+    if (identity()) return;
+
+    // Past a few lines a single pass beats a tree update per line.
+    last = std::min(last, lines);
+    if (first >= last) return;
+    if (last - first > lines / 8)
+    {
+        rebuild();
+        return;
+    }
+
+    for (size_t line = first; line < last; ++line)
+        if (!hidden(line)) add(line, static_cast<long>(height(line)) - static_cast<long>(weight(line)));
+}
+
+const WrapCache* RowMap::wrapping() const { return wrap; }
+
+bool RowMap::empty() const { return entries.empty(); }
+
+bool RowMap::folded(const size_t header) const
+{
+    const auto at = std::lower_bound(entries.begin(), entries.end(), header, headerBefore);
+    return at != entries.end() && at->header == header;
+}
+
+const std::vector<RowMap::Fold>& RowMap::folds() const { return entries; }
+size_t RowMap::lineCount() const { return lines; }
+size_t RowMap::rowCount() const { return rows; }
+
+bool RowMap::hidden(const size_t line) const { return line < cover.size() && cover[line] > 0; }
+
+size_t RowMap::toRow(const size_t line) const
+{
+    if (identity()) return line;
+
+    const size_t row = rowsBefore(line);
+    return hidden(line) && row > 0 ? row - 1 : row;
+}
+
+size_t RowMap::toLine(size_t row, size_t* lineRow) const
+{
+    row = std::min(row, rows > 0 ? rows - 1 : 0);
+    if (lineRow) *lineRow = 0;
+    if (identity()) return row;
+
+    // Descends the tree for the number of lines taking at most `row` rows, which is the line after them; what is left
+    // of `row` is the row within that line.
+    size_t line = 0, step = 1;
+    while (step * 2 <= tree.size()) step *= 2;
+    for (; step > 0; step /= 2)
+        if (line + step <= tree.size() && tree[line + step - 1] <= row)
+        {
+            line += step;
+            row -= tree[line - 1];
+        }
+
+    if (lineRow) *lineRow = row;
+    return line;
+}
+
+bool RowMap::identity() const { return entries.empty() && !wrap; }
+
+uint32_t RowMap::height(const size_t line) const
+{
+    return wrap && line < wrap->lineCount() ? wrap->rows(line) : 1;
+}
+
+uint32_t RowMap::weight(const size_t line) const
+{
+    return static_cast<uint32_t>(rowsBefore(line + 1) - rowsBefore(line));
+}
+
+void RowMap::rebuild()
+{
+    if (identity())
+    {
+        cover.clear();
+        cover.shrink_to_fit();
+        tree.clear();
+        tree.shrink_to_fit();
+        rows = lines;
+        return;
+    }
+
+    // Difference counts over the folded ranges, then the tree built bottom-up in one pass.
+    cover.assign(lines + 1, 0);
+    for (const Fold& f : entries)
+    {
+        cover[f.header + 1]++;
+        cover[f.end]--;
+    }
+    for (size_t line = 1; line < lines; ++line) cover[line] += cover[line - 1];
+    cover.resize(lines);
+
+    tree.assign(lines, 0);
+    rows = 0;
+    for (size_t j = 1; j <= lines; ++j)
+    {
+        const uint32_t weight = cover[j - 1] == 0 ? height(j - 1) : 0;
+        rows += weight;
+        tree[j - 1] += weight;
+        if (const size_t parent = j + (j & (~j + 1)); parent <= lines) tree[parent - 1] += tree[j - 1];
+    }
+}
+
+void RowMap::add(const size_t line, const long delta)
+{
+    if (delta == 0) return;
+
+    rows = static_cast<size_t>(static_cast<long>(rows) + delta);
+    for (size_t j = line + 1; j <= tree.size(); j += j & (~j + 1))
+        tree[j - 1] = static_cast<uint32_t>(static_cast<long>(tree[j - 1]) + delta);
+}
+
+size_t RowMap::rowsBefore(size_t line) const
+{
+    size_t sum = 0;
+    for (line = std::min(line, tree.size()); line > 0; line &= line - 1) sum += tree[line - 1];
+
+    return sum;
+}
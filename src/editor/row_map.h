@@ -0,0 +1,68 @@
+#pragma once
+
+#include "./text.h"
+#include "./block_index.h"
+#include "./wrap_cache.h"
+
+// Screen rows of the buffer. Folds hide the lines between a block's header and closing lines, and soft wrap spreads
+// a line over several rows. A Fenwick tree over the rows each line takes converts buffer lines to rows, and back, in
+// O(log n) however many folds and wrapped lines there are. Without either, lines and rows are the same and nothing
+// is allocated.
+class RowMap
+{
+public:
+    struct Fold
+    {
+        size_t header = 0, end = 0;
+
+        friend bool operator==(const Fold&, const Fold&) = default;
+    };
+
+    // Hides the lines between `header` and `end`; false when there are none or `header` is already folded.
+    bool fold(size_t header, size_t end);
+    bool unfold(size_t header);
+    void unfoldAll();
+
+    // Unfolds every fold hiding `line`; returns whether there was one.
+    bool reveal(size_t line);
+
+    // Follows the buffer's edits: folds move with their lines, take the extent of the block they head now, and go
+    // away when it no longer spans any line. Returns whether rows changed. A wrap cache in use must be synced first.
+    bool sync(const TextBuffer& buffer, const BlockIndex& blocks);
+
+    // Takes the rows of each line from `wrap`, or one each when null.
+    void setWrap(const WrapCache* wrap);
+    // Re-reads the rows of lines [first, last) after the wrap cache rewrapped them.
+    void rewrapped(size_t first, size_t last);
+    [[nodiscard]] const WrapCache* wrapping() const;
+
+    [[nodiscard]] bool empty() const;
+    [[nodiscard]] bool folded(size_t header) const;
+    [[nodiscard]] const std::vector<Fold>& folds() const;
+
+    [[nodiscard]] size_t lineCount() const;
+    [[nodiscard]] size_t rowCount() const;
+    [[nodiscard]] bool hidden(size_t line) const;
+
+    // The first row showing `line`, or the last row of the fold header hiding it.
+    [[nodiscard]] size_t toRow(size_t line) const;
+    // The line shown on `row`, clamped to the last row, and which of its rows that is.
+    [[nodiscard]] size_t toLine(size_t row, size_t* lineRow = nullptr) const;
+
+private:
+    std::vector<Fold> entries;
+    std::vector<uint16_t> cover;
+    std::vector<uint32_t> tree;
+    std::vector<TextBuffer::LineEdit> edits;
+    const WrapCache* wrap = nullptr;
+    size_t lines = 1, rows = 1;
+    uint64_t version = 0;
+
+    [[nodiscard]] bool identity() const;
+    [[nodiscard]] uint32_t height(size_t line) const;
+    [[nodiscard]] uint32_t weight(size_t line) const;
+
+    void rebuild();
+    void add(size_t line, long delta);
+    [[nodiscard]] size_t rowsBefore(size_t line) const;
+};
@@ -0,0 +1,34 @@
+#include "./search.h"
+
+#include <cstring>
+
+SubstringSearch::SubstringSearch(std::string pattern) : needle(std::move(pattern))
+{
+    const size_t m = needle.size();
+    shift.fill(m);
+    for (size_t i = 0; i + 1 < m; ++i) shift[static_cast<uint8_t>(needle[i])] = m - 1 - i;
+}
+
+const std::string& SubstringSearch::pattern() const { return needle; }
+
+size_t SubstringSearch::find(const char* text, const size_t size, const size_t from) const
+{
+    const size_t m = needle.size();
+    if (m == 0 || from >= size || size - from < m) return NPOS;
+
+    if (m == 1)
+    {
+        const void* hit = std::memchr(text + from, needle[0], size - from);
+        return hit ? static_cast<size_t>(static_cast<const char*>(hit) - text) : NPOS;
+    }
+
+    const char last = needle[m - 1];
+    for (size_t i = from; i + m <= size;)
+    {
+        const char c = text[i + m - 1];
+        if (c == last && std::memcmp(text + i, needle.data(), m - 1) == 0) return i;
+        i += shift[static_cast<uint8_t>(c)];
+    }
+
+    return NPOS;
+}
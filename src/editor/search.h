@@ -0,0 +1,22 @@
+#pragma once
+
+#include <array>
+#include <string>
+#include <cstddef>
+
+// Boyer-Moore-Horspool substring search. The shift table is built once per pattern, so a single searcher is reused
+// across every buffer of a scan.
+class SubstringSearch
+{
+public:
+    static constexpr size_t NPOS = static_cast<size_t>(-1);
+
+    explicit SubstringSearch(std::string pattern = {});
+
+    [[nodiscard]] const std::string& pattern() const;
+    [[nodiscard]] size_t find(const char* text, size_t size, size_t from = 0) const;
+
+private:
+    std::string needle;
+    std::array<size_t, 256> shift = {};
+};
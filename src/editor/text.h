@@ -2,6 +2,9 @@
 
 #include <string>
 #include <vector>
+#include <tuple>
+#include <cstdint>
+#include <cstddef>
 
 struct TextPos
 {
@@ -29,6 +32,14 @@ struct Clipboard
 class TextBuffer
 {
 public:
+    // Lines [line, line + removed) were replaced by `inserted` lines.
+    struct LineEdit
+    {
+        size_t line = 0, removed = 0, inserted = 0;
+    };
+
+    static constexpr size_t MAX_EDITS = 64;
+
     void setText(const std::string& text);
     [[nodiscard]] std::string getText() const;
 
@@ -37,15 +48,39 @@ public:
     [[nodiscard]] size_t lineCount() const;
     [[nodiscard]] size_t lineLength(size_t line) const;
 
+    // Whoever mutates getLines() reports it here, so caches keyed by line can update only what changed.
+    void noteEdit(size_t line, size_t removed, size_t inserted);
+    [[nodiscard]] uint64_t version() const;
+
+    // Appends the edits made since `since`; false when they are no longer all logged (setText, or more than
+    // MAX_EDITS ago) and the caller has to start over.
+    bool editsSince(uint64_t since, std::vector<LineEdit>& out) const;
+
 private:
     std::vector<std::string> lines = {""};
+    std::vector<LineEdit> edits;
+    uint64_t editVersion = 0;
 };
 
+class RowMap;
+class WrapCache;
+
 class TextCursor
 {
 public:
     explicit TextCursor(const TextBuffer& buffer);
 
+    // Moves go by the screen rows `rows` lays out, skipping folded lines and following soft wraps. It is ignored
+    // while it lags behind the buffer's line count.
+    void setRows(const RowMap* rows);
+
+    // Screen rows: buffer lines less the folded ones, plus the extra rows of wrapped lines.
+    [[nodiscard]] size_t row(size_t line) const;
+    [[nodiscard]] size_t rowOf(TextPos pos) const;
+    [[nodiscard]] size_t rowCount() const;
+    [[nodiscard]] size_t lineAt(size_t row, size_t* lineRow = nullptr) const;
+    [[nodiscard]] const WrapCache* wrapping() const;
+
     [[nodiscard]] TextPos cursor() const;
     void setCursor(TextPos pos, bool clearSel = true);
 
@@ -73,10 +108,13 @@ public:
 
 private:
     const TextBuffer* textBuffer = nullptr;
+    const RowMap* rowMap = nullptr;
     TextPos cursorPos, selectionStart, selectionEnd;
     bool selecting = false;
 
     void clampCursor();
+    void moveToRow(size_t row);
+    [[nodiscard]] const RowMap* rowsInUse() const;
 };
 
 class TextEditor
@@ -106,6 +144,7 @@ public:
     [[nodiscard]] std::string getTextInRange(const Range& range) const;
     void deleteRange(const Range& range);
     void insertTextAt(TextPos pos, const std::string& text);
+    void replaceLine(size_t line, std::string text);
 
 private:
     TextBuffer textBuffer;
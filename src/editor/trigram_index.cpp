@@ -0,0 +1,464 @@
+#include "./trigram_index.h"
+
+#include <mutex>
+#include <cstring>
+#include <algorithm>
+
+static constexpr size_t HEADER_BYTES = 32, ENTRY_BYTES = 12;
+
+static void put16(std::vector<uint8_t>& out, const uint16_t v)
+{
+    out.push_back(static_cast<uint8_t>(v));
+    out.push_back(static_cast<uint8_t>(v >> 8));
+}
+
+static void put32(std::vector<uint8_t>& out, const uint32_t v)
+{
+    put16(out, static_cast<uint16_t>(v));
+    put16(out, static_cast<uint16_t>(v >> 16));
+}
+
+static void set32(std::vector<uint8_t>& out, const size_t at, const uint32_t v)
+{
+    for (int i = 0; i < 4; ++i) out[at + i] = static_cast<uint8_t>(v >> (8 * i));
+}
+
+static void putVarint(std::vector<uint8_t>& out, uint32_t v)
+{
+    while (v >= 0x80)
+    {
+        out.push_back(static_cast<uint8_t>(v | 0x80));
+        v >>= 7;
+    }
+    out.push_back(static_cast<uint8_t>(v));
+}
+
+static uint16_t get16(const uint8_t* p) { return static_cast<uint16_t>(p[0] | p[1] << 8); }
+static uint32_t get32(const uint8_t* p) { return get16(p) | static_cast<uint32_t>(get16(p + 2)) << 16; }
+
+// Delta-coded ascending file ids.
+static bool decodePostings(const uint8_t* p, const size_t bytes, std::vector<uint32_t>& out)
+{
+    out.clear();
+    uint32_t id = 0;
+    for (size_t i = 0; i < bytes;)
+    {
+        uint32_t delta = 0;
+        for (int shift = 0;; shift += 7)
+        {
+            if (i >= bytes || shift > 28) return false;
+            const uint8_t b = p[i++];
+            delta |= static_cast<uint32_t>(b & 0x7F) << shift;
+            if ((b & 0x80) == 0) break;
+        }
+
+        id += delta;
+        out.push_back(id);
+    }
+
+    return true;
+}
+
+// Trigrams never span a line break, since matches never do.
+static void collectTrigrams(const uint8_t* p, const size_t n, std::vector<uint32_t>& out)
+{
+    out.clear();
+    for (size_t i = 0; i + 3 <= n; ++i)
+    {
+        if (p[i + 2] == '\n' || p[i + 2] == '\r')
+        {
+            i += 2;
+            continue;
+        }
+        if (p[i] == '\n' || p[i] == '\r' || p[i + 1] == '\n' || p[i + 1] == '\r') continue;
+
+        out.push_back(static_cast<uint32_t>(p[i]) << 16 | static_cast<uint32_t>(p[i + 1]) << 8 | p[i + 2]);
+    }
+
+    std::sort(out.begin(), out.end());
+    out.erase(std::unique(out.begin(), out.end()), out.end());
+}
+
+static bool isUnder(const std::string& path, const std::string& dir)
+{
+    return path.size() >= dir.size() && path.compare(0, dir.size(), dir) == 0 &&
+        (path.size() == dir.size() || path[dir.size()] == '/' || dir.back() == '/');
+}
+
+static bool isDirty(const std::string& path, const std::map<std::string, uint64_t>& dirty)
+{
+    return std::any_of(dirty.begin(), dirty.end(), [&](const auto& d) { return isUnder(path, d.first); });
+}
+
+static void walk(const std::string& dir, const size_t rootLength, std::vector<FileSystem::DirEntry>& out,
+                 const std::atomic<bool>& stop)
+{
+    std::vector<FileSystem::DirEntry> entries;
+    if (!FileSystem::listDir(dir, entries, true)) return;
+
+    for (auto& e : entries)
+    {
+        if (stop) return;
+        if (e.path.size() <= rootLength) continue;
+
+        if (e.isDir) walk(e.path, rootLength, out, stop);
+        else out.push_back(std::move(e));
+    }
+}
+
+TrigramIndex::TrigramIndex(std::string root, std::string indexPath)
+    : root(FileSystem::normalize(std::move(root))), indexPath(FileSystem::normalize(std::move(indexPath)))
+{
+    if (this->root.empty() || this->root.back() != '/') this->root.push_back('/');
+}
+
+bool TrigramIndex::tracks(const std::string& path) const
+{
+    return path.size() > root.size() && path.compare(0, root.size(), root) == 0;
+}
+
+void TrigramIndex::noteChange(FileSystem::Change, const std::string& path, const std::string& to)
+{
+    const bool from = tracks(path), dest = !to.empty() && tracks(to);
+    if (!from && !dest) return;
+
+    std::lock_guard lock(mutex);
+    generation++;
+    if (from) dirty[path] = generation;
+    if (dest) dirty[to] = generation;
+}
+
+void TrigramIndex::rescan() { stale = true; }
+
+std::map<std::string, uint64_t> TrigramIndex::dirtySnapshot()
+{
+    std::lock_guard lock(mutex);
+    return dirty;
+}
+
+size_t TrigramIndex::dirtyCount()
+{
+    std::lock_guard lock(mutex);
+    return dirty.size();
+}
+
+size_t TrigramIndex::fileCount() const { return files.size(); }
+
+bool TrigramIndex::load(std::string* outError)
+{
+    files.clear();
+    fences.clear();
+    trigramCount = dirOffset = 0;
+    loaded = false;
+
+    FileSystem::Reader in;
+    uint8_t header[HEADER_BYTES];
+    if (!in.open(indexPath) || in.size() < HEADER_BYTES) return false;
+
+    const uint64_t size = in.size();
+    if (!in.readAt(header, HEADER_BYTES, 0) || std::memcmp(header, MAGIC, 4) != 0 || header[4] != VERSION)
+    {
+        if (outError) *outError = "Not a supported search index: " + indexPath;
+        return false;
+    }
+
+    const uint32_t fileCount = get32(header + 8), filesOffset = get32(header + 16), postingsOffset = get32(header + 20),
+                   fenceOffset = get32(header + 28), fenceCount = (get32(header + 12) + BLOCK_ENTRIES - 1) /
+                   BLOCK_ENTRIES;
+    if (filesOffset > postingsOffset || postingsOffset > size || fenceOffset + uint64_t{fenceCount} * 4 > size)
+    {
+        if (outError) *outError = "Search index is corrupt: " + indexPath;
+        return false;
+    }
+
+    std::vector<uint8_t> table(postingsOffset - filesOffset), fenceBytes(fenceCount * 4);
+    if (!in.readAt(table.data(), table.size(), filesOffset) ||
+        !in.readAt(fenceBytes.data(), fenceBytes.size(), fenceOffset))
+        return false;
+
+    for (size_t at = 0; files.size() < fileCount;)
+    {
+        if (table.size() - at < 11) return false;
+        const uint16_t length = get16(table.data() + at + 9);
+        if (table.size() - at - 11 < length) return false;
+
+        files.push_back({
+            .path = std::string(reinterpret_cast<const char*>(table.data() + at + 11), length),
+            .size = get32(table.data() + at), .mtime = get32(table.data() + at + 4), .flags = table[at + 8]
+        });
+        at += 11 + length;
+    }
+    for (uint32_t i = 0; i < fenceCount; ++i) fences.push_back(get32(fenceBytes.data() + i * 4));
+
+    trigramCount = get32(header + 12);
+    dirOffset = get32(header + 24);
+    loaded = true;
+
+    return true;
+}
+
+bool TrigramIndex::prepare(const std::atomic<bool>& stop, std::string* outError)
+{
+    if (stale.exchange(false)) checked = false;
+    if (!checked) load(outError);
+    if (checked && dirtyCount() <= MAX_DIRTY) return true;
+    if (!compact(stop, outError)) return false;
+
+    // A load that failed only left the compaction to start from scratch.
+    if (outError) outError->clear();
+    checked = true;
+
+    return true;
+}
+
+bool TrigramIndex::findEntry(FileSystem::Reader& in, const uint32_t trigram, Entry& out) const
+{
+    const auto fence = std::upper_bound(fences.begin(), fences.end(), trigram);
+    if (fence == fences.begin()) return false;
+
+    const size_t first = static_cast<size_t>(fence - fences.begin() - 1) * BLOCK_ENTRIES,
+                 count = std::min<size_t>(BLOCK_ENTRIES, trigramCount - first);
+    std::vector<uint8_t> block(count * ENTRY_BYTES);
+    if (!in.readAt(block.data(), block.size(), dirOffset + first * ENTRY_BYTES)) return false;
+
+    size_t lo = 0, hi = count;
+    while (lo < hi)
+    {
+        const size_t mid = (lo + hi) / 2;
+        if (const uint32_t t = get32(block.data() + mid * ENTRY_BYTES); t < trigram) lo = mid + 1;
+        else hi = mid;
+    }
+    if (lo == count || get32(block.data() + lo * ENTRY_BYTES) != trigram) return false;
+
+    const uint8_t* e = block.data() + lo * ENTRY_BYTES;
+    out = {.trigram = trigram, .offset = get32(e + 4), .bytes = get32(e + 8)};
+
+    return true;
+}
+
+bool TrigramIndex::readPostings(FileSystem::Reader& in, const Entry& e, std::vector<uint8_t>& bytes,
+                                std::vector<uint32_t>& out)
+{
+    bytes.resize(e.bytes);
+    return in.readAt(bytes.data(), bytes.size(), e.offset) && decodePostings(bytes.data(), bytes.size(), out);
+}
+
+bool TrigramIndex::candidates(const std::string& pattern, std::vector<std::string>& outPaths,
+                              const std::atomic<bool>& stop)
+{
+    outPaths.clear();
+    const auto snapshot = dirtySnapshot();
+
+    std::vector<uint32_t> grams, ids, next;
+    collectTrigrams(reinterpret_cast<const uint8_t*>(pattern.data()), pattern.size(), grams);
+
+    if (grams.empty())
+    {
+        ids.resize(files.size());
+        for (uint32_t i = 0; i < ids.size(); ++i) ids[i] = i;
+    }
+    else
+    {
+        FileSystem::Reader in;
+        if (!in.open(indexPath)) return false;
+
+        std::vector<Entry> entries;
+        std::vector<uint8_t> bytes;
+        for (const uint32_t g : grams)
+            if (Entry e; findEntry(in, g, e)) entries.push_back(e);
+            else
+            {
+                entries.clear();
+                break;
+            }
+
+        // Smallest posting lists first, so the running intersection shrinks as early as possible.
+        std::sort(entries.begin(), entries.end(), [](const Entry& a, const Entry& b) { return a.bytes < b.bytes; });
+        for (size_t i = 0; i < entries.size() && !stop; ++i)
+        {
+            if (!readPostings(in, entries[i], bytes, i == 0 ? ids : next)) return false;
+            if (i > 0)
+                ids.erase(std::set_intersection(ids.begin(), ids.end(), next.begin(), next.end(), ids.begin()),
+                          ids.end());
+            if (ids.empty()) break;
+        }
+
+        for (uint32_t i = 0; i < files.size(); ++i)
+            if (files[i].flags & UNINDEXED) ids.push_back(i);
+    }
+    if (stop) return false;
+
+    for (const uint32_t id : ids)
+        if (id < files.size() && !(files[id].flags & BINARY))
+            if (std::string path = root + files[id].path; !isDirty(path, snapshot)) outPaths.push_back(std::move(path));
+
+    std::vector<FileSystem::DirEntry> walked;
+    for (const auto& d : snapshot)
+    {
+        if (FileSystem::isDir(d.first)) walk(d.first, root.size(), walked, stop);
+        else if (FileSystem::exists(d.first)) outPaths.push_back(d.first);
+    }
+    for (auto& w : walked) outPaths.push_back(std::move(w.path));
+
+    std::sort(outPaths.begin(), outPaths.end());
+    outPaths.erase(std::unique(outPaths.begin(), outPaths.end()), outPaths.end());
+
+    return !stop;
+}
+
+bool TrigramIndex::compact(const std::atomic<bool>& stop, std::string* outError)
+{
+    const auto snapshot = dirtySnapshot();
+    uint64_t snapshotGeneration = 0;
+    for (const auto& d : snapshot) snapshotGeneration = std::max(snapshotGeneration, d.second);
+
+    std::map<std::string, uint32_t> previous;
+    for (uint32_t i = 0; i < files.size(); ++i) previous.emplace(files[i].path, i);
+
+    std::vector<FileSystem::DirEntry> walked;
+    walk(root, root.size(), walked, stop);
+    if (stop) return false;
+
+    // Unchanged files keep their postings under a new id; everything else is read and tokenized again.
+    std::vector<File> next;
+    std::vector<int64_t> remap(files.size(), -1);
+    std::vector<std::pair<uint32_t, uint32_t>> fresh;
+    std::vector<uint8_t> data;
+    std::vector<uint32_t> grams;
+    bool changed = !loaded || walked.size() != files.size();
+    for (const auto& w : walked)
+    {
+        File f = {.path = w.path.substr(root.size()), .size = static_cast<uint32_t>(w.size),
+                  .mtime = static_cast<uint32_t>(w.mtime)};
+        const auto id = static_cast<uint32_t>(next.size());
+
+        if (const auto it = previous.find(f.path); it != previous.end() && files[it->second].size == f.size &&
+            files[it->second].mtime == f.mtime && !isDirty(w.path, snapshot))
+        {
+            f.flags = files[it->second].flags;
+            remap[it->second] = id;
+        }
+        else
+        {
+            changed = true;
+            if (w.size > MAX_INDEXED_BYTES || !FileSystem::readFile(w.path, data)) f.flags = UNINDEXED;
+            else if (std::memchr(data.data(), 0, data.size())) f.flags = BINARY;
+            else
+            {
+                collectTrigrams(data.data(), data.size(), grams);
+                for (const uint32_t g : grams) fresh.emplace_back(g, id);
+            }
+        }
+
+        next.push_back(std::move(f));
+        if (stop) return false;
+    }
+
+    // The old index is read a directory block and a posting list at a time, in file order.
+    FileSystem::Reader in;
+    if (changed && loaded && !in.open(indexPath))
+    {
+        if (outError) *outError = "Failed to read search index: " + indexPath;
+        return false;
+    }
+
+    if (changed)
+    {
+        std::sort(fresh.begin(), fresh.end());
+
+        std::vector<uint8_t> out(HEADER_BYTES, 0);
+        std::memcpy(out.data(), MAGIC, 4);
+        out[4] = VERSION;
+
+        const auto filesOffset = static_cast<uint32_t>(out.size());
+        for (const File& f : next)
+        {
+            put32(out, f.size);
+            put32(out, f.mtime);
+            out.push_back(f.flags);
+            put16(out, static_cast<uint16_t>(f.path.size()));
+            out.insert(out.end(), f.path.begin(), f.path.end());
+        }
+
+        const auto postingsOffset = static_cast<uint32_t>(out.size());
+        std::vector<Entry> dir;
+        std::vector<uint32_t> ids, oldIds;
+        std::vector<uint8_t> block, bytes;
+        size_t oi = 0, fi = 0, blockFirst = SIZE_MAX;
+        while (oi < trigramCount || fi < fresh.size())
+        {
+            const size_t first = oi - oi % BLOCK_ENTRIES;
+            if (oi < trigramCount && first != blockFirst)
+            {
+                block.resize(std::min<size_t>(BLOCK_ENTRIES, trigramCount - first) * ENTRY_BYTES);
+                if (!in.readAt(block.data(), block.size(), dirOffset + first * ENTRY_BYTES))
+                {
+                    if (outError) *outError = "Failed to read search index: " + indexPath;
+                    return false;
+                }
+                blockFirst = first;
+            }
+
+            const uint8_t* oe = oi < trigramCount ? block.data() + (oi - first) * ENTRY_BYTES : nullptr;
+            const uint32_t ot = oe ? get32(oe) : UINT32_MAX, ft = fi < fresh.size() ? fresh[fi].first : UINT32_MAX;
+            const uint32_t t = std::min(ot, ft);
+
+            ids.clear();
+            if (oe && ot == t)
+            {
+                if (readPostings(in, {.trigram = ot, .offset = get32(oe + 4), .bytes = get32(oe + 8)}, bytes, oldIds))
+                    for (const uint32_t id : oldIds)
+                        if (id < remap.size() && remap[id] >= 0) ids.push_back(static_cast<uint32_t>(remap[id]));
+                oi++;
+            }
+            for (; fi < fresh.size() && fresh[fi].first == t; ++fi) ids.push_back(fresh[fi].second);
+            if (ids.empty()) continue;
+
+            std::sort(ids.begin(), ids.end());
+            const auto offset = static_cast<uint32_t>(out.size());
+            for (size_t i = 0; i < ids.size(); ++i) putVarint(out, ids[i] - (i > 0 ? ids[i - 1] : 0));
+            dir.push_back({.trigram = t, .offset = offset, .bytes = static_cast<uint32_t>(out.size() - offset)});
+        }
+
+        const auto newDirOffset = static_cast<uint32_t>(out.size());
+        for (const Entry& e : dir)
+        {
+            put32(out, e.trigram);
+            put32(out, e.offset);
+            put32(out, e.bytes);
+        }
+        const auto fenceOffset = static_cast<uint32_t>(out.size());
+        std::vector<uint32_t> nextFences;
+        for (size_t i = 0; i < dir.size(); i += BLOCK_ENTRIES)
+        {
+            put32(out, dir[i].trigram);
+            nextFences.push_back(dir[i].trigram);
+        }
+
+        set32(out, 8, static_cast<uint32_t>(next.size()));
+        set32(out, 12, static_cast<uint32_t>(dir.size()));
+        set32(out, 16, filesOffset);
+        set32(out, 20, postingsOffset);
+        set32(out, 24, newDirOffset);
+        set32(out, 28, fenceOffset);
+
+        in.close();
+        if (!FileSystem::writeFile(indexPath, out))
+        {
+            if (outError) *outError = "Failed to write search index: " + indexPath;
+            return false;
+        }
+
+        files = std::move(next);
+        fences = std::move(nextFences);
+        trigramCount = static_cast<uint32_t>(dir.size());
+        dirOffset = newDirOffset;
+        loaded = true;
+    }
+
+    std::lock_guard lock(mutex);
+    for (auto it = dirty.begin(); it != dirty.end();)
+        it = it->second <= snapshotGeneration ? dirty.erase(it) : std::next(it);
+
+    return true;
+}
@@ -0,0 +1,76 @@
+#pragma once
+
+#include "../platform/platform.h"
+
+#include <map>
+#include <atomic>
+
+// Persistent trigram index over a directory tree, used to narrow find-in-files to the files that can contain a
+// literal pattern. The file on disk is immutable between compactions; queries read its header, file table and block
+// fences once and then, through one open handle, only the directory blocks and posting lists the pattern needs.
+// Changes reported through FileSystem's change listener mark paths dirty: dirty files are always candidates until the
+// next compaction, which walks the tree, reuses postings of unchanged files and only reads the rest, streaming the
+// old index block by block.
+class TrigramIndex
+{
+public:
+    static constexpr char MAGIC[4] = {'W', 'S', 'T', 'I'};
+    static constexpr uint8_t VERSION = 1;
+    static constexpr size_t BLOCK_ENTRIES = 256, MAX_DIRTY = 32, MAX_INDEXED_BYTES = 1024 * 1024;
+
+    TrigramIndex(std::string root, std::string indexPath);
+
+    TrigramIndex(const TrigramIndex&) = delete;
+    TrigramIndex& operator=(const TrigramIndex&) = delete;
+
+    // Called from the thread that changed the file; only records the path.
+    void noteChange(FileSystem::Change change, const std::string& path, const std::string& to);
+    // For changes FileSystem never saw, such as a script's own io and os calls: the next prepare() walks the tree.
+    void rescan();
+
+    // Worker side. prepare() loads the index and compacts it on first use or once enough paths are dirty.
+    bool prepare(const std::atomic<bool>& stop, std::string* outError = nullptr);
+    bool candidates(const std::string& pattern, std::vector<std::string>& outPaths, const std::atomic<bool>& stop);
+
+    [[nodiscard]] size_t fileCount() const;
+    [[nodiscard]] size_t dirtyCount();
+
+private:
+    enum : uint8_t
+    {
+        BINARY = 1 << 0,
+        UNINDEXED = 1 << 1
+    };
+
+    struct File
+    {
+        std::string path;
+        uint32_t size = 0, mtime = 0;
+        uint8_t flags = 0;
+    };
+
+    struct Entry
+    {
+        uint32_t trigram = 0, offset = 0, bytes = 0;
+    };
+
+    std::string root, indexPath;
+    std::vector<File> files;
+    std::vector<uint32_t> fences;
+    uint32_t trigramCount = 0, dirOffset = 0;
+    bool loaded = false, checked = false;
+    std::atomic<bool> stale = false;
+
+    Thread::Mutex mutex;
+    std::map<std::string, uint64_t> dirty;
+    uint64_t generation = 0;
+
+    bool load(std::string* outError);
+    bool compact(const std::atomic<bool>& stop, std::string* outError);
+    bool findEntry(FileSystem::Reader& in, uint32_t trigram, Entry& out) const;
+    static bool readPostings(FileSystem::Reader& in, const Entry& e, std::vector<uint8_t>& bytes,
+                             std::vector<uint32_t>& out);
+
+    [[nodiscard]] bool tracks(const std::string& path) const;
+    [[nodiscard]] std::map<std::string, uint64_t> dirtySnapshot();
+};
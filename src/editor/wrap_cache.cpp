@@ -0,0 +1,159 @@
+#include "./wrap_cache.h"
+#include "../debug/memory.h"
+
+#include <algorithm>
+
+static bool continuationByte(const char c) { return (static_cast<uint8_t>(c) & 0xC0) == 0x80; }
+
+bool WrapCache::configure(const float width, const Advances& advances)
+{
+    if (configured && width == this->width && advances == advance) return false;
+
+    this->width = width;
+    advance = advances;
+    configured = true;
+    built = false;
+
+    return true;
+}
+
+void WrapCache::clear()
+{
+    breaks.clear();
+    breaks.shrink_to_fit();
+    configured = built = false;
+}
+
+bool WrapCache::sync(const TextBuffer& buffer, size_t& first, size_t& last)
+{
+    if (!configured || (built && buffer.version() == version)) return false;
+    MEMORY_SCOPE(EditorText);
+
+    const auto& text = buffer.getLines();
+    edits.clear();
+    if (built && buffer.editsSince(version, edits))
+    {
+        // Same bookkeeping as BufferSearch::sync: [first, last) covers every line the edits produced.
+        first = SIZE_MAX;
+        last = 0;
+        for (const auto& e : edits)
+        {
+            const size_t at = std::min(e.line, breaks.size()), removed = std::min(e.removed, breaks.size() - at);
+            breaks.erase(breaks.begin() + static_cast<ptrdiff_t>(at),
+                         breaks.begin() + static_cast<ptrdiff_t>(at + removed));
+            breaks.insert(breaks.begin() + static_cast<ptrdiff_t>(at), e.inserted, {});
+
+            if (first < last)
+            {
+                if (last > at) last = last >= at + removed ? last + e.inserted - removed : at + e.inserted;
+                if (first >= at + removed) first = first + e.inserted - removed;
+            }
+            first = std::min(first, at);
+            last = std::max(last, at + e.inserted);
+        }
+    }
+
+    if (!built || breaks.size() != text.size())
+    {
+        breaks.assign(text.size(), {});
+        first = 0;
+        last = text.size();
+    }
+
+    last = std::min(last, text.size());
+    for (size_t i = first; i < last; ++i) wrapLine(text[i], breaks[i]);
+
+    version = buffer.version();
+    built = true;
+
+    return first < last;
+}
+
+bool WrapCache::active() const { return configured; }
+size_t WrapCache::lineCount() const { return built ? breaks.size() : 0; }
+
+uint32_t WrapCache::rows(const size_t line) const
+{
+    return line < breaks.size() ? static_cast<uint32_t>(breaks[line].size() + 1) : 1;
+}
+
+size_t WrapCache::rowStart(const size_t line, const size_t row) const
+{
+    if (line >= breaks.size() || row == 0) return 0;
+
+    const auto& b = breaks[line];
+    return b[std::min(row, b.size()) - 1];
+}
+
+size_t WrapCache::rowEnd(const size_t line, const size_t row, const size_t length) const
+{
+    if (line >= breaks.size() || row >= breaks[line].size()) return length;
+
+    return std::min<size_t>(breaks[line][row], length);
+}
+
+size_t WrapCache::rowOf(const size_t line, const size_t col) const
+{
+    if (line >= breaks.size()) return 0;
+
+    const auto& b = breaks[line];
+    return static_cast<size_t>(std::upper_bound(b.begin(), b.end(), col) - b.begin());
+}
+
+float WrapCache::offset(const std::string& text, const size_t line, const size_t col) const
+{
+    return span(text, rowStart(line, rowOf(line, col)), col);
+}
+
+size_t WrapCache::columnAt(const std::string& text, const size_t line, const size_t row, const float x) const
+{
+    const size_t start = rowStart(line, row), end = rowEnd(line, row, text.size());
+
+    // The end of a row that continues belongs to the next one, so the caret stops a column short of it.
+    const size_t last = end < text.size() && end > start ? end - 1 : end;
+
+    float pen = 0.0f;
+    size_t col = start;
+    while (col < last)
+    {
+        size_t next = col + 1;
+        while (next < last && continuationByte(text[next])) ++next;
+
+        const float w = span(text, col, next);
+        if (pen + w / 2.0f > x) break;
+        pen += w;
+        col = next;
+    }
+
+    return col;
+}
+
+void WrapCache::wrapLine(const std::string& text, std::vector<uint32_t>& out) const
+{
+    out.clear();
+
+    float pen = 0.0f;
+    size_t start = 0, afterSpace = 0;
+    for (size_t i = 0; i < text.size(); ++i)
+    {
+        const float w = advance[static_cast<uint8_t>(text[i])];
+        if (pen + w > width && i > start && !continuationByte(text[i]))
+        {
+            start = afterSpace > start ? afterSpace : i;
+            out.push_back(static_cast<uint32_t>(start));
+            pen = span(text, start, i);
+        }
+
+        pen += w;
+        if (text[i] == ' ') afterSpace = i + 1;
+    }
+}
+
+float WrapCache::span(const std::string& text, size_t from, const size_t to) const
+{
+    float w = 0.0f;
+    for (const size_t end = std::min(to, text.size()); from < end; ++from)
+        w += advance[static_cast<uint8_t>(text[from])];
+
+    return w;
+}
@@ -0,0 +1,46 @@
+#pragma once
+
+#include "./text.h"
+
+#include <array>
+
+// Soft-wrap points of every line at a given width, measured with a per-byte advance table; kerning is left out,
+// which moves a break by a glyph at most. A line breaks after the last space that fits, or mid-word when one word is
+// wider than the row. Buffer edits rewrap just the lines they touched; a new width or font rewraps all of them.
+class WrapCache
+{
+public:
+    using Advances = std::array<float, 256>;
+
+    // Returns whether the layout changed, in which case the next sync() rewraps every line.
+    bool configure(float width, const Advances& advances);
+    void clear();
+
+    // Catches up with the buffer; lines [first, last) got new break points. Returns false when none did.
+    bool sync(const TextBuffer& buffer, size_t& first, size_t& last);
+
+    [[nodiscard]] bool active() const;
+    [[nodiscard]] size_t lineCount() const;
+
+    [[nodiscard]] uint32_t rows(size_t line) const;
+    // Columns [rowStart, rowEnd) of `line` are shown on its row `row`.
+    [[nodiscard]] size_t rowStart(size_t line, size_t row) const;
+    [[nodiscard]] size_t rowEnd(size_t line, size_t row, size_t length) const;
+    // The row of `line` holding `col`; a column on a break starts the next row.
+    [[nodiscard]] size_t rowOf(size_t line, size_t col) const;
+
+    // Distance of `col` from the start of its row, and the column of row `row` nearest to `x`.
+    [[nodiscard]] float offset(const std::string& text, size_t line, size_t col) const;
+    [[nodiscard]] size_t columnAt(const std::string& text, size_t line, size_t row, float x) const;
+
+private:
+    Advances advance = {};
+    float width = 0.0f;
+    std::vector<std::vector<uint32_t>> breaks;
+    std::vector<TextBuffer::LineEdit> edits;
+    uint64_t version = 0;
+    bool configured = false, built = false;
+
+    void wrapLine(const std::string& text, std::vector<uint32_t>& out) const;
+    [[nodiscard]] float span(const std::string& text, size_t from, size_t to) const;
+};
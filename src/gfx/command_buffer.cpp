@@ -0,0 +1,623 @@
+#include "./command_buffer.h"
+#include "./drawing.h"
+#include "./rounded_rect.h"
+#include "./font.h"
+
+#include <cstring>
+#include <algorithm>
+
+static constexpr size_t MAX_BATCH_VERTICES = 65532;
+static constexpr float UNBOUNDED = 1e9f;
+
+enum : uint8_t
+{
+    KIND_FILLED,
+    KIND_OUTLINE,
+    KIND_TEXT,
+    KIND_SPRITE,
+    KIND_MESH,
+    KIND_BLIT,
+    KIND_CAPTURE,
+};
+
+static std::vector<guVector> batchVertices;
+static std::vector<uint32_t> batchColors;
+
+static void submitBatch(const uint8_t primitive)
+{
+    if (batchVertices.empty()) return;
+
+    GRRLIB_GXEngine(batchVertices.data(), batchColors.data(), static_cast<uint16_t>(batchVertices.size()), primitive);
+    batchVertices.clear();
+    batchColors.clear();
+}
+
+static void beginBatch()
+{
+    batchVertices.clear();
+    batchColors.clear();
+
+    if (batchVertices.capacity() < MAX_BATCH_VERTICES)
+    {
+        batchVertices.reserve(MAX_BATCH_VERTICES);
+        batchColors.reserve(MAX_BATCH_VERTICES);
+    }
+}
+
+// Quads when filled, line pairs otherwise, so any mix of shapes can share one submission.
+static void appendShape(const DrawCommand& c, const bool filled, std::vector<guVector>& vertices,
+                        std::vector<uint32_t>& colors)
+{
+    auto push = [&](const float x, const float y)
+    {
+        vertices.push_back({x, y, 0.0f});
+        colors.push_back(c.color);
+    };
+
+    if (c.type == DrawCommand::Type::Line)
+    {
+        push(c.x, c.y);
+        push(c.w, c.h);
+        return;
+    }
+
+    if (c.radius > 0.0f &&
+        appendRoundedRect({c.x, c.y, c.w, c.h, c.radius, c.radiusY, c.color}, filled, vertices, colors))
+        return;
+
+    const float x0 = c.x, y0 = c.y, x1 = c.x + c.w, y1 = c.y + c.h;
+    if (filled)
+    {
+        push(x0, y0);
+        push(x1, y0);
+        push(x1, y1);
+        push(x0, y1);
+    }
+    else
+    {
+        push(x0, y0);
+        push(x1, y0);
+        push(x1, y0);
+        push(x1, y1);
+        push(x1, y1);
+        push(x0, y1);
+        push(x0, y1);
+        push(x0, y0);
+    }
+}
+
+CommandBuffer::CommandBuffer(const size_t maxCommands, const size_t maxTextBytes)
+    : commands(maxCommands), textArena(maxTextBytes), outer({-UNBOUNDED, -UNBOUNDED, UNBOUNDED, UNBOUNDED})
+{
+}
+
+DrawCommand* CommandBuffer::push(const DrawCommand::Type type)
+{
+    if (count >= commands.size())
+    {
+        dropped++;
+        return nullptr;
+    }
+
+    DrawCommand* cmd = &commands[count++];
+    *cmd = {};
+    cmd->type = type;
+    cmd->clip = clip;
+
+    return cmd;
+}
+
+bool CommandBuffer::rect(const float x, const float y, const float w, const float h, const uint32_t color,
+                         const float radius, const bool filled)
+{
+    if (w <= 0.0f || h <= 0.0f) return true;
+    DrawCommand* cmd = push(DrawCommand::Type::Rect);
+    if (!cmd) return false;
+
+    cmd->x = x;
+    cmd->y = y;
+    cmd->w = w;
+    cmd->h = h;
+    cmd->radius = radius;
+    cmd->radiusY = radius;
+    cmd->filled = filled;
+    cmd->color = color;
+
+    return true;
+}
+
+bool CommandBuffer::roundedRect(const float x, const float y, const float w, const float h, const float radiusX,
+                                const float radiusY, const uint32_t color, const bool filled)
+{
+    if (!rect(x, y, w, h, color, radiusX, filled)) return false;
+    if (w > 0.0f && h > 0.0f) commands[count - 1].radiusY = radiusY;
+
+    return true;
+}
+
+bool CommandBuffer::line(const float x1, const float y1, const float x2, const float y2, const uint32_t color)
+{
+    DrawCommand* cmd = push(DrawCommand::Type::Line);
+    if (!cmd) return false;
+
+    cmd->x = x1;
+    cmd->y = y1;
+    cmd->w = x2;
+    cmd->h = y2;
+    cmd->color = color;
+
+    return true;
+}
+
+bool CommandBuffer::sprite(const uint32_t texture, const float x, const float y, const float scaleX,
+                           const float scaleY, const uint32_t color)
+{
+    if (texture == 0) return true;
+    DrawCommand* cmd = push(DrawCommand::Type::Sprite);
+    if (!cmd) return false;
+
+    cmd->texture = texture;
+    cmd->x = x;
+    cmd->y = y;
+    cmd->w = scaleX;
+    cmd->h = scaleY;
+    cmd->color = color;
+
+    return true;
+}
+
+bool CommandBuffer::text(const std::string_view str, const float x, const float y, const uint32_t color,
+                         const Font* font)
+{
+    if (str.empty()) return true;
+    if (textUsed + str.size() + 1 > textArena.size())
+    {
+        dropped++;
+        return false;
+    }
+
+    DrawCommand* cmd = push(DrawCommand::Type::Text);
+    if (!cmd) return false;
+
+    std::memcpy(textArena.data() + textUsed, str.data(), str.size());
+    textArena[textUsed + str.size()] = '\0';
+
+    cmd->x = x;
+    cmd->y = y;
+    cmd->color = color;
+    cmd->textOffset = static_cast<uint32_t>(textUsed);
+    cmd->textLength = static_cast<uint32_t>(str.size());
+    cmd->font = font;
+    textUsed += str.size() + 1;
+
+    return true;
+}
+
+bool CommandBuffer::mesh(const Mesh& mesh)
+{
+    if (mesh.vertices.empty()) return true;
+    DrawCommand* cmd = push(DrawCommand::Type::Mesh);
+    if (!cmd) return false;
+
+    cmd->mesh = &mesh;
+    cmd->filled = mesh.filled;
+
+    return true;
+}
+
+bool CommandBuffer::blit(const RenderTexture& target, const float x, const float y, const float w, const float h)
+{
+    if (!target.image || w <= 0.0f || h <= 0.0f) return true;
+    DrawCommand* cmd = push(DrawCommand::Type::Blit);
+    if (!cmd) return false;
+
+    cmd->target = &target;
+    cmd->x = x;
+    cmd->y = y;
+    cmd->w = w;
+    cmd->h = h;
+
+    return true;
+}
+
+bool CommandBuffer::capture(const RenderTexture& target, const float x, const float y, const float w, const float h)
+{
+    if (w <= 0.0f || h <= 0.0f) return true;
+    DrawCommand* cmd = push(DrawCommand::Type::Capture);
+    if (!cmd) return false;
+
+    cmd->target = &target;
+    cmd->x = x;
+    cmd->y = y;
+    cmd->w = w;
+    cmd->h = h;
+
+    return true;
+}
+
+void CommandBuffer::pushScissor(const float x, const float y, const float w, const float h)
+{
+    if (clips.empty()) clips.push_back(outer);
+    scissorStack.push_back(clip);
+    if (clips.size() > UINT16_MAX) return;
+
+    const Bounds& p = clips[clip];
+    clips.push_back({std::max(x, p.x0), std::max(y, p.y0), std::min(x + std::max(0.0f, w), p.x1),
+                     std::min(y + std::max(0.0f, h), p.y1)});
+    clip = static_cast<uint16_t>(clips.size() - 1);
+}
+
+void CommandBuffer::popScissor()
+{
+    if (scissorStack.empty()) return;
+
+    clip = scissorStack.back();
+    scissorStack.pop_back();
+}
+
+bool CommandBuffer::unclipped(const float x, const float y, const float w, const float h) const
+{
+    const Bounds& c = clip == 0 ? outer : clips[clip];
+    return x >= c.x0 && y >= c.y0 && x + w <= c.x1 && y + h <= c.y1;
+}
+
+void CommandBuffer::clipTo(const float x, const float y, const float w, const float h)
+{
+    outer = {x, y, x + std::max(0.0f, w), y + std::max(0.0f, h)};
+    if (!clips.empty()) clips[0] = outer;
+}
+
+void CommandBuffer::clearClip()
+{
+    outer = {-UNBOUNDED, -UNBOUNDED, UNBOUNDED, UNBOUNDED};
+    if (!clips.empty()) clips[0] = outer;
+}
+
+CommandBuffer::Bounds CommandBuffer::boundsOf(const DrawCommand& cmd) const
+{
+    Bounds b = {-UNBOUNDED, -UNBOUNDED, UNBOUNDED, UNBOUNDED};
+    switch (cmd.type)
+    {
+    case DrawCommand::Type::Rect:
+        b = {cmd.x, cmd.y, cmd.x + cmd.w + 1.0f, cmd.y + cmd.h + 1.0f};
+        break;
+    case DrawCommand::Type::Blit:
+    case DrawCommand::Type::Capture:
+        b = {cmd.x, cmd.y, cmd.x + cmd.w, cmd.y + cmd.h};
+        break;
+    case DrawCommand::Type::Line:
+        b = {std::min(cmd.x, cmd.w), std::min(cmd.y, cmd.h), std::max(cmd.x, cmd.w) + 1.0f,
+             std::max(cmd.y, cmd.h) + 1.0f};
+        break;
+    case DrawCommand::Type::Text:
+        // Glyph advances stay under the em size, descenders can reach a quarter below it.
+        if (cmd.font)
+        {
+            const float em = cmd.font->textHeight();
+            b = {cmd.x, cmd.y, cmd.x + em * static_cast<float>(cmd.textLength), cmd.y + em * 1.25f};
+        }
+        break;
+    case DrawCommand::Type::Mesh:
+        b = {cmd.mesh->x0, cmd.mesh->y0, cmd.mesh->x1, cmd.mesh->y1};
+        break;
+    case DrawCommand::Type::Sprite:
+        break;
+    }
+
+    const Bounds& c = cmd.clip == 0 ? outer : clips[cmd.clip];
+    return {std::max(b.x0, c.x0), std::max(b.y0, c.y0), std::min(b.x1, c.x1), std::min(b.y1, c.y1)};
+}
+
+// Merges runs of adjacent commands with identical state into batches, keeping recorded order.
+void CommandBuffer::batch()
+{
+    batches.clear();
+    links.assign(count, UINT32_MAX);
+
+    for (uint32_t i = 0; i < count; ++i)
+    {
+        const DrawCommand& cmd = commands[i];
+        const Bounds b = boundsOf(cmd);
+        if (b.x0 >= b.x1 || b.y0 >= b.y1)
+        {
+            stats.culled++;
+            continue;
+        }
+
+        const uint8_t kind = cmd.type == DrawCommand::Type::Text
+                                 ? KIND_TEXT
+                                 : cmd.type == DrawCommand::Type::Sprite
+                                 ? KIND_SPRITE
+                                 : cmd.type == DrawCommand::Type::Mesh
+                                 ? KIND_MESH
+                                 : cmd.type == DrawCommand::Type::Blit
+                                 ? KIND_BLIT
+                                 : cmd.type == DrawCommand::Type::Capture
+                                 ? KIND_CAPTURE
+                                 : cmd.type == DrawCommand::Type::Rect && cmd.filled
+                                 ? KIND_FILLED
+                                 : KIND_OUTLINE;
+        const void* resource = kind == KIND_TEXT
+                                   ? static_cast<const void*>(cmd.font)
+                                   : kind == KIND_SPRITE
+                                   ? reinterpret_cast<const void*>(static_cast<uintptr_t>(cmd.texture))
+                                   : kind == KIND_MESH
+                                   ? static_cast<const void*>(cmd.mesh)
+                                   : kind == KIND_BLIT
+                                   ? static_cast<const void*>(cmd.target)
+                                   : nullptr;
+
+        if (Batch* last = batches.empty() ? nullptr : &batches.back(); last && kind != KIND_CAPTURE &&
+            last->kind == kind && last->clip == cmd.clip && last->resource == resource)
+        {
+            links[last->last] = i;
+            last->last = i;
+            continue;
+        }
+
+        batches.push_back({.kind = kind, .clip = cmd.clip, .resource = resource, .first = i, .last = i});
+    }
+}
+
+void CommandBuffer::submit(const Batch& b, DrawBackend& backend)
+{
+    if (b.kind == KIND_FILLED || b.kind == KIND_OUTLINE)
+    {
+        scratch.clear();
+        for (uint32_t i = b.first; i != UINT32_MAX; i = links[i]) scratch.push_back(commands[i]);
+
+        backend.shapes(scratch.data(), scratch.size());
+        stats.submissions++;
+        return;
+    }
+
+    for (uint32_t i = b.first; i != UINT32_MAX; i = links[i])
+    {
+        const DrawCommand& cmd = commands[i];
+        if (b.kind == KIND_TEXT) backend.text(cmd, {textArena.data() + cmd.textOffset, cmd.textLength});
+        else if (b.kind == KIND_MESH) backend.mesh(*cmd.mesh);
+        else if (b.kind == KIND_BLIT) backend.blit(cmd);
+        else if (b.kind == KIND_CAPTURE) backend.capture(cmd);
+        else backend.sprite(cmd);
+        stats.submissions++;
+    }
+}
+
+void CommandBuffer::flush(DrawBackend& backend)
+{
+    stats = {.commands = count, .submissions = 0, .scissors = 0, .culled = 0, .dropped = dropped};
+    batch();
+
+    const bool clipped = outer.x0 > -UNBOUNDED || outer.y0 > -UNBOUNDED || outer.x1 < UNBOUNDED ||
+                         outer.y1 < UNBOUNDED;
+    uint16_t active = 0;
+    if (clipped && !batches.empty()) applyClip(0, backend);
+
+    for (const Batch& b : batches)
+    {
+        if (b.clip != active)
+        {
+            applyClip(b.clip, backend);
+            active = b.clip;
+        }
+
+        submit(b, backend);
+    }
+    if (active != 0 || (clipped && !batches.empty())) backend.resetScissor();
+
+    clear();
+}
+
+void CommandBuffer::applyClip(const uint16_t index, DrawBackend& backend)
+{
+    const Bounds& c = index == 0 ? outer : clips[index];
+    if (c.x0 <= -UNBOUNDED && c.y0 <= -UNBOUNDED && c.x1 >= UNBOUNDED && c.y1 >= UNBOUNDED) backend.resetScissor();
+    else backend.scissor(c.x0, c.y0, c.x1 - c.x0, c.y1 - c.y0);
+    stats.scissors++;
+}
+
+void CommandBuffer::clear()
+{
+    count = 0;
+    textUsed = 0;
+    dropped = 0;
+    clip = 0;
+    clips.clear();
+    scissorStack.clear();
+}
+
+size_t CommandBuffer::size() const { return count; }
+size_t CommandBuffer::capacity() const { return commands.size(); }
+const CommandBuffer::Stats& CommandBuffer::lastFlush() const { return stats; }
+
+GXBackend::GXBackend(const Font& font) : font(&font)
+{
+}
+
+GXBackend::~GXBackend() { clearTextures(); }
+
+void GXBackend::shapes(const DrawCommand* commands, const size_t count)
+{
+    if (count == 0) return;
+
+    const bool filled = commands[0].type == DrawCommand::Type::Rect && commands[0].filled;
+    const uint8_t primitive = filled ? GX_QUADS : GX_LINES;
+    beginBatch();
+
+    for (size_t i = 0; i < count; ++i)
+    {
+        if (batchVertices.size() + 2 * VERTICES > MAX_BATCH_VERTICES) submitBatch(primitive);
+        appendShape(commands[i], filled, batchVertices, batchColors);
+    }
+
+    submitBatch(primitive);
+}
+
+void GXBackend::sprite(const DrawCommand& command)
+{
+    if (command.texture == 0 || command.texture > textures.size()) return;
+    const auto* tex = static_cast<GRRLIB_texImg*>(textures[command.texture - 1]);
+
+    if (tex) GRRLIB_DrawImg(command.x, command.y, tex, 0, command.w, command.h, command.color);
+}
+
+void GXBackend::text(const DrawCommand& command, const std::string_view text)
+{
+    if (const Font* f = command.font ? command.font : font) f->drawText(text, command.x, command.y, command.color);
+}
+
+void GXBackend::mesh(const Mesh& mesh)
+{
+    const size_t total = mesh.vertices.size(), step = mesh.filled ? 4 : 2,
+                 chunk = MAX_BATCH_VERTICES - MAX_BATCH_VERTICES % step;
+
+    for (size_t at = 0; at < total; at += chunk)
+    {
+        const auto n = static_cast<uint16_t>(std::min(chunk, total - at));
+        GRRLIB_GXEngine(const_cast<guVector*>(mesh.vertices.data() + at),
+                        const_cast<uint32_t*>(mesh.colors.data() + at), n, mesh.filled ? GX_QUADS : GX_LINES);
+    }
+}
+
+void GXBackend::blit(const DrawCommand& command)
+{
+    if (command.target->image) GRRLIB_DrawImg(command.x, command.y, command.target->image, 0, 1, 1, 0xFFFFFFFF);
+}
+
+void GXBackend::capture(const DrawCommand& command)
+{
+    GRRLIB_texImg*& image = command.target->image;
+    const auto w = static_cast<uint32_t>(command.w), h = static_cast<uint32_t>(command.h);
+
+    if (image && (image->w != w || image->h != h))
+    {
+        GRRLIB_FreeTexture(image);
+        image = nullptr;
+    }
+    if (!image) image = GRRLIB_CreateEmptyTexture(w, h);
+    if (image) GRRLIB_Screen2Texture(static_cast<int>(command.x), static_cast<int>(command.y), image, false);
+}
+
+void GXBackend::scissor(const float x, const float y, const float w, const float h)
+{
+    GX_SetScissor(static_cast<uint32_t>(std::max(0.0f, x)), static_cast<uint32_t>(std::max(0.0f, y)),
+                  static_cast<uint32_t>(w), static_cast<uint32_t>(h));
+}
+
+void GXBackend::resetScissor() { GX_SetScissor(0, 0, 640, 480); }
+
+uint32_t GXBackend::loadTexture(const std::vector<uint8_t>& data)
+{
+    if (data.empty()) return 0;
+
+    GRRLIB_texImg* tex = GRRLIB_LoadTexture(data.data());
+    if (!tex) return 0;
+
+    textures.push_back(tex);
+    return static_cast<uint32_t>(textures.size());
+}
+
+void GXBackend::clearTextures()
+{
+    for (void* tex : textures) GRRLIB_FreeTexture(static_cast<GRRLIB_texImg*>(tex));
+    textures.clear();
+}
+
+RenderTexture::~RenderTexture()
+{
+    if (image) GRRLIB_FreeTexture(image);
+}
+
+DisplayList::DisplayList(const size_t maxCommands, const size_t maxTextBytes) : recorder(maxCommands, maxTextBytes)
+{
+}
+
+CommandBuffer& DisplayList::record()
+{
+    recorder.clear();
+    compiled = false;
+
+    return recorder;
+}
+
+void DisplayList::compile()
+{
+    meshes.clear();
+    segments.clear();
+    textPool.clear();
+
+    Compiler compiler(*this);
+    recorder.flush(compiler);
+
+    for (Mesh& m : meshes)
+    {
+        m.x0 = m.y0 = UNBOUNDED;
+        m.x1 = m.y1 = -UNBOUNDED;
+        for (const guVector& v : m.vertices)
+        {
+            m.x0 = std::min(m.x0, v.x);
+            m.y0 = std::min(m.y0, v.y);
+            m.x1 = std::max(m.x1, v.x + 1.0f);
+            m.y1 = std::max(m.y1, v.y + 1.0f);
+        }
+    }
+
+    compiled = true;
+}
+
+void DisplayList::replay(CommandBuffer& out) const
+{
+    if (!compiled) return;
+
+    for (const Segment& seg : segments)
+    {
+        const DrawCommand& c = seg.command;
+        if (seg.mesh != SIZE_MAX) out.mesh(meshes[seg.mesh]);
+        else if (c.type == DrawCommand::Type::Text)
+            out.text({textPool.data() + c.textOffset, c.textLength}, c.x, c.y, c.color, c.font);
+        else if (c.type == DrawCommand::Type::Sprite) out.sprite(c.texture, c.x, c.y, c.w, c.h, c.color);
+    }
+}
+
+void DisplayList::invalidate() { compiled = false; }
+bool DisplayList::valid() const { return compiled; }
+
+size_t DisplayList::vertexCount() const
+{
+    size_t n = 0;
+    for (const Mesh& m : meshes) n += m.vertices.size();
+
+    return n;
+}
+
+void DisplayList::Compiler::shapes(const DrawCommand* commands, const size_t count)
+{
+    if (count == 0) return;
+
+    const bool filled = commands[0].type == DrawCommand::Type::Rect && commands[0].filled;
+    if (list->segments.empty() || list->segments.back().mesh == SIZE_MAX ||
+        list->meshes[list->segments.back().mesh].filled != filled)
+    {
+        list->meshes.push_back({.filled = filled});
+        list->segments.push_back({.mesh = list->meshes.size() - 1});
+    }
+
+    Mesh& m = list->meshes.back();
+    for (size_t i = 0; i < count; ++i) appendShape(commands[i], filled, m.vertices, m.colors);
+}
+
+void DisplayList::Compiler::sprite(const DrawCommand& command) { list->segments.push_back({.command = command}); }
+
+void DisplayList::Compiler::text(const DrawCommand& command, const std::string_view text)
+{
+    Segment& seg = list->segments.emplace_back(Segment{.command = command});
+    seg.command.textOffset = static_cast<uint32_t>(list->textPool.size());
+    seg.command.textLength = static_cast<uint32_t>(text.size());
+    list->textPool.append(text);
+}
+
+void DisplayList::Compiler::mesh(const Mesh& mesh)
+{
+    list->meshes.push_back(mesh);
+    list->segments.push_back({.mesh = list->meshes.size() - 1});
+}
@@ -0,0 +1,261 @@
+#pragma once
+
+#include <string>
+#include <vector>
+#include <cstdint>
+#include <string_view>
+
+#include <grrlib.h>
+
+class Font;
+
+// Prebuilt vertices in screen space, submitted with a single draw call.
+struct Mesh
+{
+    std::vector<guVector> vertices = {};
+    std::vector<uint32_t> colors = {};
+    bool filled = true;
+    float x0 = 0, y0 = 0, x1 = 0, y1 = 0;
+};
+
+// Offscreen copy of a screen region: CommandBuffer::capture() fills it with what has been drawn so far and blit()
+// draws it back. The backend allocates the storage on the first capture.
+class RenderTexture
+{
+public:
+    RenderTexture() = default;
+    ~RenderTexture();
+
+    RenderTexture(const RenderTexture&) = delete;
+    RenderTexture& operator=(const RenderTexture&) = delete;
+
+    mutable GRRLIB_texImg* image = nullptr;
+};
+
+struct DrawCommand
+{
+    enum class Type : uint8_t { Rect, Line, Sprite, Text, Mesh, Blit, Capture } type = Type::Rect;
+
+    bool filled = true;
+    uint16_t clip = 0;
+    uint32_t color = 0xFFFFFFFF;
+
+    // Rect, Blit, Capture: x, y, w, h (+ radius). Line: x, y -> w, h. Sprite: x, y, scale w, h. Text: x, y.
+    float x = 0, y = 0, w = 0, h = 0, radius = 0, radiusY = 0;
+    uint32_t texture = 0, textOffset = 0, textLength = 0;
+    const Font* font = nullptr;
+    const Mesh* mesh = nullptr;
+    const RenderTexture* target = nullptr;
+};
+
+class DrawBackend
+{
+public:
+    virtual ~DrawBackend() = default;
+
+    // Every command in a shapes() call is untextured and shares `filled`; outlines and lines arrive together.
+    virtual void shapes(const DrawCommand* commands, size_t count) = 0;
+    virtual void sprite(const DrawCommand& command) = 0;
+    virtual void text(const DrawCommand& command, std::string_view text) = 0;
+    virtual void mesh(const Mesh& mesh) = 0;
+    virtual void blit(const DrawCommand& command) = 0;
+    virtual void capture(const DrawCommand& command) = 0;
+    virtual void scissor(float x, float y, float w, float h) = 0;
+    virtual void resetScissor() = 0;
+
+    virtual uint32_t loadTexture(const std::vector<uint8_t>& data) = 0;
+    virtual void clearTextures() = 0;
+};
+
+class CommandBuffer
+{
+public:
+    struct Stats
+    {
+        size_t commands = 0, submissions = 0, scissors = 0, culled = 0, dropped = 0;
+    };
+
+    explicit CommandBuffer(size_t maxCommands = 16384, size_t maxTextBytes = 32 * 1024);
+
+    bool rect(float x, float y, float w, float h, uint32_t color, float radius = 0.0f, bool filled = true);
+    bool roundedRect(float x, float y, float w, float h, float radiusX, float radiusY, uint32_t color, bool filled);
+    bool line(float x1, float y1, float x2, float y2, uint32_t color);
+    bool sprite(uint32_t texture, float x, float y, float scaleX, float scaleY, uint32_t color);
+    bool text(std::string_view str, float x, float y, uint32_t color, const Font* font = nullptr);
+    bool mesh(const Mesh& mesh);
+    bool blit(const RenderTexture& target, float x, float y, float w, float h);
+    // Copies the rect as composited so far.
+    bool capture(const RenderTexture& target, float x, float y, float w, float h);
+
+    // Commands recorded until the matching popScissor() are clipped to this rect and any enclosing ones.
+    void pushScissor(float x, float y, float w, float h);
+    void popScissor();
+    [[nodiscard]] bool unclipped(float x, float y, float w, float h) const;
+
+    // Outer clip for every command, kept across flushes; scissor rects are intersected with it.
+    void clipTo(float x, float y, float w, float h);
+    void clearClip();
+
+    void flush(DrawBackend& backend);
+    void clear();
+
+    [[nodiscard]] size_t size() const;
+    [[nodiscard]] size_t capacity() const;
+    [[nodiscard]] const Stats& lastFlush() const;
+
+private:
+    struct Bounds
+    {
+        float x0 = 0, y0 = 0, x1 = 0, y1 = 0;
+    };
+
+    void applyClip(uint16_t index, DrawBackend& backend);
+
+    struct Batch
+    {
+        uint8_t kind = 0;
+        uint16_t clip = 0;
+        const void* resource = nullptr;
+        uint32_t first = 0, last = 0;
+    };
+
+    std::vector<DrawCommand> commands;
+    std::vector<char> textArena;
+    std::vector<Bounds> clips;
+    std::vector<Batch> batches;
+    std::vector<uint32_t> links;
+    std::vector<DrawCommand> scratch;
+    std::vector<uint16_t> scissorStack;
+    Bounds outer;
+    size_t count = 0, textUsed = 0, dropped = 0;
+    uint16_t clip = 0;
+    Stats stats;
+
+    DrawCommand* push(DrawCommand::Type type);
+    [[nodiscard]] Bounds boundsOf(const DrawCommand& cmd) const;
+    void batch();
+    void submit(const Batch& b, DrawBackend& backend);
+};
+
+class GXBackend : public DrawBackend
+{
+public:
+    explicit GXBackend(const Font& font);
+    ~GXBackend() override;
+
+    void shapes(const DrawCommand* commands, size_t count) override;
+    void sprite(const DrawCommand& command) override;
+    void text(const DrawCommand& command, std::string_view text) override;
+    void mesh(const Mesh& mesh) override;
+    void blit(const DrawCommand& command) override;
+    void capture(const DrawCommand& command) override;
+    void scissor(float x, float y, float w, float h) override;
+    void resetScissor() override;
+
+    uint32_t loadTexture(const std::vector<uint8_t>& data) override;
+    void clearTextures() override;
+
+private:
+    const Font* font = nullptr;
+    std::vector<void*> textures;
+};
+
+class RecordingBackend : public DrawBackend
+{
+public:
+    struct Entry
+    {
+        DrawCommand command;
+        std::string text;
+        size_t submission = 0;
+    };
+
+    std::vector<Entry> entries;
+    size_t submissions = 0, scissors = 0, captures = 0;
+    uint32_t nextTexture = 1;
+
+    void reset()
+    {
+        entries.clear();
+        submissions = scissors = captures = 0;
+    }
+
+    void shapes(const DrawCommand* commands, const size_t count) override { record(commands, count); }
+    void sprite(const DrawCommand& command) override { record(&command, 1); }
+    void mesh(const Mesh& mesh) override
+    {
+        const DrawCommand command = {.type = DrawCommand::Type::Mesh, .mesh = &mesh};
+        record(&command, 1);
+    }
+    void blit(const DrawCommand& command) override { record(&command, 1); }
+    void capture(const DrawCommand&) override { captures++; }
+    void scissor(float, float, float, float) override { scissors++; }
+    void resetScissor() override { scissors++; }
+
+    void text(const DrawCommand& command, const std::string_view text) override
+    {
+        record(&command, 1);
+        entries.back().text = text;
+    }
+
+    uint32_t loadTexture(const std::vector<uint8_t>& data) override { return data.empty() ? 0 : nextTexture++; }
+    void clearTextures() override { nextTexture = 1; }
+
+private:
+    void record(const DrawCommand* commands, const size_t count)
+    {
+        for (size_t i = 0; i < count; ++i) entries.push_back({commands[i], {}, submissions});
+        submissions++;
+    }
+};
+
+// Static content compiled once into meshes and replayed each frame. Scissors and render textures are ignored;
+// the replay is clipped by whatever scissor is active in the target buffer.
+class DisplayList
+{
+public:
+    explicit DisplayList(size_t maxCommands = 512, size_t maxTextBytes = 4096);
+
+    // Draw the static content into the returned buffer, then call compile().
+    [[nodiscard]] CommandBuffer& record();
+    void compile();
+    void replay(CommandBuffer& out) const;
+    void invalidate();
+
+    [[nodiscard]] bool valid() const;
+    [[nodiscard]] size_t vertexCount() const;
+
+private:
+    struct Segment
+    {
+        size_t mesh = SIZE_MAX;
+        DrawCommand command = {};
+    };
+
+    class Compiler : public DrawBackend
+    {
+    public:
+        explicit Compiler(DisplayList& list) : list(&list) {}
+
+        void shapes(const DrawCommand* commands, size_t count) override;
+        void sprite(const DrawCommand& command) override;
+        void text(const DrawCommand& command, std::string_view text) override;
+        void mesh(const Mesh& mesh) override;
+        void blit(const DrawCommand&) override {}
+        void capture(const DrawCommand&) override {}
+        void scissor(float, float, float, float) override {}
+        void resetScissor() override {}
+
+        uint32_t loadTexture(const std::vector<uint8_t>&) override { return 0; }
+        void clearTextures() override {}
+
+    private:
+        DisplayList* list;
+    };
+
+    CommandBuffer recorder;
+    std::vector<Mesh> meshes;
+    std::vector<Segment> segments;
+    std::string textPool;
+    bool compiled = false;
+};
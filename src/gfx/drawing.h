@@ -98,29 +98,22 @@ struct TrigLUT
     }
 };
 
-inline void roundedRectangle(const float x, const float y, const float width, const float height, const float radiusX,
-                             const float radiusY, const uint32_t color, const bool filled)
+using RoundedOutline = std::array<guVector, VERTICES>;
+
+// Closed outline (first point repeated last) of a rounded rect; false when the corners are square.
+inline bool roundedRectOutline(const float x, const float y, const float width, const float height,
+                               const float radiusX, const float radiusY, RoundedOutline& v)
 {
-    if (width <= 0.0f || height <= 0.0f) return;
     const float rx = std::clamp(radiusX, 0.0f, 0.5f * width), ry = std::clamp(radiusY, 0.0f, 0.5f * height),
                 ww = width - 2.0f * rx, hh = height - 2.0f * ry;
-
-    if (rx <= 0.0f || ry <= 0.0f)
-    {
-        GRRLIB_Rectangle(x, y, width, height, color, filled);
-        return;
-    }
+    if (rx <= 0.0f || ry <= 0.0f) return false;
 
     static const TrigLUT lut = {};
-    std::array<guVector, VERTICES> v = {};
-    std::array<uint32_t, VERTICES> col = {};
-
     auto setV = [&](const int i, const float vx, const float vy) noexcept
     {
         v[i].x = vx;
         v[i].y = vy;
         v[i].z = 0.0f;
-        col[i] = color;
     };
 
     auto arc = [&](const int outStart, const int startIndex, const int endIndex, const float ccx,
@@ -141,5 +134,5 @@ inline void roundedRectangle(const float x, const float y, const float width, co
         y + 0.5f * height + 0.5f * hh - hh);
     setV(VERTICES - 1, v[0].x, v[0].y);
 
-    GRRLIB_GXEngine(v.data(), col.data(), VERTICES, filled ? GX_TRIANGLEFAN : GX_LINESTRIP);
+    return true;
 }
@@ -1,32 +1,276 @@
 #include "./font.h"
+#include "./font_atlas.h"
 #include "../platform/platform.h"
+#include "../debug/memory.h"
 
 #include <cmath>
+#include <cstdlib>
+#include <algorithm>
 
-bool Font::load(const std::string& path, const int size)
+#ifndef WIISCRIPT_HOST
+#include <malloc.h>
+#endif
+
+struct Quad
+{
+    float x0, y0, x1, y1, s0, t0, s1, t1;
+};
+
+static constexpr size_t MAX_QUADS = 65532 / 4;
+static std::vector<Quad> quads;
+
+static uint32_t nextCodepoint(const std::string_view s, size_t& i)
+{
+    const auto c = static_cast<uint8_t>(s[i++]);
+    if (c < 0x80) return c;
+
+    const int extra = c >= 0xF0 ? 3 : c >= 0xE0 ? 2 : c >= 0xC0 ? 1 : 0;
+    uint32_t cp = c & (0x3F >> extra);
+    for (int k = 0; k < extra && i < s.size() && (static_cast<uint8_t>(s[i]) & 0xC0) == 0x80; ++k)
+        cp = cp << 6 | (static_cast<uint8_t>(s[i++]) & 0x3F);
+
+    return cp;
+}
+
+struct Font::Atlas
+{
+    struct Glyph
+    {
+        float s0 = 0, t0 = 0, s1 = 0, t1 = 0;
+        int16_t left = 0, top = 0, w = 0, h = 0, advance = 0;
+        bool present = false;
+    };
+
+    std::vector<Glyph> glyphs;
+    std::vector<FontAtlas::Kerning> kerning;
+    uint16_t width = 0, height = 0;
+    size_t bytes = 0;
+    uint8_t* texels = nullptr;
+#ifndef WIISCRIPT_HOST
+    GXTexObj texture = {};
+#endif
+
+    Atlas() = default;
+    Atlas(const Atlas&) = delete;
+    Atlas& operator=(const Atlas&) = delete;
+
+    ~Atlas()
+    {
+        if (!texels) return;
+#ifdef WIISCRIPT_MEMORY
+        Memory::recordFree(Memory::Category::Fonts, bytes);
+#endif
+        std::free(texels);
+    }
+
+    // Coverage becomes white IA8 texels in GX 4x4 tiles, so the tinted draw color shows through the alpha.
+    bool upload(const FontAtlas::Data& d)
+    {
+        width = d.width;
+        height = d.height;
+        if (width == 0 || height == 0 || width % 4 != 0 || height % 4 != 0) return false;
+
+        bytes = static_cast<size_t>(width) * height * 2;
+#ifdef WIISCRIPT_HOST
+        texels = static_cast<uint8_t*>(std::malloc(bytes));
+#else
+        texels = static_cast<uint8_t*>(memalign(32, bytes));
+#endif
+        if (!texels) return false;
+#ifdef WIISCRIPT_MEMORY
+        Memory::recordAlloc(Memory::Category::Fonts, bytes);
+#endif
+
+        uint8_t* out = texels;
+        for (size_t ty = 0; ty < height; ty += 4)
+            for (size_t tx = 0; tx < width; tx += 4)
+                for (size_t y = ty; y < ty + 4; ++y)
+                    for (size_t x = tx; x < tx + 4; ++x)
+                    {
+                        *out++ = d.coverage[y * width + x];
+                        *out++ = 0xFF;
+                    }
+
+#ifndef WIISCRIPT_HOST
+        DCFlushRange(texels, bytes);
+        GX_InitTexObj(&texture, texels, width, height, GX_TF_IA8, GX_CLAMP, GX_CLAMP, GX_FALSE);
+        GX_InitTexObjLOD(&texture, GX_NEAR, GX_NEAR, 0.0f, 0.0f, 0.0f, GX_FALSE, GX_FALSE, GX_ANISO_1);
+#endif
+
+        const uint32_t maxCodepoint = d.glyphs.empty() ? 0 : d.glyphs.back().codepoint;
+        glyphs.assign(std::min<uint32_t>(maxCodepoint, 0xFFFF) + 1, {});
+        for (const FontAtlas::Glyph& g : d.glyphs)
+        {
+            if (g.codepoint >= glyphs.size()) continue;
+            glyphs[g.codepoint] = {
+                .s0 = static_cast<float>(g.x) / width, .t0 = static_cast<float>(g.y) / height,
+                .s1 = static_cast<float>(g.x + g.w) / width, .t1 = static_cast<float>(g.y + g.h) / height,
+                .left = g.left, .top = g.top, .w = g.w, .h = g.h, .advance = static_cast<int16_t>(g.advance),
+                .present = true
+            };
+        }
+        kerning = d.kerning;
+
+        return true;
+    }
+
+    [[nodiscard]] int kern(const uint32_t left, const uint32_t right) const
+    {
+        const auto it = std::lower_bound(kerning.begin(), kerning.end(), std::make_pair(left, right),
+                                         [](const FontAtlas::Kerning& k, const std::pair<uint32_t, uint32_t>& key)
+                                         {
+                                             return k.left != key.first ? k.left < key.first : k.right < key.second;
+                                         });
+
+        return it != kerning.end() && it->left == left && it->right == right ? it->dx : 0;
+    }
+
+    // Calls emit(glyph, penX) in order; returns the advance width, or -1 if a glyph is missing from the atlas.
+    template <typename F>
+    int layout(const std::string_view text, F&& emit) const
+    {
+        int pen = 0;
+        uint32_t prev = 0;
+        for (size_t i = 0; i < text.size();)
+        {
+            const uint32_t cp = nextCodepoint(text, i);
+            if (cp >= glyphs.size() || !glyphs[cp].present) return -1;
+
+            const Glyph& g = glyphs[cp];
+            if (prev && !kerning.empty()) pen += kern(prev, cp);
+            emit(g, pen);
+            pen += g.advance;
+            prev = cp;
+        }
+
+        return pen;
+    }
+
+    bool draw(const std::string_view text, const float x, const float baseline, const uint32_t color) const
+    {
+        quads.clear();
+        const int advance = layout(text, [&](const Glyph& g, const int pen)
+        {
+            if (g.w == 0 || g.h == 0) return;
+            const float x0 = x + static_cast<float>(pen + g.left), y0 = baseline - static_cast<float>(g.top);
+            quads.push_back({x0, y0, x0 + g.w, y0 + g.h, g.s0, g.t0, g.s1, g.t1});
+        });
+        if (advance < 0) return false;
+        if (quads.empty()) return true;
+
+#ifdef WIISCRIPT_HOST
+        std::vector<guVector> vertices;
+        std::vector<uint32_t> colors(quads.size() * 4, color);
+        for (const Quad& q : quads)
+            vertices.insert(vertices.end(), {{q.x0, q.y0, 0}, {q.x1, q.y0, 0}, {q.x1, q.y1, 0}, {q.x0, q.y1, 0}});
+
+        HostGfx::stats().textCalls++;
+        GRRLIB_GXEngine(vertices.data(), colors.data(), static_cast<uint16_t>(vertices.size()), GX_QUADS);
+#else
+        GX_LoadTexObj(const_cast<GXTexObj*>(&texture), GX_TEXMAP0);
+        GX_SetTevOp(GX_TEVSTAGE0, GX_MODULATE);
+        GX_SetVtxDesc(GX_VA_TEX0, GX_DIRECT);
+
+        for (size_t at = 0; at < quads.size(); at += MAX_QUADS)
+        {
+            const size_t n = std::min(MAX_QUADS, quads.size() - at);
+            GX_Begin(GX_QUADS, GX_VTXFMT0, static_cast<u16>(n * 4));
+            for (size_t i = at; i < at + n; ++i)
+            {
+                const Quad& q = quads[i];
+                GX_Position3f32(q.x0, q.y0, 0);
+                GX_Color1u32(color);
+                GX_TexCoord2f32(q.s0, q.t0);
+                GX_Position3f32(q.x1, q.y0, 0);
+                GX_Color1u32(color);
+                GX_TexCoord2f32(q.s1, q.t0);
+                GX_Position3f32(q.x1, q.y1, 0);
+                GX_Color1u32(color);
+                GX_TexCoord2f32(q.s1, q.t1);
+                GX_Position3f32(q.x0, q.y1, 0);
+                GX_Color1u32(color);
+                GX_TexCoord2f32(q.s0, q.t1);
+            }
+            GX_End();
+        }
+
+        GX_SetTevOp(GX_TEVSTAGE0, GX_PASSCLR);
+        GX_SetVtxDesc(GX_VA_TEX0, GX_NONE);
+#endif
+
+        return true;
+    }
+};
+
+Font::Font() = default;
+Font::~Font() = default;
+
+bool Font::load(const std::string& path, const int size) { return read(path, size) && open(); }
+
+bool Font::read(const std::string& path, const int size)
 {
+    MEMORY_SCOPE(Fonts);
+    font.reset();
     data.clear();
-    if (!FileSystem::readFile(path, data)) return false;
+    atlas.reset();
+    ttfPath = path;
+    fontSize = size;
+    ttfTried = false;
+
+    if (std::vector<uint8_t> baked; FileSystem::readFile(FontAtlas::bakedPath(path, size), baked))
+    {
+        FontAtlas::Data d;
+        if (FontAtlas::decode(baked, d) && d.size == size)
+        {
+            atlas = std::make_unique<Atlas>();
+            if (atlas->upload(d)) return true;
+            atlas.reset();
+        }
+    }
+
+    return FileSystem::readFile(ttfPath, data);
+}
+
+bool Font::open() { return atlas || loadTtf(); }
+
+bool Font::loadTtf() const
+{
+    if (font) return true;
+    if (ttfTried) return false;
+    ttfTried = true;
+
+    MEMORY_SCOPE(Fonts);
+    if (data.empty() && !FileSystem::readFile(ttfPath, data)) return false;
     GRRLIB_ttfFont* f = GRRLIB_LoadTTF(data.data(), static_cast<int>(data.size()));
-    if (!f) return false;
+    if (!f)
+    {
+        data.clear();
+        return false;
+    }
 
     font.reset(f);
-    fontSize = size;
 
     return true;
 }
 
 void Font::drawText(const std::string_view text, const float x, const float y, const uint32_t color) const
 {
-    if (!font || text.empty()) return;
+    if (text.empty()) return;
+    if (atlas && atlas->draw(text, std::round(x), std::round(y) + static_cast<float>(fontSize), color)) return;
+    if (!loadTtf()) return;
+
     GRRLIB_PrintfTTF(static_cast<int>(std::round(x)), static_cast<int>(std::round(y)), font.get(), text.data(),
                      fontSize, color);
 }
 
 float Font::textWidth(const std::string_view text) const
 {
-    if (!font) return 0.0f;
+    if (atlas)
+        if (const int w = atlas->layout(text, [](const Atlas::Glyph&, int) {}); w >= 0) return static_cast<float>(w);
+    if (!loadTtf()) return 0.0f;
+
     return static_cast<float>(GRRLIB_WidthTTF(font.get(), text.data(), fontSize));
 }
 
 float Font::textHeight() const { return static_cast<float>(fontSize); }
+bool Font::isBaked() const { return atlas != nullptr; }
@@ -9,16 +9,32 @@
 class Font
 {
 public:
+    Font();
+    ~Font();
+
+    // Prefers the prebaked atlas next to the TTF; the TTF itself is only opened for glyphs the atlas lacks.
     bool load(const std::string& path, int size);
+
+    // load() in two steps: read() only does SD I/O and CPU work, so it may run off the main thread; open() hands the
+    // TTF to FreeType when there is no atlas and needs GRRLIB_Init.
+    bool read(const std::string& path, int size);
+    bool open();
     void drawText(std::string_view text, float x, float y, uint32_t color) const;
 
     [[nodiscard]] float textWidth(std::string_view text) const;
     [[nodiscard]] float textHeight() const;
+    [[nodiscard]] bool isBaked() const;
 
 private:
     using FontPtr = std::unique_ptr<GRRLIB_ttfFont, decltype(&GRRLIB_FreeTTF)>;
+    struct Atlas;
 
-    FontPtr font = {nullptr, &GRRLIB_FreeTTF};
-    std::vector<uint8_t> data;
+    mutable FontPtr font = {nullptr, &GRRLIB_FreeTTF};
+    mutable std::vector<uint8_t> data;
+    std::unique_ptr<Atlas> atlas;
+    std::string ttfPath;
     int fontSize = 16;
+    mutable bool ttfTried = false;
+
+    bool loadTtf() const;
 };
@@ -0,0 +1,109 @@
+#include "./font_atlas.h"
+
+#include <cstring>
+
+static constexpr size_t HEADER_BYTES = 16, GLYPH_BYTES = 14, KERNING_BYTES = 9;
+
+static void put16(std::vector<uint8_t>& out, const uint16_t v)
+{
+    out.push_back(static_cast<uint8_t>(v));
+    out.push_back(static_cast<uint8_t>(v >> 8));
+}
+
+static void put32(std::vector<uint8_t>& out, const uint32_t v)
+{
+    put16(out, static_cast<uint16_t>(v));
+    put16(out, static_cast<uint16_t>(v >> 16));
+}
+
+static uint16_t get16(const uint8_t* p) { return static_cast<uint16_t>(p[0] | p[1] << 8); }
+static uint32_t get32(const uint8_t* p) { return get16(p) | static_cast<uint32_t>(get16(p + 2)) << 16; }
+
+void FontAtlas::encode(const Data& data, std::vector<uint8_t>& out)
+{
+    out.assign(std::begin(MAGIC), std::end(MAGIC));
+    out.push_back(VERSION);
+    out.push_back(0);
+    put16(out, data.size);
+    put16(out, data.width);
+    put16(out, data.height);
+    put16(out, static_cast<uint16_t>(data.glyphs.size()));
+    put16(out, static_cast<uint16_t>(data.kerning.size()));
+
+    for (const Glyph& g : data.glyphs)
+    {
+        put32(out, g.codepoint);
+        put16(out, g.x);
+        put16(out, g.y);
+        out.push_back(g.w);
+        out.push_back(g.h);
+        out.push_back(static_cast<uint8_t>(g.left));
+        out.push_back(static_cast<uint8_t>(g.top));
+        put16(out, g.advance);
+    }
+    for (const Kerning& k : data.kerning)
+    {
+        put32(out, k.left);
+        put32(out, k.right);
+        out.push_back(static_cast<uint8_t>(k.dx));
+    }
+
+    out.insert(out.end(), data.coverage.begin(), data.coverage.end());
+}
+
+bool FontAtlas::decode(const std::vector<uint8_t>& in, Data& out, std::string* outError)
+{
+    if (in.size() < HEADER_BYTES || std::memcmp(in.data(), MAGIC, 4) != 0 || in[4] != VERSION)
+    {
+        if (outError) *outError = "Not a supported font atlas.";
+        return false;
+    }
+
+    const uint8_t* p = in.data() + 6;
+    out.size = get16(p);
+    out.width = get16(p + 2);
+    out.height = get16(p + 4);
+    const size_t glyphCount = get16(p + 6), kerningCount = get16(p + 8),
+                 pixels = static_cast<size_t>(out.width) * out.height;
+
+    if (in.size() != HEADER_BYTES + glyphCount * GLYPH_BYTES + kerningCount * KERNING_BYTES + pixels)
+    {
+        if (outError) *outError = "Font atlas is truncated.";
+        return false;
+    }
+
+    p = in.data() + HEADER_BYTES;
+    out.glyphs.resize(glyphCount);
+    for (Glyph& g : out.glyphs)
+    {
+        g = {.codepoint = get32(p), .x = get16(p + 4), .y = get16(p + 6), .w = p[8], .h = p[9],
+             .left = static_cast<int8_t>(p[10]), .top = static_cast<int8_t>(p[11]), .advance = get16(p + 12)};
+        if (g.x + g.w > out.width || g.y + g.h > out.height)
+        {
+            if (outError) *outError = "Font atlas glyph lies outside the atlas.";
+            return false;
+        }
+        p += GLYPH_BYTES;
+    }
+
+    out.kerning.resize(kerningCount);
+    for (Kerning& k : out.kerning)
+    {
+        k = {.left = get32(p), .right = get32(p + 4), .dx = static_cast<int8_t>(p[8])};
+        p += KERNING_BYTES;
+    }
+
+    out.coverage.assign(p, p + pixels);
+
+    return true;
+}
+
+std::string FontAtlas::bakedPath(const std::string& ttfPath, const int size)
+{
+    const size_t dot = ttfPath.find_last_of('.'), slash = ttfPath.find_last_of('/');
+    const std::string stem = dot != std::string::npos && (slash == std::string::npos || dot > slash)
+                                 ? ttfPath.substr(0, dot)
+                                 : ttfPath;
+
+    return stem + "-" + std::to_string(size) + ".wsf";
+}
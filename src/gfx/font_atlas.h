@@ -0,0 +1,43 @@
+#pragma once
+
+#include <string>
+#include <vector>
+#include <cstdint>
+
+// Pre-rasterized glyphs for one font size, produced at build time by the host fontbake tool. Metrics follow
+// GRRLIB_PrintfTTF: the pen starts at the left edge, the baseline sits one font size below the top.
+namespace FontAtlas
+{
+    constexpr char MAGIC[4] = {'W', 'S', 'F', 'A'};
+    constexpr uint8_t VERSION = 1;
+
+    struct Glyph
+    {
+        uint32_t codepoint = 0;
+        uint16_t x = 0, y = 0;
+        uint8_t w = 0, h = 0;
+        int8_t left = 0, top = 0;
+        uint16_t advance = 0;
+    };
+
+    struct Kerning
+    {
+        uint32_t left = 0, right = 0;
+        int8_t dx = 0;
+    };
+
+    struct Data
+    {
+        uint16_t size = 0, width = 0, height = 0;
+        std::vector<Glyph> glyphs;
+        std::vector<Kerning> kerning;
+        std::vector<uint8_t> coverage;
+    };
+
+    // Glyphs are sorted by codepoint and kerning pairs by (left, right); coverage is width * height bytes.
+    void encode(const Data& data, std::vector<uint8_t>& out);
+    bool decode(const std::vector<uint8_t>& in, Data& out, std::string* outError = nullptr);
+
+    // "code.ttf" at 16 px is baked to "code-16.wsf" next to it.
+    [[nodiscard]] std::string bakedPath(const std::string& ttfPath, int size);
+}
@@ -0,0 +1,37 @@
+#include "./present.h"
+
+#include <grrlib.h>
+
+#ifdef WIISCRIPT_HOST
+
+void presentFrame() { GRRLIB_Render(); }
+void presentIdle() {}
+
+#else
+
+#include <ogc/video.h>
+
+// Mirrors GRRLIB_Render(), except the display copy leaves the EFB intact.
+void presentFrame()
+{
+    GX_DrawDone();
+    GX_InvalidateTexAll();
+
+    fb ^= 1;
+    GX_SetZMode(GX_TRUE, GX_LEQUAL, GX_TRUE);
+    GX_SetColorUpdate(GX_TRUE);
+    GX_CopyDisp(xfb[fb], GX_FALSE);
+
+    VIDEO_SetNextFramebuffer(xfb[fb]);
+    VIDEO_Flush();
+    VIDEO_WaitVSync();
+    if (rmode->viTVMode & VI_NON_INTERLACE) VIDEO_WaitVSync();
+}
+
+void presentIdle()
+{
+    VIDEO_WaitVSync();
+    if (rmode->viTVMode & VI_NON_INTERLACE) VIDEO_WaitVSync();
+}
+
+#endif
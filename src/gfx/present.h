@@ -0,0 +1,8 @@
+#pragma once
+
+// Copies the EFB to the next external framebuffer without clearing it, so the next frame only has to redraw its
+// damaged areas on top of the previous image.
+void presentFrame();
+
+// Nothing changed: keep scanning out the current framebuffer and wait for the next retrace.
+void presentIdle();
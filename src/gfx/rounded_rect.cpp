@@ -0,0 +1,133 @@
+#include "./rounded_rect.h"
+
+#include <bit>
+#include <cstddef>
+
+static constexpr size_t MAX_BATCH_VERTICES = 65532;
+
+static std::array<GeometryCache::RoundedRect, GeometryCache::SLOTS> slots;
+static GeometryCache::Stats cacheStats;
+
+static size_t slotFor(const float w, const float h, const float rx, const float ry, const bool filled)
+{
+    uint32_t hash = filled ? 0x9E3779B9u : 0u;
+    for (const float f : {w, h, rx, ry})
+    {
+        hash ^= std::bit_cast<uint32_t>(f) + 0x9E3779B9u + (hash << 6) + (hash >> 2);
+        hash = (hash ^ (hash >> 16)) * 0x45D9F3Bu;
+    }
+
+    return (hash ^ (hash >> 16)) % GeometryCache::SLOTS;
+}
+
+const GeometryCache::RoundedRect* GeometryCache::roundedRect(const float w, const float h, const float radiusX,
+                                                             const float radiusY, const bool filled)
+{
+    if (w <= 0.0f || h <= 0.0f || radiusX <= 0.0f || radiusY <= 0.0f) return nullptr;
+
+    RoundedRect& slot = slots[slotFor(w, h, radiusX, radiusY, filled)];
+    if (slot.count > 0 && slot.w == w && slot.h == h && slot.radiusX == radiusX && slot.radiusY == radiusY &&
+        slot.filled == filled)
+    {
+        cacheStats.hits++;
+        return &slot;
+    }
+
+    RoundedOutline outline = {};
+    if (!roundedRectOutline(0.0f, 0.0f, w, h, radiusX, radiusY, outline)) return nullptr;
+    cacheStats.misses++;
+
+    slot = {.w = w, .h = h, .radiusX = radiusX, .radiusY = radiusY, .filled = filled};
+    auto push = [&](const guVector& v) { slot.vertices[slot.count++] = v; };
+
+    if (filled)
+    {
+        for (int k = 1; k + 2 < VERTICES; k += 2)
+        {
+            push(outline[0]);
+            for (int j = 0; j < 3; ++j) push(outline[k + j]);
+        }
+    }
+    else
+    {
+        for (int k = 0; k + 1 < VERTICES; ++k)
+        {
+            push(outline[k]);
+            push(outline[k + 1]);
+        }
+    }
+
+    return &slot;
+}
+
+const GeometryCache::Stats& GeometryCache::stats() { return cacheStats; }
+
+void GeometryCache::clear()
+{
+    for (RoundedRect& slot : slots) slot.count = 0;
+    cacheStats = {};
+}
+
+bool appendRoundedRect(const RoundedRectDraw& r, const bool filled, std::vector<guVector>& vertices,
+                       std::vector<uint32_t>& colors)
+{
+    const GeometryCache::RoundedRect* g = GeometryCache::roundedRect(r.w, r.h, r.radiusX, r.radiusY, filled);
+    if (!g) return false;
+
+    const size_t at = vertices.size();
+    vertices.insert(vertices.end(), g->vertices.begin(), g->vertices.begin() + g->count);
+    colors.insert(colors.end(), g->count, r.color);
+
+    for (auto it = vertices.begin() + static_cast<ptrdiff_t>(at); it != vertices.end(); ++it)
+    {
+        it->x += r.x;
+        it->y += r.y;
+    }
+
+    return true;
+}
+
+void roundedRectangle(const float x, const float y, const float width, const float height, const float radiusX,
+                      const float radiusY, const uint32_t color, const bool filled)
+{
+    const RoundedRectDraw r = {x, y, width, height, radiusX, radiusY, color};
+    roundedRectangles(&r, 1, filled);
+}
+
+void roundedRectangles(const RoundedRectDraw* rects, const size_t count, const bool filled)
+{
+    static std::vector<guVector> vertices;
+    static std::vector<uint32_t> colors;
+
+    const uint8_t primitive = filled ? GX_QUADS : GX_LINES;
+    auto submit = [&]
+    {
+        if (vertices.empty()) return;
+
+        GRRLIB_GXEngine(vertices.data(), colors.data(), static_cast<uint16_t>(vertices.size()), primitive);
+        vertices.clear();
+        colors.clear();
+    };
+
+    for (size_t i = 0; i < count; ++i)
+    {
+        const RoundedRectDraw& r = rects[i];
+        if (r.w <= 0.0f || r.h <= 0.0f) continue;
+        if (vertices.size() + GeometryCache::MAX_VERTICES > MAX_BATCH_VERTICES) submit();
+        if (appendRoundedRect(r, filled, vertices, colors)) continue;
+
+        const float x1 = r.x + r.w, y1 = r.y + r.h;
+        const guVector corners[] = {{r.x, r.y, 0.0f}, {x1, r.y, 0.0f}, {x1, y1, 0.0f}, {r.x, y1, 0.0f}};
+        for (int k = 0; k < 4; ++k)
+        {
+            vertices.push_back(corners[k]);
+            colors.push_back(r.color);
+            if (filled) continue;
+
+            vertices.push_back(corners[(k + 1) % 4]);
+            colors.push_back(r.color);
+        }
+    }
+
+    submit();
+}
@@ -0,0 +1,44 @@
+#pragma once
+
+#include "./drawing.h"
+
+#include <vector>
+#include <cstdint>
+
+namespace GeometryCache
+{
+    constexpr size_t SLOTS = 64, MAX_VERTICES = 2 * (VERTICES - 1);
+
+    // Origin-relative vertices: quads fanned from the first outline point when filled, line pairs otherwise.
+    struct RoundedRect
+    {
+        float w = 0, h = 0, radiusX = 0, radiusY = 0;
+        bool filled = false;
+        uint16_t count = 0;
+        std::array<guVector, MAX_VERTICES> vertices = {};
+    };
+
+    struct Stats
+    {
+        uint64_t hits = 0, misses = 0;
+    };
+
+    // nullptr when the clamped radii leave square corners.
+    [[nodiscard]] const RoundedRect* roundedRect(float w, float h, float radiusX, float radiusY, bool filled);
+    [[nodiscard]] const Stats& stats();
+    void clear();
+}
+
+struct RoundedRectDraw
+{
+    float x = 0, y = 0, w = 0, h = 0, radiusX = 0, radiusY = 0;
+    uint32_t color = 0xFFFFFFFF;
+};
+
+// Appends translated cached geometry; false when the rect has square corners and nothing was added.
+bool appendRoundedRect(const RoundedRectDraw& r, bool filled, std::vector<guVector>& vertices,
+                       std::vector<uint32_t>& colors);
+
+void roundedRectangle(float x, float y, float width, float height, float radiusX, float radiusY, uint32_t color,
+                      bool filled);
+void roundedRectangles(const RoundedRectDraw* rects, size_t count, bool filled);
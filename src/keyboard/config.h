@@ -1,5 +1,7 @@
 #pragma once
 
+#include <cstddef>
+
 enum class KeyAction { Text, Backspace, Tab, Enter, Caps, Shift };
 
 struct KeyboardKey
@@ -31,16 +31,33 @@ KeyButton::KeyButton(KeyCollection& keys, Font& font, const size_t keyIndex)
 
 size_t KeyButton::index() const { return keyIndex; }
 
-void KeyButton::onDraw() const
+void KeyButton::drawStatic(CommandBuffer& out) const
+{
+    if (!visible) return;
+    const Rect r = worldBounds();
+
+    out.roundedRect(r.x, r.y, r.w, r.h, radiusX, radiusY, enabled ? theme().btn : theme().btnDisabled, true);
+    out.roundedRect(r.x, r.y, r.w, r.h, radiusX, radiusY, theme().panelBorder, false);
+    drawLabel(out);
+}
+
+void KeyButton::onDraw(CommandBuffer& out) const
+{
+    if (!hovered && !pressed) return;
+
+    Button::onDraw(out);
+    drawLabel(out);
+}
+
+void KeyButton::drawLabel(CommandBuffer& out) const
 {
-    Button::onDraw();
     if (!keys || !font) return;
 
     const auto& k = keys->keyAt(keyIndex);
     const char* label = getLabelForKey(k, keys->caps, keys->shift);
     const Rect r = worldBounds();
 
-    font->drawText(label, r.x + (r.w - font->textWidth(label)) / 2, r.y + (r.h - font->textHeight()) / 2, theme().text);
+    out.text(label, r.x + (r.w - font->textWidth(label)) / 2, r.y + (r.h - font->textHeight()) / 2, theme().text, font);
 }
 
 Keyboard::Keyboard(Font& font) : font(&font)
@@ -66,10 +83,20 @@ Keyboard::Keyboard(Font& font) : font(&font)
 const std::string& Keyboard::getText() const { return textValue; }
 void Keyboard::setText(const std::string& str) { textValue = str; }
 
-void Keyboard::onDraw() const
+void Keyboard::onDraw(CommandBuffer& out) const
 {
     const Rect r = worldBounds();
-    roundedRectangle(r.x, r.y, r.w, r.h, radiusX, radiusY, theme().panel, true);
+    if (const CacheKey key = {r, keys.caps, keys.shift, themeVersion()}; !staticKeys.valid() || key != cacheKey)
+    {
+        CommandBuffer& rec = staticKeys.record();
+        rec.roundedRect(r.x, r.y, r.w, r.h, radiusX, radiusY, theme().panel, true);
+        for (const KeyButton* btn : keyButtons) btn->drawStatic(rec);
+
+        staticKeys.compile();
+        cacheKey = key;
+    }
+
+    staticKeys.replay(out);
 }
 
 void Keyboard::onUpdate(double)
@@ -83,6 +110,7 @@ void Keyboard::onUpdate(double)
 
 void Keyboard::layoutKeys() const
 {
+    staticKeys.invalidate();
     const Rect dest = {0.0f, 0.0f, bounds.w, bounds.h};
     const auto& keysList = keys.getKeys();
     const Rect src = computeBounds(keysList);
@@ -115,14 +143,17 @@ void Keyboard::activateKey(const char* keyText, const KeyAction action)
         break;
     case KeyAction::Caps:
         keys.caps = !keys.caps;
+        invalidate();
         break;
     case KeyAction::Shift:
         keys.shift = !keys.shift;
+        invalidate();
         break;
     case KeyAction::Text:
     default:
         if (keyText && keyText[0] != '\0')
         {
+            if (keys.shift) invalidate();
             keys.shift = false;
             textValue += keyText;
         }
@@ -12,8 +12,12 @@ public:
     KeyButton(KeyCollection& keys, Font& font, size_t keyIndex);
     [[nodiscard]] size_t index() const;
 
+    // Resting look, compiled into the keyboard's display list; onDraw only adds hover/press highlights on top.
+    void drawStatic(CommandBuffer& out) const;
+
 protected:
-    void onDraw() const override;
+    void onDraw(CommandBuffer& out) const override;
+    void drawLabel(CommandBuffer& out) const;
 
 private:
     KeyCollection* keys = nullptr;
@@ -32,10 +36,19 @@ public:
     std::function<void(const char* key, KeyAction action)> onKey;
 
 protected:
-    void onDraw() const override;
+    void onDraw(CommandBuffer& out) const override;
     void onUpdate(double) override;
 
 private:
+    struct CacheKey
+    {
+        Rect bounds = Rect::empty();
+        bool caps = false, shift = false;
+        uint32_t theme = 0;
+
+        bool operator==(const CacheKey&) const = default;
+    };
+
     void layoutKeys() const;
     void activateKey(const char* keyText, KeyAction action);
 
@@ -44,4 +57,7 @@ private:
     Font* font = nullptr;
     std::string textValue;
     Rect lastBounds = Rect::empty();
+
+    mutable DisplayList staticKeys = DisplayList(1024, 4096);
+    mutable CacheKey cacheKey;
 };
@@ -4,74 +4,264 @@
 #include <ogc/video.h>
 
 #include "./platform/platform.h"
+#include "./platform/startup.h"
 #include "./gfx/font.h"
+#include "./gfx/present.h"
+#include "./script/runtime.h"
 #include "./ui/ui_root.h"
+#include "./debug/profiler.h"
+#include "./debug/memory.h"
+
+static std::string numberedPath(const std::string& folder, const std::string& prefix, const std::string& ext)
+{
+    const std::string dir = FileSystem::join(FileSystem::workspaceRoot, folder);
+    for (int i = 1;; ++i)
+        if (std::string path = FileSystem::join(dir, prefix + "-" + std::to_string(i) + ext); !FileSystem::exists(path))
+            return path;
+}
 
 int main()
 {
     SYS_STDIO_Report(true);
-    VIDEO_Init();
-    GRRLIB_Init();
-    GRRLIB_SetBackgroundColour(0, 0, 0, 255);
+    Thread::init();
+    Time::init();
+
+    Input::TracePlayer replay;
+    Font codeFont, uiFont;
+    std::vector<FileSystem::DirEntry> workspace;
+    std::string replayError;
+    std::unique_ptr<GXBackend> scriptBackend;
+    std::unique_ptr<ScriptRuntime> scriptRuntime;
+    std::unique_ptr<UIRoot> uiRoot;
 
-    if (!Input::init())
+    using Lane = StartupPlan::Lane;
+    StartupPlan boot;
+    const size_t video = boot.add("video", Lane::Main, {}, [](std::string*)
     {
-        printf("Failed to initialize input!\n");
-        return EXIT_FAILURE;
-    }
-    if (!Time::init())
+        VIDEO_Init();
+        GRRLIB_Init();
+        GRRLIB_SetBackgroundColour(0, 0, 0, 255);
+        return true;
+    });
+    const size_t input = boot.add("input", Lane::Main, {}, [](std::string* err)
     {
-        printf("Failed to initialize time!\n");
-        return EXIT_FAILURE;
-    }
-    if (!FileSystem::init())
+        if (Input::init()) return true;
+        *err = "Failed to initialize input!";
+        return false;
+    });
+    const size_t fs = boot.add("filesystem", Lane::Io, {}, [](std::string* err)
     {
-        printf("Failed to initialize filesystem!\n");
-        return EXIT_FAILURE;
-    }
-    if (!FileSystem::ensureDir(FileSystem::workspaceRoot))
+        if (!FileSystem::init())
+        {
+            *err = "Failed to initialize filesystem!";
+            return false;
+        }
+        if (!FileSystem::ensureDir(FileSystem::workspaceRoot))
+        {
+            *err = "Failed to create workspace directory!";
+            return false;
+        }
+        return true;
+    });
+    const size_t fontsRead = boot.add("fonts.read", Lane::Io, {fs}, [&](std::string* err)
+    {
+        if (codeFont.read(FileSystem::appRoot + "code.ttf", 16) && uiFont.read(FileSystem::appRoot + "ui.ttf", 14))
+            return true;
+        *err = "Failed to read fonts!";
+        return false;
+    });
+    const size_t listing = boot.add("workspace", Lane::Io, {fs}, [&](std::string*)
+    {
+        FileSystem::listDir(FileSystem::workspaceRoot, workspace, true);
+        return true;
+    });
+    boot.add("replay", Lane::Io, {fs}, [&](std::string*)
+    {
+        if (FileSystem::exists(FileSystem::appRoot + "replay.wst"))
+            replay.load(FileSystem::appRoot + "replay.wst", &replayError);
+        return true;
+    });
+    const size_t fontsOpen = boot.add("fonts.open", Lane::Main, {video, fontsRead}, [&](std::string* err)
+    {
+        if (codeFont.open() && uiFont.open()) return true;
+        *err = "Failed to load fonts!";
+        return false;
+    });
+    const size_t scriptInit = boot.add("script", Lane::Main, {fontsOpen}, [&](std::string*)
+    {
+        scriptBackend = std::make_unique<GXBackend>(uiFont);
+        scriptRuntime = std::make_unique<ScriptRuntime>(*scriptBackend);
+        return true;
+    });
+    boot.add("ui", Lane::Main, {input, scriptInit, listing}, [&](std::string*)
+    {
+        uiRoot = std::make_unique<UIRoot>(640, 480, codeFont, uiFont, *scriptRuntime, &workspace);
+        return true;
+    });
+
+    std::string bootError;
+    const bool booted = boot.run(&bootError);
+    boot.log(stdout);
+    if (!booted)
     {
-        printf("Failed to create workspace directory!\n");
+        printf("%s\n", bootError.c_str());
         return EXIT_FAILURE;
     }
+    if (!replayError.empty()) printf("%s\n", replayError.c_str());
+
+    ScriptRuntime& script = *scriptRuntime;
+    UIRoot& ui = *uiRoot;
 
     double last = Time::seconds();
     Input::InputFrame frame = {};
     Input::KeyRepeat keyRepeat;
     std::vector<Input::InputEvent> events;
+    Input::TraceRecorder recorder;
+    const double replayStart = last;
+    bool interactive = false;
 
-    Font codeFont, uiFont;
-    if (!codeFont.load(FileSystem::appRoot + "code.ttf", 16))
-    {
-        printf("Failed to load code font!\n");
-        return EXIT_FAILURE;
-    }
-    if (!uiFont.load(FileSystem::appRoot + "ui.ttf", 14))
-    {
-        printf("Failed to load UI font!\n");
-        return EXIT_FAILURE;
-    }
-
-    UIRoot ui(640, 480, codeFont, uiFont);
+    Rect lastCursor = Rect::empty();
+    bool scriptWasRunning = false, profilerShown = false, memoryShown = false;
     while (true)
     {
-        Input::poll(&frame, events);
-        const double now = Time::seconds(), dt = now - last;
+        PROFILE_FRAME();
+        MEMORY_FRAME();
+
+        const bool replaying = replay.isPlaying();
+        {
+            PROFILE_ZONE("Input::poll");
+            Input::poll(&frame, events, replaying ? &replay : nullptr);
+        }
+        const double now = Time::seconds(), dt = replaying ? replay.fixedDt : now - last;
         last = now;
         keyRepeat.generate(frame, dt, events);
 
+        if (replaying && !replay.isPlaying())
+            printf("Replayed %zu frames in %.3f s (recorded %.3f s)\n", replay.position(), now - replayStart,
+                   replay.recordedSeconds());
+
+        if (Input::comboPressed(frame, {Input::Key::One, Input::Key::Two, Input::Key::Minus}))
+        {
+            if (std::string err; recorder.isRecording())
+            {
+                const size_t frames = recorder.frameCount();
+                if (recorder.stop(&err)) printf("Recorded %zu input frames\n", frames);
+                else printf("%s\n", err.c_str());
+            }
+            else recorder.start(numberedPath("traces", "trace", ".wst"));
+        }
+        recorder.record(frame, dt);
+#ifdef WIISCRIPT_PROFILE
+        if (Input::comboPressed(frame, {Input::Key::One, Input::Key::Two, Input::Key::Plus}))
+            Profiler::toggleOverlay();
+        if (Input::comboPressed(frame, {Input::Key::One, Input::Key::Two, Input::Key::B}))
+        {
+            if (std::string err; Profiler::isCapturing())
+            {
+                if (!Profiler::stopCapture(&err)) printf("%s\n", err.c_str());
+            }
+            else if (!Profiler::startCapture(numberedPath("captures", "capture", ".json")))
+                printf("Failed to start trace capture!\n");
+        }
+#endif
+#ifdef WIISCRIPT_MEMORY
+        if (Input::comboPressed(frame, {Input::Key::One, Input::Key::Two, Input::Key::Up})) Memory::toggleOverlay();
+#endif
+
         if (ui.quit) break;
-        GRRLIB_FillScreen(theme().bg);
 
-        ui.layout();
-        ui.update(dt);
-        for (const auto& e : events) ui.routeEvent(e);
-        ui.draw();
+        {
+            PROFILE_ZONE("ui.layout");
+            ui.layout();
+        }
+        {
+            PROFILE_ZONE("ui.update");
+            ui.update(dt);
+        }
+        {
+            PROFILE_ZONE("routeEvent");
+            for (const auto& e : events)
+            {
+                ui.routeEvent(e);
+                script.dispatch(e);
+            }
+        }
+        {
+            PROFILE_ZONE("script.update");
+            script.update(dt);
+        }
+
+        const bool scriptRunning = script.isRunning();
+        if (scriptRunning || scriptWasRunning) ui.damage.addAll();
+        scriptWasRunning = scriptRunning;
 
+        if (const Rect cursor = frame.pointer.valid ? Rect({frame.pointer.x - 4, frame.pointer.y - 4, 8, 8})
+                                                    : Rect::empty(); cursor != lastCursor)
+        {
+            ui.damage.add(lastCursor);
+            ui.damage.add(cursor);
+            lastCursor = cursor;
+        }
+#ifdef WIISCRIPT_PROFILE
+        if (profilerShown || Profiler::overlayVisible()) ui.damage.add(Profiler::overlayBounds());
+        profilerShown = Profiler::overlayVisible();
+#endif
+#ifdef WIISCRIPT_MEMORY
+        if (memoryShown || Memory::overlayVisible()) ui.damage.add(Memory::overlayBounds(uiFont));
+        memoryShown = Memory::overlayVisible();
+#endif
+
+        // The EFB still holds the last frame; with nothing damaged the frame is left to scripts and background work.
+        if (ui.damage.empty())
+        {
+            PROFILE_ZONE("idle");
+            presentIdle();
+            continue;
+        }
+#ifdef WIISCRIPT_PROFILE
+        Profiler::countRedraw(ui.damage.pixels());
+#endif
+
+        {
+            PROFILE_ZONE("ui.draw");
+            for (const Rect& r : ui.damage)
+            {
+                GX_SetScissor(static_cast<u32>(r.x), static_cast<u32>(r.y), static_cast<u32>(r.w),
+                              static_cast<u32>(r.h));
+                GRRLIB_FillScreen(theme().bg);
+                ui.draw(r);
+            }
+            GX_SetScissor(0, 0, 640, 480);
+            ui.damage.clear();
+        }
+        {
+            PROFILE_ZONE("script.draw");
+            script.draw();
+        }
+
+#ifdef WIISCRIPT_PROFILE
+        Profiler::drawOverlay(uiFont);
+#endif
+#ifdef WIISCRIPT_MEMORY
+        Memory::drawOverlay(uiFont);
+#endif
         if (frame.pointer.valid) GRRLIB_Circle(frame.pointer.x, frame.pointer.y, 3, theme().accent, true);
-        GRRLIB_Render();
+        {
+            PROFILE_ZONE("present");
+            presentFrame();
+        }
+        if (!interactive)
+        {
+            printf("startup: interactive at %.2f ms\n", Time::seconds() * 1000.0);
+            interactive = true;
+        }
     }
 
+    if (recorder.isRecording()) recorder.stop();
+#ifdef WIISCRIPT_PROFILE
+    if (Profiler::isCapturing()) Profiler::stopCapture();
+#endif
+
     GRRLIB_Exit();
     Input::exit();
 
@@ -1,4 +1,5 @@
 #include "./platform.h"
+#include "../debug/profiler.h"
 
 #include <cstring>
 #include <algorithm>
@@ -8,12 +9,33 @@
 #include <fat.h>
 
 static bool ready = false;
+static FileSystem::ChangeListener changeListener;
 
-static bool isInsideWorkspace(const std::string& path)
+static void notify(const FileSystem::Change change, const std::string& path, const std::string& to = {})
+{
+    if (changeListener) changeListener(change, path, to);
+}
+
+static std::string native(const std::string& path)
+{
+#ifdef WIISCRIPT_HOST
+    if (path == "sd:" || path.rfind("sd:/", 0) == 0) return FileSystem::hostSdRoot + path.substr(3);
+#endif
+    return path;
+}
+
+static bool isInside(const std::string& path, const std::string& root)
 {
     const std::string p = FileSystem::normalize(path);
     return !p.empty() && p != ".." && p.rfind("../", 0) != 0 && p.find("/../") == std::string::npos && (p.size() < 3 ||
-        p.compare(p.size() - 3, 3, "/..") != 0) && p.rfind(FileSystem::workspaceRoot, 0) == 0;
+        p.compare(p.size() - 3, 3, "/..") != 0) && p.rfind(root, 0) == 0;
+}
+
+static bool isInsideWorkspace(const std::string& path) { return isInside(path, FileSystem::workspaceRoot); }
+
+static bool isWritable(const std::string& path)
+{
+    return isInsideWorkspace(path) || isInside(path, FileSystem::cacheRoot);
 }
 
 static std::string trimSlash(std::string s)
@@ -56,15 +78,19 @@ static bool deleteDirRecursive(const std::string& dir)
     return std::all_of(entries.begin(), entries.end(), [&](const FileSystem::DirEntry& e)
     {
         const std::string path = e.path;
-        return e.isDir ? deleteDirRecursive(path) : remove(path.c_str()) == 0;
-    }) && rmdir(dir.c_str()) == 0;
+        return e.isDir ? deleteDirRecursive(path) : remove(native(path).c_str()) == 0;
+    }) && rmdir(native(dir).c_str()) == 0;
 }
 
 bool FileSystem::init()
 {
     if (ready) return true;
 
+#ifdef WIISCRIPT_HOST
+    ready = isDir("sd:/");
+#else
     ready = fatInitDefault();
+#endif
     return ready;
 }
 
@@ -90,7 +116,7 @@ bool FileSystem::ensureDir(const std::string& path)
         if (std::string part = j == std::string::npos ? p.substr(i) : p.substr(i, j - i); !part.empty())
         {
             cur = join(cur, part);
-            if (!isDir(cur) && mkdir(cur.c_str(), 0777) != 0 && errno != EEXIST) return false;
+            if (!isDir(cur) && mkdir(native(cur).c_str(), 0777) != 0 && errno != EEXIST) return false;
         }
 
         if (j == std::string::npos) break;
@@ -103,13 +129,13 @@ bool FileSystem::ensureDir(const std::string& path)
 bool FileSystem::exists(const std::string& path)
 {
     struct stat st = {};
-    return stat(normalize(path).c_str(), &st) == 0;
+    return stat(native(normalize(path)).c_str(), &st) == 0;
 }
 
 bool FileSystem::isDir(const std::string& path)
 {
     struct stat st = {};
-    if (stat(normalize(path).c_str(), &st) != 0) return false;
+    if (stat(native(normalize(path)).c_str(), &st) != 0) return false;
 
     return S_ISDIR(st.st_mode);
 }
@@ -146,11 +172,12 @@ std::string FileSystem::join(const std::string& a, const std::string& b)
 
 bool FileSystem::listDir(const std::string& path, std::vector<DirEntry>& outEntries, bool sort)
 {
+    PROFILE_ZONE("fs.listDir");
     outEntries.clear();
     const std::string p = normalize(path);
     if (p.empty()) return false;
 
-    DIR* dir = opendir(p.c_str());
+    DIR* dir = opendir(native(p).c_str());
     if (!dir) return false;
 
     while (true)
@@ -164,10 +191,11 @@ bool FileSystem::listDir(const std::string& path, std::vector<DirEntry>& outEntr
         DirEntry e = {.name = entry->d_name, .path = join(p, entry->d_name)};
 
         struct stat st = {};
-        if (stat(e.path.c_str(), &st) == 0)
+        if (stat(native(e.path).c_str(), &st) == 0)
         {
             e.isDir = S_ISDIR(st.st_mode);
             e.size = st.st_size;
+            e.mtime = static_cast<uint64_t>(st.st_mtime);
         }
         else
         {
@@ -188,94 +216,249 @@ bool FileSystem::listDir(const std::string& path, std::vector<DirEntry>& outEntr
     return true;
 }
 
+bool FileSystem::fileSize(const std::string& path, uint64_t& outSize)
+{
+    struct stat st = {};
+    if (stat(native(normalize(path)).c_str(), &st) != 0 || S_ISDIR(st.st_mode)) return false;
+
+    outSize = static_cast<uint64_t>(st.st_size);
+    return true;
+}
+
 bool FileSystem::readFile(const std::string& path, std::vector<uint8_t>& outData)
 {
     outData.clear();
-    const std::string p = normalize(path);
-    if (p.empty()) return false;
 
-    FILE* f = fopen(p.c_str(), "rb");
-    if (!f) return false;
+    uint64_t size = 0;
+    if (!fileSize(path, size)) return false;
 
-    if (fseek(f, 0, SEEK_END) != 0)
+    outData.resize(size);
+    if (!readFile(path, outData.data(), outData.size()))
     {
-        fclose(f);
+        outData.clear();
         return false;
     }
 
-    const long size = ftell(f);
-    if (size < 0)
-    {
-        fclose(f);
-        return false;
-    }
+    return true;
+}
 
-    if (fseek(f, 0, SEEK_SET) != 0)
-    {
-        fclose(f);
-        return false;
-    }
+bool FileSystem::readFile(const std::string& path, uint8_t* out, const size_t size, const uint64_t offset)
+{
+    PROFILE_ZONE("fs.readFile");
+    const std::string p = normalize(path);
+    if (p.empty() || (!out && size > 0)) return false;
 
-    outData.resize(size);
-    if (fread(outData.data(), 1, size, f) != static_cast<size_t>(size))
+    FILE* f = fopen(native(p).c_str(), "rb");
+    if (!f) return false;
+
+    if (fseek(f, static_cast<long>(offset), SEEK_SET) != 0)
     {
         fclose(f);
-        outData.clear();
-
         return false;
     }
 
+    const bool ok = size == 0 || fread(out, 1, size, f) == size;
     fclose(f);
-    return true;
+
+    return ok;
 }
 
 bool FileSystem::writeFile(const std::string& path, const std::vector<uint8_t>& data)
 {
+    return writeFile(path, data.data(), data.size());
+}
+
+bool FileSystem::writeFile(const std::string& path, const uint8_t* data, const size_t size)
+{
+    PROFILE_ZONE("fs.writeFile");
     const std::string p = normalize(path);
 
-    if (!isInsideWorkspace(p)) return false;
+    if (!isWritable(p) || (!data && size > 0)) return false;
     if (const auto slash = p.find_last_of('/'); slash != std::string::npos && !ensureDir(p.substr(0, slash)))
         return false;
 
     const std::string temp = p + ".tmp";
-    FILE* f = fopen(temp.c_str(), "wb");
+    FILE* f = fopen(native(temp).c_str(), "wb");
     if (!f) return false;
 
-    if (!data.empty() && fwrite(data.data(), 1, data.size(), f) != data.size())
+    if (size > 0 && fwrite(data, 1, size, f) != size)
     {
         fclose(f);
-        remove(temp.c_str());
+        remove(native(temp).c_str());
 
         return false;
     }
 
     fflush(f);
     fclose(f);
-    remove(p.c_str());
+    remove(native(p).c_str());
+
+    if (rename(native(temp).c_str(), native(p).c_str()) != 0) return false;
+    notify(Change::Written, p);
+
+    return true;
+}
+
+FileSystem::Writer::Writer(const size_t bufferSize) : buffer(bufferSize > 0 ? bufferSize : 1) {}
+FileSystem::Writer::~Writer() { discard(); }
+
+bool FileSystem::Writer::open(const std::string& path)
+{
+    discard();
 
-    return rename(temp.c_str(), p.c_str()) == 0;
+    const std::string p = normalize(path);
+    if (!isWritable(p)) return false;
+    if (const auto slash = p.find_last_of('/'); slash != std::string::npos && !ensureDir(p.substr(0, slash)))
+        return false;
+
+    this->path = p;
+    temp = p + ".tmp";
+    file = fopen(native(temp).c_str(), "wb");
+    used = 0;
+    written = 0;
+    failed = false;
+
+    return file != nullptr;
 }
 
+bool FileSystem::Writer::write(const void* data, const size_t size)
+{
+    if (!file || failed) return false;
+
+    const auto* bytes = static_cast<const uint8_t*>(data);
+    if (used + size > buffer.size() && !flush()) return false;
+    if (size >= buffer.size())
+    {
+        failed = fwrite(bytes, 1, size, file) != size;
+        written += failed ? 0 : size;
+
+        return !failed;
+    }
+
+    std::memcpy(buffer.data() + used, bytes, size);
+    used += size;
+    written += size;
+
+    return true;
+}
+
+bool FileSystem::Writer::flush()
+{
+    PROFILE_ZONE("fs.flush");
+    if (!file || failed) return false;
+    if (used > 0 && fwrite(buffer.data(), 1, used, file) != used) failed = true;
+    used = 0;
+
+    return !failed;
+}
+
+bool FileSystem::Writer::close()
+{
+    if (!file) return false;
+
+    const bool ok = flush();
+    fclose(file);
+    file = nullptr;
+
+    if (!ok)
+    {
+        remove(native(temp).c_str());
+        return false;
+    }
+
+    remove(native(path).c_str());
+    if (rename(native(temp).c_str(), native(path).c_str()) != 0) return false;
+    notify(Change::Written, path);
+
+    return true;
+}
+
+void FileSystem::Writer::discard()
+{
+    if (!file) return;
+
+    fclose(file);
+    file = nullptr;
+    remove(native(temp).c_str());
+}
+
+bool FileSystem::Writer::isOpen() const { return file != nullptr; }
+uint64_t FileSystem::Writer::size() const { return written; }
+
+FileSystem::Reader::~Reader() { close(); }
+
+bool FileSystem::Reader::open(const std::string& path)
+{
+    close();
+
+    const std::string p = normalize(path);
+    if (p.empty() || !fileSize(p, length)) return false;
+
+    file = fopen(native(p).c_str(), "rb");
+    position = 0;
+
+    return file != nullptr;
+}
+
+size_t FileSystem::Reader::read(void* out, const size_t size)
+{
+    PROFILE_ZONE("fs.read");
+    if (!file || (!out && size > 0)) return 0;
+
+    const size_t n = fread(out, 1, size, file);
+    position += n;
+
+    return n;
+}
+
+bool FileSystem::Reader::readAt(void* out, const size_t size, const uint64_t offset)
+{
+    if (!file) return false;
+    if (offset != position)
+    {
+        if (fseek(file, static_cast<long>(offset), SEEK_SET) != 0) return false;
+        position = offset;
+    }
+
+    return read(out, size) == size;
+}
+
+void FileSystem::Reader::close()
+{
+    if (!file) return;
+
+    fclose(file);
+    file = nullptr;
+}
+
+bool FileSystem::Reader::isOpen() const { return file != nullptr; }
+uint64_t FileSystem::Reader::size() const { return length; }
+
 bool FileSystem::makeDir(const std::string& path)
 {
+    PROFILE_ZONE("fs.makeDir");
     const std::string p = normalize(path);
     if (!isInsideWorkspace(p)) return false;
     if (p.empty()) return false;
     if (isDir(p)) return true;
 
-    return mkdir(p.c_str(), 0777) == 0 || errno == EEXIST;
+    return mkdir(native(p).c_str(), 0777) == 0 || errno == EEXIST;
 }
 
 bool FileSystem::renamePath(const std::string& from, const std::string& to)
 {
+    PROFILE_ZONE("fs.renamePath");
     const std::string src = normalize(from), dst = normalize(to);
-    return isInsideWorkspace(src) && isInsideWorkspace(dst) && exists(src) && !exists(dst)
-               ? rename(src.c_str(), dst.c_str()) == 0
-               : false;
+    if (!isInsideWorkspace(src) || !isInsideWorkspace(dst) || !exists(src) || exists(dst)) return false;
+    if (rename(native(src).c_str(), native(dst).c_str()) != 0) return false;
+    notify(Change::Renamed, src, dst);
+
+    return true;
 }
 
 bool FileSystem::copyPath(const std::string& from, const std::string& to)
 {
+    PROFILE_ZONE("fs.copyPath");
     const std::string src = trimSlash(from), dst = trimSlash(to);
 
     if (!isInsideWorkspace(src) || !isInsideWorkspace(dst)) return false;
@@ -287,8 +470,13 @@ bool FileSystem::copyPath(const std::string& from, const std::string& to)
 
 bool FileSystem::removePath(const std::string& path)
 {
+    PROFILE_ZONE("fs.removePath");
     const std::string p = trimSlash(path);
     if (!isInsideWorkspace(p) || !exists(p)) return false;
+    if (!(isDir(p) ? deleteDirRecursive(p) : remove(native(p).c_str()) == 0)) return false;
+    notify(Change::Removed, p);
 
-    return isDir(p) ? deleteDirRecursive(p) : remove(p.c_str()) == 0;
+    return true;
 }
+
+void FileSystem::setChangeListener(ChangeListener listener) { changeListener = std::move(listener); }
@@ -4,7 +4,28 @@
 #include <algorithm>
 #include <wiiuse/wpad.h>
 
+static constexpr struct
+{
+    Input::Key key;
+    uint32_t button;
+} BUTTONS[] = {
+    {Input::Key::Home, WPAD_BUTTON_HOME},
+    {Input::Key::Up, WPAD_BUTTON_UP},
+    {Input::Key::Down, WPAD_BUTTON_DOWN},
+    {Input::Key::Left, WPAD_BUTTON_LEFT},
+    {Input::Key::Right, WPAD_BUTTON_RIGHT},
+    {Input::Key::A, WPAD_BUTTON_A},
+    {Input::Key::B, WPAD_BUTTON_B},
+    {Input::Key::Plus, WPAD_BUTTON_PLUS},
+    {Input::Key::Minus, WPAD_BUTTON_MINUS},
+    {Input::Key::One, WPAD_BUTTON_1},
+    {Input::Key::Two, WPAD_BUTTON_2},
+    {Input::Key::C, WPAD_NUNCHUK_BUTTON_C},
+    {Input::Key::Z, WPAD_NUNCHUK_BUTTON_Z},
+};
+
 static Input::PointerState lastPtr = {};
+static float scrollAccumX = 0.0f, scrollAccumY = 0.0f;
 
 void Input::KeyRepeat::generate(const InputFrame& frame, const double dt, std::vector<InputEvent>& outEvents)
 {
@@ -53,12 +74,43 @@ bool Input::init()
 
 void Input::exit() { WPAD_Shutdown(); }
 
-void Input::poll(InputFrame* outFrame, std::vector<InputEvent>& outEvents)
+void Input::reset()
 {
-    outEvents.clear();
+    lastPtr = {};
+    scrollAccumX = scrollAccumY = 0.0f;
+}
+
+static void sample(Input::InputFrame& frame)
+{
+    frame = {};
     WPAD_ScanPads();
+    if (WPAD_Probe(WPAD_CHAN_0, nullptr) != WPAD_ERR_NONE) return;
+
+    ir_t ir;
+    WPAD_IR(WPAD_CHAN_0, &ir);
+
+    frame.connected = true;
+    frame.pointer = {.valid = ir.valid != 0, .x = ir.x, .y = ir.y,};
+    frame.wpadDown = WPAD_ButtonsDown(WPAD_CHAN_0);
+    frame.wpadHeld = WPAD_ButtonsHeld(WPAD_CHAN_0);
+    frame.wpadUp = WPAD_ButtonsUp(WPAD_CHAN_0);
+
+    expansion_t exp;
+    WPAD_Expansion(WPAD_CHAN_0, &exp);
+
+    if (exp.type == WPAD_EXP_NUNCHUK)
+    {
+        frame.nunchuk = true;
+        frame.stickX = static_cast<int8_t>(std::clamp(exp.nunchuk.js.pos.x - exp.nunchuk.js.center.x, -128, 127));
+        frame.stickY = static_cast<int8_t>(std::clamp(exp.nunchuk.js.pos.y - exp.nunchuk.js.center.y, -128, 127));
+    }
+}
+
+static void translate(const Input::InputFrame& frame, std::vector<Input::InputEvent>& outEvents)
+{
+    using Input::InputEvent;
 
-    if (WPAD_Probe(WPAD_CHAN_0, nullptr) != WPAD_ERR_NONE)
+    if (!frame.connected)
     {
         if (lastPtr.valid)
         {
@@ -68,73 +120,29 @@ void Input::poll(InputFrame* outFrame, std::vector<InputEvent>& outEvents)
         return;
     }
 
-    const uint32_t down = WPAD_ButtonsDown(WPAD_CHAN_0), held = WPAD_ButtonsHeld(WPAD_CHAN_0),
-                   up = WPAD_ButtonsUp(WPAD_CHAN_0);
-    ir_t ir;
-    WPAD_IR(WPAD_CHAN_0, &ir);
-
-    const PointerState p = {.valid = ir.valid != 0, .x = ir.x, .y = ir.y,};
+    const Input::PointerState& p = frame.pointer;
     if (p.valid != lastPtr.valid || p.x != lastPtr.x || p.y != lastPtr.y)
     {
         outEvents.push_back({.type = InputEvent::Type::Pointer, .pointer = p});
         lastPtr = p;
     }
 
-    if (outFrame)
+    for (const auto& [key, button] : BUTTONS)
     {
-        outFrame->pointer = p;
-        outFrame->wpadDown = down;
-        outFrame->wpadHeld = held;
-        outFrame->wpadUp = up;
+        if (frame.wpadDown & button) outEvents.push_back({.type = InputEvent::Type::KeyDown, .key = key});
+        if (frame.wpadUp & button) outEvents.push_back({.type = InputEvent::Type::KeyUp, .key = key});
     }
 
-    if (down & WPAD_BUTTON_HOME) outEvents.push_back({.type = InputEvent::Type::KeyDown, .key = Key::Home});
-    if (up & WPAD_BUTTON_HOME) outEvents.push_back({.type = InputEvent::Type::KeyUp, .key = Key::Home});
-
-    if (down & WPAD_BUTTON_UP) outEvents.push_back({.type = InputEvent::Type::KeyDown, .key = Key::Up});
-    if (up & WPAD_BUTTON_UP) outEvents.push_back({.type = InputEvent::Type::KeyUp, .key = Key::Up});
-    if (down & WPAD_BUTTON_DOWN) outEvents.push_back({.type = InputEvent::Type::KeyDown, .key = Key::Down});
-    if (up & WPAD_BUTTON_DOWN) outEvents.push_back({.type = InputEvent::Type::KeyUp, .key = Key::Down});
-    if (down & WPAD_BUTTON_LEFT) outEvents.push_back({.type = InputEvent::Type::KeyDown, .key = Key::Left});
-    if (up & WPAD_BUTTON_LEFT) outEvents.push_back({.type = InputEvent::Type::KeyUp, .key = Key::Left});
-    if (down & WPAD_BUTTON_RIGHT) outEvents.push_back({.type = InputEvent::Type::KeyDown, .key = Key::Right});
-    if (up & WPAD_BUTTON_RIGHT) outEvents.push_back({.type = InputEvent::Type::KeyUp, .key = Key::Right});
-
-    if (down & WPAD_BUTTON_A) outEvents.push_back({.type = InputEvent::Type::KeyDown, .key = Key::A});
-    if (up & WPAD_BUTTON_A) outEvents.push_back({.type = InputEvent::Type::KeyUp, .key = Key::A});
-    if (down & WPAD_BUTTON_B) outEvents.push_back({.type = InputEvent::Type::KeyDown, .key = Key::B});
-    if (up & WPAD_BUTTON_B) outEvents.push_back({.type = InputEvent::Type::KeyUp, .key = Key::B});
-
-    if (down & WPAD_BUTTON_PLUS) outEvents.push_back({.type = InputEvent::Type::KeyDown, .key = Key::Plus});
-    if (up & WPAD_BUTTON_PLUS) outEvents.push_back({.type = InputEvent::Type::KeyUp, .key = Key::Plus});
-    if (down & WPAD_BUTTON_MINUS) outEvents.push_back({.type = InputEvent::Type::KeyDown, .key = Key::Minus});
-    if (up & WPAD_BUTTON_MINUS) outEvents.push_back({.type = InputEvent::Type::KeyUp, .key = Key::Minus});
-
-    if (down & WPAD_BUTTON_1) outEvents.push_back({.type = InputEvent::Type::KeyDown, .key = Key::One});
-    if (up & WPAD_BUTTON_1) outEvents.push_back({.type = InputEvent::Type::KeyUp, .key = Key::One});
-    if (down & WPAD_BUTTON_2) outEvents.push_back({.type = InputEvent::Type::KeyDown, .key = Key::Two});
-    if (up & WPAD_BUTTON_2) outEvents.push_back({.type = InputEvent::Type::KeyUp, .key = Key::Two});
-
-    if (down & WPAD_NUNCHUK_BUTTON_C) outEvents.push_back({.type = InputEvent::Type::KeyDown, .key = Key::C});
-    if (up & WPAD_NUNCHUK_BUTTON_C) outEvents.push_back({.type = InputEvent::Type::KeyUp, .key = Key::C});
-    if (down & WPAD_NUNCHUK_BUTTON_Z) outEvents.push_back({.type = InputEvent::Type::KeyDown, .key = Key::Z});
-    if (up & WPAD_NUNCHUK_BUTTON_Z) outEvents.push_back({.type = InputEvent::Type::KeyUp, .key = Key::Z});
-
-    expansion_t exp;
-    WPAD_Expansion(WPAD_CHAN_0, &exp);
-
-    if (exp.type == WPAD_EXP_NUNCHUK)
+    if (frame.nunchuk)
     {
         constexpr float deadZone = 10.0f;
-        auto dx = static_cast<float>(exp.nunchuk.js.pos.x - exp.nunchuk.js.center.x),
-             dy = static_cast<float>(exp.nunchuk.js.pos.y - exp.nunchuk.js.center.y);
+        auto dx = static_cast<float>(frame.stickX), dy = static_cast<float>(frame.stickY);
 
         if (float mag = std::sqrt(dx * dx + dy * dy); mag > deadZone)
         {
             float strength = (mag - deadZone) / (100.0f - deadZone);
             strength = std::clamp(strength, 0.0f, 1.0f);
 
-            static float scrollAccumX = 0.0f, scrollAccumY = 0.0f;
             scrollAccumX += strength * 3.0f * (dx > 0 ? 1.0f : -1.0f);
             scrollAccumY += strength * 3.0f * (dy > 0 ? -1.0f : 1.0f);
 
@@ -147,3 +155,23 @@ void Input::poll(InputFrame* outFrame, std::vector<InputEvent>& outEvents)
         }
     }
 }
+
+void Input::poll(InputFrame* outFrame, std::vector<InputEvent>& outEvents, TracePlayer* replay)
+{
+    outEvents.clear();
+
+    InputFrame frame = {};
+    if (!replay || !replay->next(frame)) sample(frame);
+    translate(frame, outEvents);
+
+    if (outFrame) *outFrame = frame;
+}
+
+bool Input::comboPressed(const InputFrame& frame, const std::initializer_list<Key> keys)
+{
+    uint32_t mask = 0;
+    for (const Key key : keys)
+        for (const auto& [k, button] : BUTTONS) if (k == key) mask |= button;
+
+    return mask != 0 && (frame.wpadHeld & mask) == mask && (frame.wpadDown & mask) != 0;
+}
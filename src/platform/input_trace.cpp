@@ -0,0 +1,231 @@
+#include "./platform.h"
+
+#include <cstring>
+
+static constexpr char TRACE_MAGIC[4] = {'W', 'S', 'I', 'T'};
+static constexpr uint8_t TRACE_VERSION = 1;
+static constexpr size_t MAX_TRACE_BYTES = 4 * 1024 * 1024;
+
+enum : uint8_t
+{
+    HELD_CHANGED = 1 << 0,
+    POINTER_CHANGED = 1 << 1,
+    STICK_CHANGED = 1 << 2,
+    CONNECTED = 1 << 3,
+    POINTER_VALID = 1 << 4,
+    NUNCHUK = 1 << 5,
+};
+
+static void putVarint(std::vector<uint8_t>& out, uint32_t v)
+{
+    while (v >= 0x80)
+    {
+        out.push_back(static_cast<uint8_t>(v | 0x80));
+        v >>= 7;
+    }
+    out.push_back(static_cast<uint8_t>(v));
+}
+
+static void putFloat(std::vector<uint8_t>& out, const float f)
+{
+    uint32_t bits;
+    std::memcpy(&bits, &f, sizeof(bits));
+    for (int i = 0; i < 4; ++i) out.push_back(static_cast<uint8_t>(bits >> (8 * i)));
+}
+
+static bool getVarint(const std::vector<uint8_t>& in, size_t& offset, uint32_t& out)
+{
+    out = 0;
+    for (int shift = 0; shift < 35 && offset < in.size(); shift += 7)
+    {
+        const uint8_t b = in[offset++];
+        out |= static_cast<uint32_t>(b & 0x7F) << shift;
+        if ((b & 0x80) == 0) return true;
+    }
+
+    return false;
+}
+
+static bool getFloat(const std::vector<uint8_t>& in, size_t& offset, float& out)
+{
+    if (in.size() - offset < 4) return false;
+
+    uint32_t bits = 0;
+    for (int i = 0; i < 4; ++i) bits |= static_cast<uint32_t>(in[offset++]) << (8 * i);
+    std::memcpy(&out, &bits, sizeof(out));
+
+    return true;
+}
+
+static bool decodeFrame(const std::vector<uint8_t>& in, size_t& offset, Input::InputFrame& frame, uint32_t& dtMicros)
+{
+    if (!getVarint(in, offset, dtMicros) || offset >= in.size()) return false;
+    const uint8_t flags = in[offset++];
+
+    const uint32_t prevHeld = frame.wpadHeld;
+    frame.connected = (flags & CONNECTED) != 0;
+    frame.nunchuk = (flags & NUNCHUK) != 0;
+    frame.pointer.valid = (flags & POINTER_VALID) != 0;
+
+    if (flags & HELD_CHANGED && !getVarint(in, offset, frame.wpadHeld)) return false;
+    if (flags & POINTER_CHANGED && (!getFloat(in, offset, frame.pointer.x) || !getFloat(in, offset, frame.pointer.y)))
+        return false;
+    if (flags & STICK_CHANGED)
+    {
+        if (in.size() - offset < 2) return false;
+        frame.stickX = static_cast<int8_t>(in[offset++]);
+        frame.stickY = static_cast<int8_t>(in[offset++]);
+    }
+
+    frame.wpadDown = frame.wpadHeld & ~prevHeld;
+    frame.wpadUp = prevHeld & ~frame.wpadHeld;
+
+    return true;
+}
+
+bool Input::TraceRecorder::start(const std::string& path)
+{
+    if (recording) return false;
+
+    this->path = path;
+    data.assign(std::begin(TRACE_MAGIC), std::end(TRACE_MAGIC));
+    data.push_back(TRACE_VERSION);
+
+    last = {};
+    frames = 0;
+    recording = true;
+    overflowed = false;
+
+    return true;
+}
+
+void Input::TraceRecorder::record(const InputFrame& frame, const double dt)
+{
+    if (!recording || overflowed) return;
+    if (data.size() + 32 > MAX_TRACE_BYTES)
+    {
+        overflowed = true;
+        return;
+    }
+
+    uint8_t flags = 0;
+    if (frame.connected) flags |= CONNECTED;
+    if (frame.nunchuk) flags |= NUNCHUK;
+    if (frame.pointer.valid) flags |= POINTER_VALID;
+    if (frame.wpadHeld != last.wpadHeld) flags |= HELD_CHANGED;
+    if (frame.pointer.x != last.pointer.x || frame.pointer.y != last.pointer.y) flags |= POINTER_CHANGED;
+    if (frame.stickX != last.stickX || frame.stickY != last.stickY) flags |= STICK_CHANGED;
+
+    putVarint(data, static_cast<uint32_t>(dt > 0.0 ? dt * 1000000.0 + 0.5 : 0.0));
+    data.push_back(flags);
+    if (flags & HELD_CHANGED) putVarint(data, frame.wpadHeld);
+    if (flags & POINTER_CHANGED)
+    {
+        putFloat(data, frame.pointer.x);
+        putFloat(data, frame.pointer.y);
+    }
+    if (flags & STICK_CHANGED)
+    {
+        data.push_back(static_cast<uint8_t>(frame.stickX));
+        data.push_back(static_cast<uint8_t>(frame.stickY));
+    }
+
+    last = frame;
+    frames++;
+}
+
+bool Input::TraceRecorder::stop(std::string* outError)
+{
+    if (!recording) return false;
+    recording = false;
+
+    const bool written = FileSystem::writeFile(path, data.data(), data.size());
+    data.clear();
+    data.shrink_to_fit();
+
+    if (!written)
+    {
+        if (outError) *outError = "Failed to write input trace: " + path;
+        return false;
+    }
+    if (overflowed)
+    {
+        if (outError) *outError = "Input trace was truncated at " + std::to_string(frames) + " frames.";
+        return false;
+    }
+
+    return true;
+}
+
+bool Input::TraceRecorder::isRecording() const { return recording; }
+size_t Input::TraceRecorder::frameCount() const { return frames; }
+
+bool Input::TracePlayer::load(const std::string& path, std::string* outError)
+{
+    data.clear();
+    frames = 0;
+    recorded = 0.0;
+
+    std::vector<uint8_t> in;
+    if (!FileSystem::readFile(path, in))
+    {
+        if (outError) *outError = "Failed to read input trace: " + path;
+        return false;
+    }
+    if (in.size() < 5 || std::memcmp(in.data(), TRACE_MAGIC, 4) != 0 || in[4] != TRACE_VERSION)
+    {
+        if (outError) *outError = "Not a supported input trace: " + path;
+        return false;
+    }
+
+    InputFrame frame = {};
+    size_t pos = 5;
+    uint64_t micros = 0;
+    while (pos < in.size())
+    {
+        uint32_t dt = 0;
+        if (!decodeFrame(in, pos, frame, dt))
+        {
+            if (outError) *outError = "Input trace is corrupt after " + std::to_string(frames) + " frames.";
+            return false;
+        }
+
+        micros += dt;
+        frames++;
+    }
+
+    data = std::move(in);
+    recorded = static_cast<double>(micros) / 1000000.0;
+    rewind();
+
+    return true;
+}
+
+bool Input::TracePlayer::next(InputFrame& outFrame)
+{
+    if (!isPlaying()) return false;
+
+    uint32_t dt = 0;
+    if (!decodeFrame(data, offset, last, dt))
+    {
+        offset = data.size();
+        return false;
+    }
+
+    outFrame = last;
+    played++;
+
+    return true;
+}
+
+void Input::TracePlayer::rewind()
+{
+    offset = data.empty() ? 0 : 5;
+    played = 0;
+    last = {};
+}
+
+bool Input::TracePlayer::isPlaying() const { return offset < data.size(); }
+size_t Input::TracePlayer::frameCount() const { return frames; }
+size_t Input::TracePlayer::position() const { return played; }
+double Input::TracePlayer::recordedSeconds() const { return recorded; }
@@ -1,8 +1,12 @@
 #pragma once
 
+#include <cstdio>
 #include <string>
 #include <vector>
 #include <array>
+#include <memory>
+#include <functional>
+#include <initializer_list>
 
 namespace Input
 {
@@ -53,6 +57,8 @@ namespace Input
     {
         PointerState pointer = {};
         uint32_t wpadDown = 0, wpadHeld = 0, wpadUp = 0;
+        bool connected = false, nunchuk = false;
+        int8_t stickX = 0, stickY = 0;
     };
 
     class KeyRepeat
@@ -71,9 +77,50 @@ namespace Input
         void repeatKey(double dt, std::vector<InputEvent>& outEvents, Key key, bool held);
     };
 
+    class TraceRecorder
+    {
+    public:
+        bool start(const std::string& path);
+        void record(const InputFrame& frame, double dt);
+        bool stop(std::string* outError = nullptr);
+
+        [[nodiscard]] bool isRecording() const;
+        [[nodiscard]] size_t frameCount() const;
+
+    private:
+        std::string path;
+        std::vector<uint8_t> data;
+        InputFrame last = {};
+        size_t frames = 0;
+        bool recording = false, overflowed = false;
+    };
+
+    class TracePlayer
+    {
+    public:
+        bool load(const std::string& path, std::string* outError = nullptr);
+        bool next(InputFrame& outFrame);
+        void rewind();
+
+        [[nodiscard]] bool isPlaying() const;
+        [[nodiscard]] size_t frameCount() const;
+        [[nodiscard]] size_t position() const;
+        [[nodiscard]] double recordedSeconds() const;
+
+        double fixedDt = 1.0 / 60.0;
+
+    private:
+        std::vector<uint8_t> data;
+        InputFrame last = {};
+        size_t offset = 0, frames = 0, played = 0;
+        double recorded = 0.0;
+    };
+
     bool init();
     void exit();
-    void poll(InputFrame* outFrame, std::vector<InputEvent>& outEvents);
+    void reset();
+    void poll(InputFrame* outFrame, std::vector<InputEvent>& outEvents, TracePlayer* replay = nullptr);
+    bool comboPressed(const InputFrame& frame, std::initializer_list<Key> keys);
 }
 
 namespace Time
@@ -81,6 +128,81 @@ namespace Time
     bool init();
     uint64_t ticks();
     double seconds();
+    double toSeconds(uint64_t ticks);
+}
+
+namespace Thread
+{
+    // Main shares the main thread's priority and, without time slicing, only runs while the main thread blocks on
+    // vsync, SD or IOS calls. Background runs below it, so the main thread preempts it as soon as it wakes.
+    enum class Priority : uint8_t
+    {
+        Main,
+        Background
+    };
+
+    // Records the calling thread as the main one; main() calls it before starting any other thread. Until then
+    // every caller counts as the main thread.
+    void init();
+    [[nodiscard]] bool isMain();
+
+    // A joinable background thread; an LWP thread on the Wii.
+    class Worker
+    {
+    public:
+        Worker();
+        ~Worker();
+
+        Worker(const Worker&) = delete;
+        Worker& operator=(const Worker&) = delete;
+
+        bool start(std::function<void()> fn, Priority priority = Priority::Main);
+        void join();
+
+        [[nodiscard]] bool isRunning() const;
+
+    private:
+        struct Impl;
+        std::unique_ptr<Impl> impl;
+    };
+
+    // Usable with std::lock_guard.
+    class Mutex
+    {
+    public:
+        Mutex();
+        ~Mutex();
+
+        Mutex(const Mutex&) = delete;
+        Mutex& operator=(const Mutex&) = delete;
+
+        void lock();
+        void unlock();
+
+    private:
+        struct Impl;
+        std::unique_ptr<Impl> impl;
+    };
+
+    // A one-shot flag that other threads can block on until it is set.
+    class Signal
+    {
+    public:
+        Signal();
+        ~Signal();
+
+        Signal(const Signal&) = delete;
+        Signal& operator=(const Signal&) = delete;
+
+        void set();
+        void wait();
+
+        [[nodiscard]] bool isSet() const;
+
+    private:
+        struct Impl;
+        std::unique_ptr<Impl> impl;
+    };
 }
 
 namespace FileSystem
@@ -89,9 +211,20 @@ namespace FileSystem
     {
         std::string name, path;
         bool isDir = false;
-        uint64_t size = 0;
+        uint64_t size = 0, mtime = 0;
     };
 
+    enum class Change : uint8_t
+    {
+        Written,
+        Renamed,
+        Removed
+    };
+
+    // Reported after a successful writeFile, Writer::close, renamePath or removePath, with normalized paths; `to` is
+    // only set for renames. Listeners run on the thread that made the change.
+    using ChangeListener = std::function<void(Change change, const std::string& path, const std::string& to)>;
+
     bool init();
     bool isReady();
 
@@ -103,13 +236,74 @@ namespace FileSystem
     std::string join(const std::string& a, const std::string& b);
 
     bool listDir(const std::string& path, std::vector<DirEntry>& outEntries, bool sort = true);
+    bool fileSize(const std::string& path, uint64_t& outSize);
     bool readFile(const std::string& path, std::vector<uint8_t>& outData);
+    bool readFile(const std::string& path, uint8_t* out, size_t size, uint64_t offset = 0);
     bool writeFile(const std::string& path, const std::vector<uint8_t>& data);
+    bool writeFile(const std::string& path, const uint8_t* data, size_t size);
+
+    class Writer
+    {
+    public:
+        explicit Writer(size_t bufferSize = 64 * 1024);
+        ~Writer();
+
+        Writer(const Writer&) = delete;
+        Writer& operator=(const Writer&) = delete;
+
+        bool open(const std::string& path);
+        bool write(const void* data, size_t size);
+        bool flush();
+        bool close();
+        void discard();
+
+        [[nodiscard]] bool isOpen() const;
+        [[nodiscard]] uint64_t size() const;
+
+    private:
+        std::FILE* file = nullptr;
+        std::vector<uint8_t> buffer;
+        size_t used = 0;
+        uint64_t written = 0;
+        std::string path, temp;
+        bool failed = false;
+    };
+
+    // Keeps one file open for a series of reads; a read that continues where the previous one ended skips the seek.
+    class Reader
+    {
+    public:
+        Reader() = default;
+        ~Reader();
+
+        Reader(const Reader&) = delete;
+        Reader& operator=(const Reader&) = delete;
+
+        bool open(const std::string& path);
+        // Reads up to `size` bytes from the current position and returns how many were read.
+        size_t read(void* out, size_t size);
+        bool readAt(void* out, size_t size, uint64_t offset);
+        void close();
+
+        [[nodiscard]] bool isOpen() const;
+        [[nodiscard]] uint64_t size() const;
+
+    private:
+        std::FILE* file = nullptr;
+        uint64_t position = 0, length = 0;
+    };
 
     bool makeDir(const std::string& path);
     bool renamePath(const std::string& from, const std::string& to);
     bool copyPath(const std::string& from, const std::string& to);
     bool removePath(const std::string& path);
 
-    inline std::string appRoot = "sd:/apps/WiiScript/", workspaceRoot = "sd:/WiiScript/";
+    void setChangeListener(ChangeListener listener);
+
+    // Writes are limited to the workspace and the app's cache directory.
+    inline std::string appRoot = "sd:/apps/WiiScript/", workspaceRoot = "sd:/WiiScript/",
+                       cacheRoot = "sd:/apps/WiiScript/cache/";
+#ifdef WIISCRIPT_HOST
+    inline std::string hostSdRoot = "sd";
+#endif
 }
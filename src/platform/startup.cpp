@@ -0,0 +1,74 @@
+#include "./startup.h"
+
+size_t StartupPlan::add(const char* name, const Lane lane, const std::initializer_list<size_t> after, Task run)
+{
+    auto e = std::make_unique<Entry>();
+    e->name = name;
+    e->lane = lane;
+    e->run = std::move(run);
+    for (const size_t dep : after)
+        if (dep < tasks.size()) e->after.push_back(dep);
+
+    tasks.push_back(std::move(e));
+
+    return tasks.size() - 1;
+}
+
+void StartupPlan::runTask(Entry& t)
+{
+    for (const size_t dep : t.after)
+    {
+        tasks[dep]->done.wait();
+        if (!tasks[dep]->ok) t.skipped = true;
+    }
+
+    t.start = Time::ticks();
+    if (!t.skipped) t.ok = t.run(&t.error);
+    t.end = Time::ticks();
+    t.done.set();
+}
+
+void StartupPlan::runLane(const Lane lane)
+{
+    for (const auto& t : tasks)
+        if (t->lane == lane) runTask(*t);
+}
+
+bool StartupPlan::run(std::string* outError)
+{
+    origin = Time::ticks();
+
+    Thread::Worker io;
+    const bool parallel = io.start([this] { runLane(Lane::Io); });
+    if (parallel)
+    {
+        runLane(Lane::Main);
+        io.join();
+    }
+    else
+    {
+        for (const auto& t : tasks) runTask(*t);
+    }
+
+    finished = Time::ticks();
+
+    for (const auto& t : tasks)
+        if (!t->ok && !t->skipped)
+        {
+            if (outError) *outError = t->error.empty() ? std::string("Startup task failed: ") + t->name : t->error;
+            return false;
+        }
+
+    return true;
+}
+
+void StartupPlan::log(FILE* out) const
+{
+    const auto ms = [this](const uint64_t ticks) { return Time::toSeconds(ticks - origin) * 1000.0; };
+
+    for (const auto& t : tasks)
+        std::fprintf(out, "startup: %-12s %-4s %8.2f .. %8.2f ms  (%.2f ms)%s\n", t->name,
+                     t->lane == Lane::Main ? "main" : "io", ms(t->start), ms(t->end), ms(t->end) - ms(t->start),
+                     t->skipped ? "  skipped" : t->ok ? "" : "  failed");
+    std::fprintf(out, "startup: total %.2f ms\n", ms(finished));
+}
@@ -0,0 +1,43 @@
+#pragma once
+
+#include "./platform.h"
+
+// Boot work split into named tasks on two lanes: Main for GX, WPAD and anything that builds UI, and Io, a worker
+// thread for SD-bound reads. A task starts once every task it runs after has finished, on either lane; if one of
+// them failed it is skipped. Dependencies must be added first, which keeps the graph acyclic.
+class StartupPlan
+{
+public:
+    enum class Lane : uint8_t
+    {
+        Main,
+        Io
+    };
+
+    using Task = std::function<bool(std::string* outError)>;
+
+    size_t add(const char* name, Lane lane, std::initializer_list<size_t> after, Task run);
+    bool run(std::string* outError);
+
+    // One line per task with its lane, start and end relative to run(), plus the total.
+    void log(FILE* out) const;
+
+private:
+    struct Entry
+    {
+        const char* name;
+        Lane lane;
+        std::vector<size_t> after;
+        Task run;
+        uint64_t start = 0, end = 0;
+        bool ok = false, skipped = false;
+        std::string error;
+        Thread::Signal done;
+    };
+
+    std::vector<std::unique_ptr<Entry>> tasks;
+    uint64_t origin = 0, finished = 0;
+
+    void runTask(Entry& t);
+    void runLane(Lane lane);
+};
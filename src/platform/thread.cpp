@@ -0,0 +1,195 @@
+#include "./platform.h"
+
+#ifdef WIISCRIPT_HOST
+#include <thread>
+#include <mutex>
+#include <condition_variable>
+#else
+#include <ogc/lwp.h>
+#include <ogc/mutex.h>
+#include <ogc/cond.h>
+#endif
+
+#ifdef WIISCRIPT_HOST
+
+static std::thread::id mainThread;
+static bool initialized = false;
+
+struct Thread::Worker::Impl
+{
+    std::thread thread;
+};
+
+struct Thread::Mutex::Impl
+{
+    std::mutex mutex;
+};
+
+struct Thread::Signal::Impl
+{
+    mutable std::mutex mutex;
+    std::condition_variable cond;
+    bool set = false;
+};
+
+void Thread::init()
+{
+    mainThread = std::this_thread::get_id();
+    initialized = true;
+}
+
+bool Thread::isMain() { return !initialized || std::this_thread::get_id() == mainThread; }
+
+Thread::Worker::Worker() : impl(std::make_unique<Impl>()) {}
+Thread::Worker::~Worker() { join(); }
+
+bool Thread::Worker::start(std::function<void()> fn, Priority)
+{
+    if (isRunning()) return false;
+    impl->thread = std::thread(std::move(fn));
+
+    return true;
+}
+
+void Thread::Worker::join()
+{
+    if (impl->thread.joinable()) impl->thread.join();
+}
+
+bool Thread::Worker::isRunning() const { return impl->thread.joinable(); }
+
+Thread::Mutex::Mutex() : impl(std::make_unique<Impl>()) {}
+Thread::Mutex::~Mutex() = default;
+
+void Thread::Mutex::lock() { impl->mutex.lock(); }
+void Thread::Mutex::unlock() { impl->mutex.unlock(); }
+
+Thread::Signal::Signal() : impl(std::make_unique<Impl>()) {}
+Thread::Signal::~Signal() = default;
+
+void Thread::Signal::set()
+{
+    {
+        std::lock_guard lock(impl->mutex);
+        impl->set = true;
+    }
+    impl->cond.notify_all();
+}
+
+void Thread::Signal::wait()
+{
+    std::unique_lock lock(impl->mutex);
+    impl->cond.wait(lock, [this] { return impl->set; });
+}
+
+bool Thread::Signal::isSet() const
+{
+    std::lock_guard lock(impl->mutex);
+    return impl->set;
+}
+
+#else
+
+static constexpr u32 WORKER_STACK = 64 * 1024;
+static constexpr u8 MAIN_PRIORITY = 64, BACKGROUND_PRIORITY = 32;
+
+static lwp_t mainThread = LWP_THREAD_NULL;
+static bool initialized = false;
+
+struct Thread::Worker::Impl
+{
+    lwp_t thread = LWP_THREAD_NULL;
+    std::function<void()> fn;
+
+    static void* entry(void* arg)
+    {
+        static_cast<Impl*>(arg)->fn();
+        return nullptr;
+    }
+};
+
+struct Thread::Mutex::Impl
+{
+    mutex_t mutex = LWP_MUTEX_NULL;
+};
+
+struct Thread::Signal::Impl
+{
+    mutex_t mutex = LWP_MUTEX_NULL;
+    cond_t cond = LWP_COND_NULL;
+    volatile bool set = false;
+};
+
+void Thread::init()
+{
+    mainThread = LWP_GetSelf();
+    initialized = true;
+}
+
+bool Thread::isMain() { return !initialized || LWP_GetSelf() == mainThread; }
+
+Thread::Worker::Worker() : impl(std::make_unique<Impl>()) {}
+Thread::Worker::~Worker() { join(); }
+
+bool Thread::Worker::start(std::function<void()> fn, const Priority priority)
+{
+    if (isRunning()) return false;
+
+    impl->fn = std::move(fn);
+    if (LWP_CreateThread(&impl->thread, &Impl::entry, impl.get(), nullptr, WORKER_STACK,
+                         priority == Priority::Main ? MAIN_PRIORITY : BACKGROUND_PRIORITY) < 0)
+    {
+        impl->thread = LWP_THREAD_NULL;
+        return false;
+    }
+
+    return true;
+}
+
+void Thread::Worker::join()
+{
+    if (impl->thread == LWP_THREAD_NULL) return;
+
+    LWP_JoinThread(impl->thread, nullptr);
+    impl->thread = LWP_THREAD_NULL;
+    impl->fn = nullptr;
+}
+
+bool Thread::Worker::isRunning() const { return impl->thread != LWP_THREAD_NULL; }
+
+Thread::Mutex::Mutex() : impl(std::make_unique<Impl>()) { LWP_MutexInit(&impl->mutex, false); }
+Thread::Mutex::~Mutex() { LWP_MutexDestroy(impl->mutex); }
+
+void Thread::Mutex::lock() { LWP_MutexLock(impl->mutex); }
+void Thread::Mutex::unlock() { LWP_MutexUnlock(impl->mutex); }
+
+Thread::Signal::Signal() : impl(std::make_unique<Impl>())
+{
+    LWP_MutexInit(&impl->mutex, false);
+    LWP_CondInit(&impl->cond);
+}
+
+Thread::Signal::~Signal()
+{
+    LWP_CondDestroy(impl->cond);
+    LWP_MutexDestroy(impl->mutex);
+}
+
+void Thread::Signal::set()
+{
+    LWP_MutexLock(impl->mutex);
+    impl->set = true;
+    LWP_CondBroadcast(impl->cond);
+    LWP_MutexUnlock(impl->mutex);
+}
+
+void Thread::Signal::wait()
+{
+    LWP_MutexLock(impl->mutex);
+    while (!impl->set) LWP_CondWait(impl->cond, impl->mutex);
+    LWP_MutexUnlock(impl->mutex);
+}
+
+bool Thread::Signal::isSet() const { return impl->set; }
+
+#endif
@@ -11,10 +11,9 @@ bool Time::init()
 
 uint64_t Time::ticks() { return gettime(); }
 
-double Time::seconds()
-{
-    const uint64_t dt = gettime() - startTicks;
-    const auto ms = static_cast<double>(ticks_to_millisecs(dt));
+double Time::seconds() { return toSeconds(gettime() - startTicks); }
 
-    return ms / 1000.0f;
+double Time::toSeconds(const uint64_t ticks)
+{
+    return static_cast<double>(ticks) / (static_cast<double>(TB_TIMER_CLOCK) * 1000.0);
 }
@@ -0,0 +1,381 @@
+#include "./modules.h"
+#include "./runtime.h"
+
+#include <cmath>
+#include <cstring>
+#include <cstddef>
+#include <algorithm>
+#include <type_traits>
+
+static constexpr auto BYTES_MT = "bytes";
+
+struct Bytes
+{
+    uint8_t* data;
+    size_t size;
+    uint8_t storage[1];
+};
+
+static Bytes* newBytes(lua_State* L, const size_t size)
+{
+    auto* b = static_cast<Bytes*>(lua_newuserdatauv(L, offsetof(Bytes, storage) + std::max<size_t>(size, 1), 1));
+    b->data = b->storage;
+    b->size = size;
+    luaL_setmetatable(L, BYTES_MT);
+
+    return b;
+}
+
+static Bytes* checkBytes(lua_State* L, const int arg) { return static_cast<Bytes*>(luaL_checkudata(L, arg, BYTES_MT)); }
+
+static size_t checkOffset(lua_State* L, const Bytes* b, const int arg, const size_t width)
+{
+    const lua_Integer pos = luaL_checkinteger(L, arg);
+    luaL_argcheck(L, pos >= 1 && static_cast<size_t>(pos) - 1 + width <= b->size, arg, "offset out of range");
+
+    return static_cast<size_t>(pos - 1);
+}
+
+static void checkRange(lua_State* L, const Bytes* b, const int arg, size_t& outFirst, size_t& outCount)
+{
+    const lua_Integer size = static_cast<lua_Integer>(b->size);
+    lua_Integer i = luaL_optinteger(L, arg, 1), j = luaL_optinteger(L, arg + 1, size);
+
+    if (i < 0) i = std::max<lua_Integer>(size + i + 1, 1);
+    else if (i == 0) i = 1;
+    if (j < 0) j = size + j + 1;
+    else if (j > size) j = size;
+
+    outFirst = std::min(static_cast<size_t>(i - 1), b->size);
+    outCount = i <= j ? static_cast<size_t>(j - i + 1) : 0;
+}
+
+template <typename T>
+using UnsignedOf = std::conditional_t<sizeof(T) == 1, uint8_t, std::conditional_t<sizeof(T) == 2, uint16_t, uint32_t>>;
+
+template <typename T>
+static T loadValue(const uint8_t* p, const bool bigEndian)
+{
+    UnsignedOf<T> u = 0;
+    for (size_t i = 0; i < sizeof(T); ++i)
+        u = static_cast<UnsignedOf<T>>(u << 8 | p[bigEndian ? i : sizeof(T) - 1 - i]);
+
+    T value;
+    std::memcpy(&value, &u, sizeof(T));
+
+    return value;
+}
+
+template <typename T>
+static void storeValue(uint8_t* p, const T value, const bool bigEndian)
+{
+    UnsignedOf<T> u;
+    std::memcpy(&u, &value, sizeof(T));
+
+    for (size_t i = 0; i < sizeof(T); ++i, u = static_cast<UnsignedOf<T>>(u >> 8))
+        p[bigEndian ? sizeof(T) - 1 - i : i] = static_cast<uint8_t>(u);
+}
+
+// Lua integers are 32 bits wide (LUA_32BITS) and its floats cannot hold every u32 either, so u32le/u32be return values
+// of 2^31 and up wrapped to the negative integer with the same bits. setU32le/setU32be store such integers back
+// unchanged and also take whole numbers from 2^31 to 2^32 - 1, so any u32 survives a get/set round trip.
+template <typename T>
+static T checkValue(lua_State* L, const int arg)
+{
+    if constexpr (std::is_floating_point_v<T>) return static_cast<T>(luaL_checknumber(L, arg));
+    else if constexpr (std::is_same_v<T, uint32_t>)
+    {
+        if (lua_isinteger(L, arg)) return static_cast<uint32_t>(lua_tointeger(L, arg));
+
+        const lua_Number n = luaL_checknumber(L, arg);
+        luaL_argcheck(L, n >= 0 && n < static_cast<lua_Number>(4294967296.0) && n == std::floor(n), arg,
+                      "number has no u32 representation");
+        return static_cast<uint32_t>(static_cast<double>(n));
+    }
+    else return static_cast<T>(luaL_checkinteger(L, arg));
+}
+
+template <typename T, bool BigEndian>
+static int bytesGet(lua_State* L)
+{
+    const Bytes* b = checkBytes(L, 1);
+    const T value = loadValue<T>(b->data + checkOffset(L, b, 2, sizeof(T)), BigEndian);
+
+    if constexpr (std::is_floating_point_v<T>) lua_pushnumber(L, static_cast<lua_Number>(value));
+    else lua_pushinteger(L, static_cast<lua_Integer>(value));
+
+    return 1;
+}
+
+template <typename T, bool BigEndian>
+static int bytesSet(lua_State* L)
+{
+    const Bytes* b = checkBytes(L, 1);
+    const size_t at = checkOffset(L, b, 2, sizeof(T));
+    storeValue(b->data + at, checkValue<T>(L, 3), BigEndian);
+
+    return 0;
+}
+
+static int pushFail(lua_State* L, const char* what, const std::string& path)
+{
+    luaL_pushfail(L);
+    lua_pushfstring(L, "cannot %s '%s'", what, path.c_str());
+
+    return 2;
+}
+
+static int bytesNew(lua_State* L)
+{
+    const lua_Integer size = luaL_checkinteger(L, 1);
+    luaL_argcheck(L, size >= 0, 1, "size must be non-negative");
+    const int fill = static_cast<int>(luaL_optinteger(L, 2, 0));
+
+    const Bytes* b = newBytes(L, static_cast<size_t>(size));
+    std::memset(b->data, fill, b->size);
+
+    return 1;
+}
+
+static int bytesFromString(lua_State* L)
+{
+    size_t len = 0;
+    const char* str = luaL_checklstring(L, 1, &len);
+    std::memcpy(newBytes(L, len)->data, str, len);
+
+    return 1;
+}
+
+static int bytesRead(lua_State* L)
+{
+    const std::string path = ScriptRuntime::resolvePath(luaL_checkstring(L, 1));
+    const lua_Integer offset = luaL_optinteger(L, 2, 0);
+    luaL_argcheck(L, offset >= 0, 2, "offset must be non-negative");
+
+    uint64_t fileSize = 0;
+    if (!FileSystem::fileSize(path, fileSize)) return pushFail(L, "read", path);
+
+    const uint64_t available = fileSize > static_cast<uint64_t>(offset) ? fileSize - offset : 0;
+    uint64_t size = available;
+    if (!lua_isnoneornil(L, 3))
+    {
+        const lua_Integer length = luaL_checkinteger(L, 3);
+        luaL_argcheck(L, length >= 0, 3, "length must be non-negative");
+        size = std::min<uint64_t>(available, static_cast<uint64_t>(length));
+    }
+
+    const Bytes* b = newBytes(L, static_cast<size_t>(size));
+    if (!FileSystem::readFile(path, b->data, b->size, static_cast<uint64_t>(offset))) return pushFail(L, "read", path);
+
+    return 1;
+}
+
+static int bytesLoad(lua_State* L)
+{
+    const Bytes* b = checkBytes(L, 1);
+    const std::string path = ScriptRuntime::resolvePath(luaL_checkstring(L, 2));
+    const lua_Integer offset = luaL_optinteger(L, 3, 0);
+    luaL_argcheck(L, offset >= 0, 3, "offset must be non-negative");
+
+    uint64_t fileSize = 0;
+    if (!FileSystem::fileSize(path, fileSize)) return pushFail(L, "read", path);
+
+    const size_t n = static_cast<size_t>(std::min<uint64_t>(b->size, fileSize > static_cast<uint64_t>(offset)
+                                                                         ? fileSize - offset
+                                                                         : 0));
+    if (!FileSystem::readFile(path, b->data, n, static_cast<uint64_t>(offset))) return pushFail(L, "read", path);
+
+    lua_pushinteger(L, static_cast<lua_Integer>(n));
+    return 1;
+}
+
+static int bytesWrite(lua_State* L)
+{
+    const Bytes* b = checkBytes(L, 1);
+    const std::string path = ScriptRuntime::resolvePath(luaL_checkstring(L, 2));
+    if (!FileSystem::writeFile(path, b->data, b->size)) return pushFail(L, "write", path);
+
+    lua_pushboolean(L, true);
+    return 1;
+}
+
+static int bytesSlice(lua_State* L)
+{
+    const Bytes* b = checkBytes(L, 1);
+    size_t first = 0, count = 0;
+    checkRange(L, b, 2, first, count);
+
+    auto* view = static_cast<Bytes*>(lua_newuserdatauv(L, offsetof(Bytes, storage), 1));
+    view->data = b->data + first;
+    view->size = count;
+    luaL_setmetatable(L, BYTES_MT);
+
+    lua_pushvalue(L, 1);
+    lua_setiuservalue(L, -2, 1);
+
+    return 1;
+}
+
+static int bytesToString(lua_State* L)
+{
+    const Bytes* b = checkBytes(L, 1);
+    size_t first = 0, count = 0;
+    checkRange(L, b, 2, first, count);
+
+    lua_pushlstring(L, reinterpret_cast<const char*>(b->data + first), count);
+    return 1;
+}
+
+static int bytesFill(lua_State* L)
+{
+    const Bytes* b = checkBytes(L, 1);
+    const int value = static_cast<int>(luaL_checkinteger(L, 2));
+    size_t first = 0, count = 0;
+    checkRange(L, b, 3, first, count);
+
+    std::memset(b->data + first, value, count);
+    return 0;
+}
+
+static int bytesCopy(lua_State* L)
+{
+    const Bytes* dst = checkBytes(L, 1);
+    const size_t at = checkOffset(L, dst, 2, 0);
+
+    if (lua_type(L, 3) == LUA_TSTRING)
+    {
+        size_t len = 0;
+        const char* str = lua_tolstring(L, 3, &len);
+        luaL_argcheck(L, len <= dst->size - at, 3, "source does not fit");
+        std::memcpy(dst->data + at, str, len);
+
+        return 0;
+    }
+
+    const Bytes* src = checkBytes(L, 3);
+    size_t first = 0, count = 0;
+    checkRange(L, src, 4, first, count);
+    luaL_argcheck(L, count <= dst->size - at, 3, "source does not fit");
+
+    std::memmove(dst->data + at, src->data + first, count);
+    return 0;
+}
+
+static int bytesFind(lua_State* L)
+{
+    const Bytes* b = checkBytes(L, 1);
+    size_t len = 0;
+    const char* needle = luaL_checklstring(L, 2, &len);
+    const lua_Integer init = luaL_optinteger(L, 3, 1);
+    luaL_argcheck(L, init >= 1, 3, "offset out of range");
+
+    const auto start = static_cast<size_t>(init - 1);
+    if (start <= b->size)
+    {
+        const uint8_t *begin = b->data, *end = begin + b->size;
+        const auto* pattern = reinterpret_cast<const uint8_t*>(needle);
+        if (const uint8_t* it = std::search(begin + start, end, pattern, pattern + len); it != end || len == 0)
+        {
+            lua_pushinteger(L, static_cast<lua_Integer>(it - begin + 1));
+            return 1;
+        }
+    }
+
+    luaL_pushfail(L);
+    return 1;
+}
+
+static int bytesIndex(lua_State* L)
+{
+    if (lua_type(L, 2) == LUA_TNUMBER)
+    {
+        const Bytes* b = checkBytes(L, 1);
+        lua_pushinteger(L, b->data[checkOffset(L, b, 2, 1)]);
+
+        return 1;
+    }
+
+    lua_gettable(L, lua_upvalueindex(1));
+    return 1;
+}
+
+static int bytesNewIndex(lua_State* L)
+{
+    const Bytes* b = checkBytes(L, 1);
+    b->data[checkOffset(L, b, 2, 1)] = static_cast<uint8_t>(luaL_checkinteger(L, 3));
+
+    return 0;
+}
+
+static int bytesLen(lua_State* L)
+{
+    lua_pushinteger(L, static_cast<lua_Integer>(checkBytes(L, 1)->size));
+    return 1;
+}
+
+static int bytesToStringMeta(lua_State* L)
+{
+    lua_pushfstring(L, "bytes(%d): %p", static_cast<int>(checkBytes(L, 1)->size), lua_topointer(L, 1));
+    return 1;
+}
+
+int luaopen_bytes(lua_State* L)
+{
+    static constexpr luaL_Reg meta[] = {
+        {"__newindex", bytesNewIndex},
+        {"__len", bytesLen},
+        {"__tostring", bytesToStringMeta},
+        {nullptr, nullptr}
+    };
+    static constexpr luaL_Reg methods[] = {
+        {"slice", bytesSlice},
+        {"string", bytesToString},
+        {"fill", bytesFill},
+        {"copy", bytesCopy},
+        {"find", bytesFind},
+        {"load", bytesLoad},
+        {"write", bytesWrite},
+        {"u8", bytesGet<uint8_t, false>},
+        {"i8", bytesGet<int8_t, false>},
+        {"u16le", bytesGet<uint16_t, false>},
+        {"u16be", bytesGet<uint16_t, true>},
+        {"i16le", bytesGet<int16_t, false>},
+        {"i16be", bytesGet<int16_t, true>},
+        {"u32le", bytesGet<uint32_t, false>},
+        {"u32be", bytesGet<uint32_t, true>},
+        {"i32le", bytesGet<int32_t, false>},
+        {"i32be", bytesGet<int32_t, true>},
+        {"f32le", bytesGet<float, false>},
+        {"f32be", bytesGet<float, true>},
+        {"setU8", bytesSet<uint8_t, false>},
+        {"setI8", bytesSet<int8_t, false>},
+        {"setU16le", bytesSet<uint16_t, false>},
+        {"setU16be", bytesSet<uint16_t, true>},
+        {"setI16le", bytesSet<int16_t, false>},
+        {"setI16be", bytesSet<int16_t, true>},
+        {"setU32le", bytesSet<uint32_t, false>},
+        {"setU32be", bytesSet<uint32_t, true>},
+        {"setI32le", bytesSet<int32_t, false>},
+        {"setI32be", bytesSet<int32_t, true>},
+        {"setF32le", bytesSet<float, false>},
+        {"setF32be", bytesSet<float, true>},
+        {nullptr, nullptr}
+    };
+    static constexpr luaL_Reg funcs[] = {
+        {"new", bytesNew},
+        {"from", bytesFromString},
+        {"read", bytesRead},
+        {nullptr, nullptr}
+    };
+
+    luaL_newmetatable(L, BYTES_MT);
+    luaL_setfuncs(L, meta, 0);
+    lua_newtable(L);
+    luaL_setfuncs(L, methods, 0);
+    lua_pushcclosure(L, bytesIndex, 1);
+    lua_setfield(L, -2, "__index");
+    lua_pop(L, 1);
+
+    luaL_newlib(L, funcs);
+    return 1;
+}
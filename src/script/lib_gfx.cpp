@@ -0,0 +1,175 @@
+#include "./modules.h"
+#include "./runtime.h"
+#include "../platform/platform.h"
+
+static CommandBuffer& drawList(lua_State* L) { return ScriptRuntime::from(L).drawList(); }
+
+static uint32_t optColor(lua_State* L, const int arg)
+{
+    return static_cast<uint32_t>(luaL_optinteger(L, arg, -1));
+}
+
+static float numberAt(lua_State* L, const int table, const lua_Integer i)
+{
+    lua_rawgeti(L, table, i);
+    const auto v = static_cast<float>(lua_tonumber(L, -1));
+    lua_pop(L, 1);
+
+    return v;
+}
+
+static int gfxRect(lua_State* L)
+{
+    const auto x = static_cast<float>(luaL_checknumber(L, 1)), y = static_cast<float>(luaL_checknumber(L, 2)),
+               w = static_cast<float>(luaL_checknumber(L, 3)), h = static_cast<float>(luaL_checknumber(L, 4)),
+               radius = static_cast<float>(luaL_optnumber(L, 6, 0));
+
+    lua_pushboolean(L, drawList(L).rect(x, y, w, h, optColor(L, 5), radius, lua_isnone(L, 7) || lua_toboolean(L, 7)));
+    return 1;
+}
+
+static int gfxRects(lua_State* L)
+{
+    luaL_checktype(L, 1, LUA_TTABLE);
+    const uint32_t color = optColor(L, 2);
+    const auto radius = static_cast<float>(luaL_optnumber(L, 3, 0));
+    const bool filled = lua_isnone(L, 4) || lua_toboolean(L, 4);
+
+    CommandBuffer& buf = drawList(L);
+    const lua_Integer n = luaL_len(L, 1) / 4;
+    lua_Integer drawn = 0;
+
+    for (lua_Integer i = 0; i < n; ++i, ++drawn)
+        if (!buf.rect(numberAt(L, 1, i * 4 + 1), numberAt(L, 1, i * 4 + 2), numberAt(L, 1, i * 4 + 3),
+                      numberAt(L, 1, i * 4 + 4), color, radius, filled))
+            break;
+
+    lua_pushinteger(L, drawn);
+    return 1;
+}
+
+static int gfxLine(lua_State* L)
+{
+    const auto x1 = static_cast<float>(luaL_checknumber(L, 1)), y1 = static_cast<float>(luaL_checknumber(L, 2)),
+               x2 = static_cast<float>(luaL_checknumber(L, 3)), y2 = static_cast<float>(luaL_checknumber(L, 4));
+
+    lua_pushboolean(L, drawList(L).line(x1, y1, x2, y2, optColor(L, 5)));
+    return 1;
+}
+
+static int gfxLines(lua_State* L)
+{
+    luaL_checktype(L, 1, LUA_TTABLE);
+    const uint32_t color = optColor(L, 2);
+
+    CommandBuffer& buf = drawList(L);
+    const lua_Integer n = luaL_len(L, 1) / 4;
+    lua_Integer drawn = 0;
+
+    for (lua_Integer i = 0; i < n; ++i, ++drawn)
+        if (!buf.line(numberAt(L, 1, i * 4 + 1), numberAt(L, 1, i * 4 + 2), numberAt(L, 1, i * 4 + 3),
+                      numberAt(L, 1, i * 4 + 4), color))
+            break;
+
+    lua_pushinteger(L, drawn);
+    return 1;
+}
+
+static int gfxSprite(lua_State* L)
+{
+    const auto texture = static_cast<uint32_t>(luaL_checkinteger(L, 1));
+    const auto x = static_cast<float>(luaL_checknumber(L, 2)), y = static_cast<float>(luaL_checknumber(L, 3)),
+               sx = static_cast<float>(luaL_optnumber(L, 4, 1)), sy = static_cast<float>(luaL_optnumber(L, 5, sx));
+
+    lua_pushboolean(L, drawList(L).sprite(texture, x, y, sx, sy, optColor(L, 6)));
+    return 1;
+}
+
+static int gfxSprites(lua_State* L)
+{
+    const auto texture = static_cast<uint32_t>(luaL_checkinteger(L, 1));
+    luaL_checktype(L, 2, LUA_TTABLE);
+    const uint32_t color = optColor(L, 3);
+
+    CommandBuffer& buf = drawList(L);
+    const lua_Integer n = luaL_len(L, 2) / 2;
+    lua_Integer drawn = 0;
+
+    for (lua_Integer i = 0; i < n; ++i, ++drawn)
+        if (!buf.sprite(texture, numberAt(L, 2, i * 2 + 1), numberAt(L, 2, i * 2 + 2), 1.0f, 1.0f, color)) break;
+
+    lua_pushinteger(L, drawn);
+    return 1;
+}
+
+static int gfxText(lua_State* L)
+{
+    size_t len = 0;
+    const char* str = luaL_checklstring(L, 1, &len);
+    const auto x = static_cast<float>(luaL_checknumber(L, 2)), y = static_cast<float>(luaL_checknumber(L, 3));
+
+    lua_pushboolean(L, drawList(L).text({str, len}, x, y, optColor(L, 4)));
+    return 1;
+}
+
+static int gfxImage(lua_State* L)
+{
+    const std::string path = ScriptRuntime::resolvePath(luaL_checkstring(L, 1));
+
+    std::vector<uint8_t> data;
+    if (!FileSystem::readFile(path, data))
+    {
+        luaL_pushfail(L);
+        lua_pushfstring(L, "cannot read '%s'", path.c_str());
+
+        return 2;
+    }
+
+    const uint32_t texture = ScriptRuntime::from(L).drawBackend().loadTexture(data);
+    if (texture == 0)
+    {
+        luaL_pushfail(L);
+        lua_pushfstring(L, "cannot decode '%s'", path.c_str());
+
+        return 2;
+    }
+
+    lua_pushinteger(L, static_cast<lua_Integer>(texture));
+    return 1;
+}
+
+static int gfxStats(lua_State* L)
+{
+    const CommandBuffer& buf = drawList(L);
+    const auto& s = buf.lastFlush();
+
+    lua_pushinteger(L, static_cast<lua_Integer>(buf.size()));
+    lua_pushinteger(L, static_cast<lua_Integer>(s.submissions));
+    lua_pushinteger(L, static_cast<lua_Integer>(s.dropped));
+
+    return 3;
+}
+
+int luaopen_gfx(lua_State* L)
+{
+    static constexpr luaL_Reg funcs[] = {
+        {"rect", gfxRect},
+        {"rects", gfxRects},
+        {"line", gfxLine},
+        {"lines", gfxLines},
+        {"sprite", gfxSprite},
+        {"sprites", gfxSprites},
+        {"text", gfxText},
+        {"image", gfxImage},
+        {"stats", gfxStats},
+        {nullptr, nullptr}
+    };
+
+    luaL_newlib(L, funcs);
+    lua_pushinteger(L, 640);
+    lua_setfield(L, -2, "width");
+    lua_pushinteger(L, 480);
+    lua_setfield(L, -2, "height");
+
+    return 1;
+}
@@ -0,0 +1,72 @@
+#include "./modules.h"
+#include "./runtime.h"
+
+static TaskScheduler& scheduler(lua_State* L) { return ScriptRuntime::from(L).scheduler(); }
+
+static int taskSpawn(lua_State* L)
+{
+    luaL_checktype(L, 1, LUA_TFUNCTION);
+    uint32_t id = 0;
+    if (!scheduler(L).spawn(L, lua_gettop(L) - 1, id))
+        return luaL_error(L, "too many tasks (at most %d)", static_cast<int>(TaskScheduler::MAX_TASKS));
+
+    lua_pushinteger(L, static_cast<lua_Integer>(id));
+    return 1;
+}
+
+static int taskCancel(lua_State* L)
+{
+    lua_pushboolean(L, scheduler(L).cancel(static_cast<uint32_t>(luaL_checkinteger(L, 1))));
+    return 1;
+}
+
+static int taskSleep(lua_State* L)
+{
+    const double seconds = luaL_optnumber(L, 1, 0);
+    return scheduler(L).sleepUntil(L, scheduler(L).now() + seconds);
+}
+
+static int taskSleepUntil(lua_State* L) { return scheduler(L).sleepUntil(L, luaL_checknumber(L, 1)); }
+static int taskFrame(lua_State* L) { return scheduler(L).waitFrame(L); }
+
+static int taskWaitInput(lua_State* L)
+{
+    Input::Key key = Input::Key::None;
+    if (!lua_isnoneornil(L, 1))
+    {
+        key = TaskScheduler::keyFromName(luaL_checkstring(L, 1));
+        luaL_argcheck(L, key != Input::Key::None, 1, "unknown key name");
+    }
+
+    return scheduler(L).waitInput(L, key);
+}
+
+static int taskNow(lua_State* L)
+{
+    lua_pushnumber(L, static_cast<lua_Number>(scheduler(L).now()));
+    return 1;
+}
+
+static int taskCount(lua_State* L)
+{
+    lua_pushinteger(L, static_cast<lua_Integer>(scheduler(L).activeCount()));
+    return 1;
+}
+
+int luaopen_task(lua_State* L)
+{
+    static constexpr luaL_Reg funcs[] = {
+        {"spawn", taskSpawn},
+        {"cancel", taskCancel},
+        {"sleep", taskSleep},
+        {"sleepUntil", taskSleepUntil},
+        {"frame", taskFrame},
+        {"waitInput", taskWaitInput},
+        {"now", taskNow},
+        {"count", taskCount},
+        {nullptr, nullptr}
+    };
+
+    luaL_newlib(L, funcs);
+    return 1;
+}
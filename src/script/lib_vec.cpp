@@ -0,0 +1,652 @@
+#include "./modules.h"
+#include "./vec_kernels.h"
+
+#include <cmath>
+#include <cstring>
+#include <cstddef>
+#include <cstdint>
+#include <algorithm>
+
+static constexpr auto VECTOR_MT = "vec.vector", MAT4_MT = "vec.mat4", ARRAY_MT = "vec.array";
+
+struct Vector
+{
+    float v[4];
+    int dim;
+};
+
+struct Mat4
+{
+    float m[16];
+};
+
+struct VecArray
+{
+    size_t count, stride;
+    int dim;
+    float data[1];
+};
+
+static Vector* newVector(lua_State* L, const int dim)
+{
+    auto* v = static_cast<Vector*>(lua_newuserdatauv(L, sizeof(Vector), 0));
+    std::memset(v->v, 0, sizeof(v->v));
+    v->dim = dim;
+    luaL_setmetatable(L, VECTOR_MT);
+
+    return v;
+}
+
+static Mat4* newMat4(lua_State* L)
+{
+    auto* m = static_cast<Mat4*>(lua_newuserdatauv(L, sizeof(Mat4), 0));
+    std::memset(m->m, 0, sizeof(m->m));
+    m->m[0] = m->m[5] = m->m[10] = m->m[15] = 1.0f;
+    luaL_setmetatable(L, MAT4_MT);
+
+    return m;
+}
+
+static constexpr size_t arrayStride(const int dim) { return dim == 1 ? 1 : 4; }
+
+// Keeps the userdata size from wrapping on the Wii's 32-bit size_t.
+static constexpr size_t maxArrayCount(const int dim)
+{
+    return (SIZE_MAX - offsetof(VecArray, data)) / (arrayStride(dim) * sizeof(float));
+}
+
+static VecArray* newArray(lua_State* L, const size_t count, const int dim)
+{
+    const size_t stride = arrayStride(dim), floats = std::max<size_t>(count * stride, 1);
+    auto* a = static_cast<VecArray*>(lua_newuserdatauv(L, offsetof(VecArray, data) + floats * sizeof(float), 0));
+
+    a->count = count;
+    a->stride = stride;
+    a->dim = dim;
+    std::memset(a->data, 0, floats * sizeof(float));
+    luaL_setmetatable(L, ARRAY_MT);
+
+    return a;
+}
+
+static Vector* checkVector(lua_State* L, const int arg)
+{
+    return static_cast<Vector*>(luaL_checkudata(L, arg, VECTOR_MT));
+}
+
+static Mat4* checkMat4(lua_State* L, const int arg) { return static_cast<Mat4*>(luaL_checkudata(L, arg, MAT4_MT)); }
+
+static VecArray* checkArray(lua_State* L, const int arg)
+{
+    return static_cast<VecArray*>(luaL_checkudata(L, arg, ARRAY_MT));
+}
+
+static int componentIndex(lua_State* L, const int arg)
+{
+    size_t len = 0;
+    const char* key = lua_tolstring(L, arg, &len);
+    if (!key || len != 1) return -1;
+
+    switch (key[0])
+    {
+    case 'x': return 0;
+    case 'y': return 1;
+    case 'z': return 2;
+    case 'w': return 3;
+    default: return -1;
+    }
+}
+
+static Vector* outVector(lua_State* L, const int arg, const int dim)
+{
+    if (lua_isnoneornil(L, arg)) return newVector(L, dim);
+
+    Vector* out = checkVector(L, arg);
+    lua_pushvalue(L, arg);
+
+    return out;
+}
+
+static VecArray* outArray(lua_State* L, const int arg, const size_t count, const int dim)
+{
+    if (lua_isnoneornil(L, arg)) return newArray(L, count, dim);
+
+    VecArray* out = checkArray(L, arg);
+    luaL_argcheck(L, out->count >= count && out->stride == arrayStride(dim), arg, "destination array too small");
+    lua_pushvalue(L, arg);
+
+    return out;
+}
+
+static int makeVector(lua_State* L, const int dim)
+{
+    float values[4] = {};
+    for (int i = 0; i < dim; ++i) values[i] = static_cast<float>(luaL_optnumber(L, i + 1, 0));
+    std::memcpy(newVector(L, dim)->v, values, sizeof(values));
+
+    return 1;
+}
+
+static int vecVec2(lua_State* L) { return makeVector(L, 2); }
+static int vecVec3(lua_State* L) { return makeVector(L, 3); }
+static int vecVec4(lua_State* L) { return makeVector(L, 4); }
+
+static int vectorIndex(lua_State* L)
+{
+    const Vector* v = checkVector(L, 1);
+    if (const int i = componentIndex(L, 2); i >= 0 && i < v->dim)
+    {
+        lua_pushnumber(L, v->v[i]);
+        return 1;
+    }
+
+    lua_gettable(L, lua_upvalueindex(1));
+    return 1;
+}
+
+static int vectorNewIndex(lua_State* L)
+{
+    Vector* v = checkVector(L, 1);
+    const int i = componentIndex(L, 2);
+    luaL_argcheck(L, i >= 0 && i < v->dim, 2, "invalid component");
+
+    v->v[i] = static_cast<float>(luaL_checknumber(L, 3));
+    return 0;
+}
+
+static int vectorSet(lua_State* L)
+{
+    Vector* v = checkVector(L, 1);
+    // Lanes past the vector's size stay zero; the kernels run over all four.
+    if (const Vector* o = static_cast<Vector*>(luaL_testudata(L, 2, VECTOR_MT)))
+        for (int i = 0; i < 4; ++i) v->v[i] = i < std::min(v->dim, o->dim) ? o->v[i] : 0.0f;
+    else
+        for (int i = 0; i < v->dim; ++i) v->v[i] = static_cast<float>(luaL_optnumber(L, i + 2, v->v[i]));
+
+    lua_settop(L, 1);
+    return 1;
+}
+
+static int vectorUnpack(lua_State* L)
+{
+    const Vector* v = checkVector(L, 1);
+    for (int i = 0; i < v->dim; ++i) lua_pushnumber(L, v->v[i]);
+
+    return v->dim;
+}
+
+static int vectorClone(lua_State* L)
+{
+    const Vector* v = checkVector(L, 1);
+    std::memcpy(newVector(L, v->dim)->v, v->v, sizeof(v->v));
+
+    return 1;
+}
+
+static int vectorLength(lua_State* L)
+{
+    const Vector* v = checkVector(L, 1);
+    float r = 0.0f;
+    VecKernels::dot(v->v, v->v, &r, 1);
+
+    lua_pushnumber(L, std::sqrt(r));
+    return 1;
+}
+
+static int vectorNormalize(lua_State* L)
+{
+    Vector* v = checkVector(L, 1);
+    float r = 0.0f;
+    VecKernels::dot(v->v, v->v, &r, 1);
+    if (r > 0.0f) VecKernels::scale(v->v, 1.0f / std::sqrt(r), v->v, 4);
+
+    lua_settop(L, 1);
+    return 1;
+}
+
+using Kernel = void (*)(const float* a, const float* b, float* out, size_t n);
+
+static int vectorArith(lua_State* L, const Kernel kernel)
+{
+    const Vector *a = static_cast<Vector*>(luaL_testudata(L, 1, VECTOR_MT)),
+                 *b = static_cast<Vector*>(luaL_testudata(L, 2, VECTOR_MT));
+    luaL_argcheck(L, a && b && a->dim == b->dim, 2, "vectors of the same size expected");
+
+    Vector* out = outVector(L, 3, a->dim);
+    kernel(a->v, b->v, out->v, 4);
+
+    return 1;
+}
+
+static int vectorAdd(lua_State* L) { return vectorArith(L, VecKernels::add); }
+static int vectorSub(lua_State* L) { return vectorArith(L, VecKernels::sub); }
+
+// Moves a leading scalar after the vector or array it scales, leaving any destination argument in place.
+static void scalarLast(lua_State* L)
+{
+    if (!lua_isnumber(L, 1)) return;
+
+    lua_pushvalue(L, 1);
+    lua_remove(L, 1);
+    lua_insert(L, 2);
+}
+
+static int vectorMul(lua_State* L)
+{
+    scalarLast(L);
+    const Vector* a = checkVector(L, 1);
+
+    if (lua_isnumber(L, 2))
+    {
+        Vector* out = outVector(L, 3, a->dim);
+        VecKernels::scale(a->v, static_cast<float>(lua_tonumber(L, 2)), out->v, 4);
+
+        return 1;
+    }
+
+    const Vector* b = checkVector(L, 2);
+    luaL_argcheck(L, a->dim == b->dim, 2, "vectors of the same size expected");
+
+    Vector* out = outVector(L, 3, a->dim);
+    VecKernels::mul(a->v, b->v, out->v, 4);
+
+    return 1;
+}
+
+static int vectorUnm(lua_State* L)
+{
+    const Vector* a = checkVector(L, 1);
+    VecKernels::scale(a->v, -1.0f, newVector(L, a->dim)->v, 4);
+
+    return 1;
+}
+
+static int vectorEq(lua_State* L)
+{
+    const Vector *a = checkVector(L, 1), *b = checkVector(L, 2);
+    lua_pushboolean(L, a->dim == b->dim && std::memcmp(a->v, b->v, sizeof(a->v)) == 0);
+
+    return 1;
+}
+
+static int vectorLen(lua_State* L)
+{
+    lua_pushinteger(L, checkVector(L, 1)->dim);
+    return 1;
+}
+
+static int vectorToString(lua_State* L)
+{
+    const Vector* v = checkVector(L, 1);
+    luaL_Buffer b;
+    luaL_buffinit(L, &b);
+    luaL_addstring(&b, "vec");
+    lua_pushinteger(L, v->dim);
+    luaL_addvalue(&b);
+    luaL_addchar(&b, '(');
+
+    for (int i = 0; i < v->dim; ++i)
+    {
+        if (i > 0) luaL_addstring(&b, ", ");
+        lua_pushnumber(L, v->v[i]);
+        luaL_addvalue(&b);
+    }
+
+    luaL_addchar(&b, ')');
+    luaL_pushresult(&b);
+
+    return 1;
+}
+
+static int vecMat4(lua_State* L)
+{
+    const bool explicitValues = lua_gettop(L) >= 16;
+    float values[16] = {};
+    if (explicitValues) for (int i = 0; i < 16; ++i) values[i] = static_cast<float>(luaL_checknumber(L, i + 1));
+
+    Mat4* m = newMat4(L);
+    if (explicitValues) std::memcpy(m->m, values, sizeof(values));
+
+    return 1;
+}
+
+static int vecTranslation(lua_State* L)
+{
+    const auto x = static_cast<float>(luaL_checknumber(L, 1)), y = static_cast<float>(luaL_checknumber(L, 2)),
+               z = static_cast<float>(luaL_optnumber(L, 3, 0));
+    Mat4* m = newMat4(L);
+
+    m->m[12] = x;
+    m->m[13] = y;
+    m->m[14] = z;
+
+    return 1;
+}
+
+static int vecScaling(lua_State* L)
+{
+    const auto sx = static_cast<float>(luaL_checknumber(L, 1)), sy = static_cast<float>(luaL_optnumber(L, 2, sx)),
+               sz = static_cast<float>(luaL_optnumber(L, 3, sx));
+    Mat4* m = newMat4(L);
+
+    m->m[0] = sx;
+    m->m[5] = sy;
+    m->m[10] = sz;
+
+    return 1;
+}
+
+static int vecRotation(lua_State* L)
+{
+    const auto a = static_cast<float>(luaL_checknumber(L, 1));
+    Mat4* m = newMat4(L);
+    const float c = std::cos(a), s = std::sin(a);
+
+    m->m[0] = c;
+    m->m[1] = s;
+    m->m[4] = -s;
+    m->m[5] = c;
+
+    return 1;
+}
+
+static int mat4Index(lua_State* L)
+{
+    const Mat4* m = checkMat4(L, 1);
+    if (lua_isinteger(L, 2))
+    {
+        const lua_Integer i = lua_tointeger(L, 2);
+        luaL_argcheck(L, i >= 1 && i <= 16, 2, "index out of range");
+        lua_pushnumber(L, m->m[i - 1]);
+
+        return 1;
+    }
+
+    lua_gettable(L, lua_upvalueindex(1));
+    return 1;
+}
+
+static int mat4NewIndex(lua_State* L)
+{
+    Mat4* m = checkMat4(L, 1);
+    const lua_Integer i = luaL_checkinteger(L, 2);
+    luaL_argcheck(L, i >= 1 && i <= 16, 2, "index out of range");
+
+    m->m[i - 1] = static_cast<float>(luaL_checknumber(L, 3));
+    return 0;
+}
+
+static int mat4Mul(lua_State* L)
+{
+    const Mat4* a = checkMat4(L, 1);
+    if (const Vector* v = static_cast<Vector*>(luaL_testudata(L, 2, VECTOR_MT)))
+    {
+        Vector* out = outVector(L, 3, v->dim);
+        VecKernels::transform(a->m, v->v, out->v, 1, v->dim);
+
+        return 1;
+    }
+
+    const Mat4* b = checkMat4(L, 2);
+    Mat4* out = lua_isnoneornil(L, 3) ? newMat4(L) : checkMat4(L, 3);
+    if (!lua_isnoneornil(L, 3)) lua_pushvalue(L, 3);
+    VecKernels::mat4Mul(a->m, b->m, out->m);
+
+    return 1;
+}
+
+static int mat4Set(lua_State* L)
+{
+    Mat4* m = checkMat4(L, 1);
+    if (const Mat4* o = static_cast<Mat4*>(luaL_testudata(L, 2, MAT4_MT))) std::memcpy(m->m, o->m, sizeof(m->m));
+    else
+        for (int i = 0; i < 16; ++i) m->m[i] = static_cast<float>(luaL_optnumber(L, i + 2, m->m[i]));
+
+    lua_settop(L, 1);
+    return 1;
+}
+
+static int mat4Identity(lua_State* L)
+{
+    Mat4* m = checkMat4(L, 1);
+    std::memset(m->m, 0, sizeof(m->m));
+    m->m[0] = m->m[5] = m->m[10] = m->m[15] = 1.0f;
+
+    lua_settop(L, 1);
+    return 1;
+}
+
+static int vecArray(lua_State* L)
+{
+    const lua_Integer n = luaL_checkinteger(L, 1), dim = luaL_optinteger(L, 2, 2);
+    luaL_argcheck(L, dim >= 1 && dim <= 4, 2, "dimension must be 1..4");
+    luaL_argcheck(L, n >= 0, 1, "negative size");
+    luaL_argcheck(L, static_cast<uint64_t>(n) <= maxArrayCount(static_cast<int>(dim)), 1, "array too large");
+
+    newArray(L, static_cast<size_t>(n), static_cast<int>(dim));
+    return 1;
+}
+
+static size_t checkArrayIndex(lua_State* L, const VecArray* a, const int arg)
+{
+    const lua_Integer i = luaL_checkinteger(L, arg);
+    luaL_argcheck(L, i >= 1 && static_cast<size_t>(i) <= a->count, arg, "index out of range");
+
+    return static_cast<size_t>(i - 1);
+}
+
+static int arrayGet(lua_State* L)
+{
+    const VecArray* a = checkArray(L, 1);
+    const float* v = a->data + checkArrayIndex(L, a, 2) * a->stride;
+    for (int i = 0; i < a->dim; ++i) lua_pushnumber(L, v[i]);
+
+    return a->dim;
+}
+
+static int arraySet(lua_State* L)
+{
+    VecArray* a = checkArray(L, 1);
+    float* v = a->data + checkArrayIndex(L, a, 2) * a->stride;
+
+    if (const Vector* o = static_cast<Vector*>(luaL_testudata(L, 3, VECTOR_MT)))
+        for (int i = 0; i < a->dim; ++i) v[i] = o->v[i];
+    else
+        for (int i = 0; i < a->dim; ++i) v[i] = static_cast<float>(luaL_optnumber(L, i + 3, v[i]));
+
+    return 0;
+}
+
+static int arrayLen(lua_State* L)
+{
+    lua_pushinteger(L, static_cast<lua_Integer>(checkArray(L, 1)->count));
+    return 1;
+}
+
+static int arrayIndex(lua_State* L)
+{
+    const VecArray* a = checkArray(L, 1);
+    if (const char* key = lua_tostring(L, 2); key && std::strcmp(key, "dim") == 0)
+    {
+        lua_pushinteger(L, a->dim);
+        return 1;
+    }
+
+    lua_gettable(L, lua_upvalueindex(1));
+    return 1;
+}
+
+static int arrayArith(lua_State* L, const Kernel kernel)
+{
+    const VecArray *a = checkArray(L, 1), *b = checkArray(L, 2);
+    luaL_argcheck(L, a->dim == b->dim && a->count == b->count, 2, "arrays of the same shape expected");
+
+    VecArray* out = outArray(L, 3, a->count, a->dim);
+    kernel(a->data, b->data, out->data, a->count * a->stride);
+
+    return 1;
+}
+
+static int vecAdd(lua_State* L)
+{
+    return luaL_testudata(L, 1, VECTOR_MT) ? vectorAdd(L) : arrayArith(L, VecKernels::add);
+}
+
+static int vecSub(lua_State* L)
+{
+    return luaL_testudata(L, 1, VECTOR_MT) ? vectorSub(L) : arrayArith(L, VecKernels::sub);
+}
+
+static int vecMul(lua_State* L)
+{
+    scalarLast(L);
+    if (luaL_testudata(L, 1, VECTOR_MT)) return vectorMul(L);
+    if (!lua_isnumber(L, 2)) return arrayArith(L, VecKernels::mul);
+
+    const VecArray* a = checkArray(L, 1);
+    VecArray* out = outArray(L, 3, a->count, a->dim);
+    VecKernels::scale(a->data, static_cast<float>(lua_tonumber(L, 2)), out->data, a->count * a->stride);
+
+    return 1;
+}
+
+static int vecScale(lua_State* L)
+{
+    const auto s = static_cast<float>(luaL_checknumber(L, 2));
+    if (const Vector* v = static_cast<Vector*>(luaL_testudata(L, 1, VECTOR_MT)))
+    {
+        Vector* out = outVector(L, 3, v->dim);
+        VecKernels::scale(v->v, s, out->v, 4);
+
+        return 1;
+    }
+
+    const VecArray* a = checkArray(L, 1);
+    VecArray* out = outArray(L, 3, a->count, a->dim);
+    VecKernels::scale(a->data, s, out->data, a->count * a->stride);
+
+    return 1;
+}
+
+static int vecDot(lua_State* L)
+{
+    if (const Vector* v = static_cast<Vector*>(luaL_testudata(L, 1, VECTOR_MT)))
+    {
+        const Vector* w = checkVector(L, 2);
+        float r = 0.0f;
+        VecKernels::dot(v->v, w->v, &r, 1);
+
+        lua_pushnumber(L, r);
+        return 1;
+    }
+
+    const VecArray *a = checkArray(L, 1), *b = checkArray(L, 2);
+    luaL_argcheck(L, a->dim == b->dim && a->count == b->count && a->stride == 4, 2,
+                  "arrays of the same shape expected");
+
+    VecArray* out = outArray(L, 3, a->count, 1);
+    VecKernels::dot(a->data, b->data, out->data, a->count);
+
+    return 1;
+}
+
+static int vecTransform(lua_State* L)
+{
+    const Mat4* m = checkMat4(L, 1);
+    if (const Vector* v = static_cast<Vector*>(luaL_testudata(L, 2, VECTOR_MT)))
+    {
+        Vector* out = outVector(L, 3, v->dim);
+        VecKernels::transform(m->m, v->v, out->v, 1, v->dim);
+
+        return 1;
+    }
+
+    const VecArray* a = checkArray(L, 2);
+    luaL_argcheck(L, a->stride == 4, 2, "array of vec2/vec3/vec4 expected");
+
+    VecArray* out = outArray(L, 3, a->count, a->dim);
+    VecKernels::transform(m->m, a->data, out->data, a->count, a->dim);
+
+    return 1;
+}
+
+static void registerType(lua_State* L, const char* name, const luaL_Reg* meta, const luaL_Reg* methods,
+                         const lua_CFunction index)
+{
+    luaL_newmetatable(L, name);
+    luaL_setfuncs(L, meta, 0);
+
+    lua_newtable(L);
+    luaL_setfuncs(L, methods, 0);
+    lua_pushcclosure(L, index, 1);
+    lua_setfield(L, -2, "__index");
+
+    lua_pop(L, 1);
+}
+
+int luaopen_vec(lua_State* L)
+{
+    static constexpr luaL_Reg vectorMeta[] = {
+        {"__newindex", vectorNewIndex},
+        {"__add", vectorAdd},
+        {"__sub", vectorSub},
+        {"__mul", vectorMul},
+        {"__unm", vectorUnm},
+        {"__eq", vectorEq},
+        {"__len", vectorLen},
+        {"__tostring", vectorToString},
+        {nullptr, nullptr}
+    };
+    static constexpr luaL_Reg vectorMethods[] = {
+        {"set", vectorSet},
+        {"unpack", vectorUnpack},
+        {"clone", vectorClone},
+        {"length", vectorLength},
+        {"normalize", vectorNormalize},
+        {nullptr, nullptr}
+    };
+    static constexpr luaL_Reg mat4Meta[] = {
+        {"__newindex", mat4NewIndex},
+        {"__mul", mat4Mul},
+        {nullptr, nullptr}
+    };
+    static constexpr luaL_Reg mat4Methods[] = {
+        {"set", mat4Set},
+        {"identity", mat4Identity},
+        {"mul", mat4Mul},
+        {nullptr, nullptr}
+    };
+    static constexpr luaL_Reg arrayMeta[] = {
+        {"__len", arrayLen},
+        {nullptr, nullptr}
+    };
+    static constexpr luaL_Reg arrayMethods[] = {
+        {"get", arrayGet},
+        {"set", arraySet},
+        {nullptr, nullptr}
+    };
+    static constexpr luaL_Reg funcs[] = {
+        {"vec2", vecVec2},
+        {"vec3", vecVec3},
+        {"vec4", vecVec4},
+        {"mat4", vecMat4},
+        {"translation", vecTranslation},
+        {"scaling", vecScaling},
+        {"rotation", vecRotation},
+        {"array", vecArray},
+        {"add", vecAdd},
+        {"sub", vecSub},
+        {"mul", vecMul},
+        {"scale", vecScale},
+        {"dot", vecDot},
+        {"transform", vecTransform},
+        {nullptr, nullptr}
+    };
+
+    registerType(L, VECTOR_MT, vectorMeta, vectorMethods, vectorIndex);
+    registerType(L, MAT4_MT, mat4Meta, mat4Methods, mat4Index);
+    registerType(L, ARRAY_MT, arrayMeta, arrayMethods, arrayIndex);
+
+    luaL_newlib(L, funcs);
+    return 1;
+}
@@ -0,0 +1,7 @@
+#pragma once
+
+extern "C" {
+#include <lua.h>
+#include <lauxlib.h>
+#include <lualib.h>
+}
@@ -0,0 +1,8 @@
+#pragma once
+
+#include "./lua_api.h"
+
+int luaopen_gfx(lua_State* L);
+int luaopen_vec(lua_State* L);
+int luaopen_task(lua_State* L);
+int luaopen_bytes(lua_State* L);
@@ -0,0 +1,111 @@
+#include "./output_buffer.h"
+
+#include <cstring>
+#include <algorithm>
+
+OutputBuffer::OutputBuffer(const size_t capacityBytes, const size_t maxLines, const size_t maxLineLength)
+    : bytes(std::max<size_t>(capacityBytes, 64)), lineStarts(std::max<size_t>(maxLines, 2)),
+      maxLineLength(std::clamp<size_t>(maxLineLength, 1, std::min(bytes.size() / 2, MAX_LINE_LENGTH)))
+{
+}
+
+void OutputBuffer::append(const std::string_view text)
+{
+    if (text.empty()) return;
+
+    size_t i = 0;
+    while (i < text.size())
+    {
+        const size_t nl = text.find('\n', i), end = nl == std::string_view::npos ? text.size() : nl;
+        while (i < end)
+        {
+            const size_t open = static_cast<size_t>(head - startOf(lines - 1));
+            if (open >= maxLineLength)
+            {
+                newLine();
+                continue;
+            }
+
+            const size_t take = std::min(maxLineLength - open, end - i);
+            write(text.data() + i, take);
+            i += take;
+        }
+
+        if (nl == std::string_view::npos) break;
+
+        newLine();
+        i = nl + 1;
+    }
+
+    changes++;
+}
+
+void OutputBuffer::clear()
+{
+    firstLine = 0;
+    lines = 1;
+    tail = head = 0;
+    lineStarts[0] = 0;
+    changes++;
+}
+
+size_t OutputBuffer::lineCount() const { return lines; }
+
+size_t OutputBuffer::lineLength(const size_t line) const
+{
+    return line < lines ? static_cast<size_t>(endOf(line) - startOf(line)) : 0;
+}
+
+size_t OutputBuffer::copyLine(const size_t line, char* out, const size_t outSize) const
+{
+    if (!out || outSize == 0) return 0;
+
+    const size_t n = std::min(lineLength(line), outSize - 1);
+    if (n > 0)
+    {
+        const size_t at = static_cast<size_t>(startOf(line) % bytes.size()), first = std::min(n, bytes.size() - at);
+
+        std::memcpy(out, bytes.data() + at, first);
+        std::memcpy(out + first, bytes.data(), n - first);
+    }
+
+    out[n] = '\0';
+    return n;
+}
+
+uint64_t OutputBuffer::version() const { return changes; }
+uint64_t OutputBuffer::droppedLines() const { return dropped; }
+size_t OutputBuffer::bytesUsed() const { return static_cast<size_t>(head - tail); }
+bool OutputBuffer::empty() const { return lines == 1 && head == tail; }
+
+uint64_t OutputBuffer::startOf(const size_t line) const { return lineStarts[(firstLine + line) % lineStarts.size()]; }
+uint64_t OutputBuffer::endOf(const size_t line) const { return line + 1 < lines ? startOf(line + 1) : head; }
+
+void OutputBuffer::newLine()
+{
+    if (lines == lineStarts.size()) dropOldest();
+
+    lineStarts[(firstLine + lines) % lineStarts.size()] = head;
+    lines++;
+}
+
+void OutputBuffer::dropOldest()
+{
+    if (lines < 2) return;
+
+    tail = startOf(1);
+    firstLine = (firstLine + 1) % lineStarts.size();
+    lines--;
+    dropped++;
+}
+
+void OutputBuffer::write(const char* data, const size_t n)
+{
+    while (head - tail + n > bytes.size() && lines > 1) dropOldest();
+
+    const size_t at = static_cast<size_t>(head % bytes.size()), first = std::min(n, bytes.size() - at);
+    std::memcpy(bytes.data() + at, data, first);
+    std::memcpy(bytes.data(), data + first, n - first);
+
+    head += n;
+}
@@ -0,0 +1,40 @@
+#pragma once
+
+#include <vector>
+#include <cstdint>
+#include <cstddef>
+#include <string_view>
+
+class OutputBuffer
+{
+public:
+    // Longer lines wrap onto a new one; readers can size a line buffer from this.
+    static constexpr size_t MAX_LINE_LENGTH = 512;
+
+    explicit OutputBuffer(size_t capacityBytes = 64 * 1024, size_t maxLines = 4096,
+                          size_t maxLineLength = MAX_LINE_LENGTH);
+
+    void append(std::string_view text);
+    void clear();
+
+    [[nodiscard]] size_t lineCount() const;
+    [[nodiscard]] size_t lineLength(size_t line) const;
+    size_t copyLine(size_t line, char* out, size_t outSize) const;
+
+    [[nodiscard]] uint64_t version() const;
+    [[nodiscard]] uint64_t droppedLines() const;
+    [[nodiscard]] size_t bytesUsed() const;
+    [[nodiscard]] bool empty() const;
+
+private:
+    std::vector<char> bytes;
+    std::vector<uint64_t> lineStarts;
+    size_t maxLineLength = 0, firstLine = 0, lines = 1;
+    uint64_t tail = 0, head = 0, changes = 0, dropped = 0;
+
+    [[nodiscard]] uint64_t startOf(size_t line) const;
+    [[nodiscard]] uint64_t endOf(size_t line) const;
+    void newLine();
+    void dropOldest();
+    void write(const char* data, size_t n);
+};
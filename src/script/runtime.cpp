@@ -0,0 +1,247 @@
+#include "./runtime.h"
+#include "./modules.h"
+#include "../platform/platform.h"
+#include "../debug/profiler.h"
+#include "../debug/memory.h"
+
+#include <cstdlib>
+
+static int scriptPrint(lua_State* L)
+{
+    OutputBuffer& out = ScriptRuntime::from(L).output();
+    const int n = lua_gettop(L);
+
+    for (int i = 1; i <= n; ++i)
+    {
+        size_t len = 0;
+        const char* s = luaL_tolstring(L, i, &len);
+
+        if (i > 1) out.append("\t");
+        out.append({s, len});
+        lua_pop(L, 1);
+    }
+
+    out.append("\n");
+    return 0;
+}
+
+static int scriptWrite(lua_State* L)
+{
+    OutputBuffer& out = ScriptRuntime::from(L).output();
+    const int n = lua_gettop(L);
+
+    for (int i = 1; i <= n; ++i)
+    {
+        size_t len = 0;
+        const char* s = luaL_checklstring(L, i, &len);
+        out.append({s, len});
+    }
+
+    lua_pushvalue(L, lua_upvalueindex(1));
+    return 1;
+}
+
+#ifdef WIISCRIPT_MEMORY
+static void* trackedAlloc(void*, void* ptr, const size_t osize, const size_t nsize)
+{
+    if (nsize == 0)
+    {
+        if (ptr) Memory::recordFree(Memory::Category::Lua, osize);
+        std::free(ptr);
+        return nullptr;
+    }
+
+    void* next = std::realloc(ptr, nsize);
+    if (!next) return nullptr;
+
+    if (ptr) Memory::recordFree(Memory::Category::Lua, osize);
+    Memory::recordAlloc(Memory::Category::Lua, nsize);
+
+    return next;
+}
+#endif
+
+static void openLibraries(lua_State* L)
+{
+    luaL_openlibs(L);
+
+    lua_register(L, "print", scriptPrint);
+    if (lua_getglobal(L, "io") == LUA_TTABLE)
+    {
+        lua_getfield(L, -1, "stdout");
+        lua_pushcclosure(L, scriptWrite, 1);
+        lua_setfield(L, -2, "write");
+    }
+    lua_pop(L, 1);
+    luaL_requiref(L, "gfx", luaopen_gfx, 1);
+    luaL_requiref(L, "vec", luaopen_vec, 1);
+    luaL_requiref(L, "task", luaopen_task, 1);
+    luaL_requiref(L, "bytes", luaopen_bytes, 1);
+    lua_pop(L, 4);
+}
+
+// String keys of the table on top of the stack; with `depth` left, also those of the tables it holds.
+static void tableKeys(lua_State* L, const int depth, std::vector<std::string>& out)
+{
+    lua_pushnil(L);
+    while (lua_next(L, -2) != 0)
+    {
+        if (lua_type(L, -2) == LUA_TSTRING)
+        {
+            out.emplace_back(lua_tostring(L, -2));
+            if (depth > 0 && lua_type(L, -1) == LUA_TTABLE && out.back() != "_G" && out.back() != "package")
+                tableKeys(L, depth - 1, out);
+        }
+        lua_pop(L, 1);
+    }
+}
+
+ScriptRuntime::ScriptRuntime(DrawBackend& backend) : backend(&backend)
+{
+}
+
+ScriptRuntime::~ScriptRuntime() { stop(); }
+
+bool ScriptRuntime::run(const std::string& source, const std::string& chunkName, std::string* outError)
+{
+    stop();
+
+    L = luaL_newstate();
+    if (!L)
+    {
+        if (outError) *outError = "Not enough memory to start the script.";
+        return false;
+    }
+#ifdef WIISCRIPT_MEMORY
+    lua_setallocf(L, trackedAlloc, nullptr);
+    Memory::recordAlloc(Memory::Category::Lua, static_cast<size_t>(lua_gc(L, LUA_GCCOUNT)) * 1024 +
+                        static_cast<size_t>(lua_gc(L, LUA_GCCOUNTB)));
+#endif
+
+    *static_cast<ScriptRuntime**>(lua_getextraspace(L)) = this;
+    openLibraries(L);
+    outputBuffer.clear();
+    tasks.attach(L);
+
+    if (luaL_loadbuffer(L, source.data(), source.size(), chunkName.c_str()) != LUA_OK ||
+        lua_pcall(L, 0, 0, 0) != LUA_OK)
+    {
+        const std::string msg = lua_isstring(L, -1) ? lua_tostring(L, -1) : "Unknown error.";
+        if (outError) *outError = msg;
+
+        stop();
+        outputBuffer.append(msg);
+        outputBuffer.append("\n");
+
+        return false;
+    }
+
+    return true;
+}
+
+void ScriptRuntime::globalNames(std::vector<std::string>& out)
+{
+    lua_State* names = luaL_newstate();
+    if (!names) return;
+
+    openLibraries(names);
+    lua_pushglobaltable(names);
+    tableKeys(names, 1, out);
+    lua_close(names);
+}
+
+void ScriptRuntime::stop()
+{
+    commands.clear();
+    pendingError.clear();
+
+    if (!L) return;
+
+    tasks.reset();
+    lua_close(L);
+    L = nullptr;
+    if (backend) backend->clearTextures();
+}
+
+bool ScriptRuntime::isRunning() const { return L != nullptr; }
+
+void ScriptRuntime::update(const double dt)
+{
+    if (!L) return;
+    {
+        PROFILE_ZONE("lua.update");
+        if (!callGlobal("update", dt, true)) return;
+    }
+
+    PROFILE_ZONE("lua.tasks");
+    if (std::string err; L && !tasks.tick(Time::seconds(), &err)) fail(err);
+}
+
+void ScriptRuntime::dispatch(const Input::InputEvent& e)
+{
+    if (L) tasks.dispatch(e);
+}
+
+void ScriptRuntime::draw()
+{
+    if (L)
+    {
+        PROFILE_ZONE("lua.draw");
+        callGlobal("draw", 0.0, false);
+    }
+
+    PROFILE_ZONE("gfx.flush");
+    if (backend) commands.flush(*backend);
+}
+
+bool ScriptRuntime::takeError(std::string& outError)
+{
+    if (pendingError.empty()) return false;
+
+    outError = std::move(pendingError);
+    pendingError.clear();
+
+    return true;
+}
+
+CommandBuffer& ScriptRuntime::drawList() { return commands; }
+DrawBackend& ScriptRuntime::drawBackend() { return *backend; }
+TaskScheduler& ScriptRuntime::scheduler() { return tasks; }
+OutputBuffer& ScriptRuntime::output() { return outputBuffer; }
+lua_State* ScriptRuntime::state() const { return L; }
+ScriptRuntime& ScriptRuntime::from(lua_State* L) { return **static_cast<ScriptRuntime**>(lua_getextraspace(L)); }
+
+std::string ScriptRuntime::resolvePath(const std::string& path)
+{
+    if (path.rfind("sd:/", 0) == 0) return FileSystem::normalize(path);
+    return FileSystem::join(FileSystem::workspaceRoot, path);
+}
+
+bool ScriptRuntime::callGlobal(const char* name, const double arg, const bool hasArg)
+{
+    if (lua_getglobal(L, name) != LUA_TFUNCTION)
+    {
+        lua_pop(L, 1);
+        return true;
+    }
+
+    if (hasArg) lua_pushnumber(L, static_cast<lua_Number>(arg));
+    if (lua_pcall(L, hasArg ? 1 : 0, 0, 0) != LUA_OK)
+    {
+        const char* msg = lua_tostring(L, -1);
+        fail(msg ? msg : "Unknown error.");
+
+        return false;
+    }
+
+    return true;
+}
+
+void ScriptRuntime::fail(const std::string& message)
+{
+    stop();
+    pendingError = message;
+
+    outputBuffer.append(message);
+    outputBuffer.append("\n");
+}
@@ -0,0 +1,52 @@
+#pragma once
+
+#include <string>
+#include <vector>
+
+#include "./scheduler.h"
+#include "./output_buffer.h"
+#include "../gfx/command_buffer.h"
+
+struct lua_State;
+
+class ScriptRuntime
+{
+public:
+    explicit ScriptRuntime(DrawBackend& backend);
+    ~ScriptRuntime();
+
+    ScriptRuntime(const ScriptRuntime&) = delete;
+    ScriptRuntime& operator=(const ScriptRuntime&) = delete;
+
+    bool run(const std::string& source, const std::string& chunkName, std::string* outError = nullptr);
+    void stop();
+    [[nodiscard]] bool isRunning() const;
+
+    void update(double dt);
+    void dispatch(const Input::InputEvent& e);
+    void draw();
+
+    bool takeError(std::string& outError);
+
+    [[nodiscard]] CommandBuffer& drawList();
+    [[nodiscard]] DrawBackend& drawBackend();
+    [[nodiscard]] TaskScheduler& scheduler();
+    [[nodiscard]] OutputBuffer& output();
+    // The running script's state, or null when none is running.
+    [[nodiscard]] lua_State* state() const;
+    static ScriptRuntime& from(lua_State* L);
+    static std::string resolvePath(const std::string& path);
+    // Globals a script starts with, and the fields of the libraries among them.
+    static void globalNames(std::vector<std::string>& out);
+
+private:
+    lua_State* L = nullptr;
+    DrawBackend* backend = nullptr;
+    CommandBuffer commands;
+    TaskScheduler tasks;
+    OutputBuffer outputBuffer;
+    std::string pendingError;
+
+    bool callGlobal(const char* name, double arg, bool hasArg);
+    void fail(const std::string& message);
+};
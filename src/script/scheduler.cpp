@@ -0,0 +1,283 @@
+#include "./scheduler.h"
+#include "./lua_api.h"
+
+#include <cstring>
+#include <algorithm>
+#include <functional>
+
+static constexpr const char* KEY_NAMES[] = {
+    "", "Home", "Up", "Down", "Left", "Right", "A", "B", "Plus", "Minus", "One", "Two", "C", "Z", "StickLeft",
+    "StickRight", "StickUp", "StickDown"
+};
+
+void TaskScheduler::attach(lua_State* L)
+{
+    reset();
+    this->L = L;
+    started = Time::seconds();
+}
+
+void TaskScheduler::reset()
+{
+    L = nullptr;
+    tasks.clear();
+    freeList.clear();
+    pending.clear();
+    running.clear();
+    timers.clear();
+    for (auto& w : inputWaiters) w.clear();
+
+    active = staleTimers = staleWaiters = 0;
+    current = -1;
+}
+
+bool TaskScheduler::spawn(lua_State* from, const int nargs, uint32_t& outId)
+{
+    uint32_t index = 0;
+    if (!freeList.empty())
+    {
+        index = freeList.back();
+        freeList.pop_back();
+    }
+    else
+    {
+        if (tasks.size() >= MAX_TASKS) return false;
+
+        lua_State* co = lua_newthread(from);
+        const int ref = luaL_ref(from, LUA_REGISTRYINDEX);
+
+        index = static_cast<uint32_t>(tasks.size());
+        tasks.push_back({.thread = co, .ref = ref});
+    }
+
+    Task& t = tasks[index];
+    lua_xmove(from, t.thread, nargs + 1);
+    t.nargs = nargs;
+    active++;
+    makeReady(index);
+    outId = makeId(index);
+
+    return true;
+}
+
+bool TaskScheduler::cancel(const uint32_t id)
+{
+    const uint32_t index = id & 0xFFFF;
+    if (index >= tasks.size()) return false;
+
+    const Task& t = tasks[index];
+    if (makeId(index) != id || t.state == State::Free || t.state == State::Running) return false;
+
+    const State was = t.state;
+    release(index, true);
+
+    // A cancelled sleeper leaves its timer in the heap until it would have woken, and a cancelled input waiter stays
+    // queued until its key is pressed; once those outnumber the live entries they are dropped.
+    if (was == State::Sleeping)
+    {
+        staleTimers++;
+        if (staleTimers > timers.size() - staleTimers)
+        {
+            std::erase_if(timers, [this](const Timer& timer) { return !isWaiting(timer.waiter, State::Sleeping); });
+            std::make_heap(timers.begin(), timers.end(), std::greater<>());
+            staleTimers = 0;
+        }
+    }
+    else if (was == State::WaitInput)
+    {
+        staleWaiters++;
+        size_t queued = 0;
+        for (const auto& waiters : inputWaiters) queued += waiters.size();
+        if (staleWaiters > queued - staleWaiters)
+        {
+            for (auto& waiters : inputWaiters)
+                std::erase_if(waiters, [this](const Waiter& w) { return !isWaiting(w, State::WaitInput); });
+            staleWaiters = 0;
+        }
+    }
+
+    return true;
+}
+
+int TaskScheduler::sleepUntil(lua_State* L, const double wakeTime)
+{
+    if (!inTask(L)) return luaL_error(L, "attempt to sleep outside of a task");
+
+    timers.push_back({wakeTime, beginWait(current, State::Sleeping)});
+    std::push_heap(timers.begin(), timers.end(), std::greater<>());
+
+    return lua_yield(L, 0);
+}
+
+int TaskScheduler::waitFrame(lua_State* L)
+{
+    if (!inTask(L)) return luaL_error(L, "attempt to wait for a frame outside of a task");
+
+    tasks[current].nargs = 0;
+    makeReady(current);
+
+    return lua_yield(L, 0);
+}
+
+int TaskScheduler::waitInput(lua_State* L, const Input::Key key)
+{
+    if (!inTask(L)) return luaL_error(L, "attempt to wait for input outside of a task");
+
+    inputWaiters[static_cast<size_t>(key)].push_back(beginWait(current, State::WaitInput));
+    return lua_yield(L, 0);
+}
+
+bool TaskScheduler::tick(double now, std::string* outError)
+{
+    if (!L) return true;
+
+    running.swap(pending);
+    pending.clear();
+
+    now -= started;
+    while (!timers.empty() && timers.front().wake <= now)
+    {
+        std::pop_heap(timers.begin(), timers.end(), std::greater<>());
+        const Waiter w = timers.back().waiter;
+        timers.pop_back();
+
+        if (!isWaiting(w, State::Sleeping))
+        {
+            if (staleTimers > 0) staleTimers--;
+            continue;
+        }
+        tasks[w.index].nargs = 0;
+        tasks[w.index].state = State::Ready;
+        running.push_back(w);
+    }
+
+    for (const Waiter& w : running)
+    {
+        if (!isCurrent(w) || tasks[w.index].state != State::Ready) continue;
+
+        tasks[w.index].state = State::Running;
+        current = static_cast<int>(w.index);
+
+        int nres = 0;
+        const int status = lua_resume(tasks[w.index].thread, L, tasks[w.index].nargs, &nres);
+        Task& t = tasks[w.index];
+        current = -1;
+
+        if (status == LUA_YIELD)
+        {
+            lua_pop(t.thread, nres);
+            if (t.state == State::Running)
+            {
+                t.nargs = 0;
+                makeReady(w.index);
+            }
+            continue;
+        }
+
+        if (status == LUA_OK)
+        {
+            lua_settop(t.thread, 0);
+            release(w.index, false);
+
+            continue;
+        }
+
+        const char* msg = lua_tostring(t.thread, -1);
+        if (outError) *outError = msg ? msg : "Unknown error.";
+
+        release(w.index, true);
+        running.clear();
+
+        return false;
+    }
+
+    running.clear();
+    return true;
+}
+
+void TaskScheduler::dispatch(const Input::InputEvent& e)
+{
+    if (!L || e.type != Input::InputEvent::Type::KeyDown) return;
+
+    auto wake = [&](std::vector<Waiter>& waiters)
+    {
+        for (const Waiter& w : waiters)
+        {
+            if (!isWaiting(w, State::WaitInput))
+            {
+                if (staleWaiters > 0) staleWaiters--;
+                continue;
+            }
+            Task& t = tasks[w.index];
+
+            lua_pushstring(t.thread, keyName(e.key));
+            t.nargs = 1;
+            makeReady(w.index);
+        }
+        waiters.clear();
+    };
+
+    if (e.key != Input::Key::None) wake(inputWaiters[static_cast<size_t>(e.key)]);
+    wake(inputWaiters[static_cast<size_t>(Input::Key::None)]);
+}
+
+double TaskScheduler::now() const { return Time::seconds() - started; }
+size_t TaskScheduler::activeCount() const { return active; }
+size_t TaskScheduler::poolSize() const { return tasks.size(); }
+
+bool TaskScheduler::inTask(lua_State* L) const
+{
+    return current >= 0 && tasks[current].thread == L && tasks[current].state == State::Running;
+}
+
+const char* TaskScheduler::keyName(const Input::Key key)
+{
+    const auto i = static_cast<size_t>(key);
+    return i < std::size(KEY_NAMES) ? KEY_NAMES[i] : "";
+}
+
+Input::Key TaskScheduler::keyFromName(const char* name)
+{
+    if (!name) return Input::Key::None;
+    for (size_t i = 1; i < std::size(KEY_NAMES); ++i)
+        if (std::strcmp(KEY_NAMES[i], name) == 0) return static_cast<Input::Key>(i);
+
+    return Input::Key::None;
+}
+
+uint32_t TaskScheduler::makeId(const uint32_t index) const
+{
+    return (tasks[index].generation & 0x7FFF) << 16 | index;
+}
+
+void TaskScheduler::release(const uint32_t index, const bool close)
+{
+    Task& t = tasks[index];
+    if (close) lua_closethread(t.thread, L);
+
+    t.state = State::Free;
+    t.nargs = 0;
+    t.generation++;
+    t.seq++;
+
+    freeList.push_back(index);
+    active--;
+}
+
+bool TaskScheduler::isCurrent(const Waiter& w) const { return w.index < tasks.size() && tasks[w.index].seq == w.seq; }
+
+bool TaskScheduler::isWaiting(const Waiter& w, const State state) const
+{
+    return isCurrent(w) && tasks[w.index].state == state;
+}
+
+TaskScheduler::Waiter TaskScheduler::beginWait(const uint32_t index, const State state)
+{
+    Task& t = tasks[index];
+    t.state = state;
+    t.seq++;
+
+    return {index, t.seq};
+}
+
+void TaskScheduler::makeReady(const uint32_t index) { pending.push_back(beginWait(index, State::Ready)); }
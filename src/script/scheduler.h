@@ -0,0 +1,84 @@
+#pragma once
+
+#include <array>
+#include <string>
+#include <vector>
+#include <cstdint>
+
+#include "../platform/platform.h"
+
+struct lua_State;
+
+class TaskScheduler
+{
+public:
+    enum class State : uint8_t { Free, Ready, Running, Sleeping, WaitInput };
+
+    void attach(lua_State* L);
+    void reset();
+
+    // Ids keep the pool index in their low 16 bits, so at most MAX_TASKS can be alive at once.
+    static constexpr size_t MAX_TASKS = 65536;
+
+    // Fails only when MAX_TASKS are already alive.
+    bool spawn(lua_State* from, int nargs, uint32_t& outId);
+    bool cancel(uint32_t id);
+
+    // Script time: seconds since attach. Lua numbers are single-precision floats, so absolute uptime would lose
+    // sub-frame resolution after a few hours.
+    [[nodiscard]] double now() const;
+    int sleepUntil(lua_State* L, double wakeTime);
+    int waitFrame(lua_State* L);
+    int waitInput(lua_State* L, Input::Key key);
+
+    bool tick(double now, std::string* outError = nullptr);
+    void dispatch(const Input::InputEvent& e);
+
+    [[nodiscard]] size_t activeCount() const;
+    [[nodiscard]] size_t poolSize() const;
+    [[nodiscard]] bool inTask(lua_State* L) const;
+
+    static const char* keyName(Input::Key key);
+    static Input::Key keyFromName(const char* name);
+
+private:
+    struct Task
+    {
+        lua_State* thread = nullptr;
+        int ref = 0, nargs = 0;
+        uint32_t generation = 0, seq = 0;
+        State state = State::Free;
+    };
+
+    struct Waiter
+    {
+        uint32_t index = 0, seq = 0;
+    };
+
+    struct Timer
+    {
+        double wake = 0.0;
+        Waiter waiter;
+
+        bool operator>(const Timer& other) const { return wake > other.wake; }
+    };
+
+    static constexpr size_t KEY_COUNT = static_cast<size_t>(Input::Key::StickDown) + 1;
+
+    lua_State* L = nullptr;
+    std::vector<Task> tasks;
+    std::vector<uint32_t> freeList;
+    std::vector<Waiter> pending, running;
+    std::vector<Timer> timers;
+    std::array<std::vector<Waiter>, KEY_COUNT> inputWaiters;
+    size_t active = 0, staleTimers = 0, staleWaiters = 0;
+    int current = -1;
+    double started = 0.0;
+
+    [[nodiscard]] uint32_t makeId(uint32_t index) const;
+    void release(uint32_t index, bool close);
+    [[nodiscard]] bool isCurrent(const Waiter& w) const;
+    [[nodiscard]] bool isWaiting(const Waiter& w, State state) const;
+    Waiter beginWait(uint32_t index, State state);
+    void makeReady(uint32_t index);
+};
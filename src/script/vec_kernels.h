@@ -0,0 +1,244 @@
+#pragma once
+
+#include <cstddef>
+#include <cstdint>
+
+#if defined(__SSE__)
+#include <xmmintrin.h>
+#endif
+
+// Gekko's paired singles hold two floats per FPR. The compiler never allocates them, so each block keeps its pairs in
+// fixed scratch registers (f0-f13 are volatile in the EABI) and relies on GQR0 staying at its libogc default of
+// unscaled floats.
+namespace VecKernels
+{
+    inline void add(const float* a, const float* b, float* out, const size_t n)
+    {
+        size_t i = 0;
+#if defined(__SSE__)
+        for (; i + 4 <= n; i += 4) _mm_storeu_ps(out + i, _mm_add_ps(_mm_loadu_ps(a + i), _mm_loadu_ps(b + i)));
+#elif defined(GEKKO)
+        for (; i + 4 <= n; i += 4)
+            __asm__ volatile("psq_l 0, 0(%0), 0, 0\n"
+                             "psq_l 1, 8(%0), 0, 0\n"
+                             "psq_l 2, 0(%1), 0, 0\n"
+                             "psq_l 3, 8(%1), 0, 0\n"
+                             "ps_add 0, 0, 2\n"
+                             "ps_add 1, 1, 3\n"
+                             "psq_st 0, 0(%2), 0, 0\n"
+                             "psq_st 1, 8(%2), 0, 0\n"
+                             : : "b"(a + i), "b"(b + i), "b"(out + i) : "fr0", "fr1", "fr2", "fr3", "memory");
+#else
+        for (; i + 4 <= n; i += 4)
+        {
+            const float r0 = a[i] + b[i], r1 = a[i + 1] + b[i + 1], r2 = a[i + 2] + b[i + 2], r3 = a[i + 3] + b[i + 3];
+            out[i] = r0;
+            out[i + 1] = r1;
+            out[i + 2] = r2;
+            out[i + 3] = r3;
+        }
+#endif
+        for (; i < n; ++i) out[i] = a[i] + b[i];
+    }
+
+    inline void sub(const float* a, const float* b, float* out, const size_t n)
+    {
+        size_t i = 0;
+#if defined(__SSE__)
+        for (; i + 4 <= n; i += 4) _mm_storeu_ps(out + i, _mm_sub_ps(_mm_loadu_ps(a + i), _mm_loadu_ps(b + i)));
+#elif defined(GEKKO)
+        for (; i + 4 <= n; i += 4)
+            __asm__ volatile("psq_l 0, 0(%0), 0, 0\n"
+                             "psq_l 1, 8(%0), 0, 0\n"
+                             "psq_l 2, 0(%1), 0, 0\n"
+                             "psq_l 3, 8(%1), 0, 0\n"
+                             "ps_sub 0, 0, 2\n"
+                             "ps_sub 1, 1, 3\n"
+                             "psq_st 0, 0(%2), 0, 0\n"
+                             "psq_st 1, 8(%2), 0, 0\n"
+                             : : "b"(a + i), "b"(b + i), "b"(out + i) : "fr0", "fr1", "fr2", "fr3", "memory");
+#else
+        for (; i + 4 <= n; i += 4)
+        {
+            const float r0 = a[i] - b[i], r1 = a[i + 1] - b[i + 1], r2 = a[i + 2] - b[i + 2], r3 = a[i + 3] - b[i + 3];
+            out[i] = r0;
+            out[i + 1] = r1;
+            out[i + 2] = r2;
+            out[i + 3] = r3;
+        }
+#endif
+        for (; i < n; ++i) out[i] = a[i] - b[i];
+    }
+
+    inline void mul(const float* a, const float* b, float* out, const size_t n)
+    {
+        size_t i = 0;
+#if defined(__SSE__)
+        for (; i + 4 <= n; i += 4) _mm_storeu_ps(out + i, _mm_mul_ps(_mm_loadu_ps(a + i), _mm_loadu_ps(b + i)));
+#elif defined(GEKKO)
+        for (; i + 4 <= n; i += 4)
+            __asm__ volatile("psq_l 0, 0(%0), 0, 0\n"
+                             "psq_l 1, 8(%0), 0, 0\n"
+                             "psq_l 2, 0(%1), 0, 0\n"
+                             "psq_l 3, 8(%1), 0, 0\n"
+                             "ps_mul 0, 0, 2\n"
+                             "ps_mul 1, 1, 3\n"
+                             "psq_st 0, 0(%2), 0, 0\n"
+                             "psq_st 1, 8(%2), 0, 0\n"
+                             : : "b"(a + i), "b"(b + i), "b"(out + i) : "fr0", "fr1", "fr2", "fr3", "memory");
+#else
+        for (; i + 4 <= n; i += 4)
+        {
+            const float r0 = a[i] * b[i], r1 = a[i + 1] * b[i + 1], r2 = a[i + 2] * b[i + 2], r3 = a[i + 3] * b[i + 3];
+            out[i] = r0;
+            out[i + 1] = r1;
+            out[i + 2] = r2;
+            out[i + 3] = r3;
+        }
+#endif
+        for (; i < n; ++i) out[i] = a[i] * b[i];
+    }
+
+    inline void scale(const float* a, const float s, float* out, const size_t n)
+    {
+        size_t i = 0;
+#if defined(__SSE__)
+        const __m128 vs = _mm_set1_ps(s);
+        for (; i + 4 <= n; i += 4) _mm_storeu_ps(out + i, _mm_mul_ps(_mm_loadu_ps(a + i), vs));
+#elif defined(GEKKO)
+        for (; i + 4 <= n; i += 4)
+            __asm__ volatile("psq_l 0, 0(%0), 0, 0\n"
+                             "psq_l 1, 8(%0), 0, 0\n"
+                             "ps_muls0 0, 0, %2\n"
+                             "ps_muls0 1, 1, %2\n"
+                             "psq_st 0, 0(%1), 0, 0\n"
+                             "psq_st 1, 8(%1), 0, 0\n"
+                             : : "b"(a + i), "b"(out + i), "f"(s) : "fr0", "fr1", "memory");
+#else
+        for (; i + 4 <= n; i += 4)
+        {
+            const float r0 = a[i] * s, r1 = a[i + 1] * s, r2 = a[i + 2] * s, r3 = a[i + 3] * s;
+            out[i] = r0;
+            out[i + 1] = r1;
+            out[i + 2] = r2;
+            out[i + 3] = r3;
+        }
+#endif
+        for (; i < n; ++i) out[i] = a[i] * s;
+    }
+
+    // m is a column-major 4x4 matrix, in/out are count vectors packed with a stride of 4 floats. Vectors with fewer
+    // than 4 components are treated as points (w = 1) and keep their unused lanes zeroed.
+    inline void transform(const float* m, const float* in, float* out, const size_t count, const int dim = 4)
+    {
+#if defined(__SSE__)
+        const __m128 c0 = _mm_loadu_ps(m), c1 = _mm_loadu_ps(m + 4), c2 = _mm_loadu_ps(m + 8),
+                     c3 = _mm_loadu_ps(m + 12);
+        alignas(16) static constexpr uint32_t masks[4][4] = {
+            {~0u, 0, 0, 0}, {~0u, ~0u, 0, 0}, {~0u, ~0u, ~0u, 0}, {~0u, ~0u, ~0u, ~0u}
+        };
+        const __m128 mask = _mm_load_ps(reinterpret_cast<const float*>(masks[dim - 1]));
+
+        for (size_t i = 0; i < count; ++i)
+        {
+            const float* v = in + i * 4;
+            const __m128 w = dim == 4 ? _mm_set1_ps(v[3]) : _mm_set1_ps(1.0f),
+                         xy = _mm_add_ps(_mm_mul_ps(c0, _mm_set1_ps(v[0])), _mm_mul_ps(c1, _mm_set1_ps(v[1]))),
+                         zw = _mm_add_ps(_mm_mul_ps(c2, _mm_set1_ps(v[2])), _mm_mul_ps(c3, w));
+            _mm_storeu_ps(out + i * 4, _mm_and_ps(_mm_add_ps(xy, zw), mask));
+        }
+#elif defined(GEKKO)
+        for (size_t i = 0; i < count; ++i)
+        {
+            const float* v = in + i * 4;
+            float* o = out + i * 4;
+            const float p[4] = {v[0], v[1], v[2], dim == 4 ? v[3] : 1.0f};
+
+            // f8 = (x, y) and f9 = (z, w) scale the column pairs into f10 (rows 0-1) and f11 (rows 2-3).
+            __asm__ volatile("psq_l 0, 0(%0), 0, 0\n"
+                             "psq_l 1, 8(%0), 0, 0\n"
+                             "psq_l 2, 16(%0), 0, 0\n"
+                             "psq_l 3, 24(%0), 0, 0\n"
+                             "psq_l 4, 32(%0), 0, 0\n"
+                             "psq_l 5, 40(%0), 0, 0\n"
+                             "psq_l 6, 48(%0), 0, 0\n"
+                             "psq_l 7, 56(%0), 0, 0\n"
+                             "psq_l 8, 0(%1), 0, 0\n"
+                             "psq_l 9, 8(%1), 0, 0\n"
+                             "ps_muls0 10, 0, 8\n"
+                             "ps_muls0 11, 1, 8\n"
+                             "ps_madds1 10, 2, 8, 10\n"
+                             "ps_madds1 11, 3, 8, 11\n"
+                             "ps_madds0 10, 4, 9, 10\n"
+                             "ps_madds0 11, 5, 9, 11\n"
+                             "ps_madds1 10, 6, 9, 10\n"
+                             "ps_madds1 11, 7, 9, 11\n"
+                             "psq_st 10, 0(%2), 0, 0\n"
+                             "psq_st 11, 8(%2), 0, 0\n"
+                             : : "b"(m), "b"(p), "b"(o)
+                             : "fr0", "fr1", "fr2", "fr3", "fr4", "fr5", "fr6", "fr7", "fr8", "fr9", "fr10", "fr11",
+                               "memory");
+            for (int lane = dim; lane < 4; ++lane) o[lane] = 0.0f;
+        }
+#else
+        for (size_t i = 0; i < count; ++i)
+        {
+            const float* v = in + i * 4;
+            const float x = v[0], y = v[1], z = v[2], w = dim == 4 ? v[3] : 1.0f;
+            float* o = out + i * 4;
+
+            o[0] = m[0] * x + m[4] * y + m[8] * z + m[12] * w;
+            o[1] = dim > 1 ? m[1] * x + m[5] * y + m[9] * z + m[13] * w : 0.0f;
+            o[2] = dim > 2 ? m[2] * x + m[6] * y + m[10] * z + m[14] * w : 0.0f;
+            o[3] = dim > 3 ? m[3] * x + m[7] * y + m[11] * z + m[15] * w : 0.0f;
+        }
+#endif
+    }
+
+    inline void dot(const float* a, const float* b, float* out, const size_t count)
+    {
+#if defined(__SSE__)
+        size_t i = 0;
+        for (; i + 4 <= count; i += 4)
+        {
+            __m128 r0 = _mm_mul_ps(_mm_loadu_ps(a + i * 4), _mm_loadu_ps(b + i * 4)),
+                   r1 = _mm_mul_ps(_mm_loadu_ps(a + i * 4 + 4), _mm_loadu_ps(b + i * 4 + 4)),
+                   r2 = _mm_mul_ps(_mm_loadu_ps(a + i * 4 + 8), _mm_loadu_ps(b + i * 4 + 8)),
+                   r3 = _mm_mul_ps(_mm_loadu_ps(a + i * 4 + 12), _mm_loadu_ps(b + i * 4 + 12));
+
+            _MM_TRANSPOSE4_PS(r0, r1, r2, r3);
+            _mm_storeu_ps(out + i, _mm_add_ps(_mm_add_ps(r0, r1), _mm_add_ps(r2, r3)));
+        }
+        for (; i < count; ++i)
+        {
+            const float *x = a + i * 4, *y = b + i * 4;
+            out[i] = x[0] * y[0] + x[1] * y[1] + x[2] * y[2] + x[3] * y[3];
+        }
+#elif defined(GEKKO)
+        for (size_t i = 0; i < count; ++i)
+            __asm__ volatile("psq_l 0, 0(%0), 0, 0\n"
+                             "psq_l 1, 8(%0), 0, 0\n"
+                             "psq_l 2, 0(%1), 0, 0\n"
+                             "psq_l 3, 8(%1), 0, 0\n"
+                             "ps_mul 4, 0, 2\n"
+                             "ps_madd 4, 1, 3, 4\n"
+                             "ps_sum0 4, 4, 4, 4\n"
+                             "stfs 4, 0(%2)\n"
+                             : : "b"(a + i * 4), "b"(b + i * 4), "b"(out + i)
+                             : "fr0", "fr1", "fr2", "fr3", "fr4", "memory");
+#else
+        for (size_t i = 0; i < count; ++i)
+        {
+            const float *x = a + i * 4, *y = b + i * 4;
+            out[i] = x[0] * y[0] + x[1] * y[1] + x[2] * y[2] + x[3] * y[3];
+        }
+#endif
+    }
+
+    inline void mat4Mul(const float* a, const float* b, float* out)
+    {
+        float r[16];
+        transform(a, b, r, 4);
+        for (int i = 0; i < 16; ++i) out[i] = r[i];
+    }
+}
@@ -0,0 +1,97 @@
+#pragma once
+
+#include "../gfx/drawing.h"
+
+#include <array>
+#include <cmath>
+#include <cstdint>
+#include <algorithm>
+
+// Screen areas that changed since the last present. Rects are kept disjoint and snapped to whole pixels; overlapping
+// additions are merged, and past MAX_RECTS the pair with the smallest union is combined.
+class DamageRegion
+{
+public:
+    static constexpr size_t MAX_RECTS = 4;
+
+    explicit DamageRegion(const Rect& screen = {0, 0, 640, 480}) : screen(screen) { addAll(); }
+
+    void add(const Rect& r)
+    {
+        const float x0 = std::max(screen.x, std::floor(r.x)), y0 = std::max(screen.y, std::floor(r.y)),
+                    x1 = std::min(screen.x + screen.w, std::ceil(r.x + r.w)),
+                    y1 = std::min(screen.y + screen.h, std::ceil(r.y + r.h));
+        if (x0 >= x1 || y0 >= y1) return;
+
+        Rect next = {x0, y0, x1 - x0, y1 - y0};
+        for (size_t i = 0; i < count;)
+        {
+            if (!overlaps(rects[i], next))
+            {
+                ++i;
+                continue;
+            }
+
+            next = unite(rects[i], next);
+            rects[i] = rects[--count];
+            i = 0;
+        }
+
+        if (count == MAX_RECTS)
+        {
+            size_t best = 0;
+            float growth = area(screen);
+            for (size_t i = 0; i < count; ++i)
+                if (const float g = area(unite(rects[i], next)) - area(rects[i]) - area(next); g < growth)
+                {
+                    best = i;
+                    growth = g;
+                }
+
+            const Rect merged = unite(rects[best], next);
+            rects[best] = rects[--count];
+            return add(merged);
+        }
+
+        rects[count++] = next;
+    }
+
+    void addAll()
+    {
+        rects[0] = screen;
+        count = 1;
+    }
+
+    void clear() { count = 0; }
+
+    [[nodiscard]] bool empty() const { return count == 0; }
+    [[nodiscard]] size_t size() const { return count; }
+    [[nodiscard]] const Rect* begin() const { return rects.data(); }
+    [[nodiscard]] const Rect* end() const { return rects.data() + count; }
+
+    [[nodiscard]] uint32_t pixels() const
+    {
+        float total = 0.0f;
+        for (size_t i = 0; i < count; ++i) total += area(rects[i]);
+
+        return static_cast<uint32_t>(total);
+    }
+
+private:
+    Rect screen;
+    std::array<Rect, MAX_RECTS> rects = {};
+    size_t count = 0;
+
+    static float area(const Rect& r) { return r.w * r.h; }
+
+    static bool overlaps(const Rect& a, const Rect& b)
+    {
+        return a.x < b.x + b.w && b.x < a.x + a.w && a.y < b.y + b.h && b.y < a.y + a.h;
+    }
+
+    static Rect unite(const Rect& a, const Rect& b)
+    {
+        const float x0 = std::min(a.x, b.x), y0 = std::min(a.y, b.y);
+        return {x0, y0, std::max(a.x + a.w, b.x + b.w) - x0, std::max(a.y + a.h, b.y + b.h) - y0};
+    }
+};
@@ -1,4 +1,14 @@
 #include "./theme.h"
 
 static Theme gTheme;
+static uint32_t gVersion = 0;
+
 const Theme& theme() { return gTheme; }
+
+void setTheme(const Theme& theme)
+{
+    gTheme = theme;
+    gVersion++;
+}
+
+uint32_t themeVersion() { return gVersion; }
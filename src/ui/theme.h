@@ -19,6 +19,10 @@ struct Theme
 
     uint32_t accent = 0xFFCC00FF;
     uint32_t selection = 0x2F4F9BFF;
+    uint32_t match = 0x5A4A20FF;
+    uint32_t bracketMatch = 0x3C5A3CFF;
+    uint32_t bracketMismatch = 0x7A2E2EFF;
+    uint32_t indentGuide = 0x2A2A36FF;
     uint32_t focus = 0xFFCC00FF;
 
     uint32_t scrollTrack = 0x22222CFF;
@@ -28,3 +32,7 @@ struct Theme
 };
 
 const Theme& theme();
+void setTheme(const Theme& theme);
+
+// Bumped by setTheme so cached drawing can tell when its colors went stale.
+uint32_t themeVersion();
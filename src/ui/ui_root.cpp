@@ -1,13 +1,18 @@
 #include "./ui_root.h"
 #include "../platform/path.h"
+#include "../debug/memory.h"
 
-#include <sys/stat.h>
-
-UIRoot::UIRoot(const float screenW, const float screenH, Font& codeFont, Font& uiFont)
+UIRoot::UIRoot(const float screenW, const float screenH, Font& codeFont, Font& uiFont, ScriptRuntime& script,
+               const std::vector<FileSystem::DirEntry>* workspace)
+    : backend(uiFont)
 {
+    MEMORY_SCOPE(UI);
     this->screenW = screenW;
     this->screenH = screenH;
+    this->script = &script;
     root->font = &uiFont;
+    root->damage = &damage;
+    damage = DamageRegion({0, 0, screenW, screenH});
 
     left = root->addChild<Panel>();
     center = root->addChild<Panel>();
@@ -19,10 +24,37 @@ UIRoot::UIRoot(const float screenW, const float screenH, Font& codeFont, Font& u
     {
         if (!contextMenu) return;
         contextMenu->openAt(x, y, {
+                                {"Undo", [this] { if (editor) editor->undo(); }},
+                                {"Redo", [this] { if (editor) editor->redo(); }},
                                 {"Cut", [this] { if (editor) editor->cutText(); }},
                                 {"Copy", [this] { if (editor) editor->copyText(); }},
                                 {"Paste", [this] { if (editor) editor->pasteText(); }},
-                                {"Select All", [this] { if (editor) editor->selectAll(); }}
+                                {"Select All", [this] { if (editor) editor->selectAll(); }},
+                                {"Jump to Match", [this]
+                                {
+                                    if (editor && editor->jumpToMatch()) revealLine(editor->selection().start.line);
+                                }},
+                                {"Toggle Fold", [this] { if (editor) editor->toggleFold(); }},
+                                {"Unfold All", [this] { if (editor) editor->unfoldAll(); }},
+                                {editor && editor->softWrap() ? "Soft Wrap Off" : "Soft Wrap On", [this]
+                                {
+                                    if (editor) editor->setSoftWrap(!editor->softWrap());
+                                }},
+                                {"Find...", [this] { promptFind(false); }},
+                                {"Find Pattern...", [this] { promptFind(true); }},
+                                {"Find Next", [this]
+                                {
+                                    if (editor && editor->findNext()) revealLine(editor->selection().end.line);
+                                }},
+                                {"Replace All...", [this] { promptReplaceAll(); }},
+                                {"Find in Files...", [this]
+                                {
+                                    promptFindInFiles(editor ? editor->selectedText() : "");
+                                }},
+                                {"Find Pattern in Files...", [this] { promptFindInFiles("", true); }},
+                                {"", nullptr},
+                                {"Run", [this] { runScript(); }},
+                                {"Stop", [this] { if (this->script) this->script->stop(); }}
                             }, this->screenW, this->screenH);
     };
 
@@ -241,9 +273,7 @@ UIRoot::UIRoot(const float screenW, const float screenH, Font& codeFont, Font& u
 
             std::string msg = "Name: " + item->name + (item->isDir ? "/" : "") + "\nFolder: " + currentDir + "\nPath: "
                 + path + "\nType: " + (item->isDir ? "Folder\n" : "File\n");
-            struct stat st = {};
-            if (stat(path.c_str(), &st) == 0)
-                msg += "Size: " + std::to_string(static_cast<uint64_t>(st.st_size)) + " B\n";
+            if (uint64_t size = 0; FileSystem::fileSize(path, size)) msg += "Size: " + std::to_string(size) + " B\n";
 
             modal->showMessage("Properties", msg);
         };
@@ -272,6 +302,8 @@ UIRoot::UIRoot(const float screenW, const float screenH, Font& codeFont, Font& u
                                 {"Paste", pasteAction},
                                 {"Delete", deleteAction},
                                 {"", nullptr},
+                                {"Find in Files...", [this] { promptFindInFiles(""); }},
+                                {"Find Pattern in Files...", [this] { promptFindInFiles("", true); }},
                                 {"Properties", propertiesAction}
                             }, this->screenW, this->screenH);
     };
@@ -280,6 +312,45 @@ UIRoot::UIRoot(const float screenW, const float screenH, Font& codeFont, Font& u
     fileListScroll->barY = fileListScroll->addChild<ScrollBar>(BoxDir::Vertical);
     fileListScroll->barY->scrollAmount = fileList->rowH;
 
+    resultsScroll = left->addChild<ScrollView>();
+    resultsScroll->visible = false;
+    resultsList = resultsScroll->addChild<List>();
+    resultsList->onItemSelected = [this](const std::string&)
+    {
+        const int i = resultsList ? resultsList->selected : -1;
+        if (i == 0)
+        {
+            if (finder.progress().running) finder.cancel();
+            else
+            {
+                showResults = false;
+                damage.addAll();
+            }
+            pollFindResults();
+            return;
+        }
+
+        if (i > 0 && i <= static_cast<int>(findResults.size())) openFindResult(findResults[i - 1]);
+    };
+    resultsScroll->content = resultsList;
+    resultsScroll->barY = resultsScroll->addChild<ScrollBar>(BoxDir::Vertical);
+    resultsScroll->barY->scrollAmount = resultsList->rowH;
+
+    suggestions = bottom->addChild<SuggestionBar>();
+    suggestions->font = &codeFont;
+    suggestions->onPick = [this](const std::string& word)
+    {
+        if (!editor || (modal && modal->isOpen())) return;
+
+        if (!editor->focused) setFocus(editor, false);
+        editor->complete(word);
+    };
+    std::vector<std::string> globals;
+    ScriptRuntime::globalNames(globals);
+    editor->addCompletionNames(globals);
+    editor->completionCount = suggestions->slots();
+    editor->onCompletions = [this](const std::vector<std::string>& words) { suggestions->setWords(words); };
+
     keyboard = bottom->addChild<Keyboard>(uiFont);
     keyboard->onKey = [this](const char* key, const KeyAction action)
     {
@@ -292,32 +363,64 @@ UIRoot::UIRoot(const float screenW, const float screenH, Font& codeFont, Font& u
         if (editor && !editor->focused) setFocus(editor, false);
         if (editor) editor->onKey(key, action);
     };
+    console = bottom->addChild<Console>(script.output());
+    console->font = &codeFont;
+    console->onContextMenu = [this](const float x, const float y)
+    {
+        if (!contextMenu) return;
+        contextMenu->openAt(x, y, {
+                                {"Clear", [this] { if (this->script) this->script->output().clear(); }},
+                                {"Hide", [this] { showConsole = false; }}
+                            }, this->screenW, this->screenH);
+    };
+
     contextMenu = root->addChild<ContextMenu>();
     modal = root->addChild<Modal>();
 
-    refreshFileList();
+    finder.setIndex(&index);
+    FileSystem::setChangeListener([this](const FileSystem::Change change, const std::string& path,
+                                         const std::string& to) { index.noteChange(change, path, to); });
+
+    refreshFileList(workspace);
     rebuildFocusList();
 
     if (editor && editor->isFocusable()) setFocus(editor, false);
     else if (!focusableWidgets.empty()) setFocus(focusableWidgets[0], false);
 }
 
+UIRoot::~UIRoot()
+{
+    finder.cancel();
+    FileSystem::setChangeListener(nullptr);
+}
+
 void UIRoot::layout() const
 {
+    MEMORY_SCOPE(UI);
     root->bounds = Rect({0, 0, screenW, screenH});
     Rect content = root->bounds;
-    const float leftW = showLeft ? 200.0f : 0.0f, bottomH = showBottom ? 140.0f : 0.0f;
+    const float leftW = showLeft ? 200.0f : 0.0f, bottomH = showBottom ? 172.0f : 0.0f;
 
     left->visible = showLeft;
     left->bounds = leftW > 0.0f ? content.takeLeft(leftW) : Rect::empty();
-    fileListScroll->visible = showLeft;
+    fileListScroll->visible = showLeft && !showResults;
     fileListScroll->bounds = Rect({0, 0, left->bounds.w, left->bounds.h}).inset(10);
     if (fileListScroll->barY) fileListScroll->barY->layout.fixedHeight = fileListScroll->bounds.h;
+    resultsScroll->visible = showLeft && showResults;
+    resultsScroll->bounds = fileListScroll->bounds;
+    if (resultsScroll->barY) resultsScroll->barY->layout.fixedHeight = resultsScroll->bounds.h;
 
     bottom->visible = showBottom;
     bottom->bounds = bottomH > 0.0f ? content.takeBottom(bottomH) : Rect::empty();
+    Rect bottomContent = Rect({0, 0, bottom->bounds.w, bottom->bounds.h}).inset(10);
+    console->visible = showBottom && showConsole;
+    console->bounds = console->visible ? bottomContent.takeRight(bottomContent.w * 0.4f) : Rect::empty();
+    if (console->visible) bottomContent.takeRight(10);
+    suggestions->visible = showBottom;
+    suggestions->bounds = bottomContent.takeTop(28);
+    bottomContent.takeTop(4);
     keyboard->visible = showBottom;
-    keyboard->bounds = Rect({0, 0, bottom->bounds.w, bottom->bounds.h}).inset(10);
+    keyboard->bounds = bottomContent;
 
     center->bounds = content;
     editorScroll->bounds = Rect({0, 0, center->bounds.w, center->bounds.h}).inset(10);
@@ -327,6 +430,7 @@ void UIRoot::layout() const
 
 void UIRoot::update(const double dt)
 {
+    MEMORY_SCOPE(UI);
     rebuildFocusList();
 
     if (focusedWidget && (!focusedWidget->visible || !focusedWidget->enabled))
@@ -339,11 +443,34 @@ void UIRoot::update(const double dt)
         else if (!focusableWidgets.empty()) setFocus(focusableWidgets[0], false);
     }
     if (hoverWidget && (!hoverWidget->visible || !hoverWidget->enabled)) hoverWidget = nullptr;
+    if (std::string err; script && script->takeError(err) && modal)
+    {
+        modal->showMessage("Script Error", err);
+        damage.addAll();
+    }
+    pollFindResults();
 
     root->update(dt);
 }
 
 void UIRoot::routeEvent(const Input::InputEvent& e)
+{
+    MEMORY_SCOPE(UI);
+    const Screen before = screen();
+    dispatch(e);
+    if (screen() != before) damage.addAll();
+}
+
+UIRoot::Screen UIRoot::screen() const
+{
+    const bool menu = contextMenu && contextMenu->isOpen();
+    return {
+        .left = showLeft, .bottom = showBottom, .console = showConsole, .results = showResults,
+        .modal = modal && modal->isOpen(), .menu = menu, .menuBounds = menu ? contextMenu->bounds : Rect::empty()
+    };
+}
+
+void UIRoot::dispatch(const Input::InputEvent& e)
 {
     if (modal && modal->isOpen())
     {
@@ -367,15 +494,29 @@ void UIRoot::routeEvent(const Input::InputEvent& e)
 
         if (prevHover && prevHover != hoverWidget) prevHover->onEvent(e);
         if (hoverWidget) hoverWidget->onEvent(e);
-        if (focusedWidget) focusedWidget->showFocus = false;
+        if (focusedWidget && focusedWidget->showFocus)
+        {
+            focusedWidget->showFocus = false;
+            focusedWidget->invalidate();
+        }
 
         return;
     }
 
     if (e.type == Input::InputEvent::Type::Scroll)
     {
-        for (Widget* w = hoverWidget; w; w = w->parent) if (w->onEvent(e)) return;
-        for (Widget* w = focusedWidget; w; w = w->parent) if (w->onEvent(e)) return;
+        for (Widget* w = hoverWidget; w; w = w->parent)
+            if (w->onEvent(e))
+            {
+                w->invalidate();
+                return;
+            }
+        for (Widget* w = focusedWidget; w; w = w->parent)
+            if (w->onEvent(e))
+            {
+                w->invalidate();
+                return;
+            }
 
         return;
     }
@@ -402,7 +543,7 @@ void UIRoot::routeEvent(const Input::InputEvent& e)
 
                 bool clickedKeyboard = false;
                 for (const Widget* p = captureWidget; p; p = p->parent)
-                    if (p == keyboard)
+                    if (p == keyboard || p == suggestions)
                     {
                         clickedKeyboard = true;
                         break;
@@ -478,6 +619,11 @@ void UIRoot::routeEvent(const Input::InputEvent& e)
                         if (list->onContextMenu) list->onContextMenu(pointer.x, pointer.y);
                         return;
                     }
+                    if (const auto* output = dynamic_cast<Console*>(p))
+                    {
+                        if (output->onContextMenu) output->onContextMenu(pointer.x, pointer.y);
+                        return;
+                    }
                 }
 
                 return;
@@ -496,7 +642,23 @@ void UIRoot::routeEvent(const Input::InputEvent& e)
     }
 }
 
-void UIRoot::draw() const { root->draw(); }
+void UIRoot::draw() const { draw(backend); }
+
+void UIRoot::draw(DrawBackend& target) const
+{
+    MEMORY_SCOPE(UI);
+    root->draw(commands);
+    commands.flush(target);
+}
+
+void UIRoot::draw(const Rect& clip) const
+{
+    commands.clipTo(clip.x, clip.y, clip.w, clip.h);
+    draw(backend);
+    commands.clearClip();
+}
+
+CommandBuffer& UIRoot::drawList() const { return commands; }
 
 void UIRoot::FileClipboard::clear()
 {
@@ -506,11 +668,177 @@ void UIRoot::FileClipboard::clear()
     valid = false;
 }
 
+// Input to the pattern prompts is a Lua pattern unless written as /regex/.
+static Pattern::Syntax patternSyntax(const std::string& input, std::string& outSource)
+{
+    const bool regex = input.size() >= 2 && input.front() == '/' && input.back() == '/';
+    outSource = regex ? input.substr(1, input.size() - 2) : input;
+
+    return regex ? Pattern::Syntax::Regex : Pattern::Syntax::Lua;
+}
+
+static std::string patternInput(const std::string& source, const Pattern::Syntax syntax)
+{
+    return syntax == Pattern::Syntax::Regex ? "/" + source + "/" : source;
+}
+
+void UIRoot::findInFiles(const std::string& pattern, const Pattern::Syntax syntax)
+{
+    MEMORY_SCOPE(FileCache);
+    findResults.clear();
+    findShown = {};
+    resultsList->items.assign(1, "");
+    resultsList->selected = -1;
+    resultsScroll->scrollY = 0.0f;
+    showResults = showLeft = true;
+    damage.addAll();
+
+    // Scripts write through Lua's io and os libraries, which never report to the index.
+    if (scriptRan)
+    {
+        index.rescan();
+        scriptRan = script && script->isRunning();
+    }
+
+    // This runs from a modal's OK handler, which closes the modal afterwards, so failures go in the results header.
+    if (std::string error; !finder.start(FileSystem::workspaceRoot, pattern, syntax, &error))
+    {
+        resultsList->items[0] = "[Close] " + (error.empty() ? "Failed to start the search." : error);
+        return;
+    }
+    pollFindResults();
+}
+
+void UIRoot::promptFindInFiles(const std::string& initial, const bool pattern)
+{
+    if (!modal) return;
+
+    const char* hint = pattern ? "Search the workspace for a Lua pattern, or /regex/:" : "Search the workspace for:";
+    const std::string seed = initial.find('\n') == std::string::npos ? initial : finder.pattern();
+    const auto start = [this, pattern](const std::string& input)
+    {
+        std::string source = input;
+        const Pattern::Syntax syntax = pattern ? patternSyntax(input, source) : Pattern::Syntax::Literal;
+        if (!input.empty()) findInFiles(source, syntax);
+    };
+    modal->showInput(pattern ? "Find Pattern in Files" : "Find in Files", hint, seed, start);
+    if (!pattern) return;
+
+    // Compile as the pattern is typed so mistakes show before the search starts.
+    modal->onInputChanged = [this, hint](const std::string& input)
+    {
+        std::string source, error;
+        const Pattern::Syntax syntax = patternSyntax(input, source);
+        modal->message = input.empty() || Pattern().compile(source, syntax, &error) ? hint : error;
+    };
+}
+
+void UIRoot::pollFindResults()
+{
+    if (!showResults || !resultsList) return;
+    MEMORY_SCOPE(FileCache);
+
+    const size_t before = findResults.size();
+    finder.poll(findResults);
+    for (size_t i = before; i < findResults.size(); ++i)
+    {
+        const auto& m = findResults[i];
+        const size_t slash = m.path.find_last_of('/');
+        resultsList->items.push_back((slash == std::string::npos ? m.path : m.path.substr(slash + 1)) + ":" +
+                                     std::to_string(m.line + 1) + "  " + m.preview);
+    }
+
+    const FindInFiles::Progress p = finder.progress();
+    if (findResults.size() == before && p.running == findShown.running && p.files == findShown.files &&
+        !resultsList->items[0].empty())
+        return;
+    findShown = p;
+
+    char header[128];
+    const char* note = p.truncated ? " (limit)" : p.cancelled ? " (stopped)" : p.split ? " (long lines split)" : "";
+    std::snprintf(header, sizeof(header), "%s %zu matches in %zu files%s", p.running ? "[Stop]" : "[Close]",
+                  findResults.size(), p.files, note);
+    resultsList->items[0] = header;
+    resultsScroll->invalidate();
+}
+
+void UIRoot::openFindResult(const FindInFiles::Match& m)
+{
+    if (!editor) return;
+
+    if (editor->filePath != m.path) editor->loadFile(m.path);
+    if (editor->filePath != m.path)
+    {
+        if (modal) modal->showMessage("Find in Files", "Failed to open " + m.path);
+        return;
+    }
+
+    editor->select({m.line, m.col}, {m.line, m.col + m.length});
+    revealLine(m.line);
+    setFocus(editor, false);
+    damage.addAll();
+}
+
+void UIRoot::promptFind(const bool pattern)
+{
+    if (!modal || !editor) return;
+
+    const TextEditor::Range origin = editor->selection();
+    const BufferSearch& previous = editor->search();
+    const bool reuse = (previous.syntax() != Pattern::Syntax::Literal) == pattern;
+    const std::string selected = editor->selectedText(),
+                      seed = !pattern && !selected.empty() && selected.find('\n') == std::string::npos
+                                 ? selected
+                                 : reuse ? patternInput(previous.pattern(), previous.syntax()) : "";
+
+    const char* hint = pattern ? "Lua pattern, or /regex/:" : "Find in this file:";
+    modal->showInput(pattern ? "Find Pattern" : "Find", hint, seed,
+                     [this](const std::string&) { setFocus(editor, false); }, [this] { editor->clearSearch(); });
+    modal->onInputChanged = [this, origin, pattern, hint](const std::string& input)
+    {
+        std::string source = input, error;
+        const Pattern::Syntax syntax = pattern ? patternSyntax(input, source) : Pattern::Syntax::Literal;
+        const size_t count = editor->findIncremental(source, origin.start, syntax, &error);
+        revealLine(editor->selection().end.line);
+
+        modal->message = !error.empty() ? error : input.empty() ? hint : std::to_string(count) +
+            (editor->search().complete() ? " matches" : "+ matches");
+    };
+    if (!seed.empty()) modal->onInputChanged(seed);
+}
+
+void UIRoot::promptReplaceAll()
+{
+    if (!modal || !editor) return;
+    if (!editor->search().active()) return promptFind(false);
+    if (editor->search().syntax() != Pattern::Syntax::Literal)
+        return modal->showMessage("Replace All", "Replace All works on plain-text searches; use Find... first.");
+
+    modal->showInput("Replace All", "Replace " + std::to_string(editor->search().count()) + " matches of \"" +
+                     editor->search().pattern() + "\" with:", "", [this](const std::string& replacement)
+                     {
+                         editor->replaceAll(replacement);
+                         setFocus(editor, false);
+                     });
+}
+
+void UIRoot::revealLine(const size_t line)
+{
+    if (!editor || !editorScroll || !editor->getFont()) return;
+
+    const float lineH = editor->getFont()->textHeight(), y = static_cast<float>(editor->reveal(line)) * lineH;
+    if (y >= editorScroll->scrollY && y + lineH <= editorScroll->scrollY + editorScroll->bounds.h) return;
+
+    editorScroll->scrollY = std::max(0.0f, y - editorScroll->bounds.h / 3.0f);
+    editorScroll->invalidate();
+}
+
 bool UIRoot::inSubdir() const { return currentDir != FileSystem::workspaceRoot; }
 
-void UIRoot::refreshFileList()
+void UIRoot::refreshFileList(const std::vector<FileSystem::DirEntry>* listed)
 {
     if (!fileList) return;
+    MEMORY_SCOPE(FileCache);
 
     currentEntries.clear();
     fileList->items.clear();
@@ -522,9 +850,13 @@ void UIRoot::refreshFileList()
     }
 
     std::vector<FileSystem::DirEntry> entries;
-    if (!FileSystem::listDir(currentDir, entries, true)) return;
+    if (!listed || currentDir != FileSystem::workspaceRoot)
+    {
+        if (!FileSystem::listDir(currentDir, entries, true)) return;
+        listed = &entries;
+    }
 
-    for (const auto& e : entries)
+    for (const auto& e : *listed)
     {
         ListItem item({e.name + (e.isDir ? "/" : ""), e.name, e.isDir, false});
 
@@ -534,6 +866,20 @@ void UIRoot::refreshFileList()
     fileList->selected = -1;
 }
 
+void UIRoot::runScript()
+{
+    if (!script || !editor) return;
+
+    const std::string& path = editor->filePath;
+    const std::string chunkName = path.empty() ? "=untitled" : "@" + path.substr(path.find_last_of('/') + 1);
+    showConsole = true;
+    if (console) console->scrollToEnd();
+
+    scriptRan = true;
+    if (std::string err; !script->run(editor->getText(), chunkName, &err) && modal)
+        modal->showMessage("Script Error", err);
+}
+
 std::string UIRoot::uniqueName(const std::string& dir, const std::string& name)
 {
     auto base = name;
@@ -567,6 +913,7 @@ void UIRoot::setFocus(Widget* w, const bool show)
     if (!w || !w->isFocusable()) return;
     if (focusedWidget && focusedWidget == w)
     {
+        if (focusedWidget->showFocus != show) focusedWidget->invalidate();
         focusedWidget->showFocus = show;
         return;
     }
@@ -574,11 +921,13 @@ void UIRoot::setFocus(Widget* w, const bool show)
     {
         focusedWidget->focused = false;
         focusedWidget->showFocus = false;
+        focusedWidget->invalidate();
     }
 
     focusedWidget = w;
     focusedWidget->focused = true;
     focusedWidget->showFocus = show;
+    focusedWidget->invalidate();
 }
 
 void UIRoot::rebuildFocusList()
@@ -2,6 +2,9 @@
 
 #include "../platform/platform.h"
 #include "../keyboard/keyboard.h"
+#include "../script/runtime.h"
+#include "../editor/find_in_files.h"
+#include "../editor/trigram_index.h"
 
 #include "./widgets/widget.h"
 #include "./widgets/panel.h"
@@ -10,31 +13,47 @@
 #include "./widgets/scrollbar.h"
 #include "./widgets/context_menu.h"
 #include "./widgets/modal.h"
+#include "./widgets/console.h"
+#include "./widgets/suggestion_bar.h"
 
 #include <memory>
 
 class UIRoot
 {
 public:
-    UIRoot(float screenW, float screenH, Font& codeFont, Font& uiFont);
+    // A workspace listing read ahead of time (during startup) saves the constructor its first directory scan.
+    UIRoot(float screenW, float screenH, Font& codeFont, Font& uiFont, ScriptRuntime& script,
+           const std::vector<FileSystem::DirEntry>* workspace = nullptr);
+    ~UIRoot();
     void layout() const;
     void update(double dt);
     void routeEvent(const Input::InputEvent& e);
     void draw() const;
+    void draw(DrawBackend& backend) const;
+    void draw(const Rect& clip) const;
 
+    // Searches the workspace in the background; results replace the file list until dismissed.
+    void findInFiles(const std::string& pattern, Pattern::Syntax syntax = Pattern::Syntax::Literal);
+
+    [[nodiscard]] CommandBuffer& drawList() const;
+
+    DamageRegion damage;
     Input::PointerState pointer = {};
-    bool quit = false, showLeft = true, showBottom = true;
+    bool quit = false, showLeft = true, showBottom = true, showConsole = false, showResults = false;
 
     std::unique_ptr<Panel> root = std::make_unique<Panel>();
     Widget *captureWidget = nullptr, *hoverWidget = nullptr, *focusedWidget = nullptr;
     Panel *left = nullptr, *center = nullptr, *bottom = nullptr;
 
-    List* fileList = nullptr;
-    ScrollView *fileListScroll = nullptr, *editorScroll = nullptr;
+    List *fileList = nullptr, *resultsList = nullptr;
+    ScrollView *fileListScroll = nullptr, *resultsScroll = nullptr, *editorScroll = nullptr;
     TextInput* editor = nullptr;
     Keyboard* keyboard = nullptr;
+    SuggestionBar* suggestions = nullptr;
+    Console* console = nullptr;
     ContextMenu* contextMenu = nullptr;
     Modal* modal = nullptr;
+    ScriptRuntime* script = nullptr;
 
 private:
     struct FileClipboard
@@ -55,13 +74,39 @@ private:
     std::vector<ListItem> currentEntries;
     [[nodiscard]] bool inSubdir() const;
 
-    void refreshFileList();
+    void refreshFileList(const std::vector<FileSystem::DirEntry>* listed = nullptr);
+    void promptFind(bool pattern);
+    void promptReplaceAll();
+    void revealLine(size_t line);
+    void promptFindInFiles(const std::string& initial, bool pattern = false);
+    void pollFindResults();
+    void openFindResult(const FindInFiles::Match& m);
+    void runScript();
     static std::string uniqueName(const std::string& dir, const std::string& name);
 
+    // What an event can change that moves or covers large parts of the screen; any change redraws all of it.
+    struct Screen
+    {
+        bool left = false, bottom = false, console = false, results = false, modal = false, menu = false;
+        Rect menuBounds = Rect::empty();
+
+        bool operator==(const Screen&) const = default;
+    };
+    [[nodiscard]] Screen screen() const;
+    void dispatch(const Input::InputEvent& e);
+
     void setFocus(Widget* w, bool show);
     void rebuildFocusList();
     [[nodiscard]] Widget* findNextFocusable(int dirX, int dirY) const;
 
+    TrigramIndex index{FileSystem::workspaceRoot, FileSystem::cacheRoot + "search.index"};
+    FindInFiles finder;
+    std::vector<FindInFiles::Match> findResults;
+    FindInFiles::Progress findShown;
+    bool scriptRan = false;
+
     std::vector<Widget*> focusableWidgets;
+    mutable CommandBuffer commands = CommandBuffer(4096, 64 * 1024);
+    mutable GXBackend backend;
     float screenW = 0.0f, screenH = 0.0f;
 };
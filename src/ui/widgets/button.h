@@ -25,7 +25,10 @@ public:
 
         if (e.type == Input::InputEvent::Type::Pointer)
         {
-            hovered = e.pointer.valid && r.contains(e.pointer.x, e.pointer.y);
+            const bool over = e.pointer.valid && r.contains(e.pointer.x, e.pointer.y);
+            if (over != hovered) invalidate();
+            hovered = over;
+
             return Widget::onEvent(e);
         }
 
@@ -34,6 +37,7 @@ public:
             hovered = e.pointer.valid && r.contains(e.pointer.x, e.pointer.y);
             if (hovered || focused)
             {
+                if (!pressed) invalidate();
                 pressed = true;
                 return true;
             }
@@ -44,6 +48,7 @@ public:
         if (e.type == Input::InputEvent::Type::KeyUp && e.key == Input::Key::A)
         {
             const bool wasPressed = pressed;
+            if (wasPressed) invalidate();
             pressed = false;
             hovered = e.pointer.valid && r.contains(e.pointer.x, e.pointer.y);
 
@@ -55,7 +60,7 @@ public:
     }
 
 protected:
-    void onDraw() const override
+    void onDraw(CommandBuffer& out) const override
     {
         const Rect r = worldBounds();
         const uint32_t textColor = enabled ? theme().text : theme().textDisabled,
@@ -67,11 +72,11 @@ protected:
                                       ? theme().btn
                                       : theme().btnDisabled;
 
-        roundedRectangle(r.x, r.y, r.w, r.h, radiusX, radiusY, btnColor, true);
-        roundedRectangle(r.x, r.y, r.w, r.h, radiusX, radiusY, theme().panelBorder, false);
+        out.roundedRect(r.x, r.y, r.w, r.h, radiusX, radiusY, btnColor, true);
+        out.roundedRect(r.x, r.y, r.w, r.h, radiusX, radiusY, theme().panelBorder, false);
 
         if (const Font* f = getFont(); f && !text.empty())
-            f->drawText(text, r.x + (r.w - f->textWidth(text)) / 2, r.y + (r.h - f->textHeight()) / 2, textColor);
+            out.text(text, r.x + (r.w - f->textWidth(text)) / 2, r.y + (r.h - f->textHeight()) / 2, textColor, f);
     }
 
     void onUpdate(double) override
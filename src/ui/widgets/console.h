@@ -0,0 +1,104 @@
+#pragma once
+
+#include "./widget.h"
+#include "../theme.h"
+#include "../../script/output_buffer.h"
+
+#include <functional>
+
+class Console : public Widget
+{
+public:
+    explicit Console(const OutputBuffer& output) : output(&output) { focusable = true; }
+
+    float padding = 6.0f;
+    std::function<void(float x, float y)> onContextMenu;
+
+    void scrollToEnd() { scrollLines = 0; }
+
+    bool onEvent(const Input::InputEvent& e) override
+    {
+        if (!visible || !enabled) return Widget::onEvent(e);
+
+        if (e.type == Input::InputEvent::Type::Scroll && e.scrollY != 0)
+        {
+            scroll(-e.scrollY);
+            return true;
+        }
+
+        if (e.type == Input::InputEvent::Type::KeyDown && focused)
+        {
+            if (e.key == Input::Key::Up)
+            {
+                scroll(1);
+                return true;
+            }
+            if (e.key == Input::Key::Down)
+            {
+                scroll(-1);
+                return true;
+            }
+        }
+
+        return Widget::onEvent(e);
+    }
+
+protected:
+    void onUpdate(double) override
+    {
+        if (!output || output->version() == seenVersion) return;
+
+        const size_t total = visibleLineCount();
+        if (scrollLines > 0 && total > seenLines) scrollLines += total - seenLines;
+        scrollLines = std::min(scrollLines, total > 0 ? total - 1 : 0);
+
+        seenVersion = output->version();
+        seenLines = total;
+        invalidate();
+    }
+
+    void onDraw(CommandBuffer& out) const override
+    {
+        const Rect r = worldBounds();
+        out.roundedRect(r.x, r.y, r.w, r.h, radiusX, radiusY, theme().bg, true);
+        out.roundedRect(r.x, r.y, r.w, r.h, radiusX, radiusY, theme().panelBorder, false);
+
+        const Font* f = getFont();
+        if (!f || !output) return;
+
+        const Rect inner = r.inset(padding);
+        const float rowH = f->textHeight() + 2.0f;
+        const size_t total = visibleLineCount(), rows = static_cast<size_t>(std::max(0.0f, inner.h / rowH));
+        if (total == 0 || rows == 0) return;
+
+        const size_t last = total - std::min(scrollLines, total - 1), first = last > rows ? last - rows : 0;
+
+        char line[OutputBuffer::MAX_LINE_LENGTH + 1];
+        for (size_t i = first; i < last; ++i)
+        {
+            if (output->copyLine(i, line, sizeof(line)) == 0) continue;
+            out.text(line, inner.x, inner.y + static_cast<float>(i - first) * rowH, theme().text, f);
+        }
+    }
+
+private:
+    const OutputBuffer* output = nullptr;
+    size_t scrollLines = 0, seenLines = 0;
+    uint64_t seenVersion = 0;
+
+    [[nodiscard]] size_t visibleLineCount() const
+    {
+        const size_t n = output->lineCount();
+        return n > 0 && output->lineLength(n - 1) == 0 ? n - 1 : n;
+    }
+
+    void scroll(const int lines)
+    {
+        const size_t total = visibleLineCount();
+        const long next = static_cast<long>(scrollLines) + lines;
+
+        const auto clamped = static_cast<size_t>(std::clamp(next, 0L, static_cast<long>(total > 0 ? total - 1 : 0)));
+        if (clamped != scrollLines) invalidate();
+        scrollLines = clamped;
+    }
+};
@@ -14,9 +14,9 @@ public:
     float padding = 0.0f;
 
 protected:
-    void onDraw() const override
+    void onDraw(CommandBuffer& out) const override
     {
         const Rect r = worldBounds().inset(padding);
-        if (const Font* f = getFont(); f && !text.empty()) f->drawText(text, r.x, r.y, theme().text);
+        if (const Font* f = getFont(); f && !text.empty()) out.text(text, r.x, r.y, theme().text, f);
     }
 };
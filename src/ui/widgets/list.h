@@ -4,7 +4,6 @@
 #include "../theme.h"
 
 #include <string>
-#include <grrlib.h>
 
 class List : public Widget
 {
@@ -70,6 +69,7 @@ public:
 
         if (e.key == Input::Key::A)
         {
+            invalidate();
             if (e.pointer.valid)
             {
                 const int i = std::clamp(static_cast<int>((e.pointer.y - r.y) / rowH), 0, n - 1);
@@ -90,13 +90,21 @@ public:
 
         if (e.key == Input::Key::Up)
         {
+            const int was = selected;
             selectNext(-1);
+            invalidateRow(was);
+            invalidateRow(selected);
+
             return true;
         }
 
         if (e.key == Input::Key::Down)
         {
+            const int was = selected;
             selectNext(1);
+            invalidateRow(was);
+            invalidateRow(selected);
+
             return true;
         }
 
@@ -104,12 +112,12 @@ public:
     }
 
 protected:
-    void onDraw() const override
+    void onDraw(CommandBuffer& out) const override
     {
         const Rect r = worldBounds();
 
-        roundedRectangle(r.x, r.y, r.w, r.h, radiusX, radiusY, theme().panel, true);
-        roundedRectangle(r.x, r.y, r.w, r.h, radiusX, radiusY, theme().panelBorder, false);
+        out.roundedRect(r.x, r.y, r.w, r.h, radiusX, radiusY, theme().panel, true);
+        out.roundedRect(r.x, r.y, r.w, r.h, radiusX, radiusY, theme().panelBorder, false);
 
         int first = 0, last = static_cast<int>(items.size());
         if (viewportH > 0.0f)
@@ -126,18 +134,18 @@ protected:
 
             if (text.empty())
             {
-                GRRLIB_Line(r.x + 5, y + rowH / 2, r.x + r.w - 5, y + rowH / 2, theme().textDisabled);
+                out.line(r.x + 5, y + rowH / 2, r.x + r.w - 5, y + rowH / 2, theme().textDisabled);
                 continue;
             }
 
-            GRRLIB_Rectangle(r.x, y, r.w, rowH, i == selected ? theme().selection : theme().btn, true);
-            GRRLIB_Line(r.x, y + rowH, r.x + r.w, y + rowH, theme().panelBorder);
+            out.rect(r.x, y, r.w, rowH, i == selected ? theme().selection : theme().btn);
+            out.line(r.x, y + rowH, r.x + r.w, y + rowH, theme().panelBorder);
 
             if (const float maxW = r.w - 20.0f; maxW > 0.0f) text = ellipsize(text, maxW);
             else text.clear();
 
             if (const Font* f = getFont(); f && !text.empty())
-                f->drawText(text, r.x + 10, y + (rowH - f->textHeight()) / 2, theme().text);
+                out.text(text, r.x + 10, y + (rowH - f->textHeight()) / 2, theme().text, f);
         }
     }
 
@@ -227,4 +235,11 @@ private:
 
         selected = -1;
     }
+
+    void invalidateRow(const int i) const
+    {
+        if (i < 0) return;
+        const Rect r = worldBounds();
+        invalidate({r.x, r.y + static_cast<float>(i) * rowH, r.w, rowH});
+    }
 };
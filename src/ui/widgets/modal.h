@@ -18,7 +18,7 @@ public:
     std::string title, message, inputText;
     size_t caret = 0;
 
-    std::function<void(const std::string&)> onOkInput;
+    std::function<void(const std::string&)> onOkInput, onInputChanged;
     std::function<void()> onOk, onCancel;
     float w = 420.0f, h = 170.0f;
 
@@ -67,6 +67,7 @@ public:
         onOkInput = std::move(ok);
         onCancel = std::move(cancel);
         onOk = nullptr;
+        onInputChanged = nullptr;
 
         open = true;
         visible = true;
@@ -110,6 +111,7 @@ public:
 
         onOk = nullptr;
         onOkInput = nullptr;
+        onInputChanged = nullptr;
         onCancel = nullptr;
 
         title.clear();
@@ -137,6 +139,7 @@ public:
             {
                 inputText.erase(caret - 1, 1);
                 caret--;
+                if (onInputChanged) onInputChanged(inputText);
             }
             break;
         case KeyAction::Tab:
@@ -149,11 +152,13 @@ public:
             {
                 inputText.insert(caret, key);
                 caret += std::strlen(key);
+                if (onInputChanged) onInputChanged(inputText);
             }
             break;
         default:
             break;
         }
+        if (panel) panel->invalidate();
     }
 
     bool onEvent(const Input::InputEvent& e) override
@@ -213,30 +218,30 @@ protected:
         okBtn->visible = true;
     }
 
-    void onDraw() const override
+    void onDraw(CommandBuffer& out) const override
     {
         if (!isOpen()) return;
 
         const Rect r = worldBounds();
-        GRRLIB_Rectangle(r.x, r.y, r.w, r.h, theme().modalBackdrop, true);
+        out.rect(r.x, r.y, r.w, r.h, theme().modalBackdrop);
 
         if (panel && kind == Kind::Input)
         {
             const Rect p = panel->worldBounds();
             const Rect ir = {p.x + inputRect.x, p.y + inputRect.y, inputRect.w, inputRect.h};
 
-            roundedRectangle(ir.x, ir.y, ir.w, ir.h, 6, 6, theme().bg, true);
-            roundedRectangle(ir.x, ir.y, ir.w, ir.h, 6, 6, theme().panelBorder, false);
+            out.roundedRect(ir.x, ir.y, ir.w, ir.h, 6, 6, theme().bg, true);
+            out.roundedRect(ir.x, ir.y, ir.w, ir.h, 6, 6, theme().panelBorder, false);
 
             if (const Font* f = getFont())
             {
                 const std::string displayText = inputText.empty() ? " " : inputText;
-                f->drawText(displayText, ir.x + 6.0f, ir.y + (ir.h - f->textHeight()) / 2.0f, theme().text);
+                out.text(displayText, ir.x + 6.0f, ir.y + (ir.h - f->textHeight()) / 2.0f, theme().text, f);
 
                 if (caret <= inputText.size())
                 {
                     const float caretX = ir.x + 6.0f + f->textWidth(inputText.substr(0, caret));
-                    GRRLIB_Line(caretX, ir.y + 4.0f, caretX, ir.y + ir.h - 4.0f, theme().accent);
+                    out.line(caretX, ir.y + 4.0f, caretX, ir.y + ir.h - 4.0f, theme().accent);
                 }
             }
         }
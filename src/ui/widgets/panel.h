@@ -13,11 +13,11 @@ public:
     bool drawBorder = true;
 
 protected:
-    void onDraw() const override
+    void onDraw(CommandBuffer& out) const override
     {
         const Rect r = worldBounds();
 
-        roundedRectangle(r.x, r.y, r.w, r.h, radiusX, radiusY, theme().panel, true);
-        if (drawBorder) roundedRectangle(r.x, r.y, r.w, r.h, radiusX, radiusY, theme().panelBorder, false);
+        out.roundedRect(r.x, r.y, r.w, r.h, radiusX, radiusY, theme().panel, true);
+        if (drawBorder) out.roundedRect(r.x, r.y, r.w, r.h, radiusX, radiusY, theme().panelBorder, false);
     }
 };
@@ -5,8 +5,6 @@
 #include "./layout.h"
 #include "../../gfx/drawing.h"
 
-#include <grrlib.h>
-
 class ScrollBar : public Widget
 {
 public:
@@ -24,7 +22,9 @@ public:
 
         if (e.type == Input::InputEvent::Type::Pointer)
         {
-            hovered = e.pointer.valid && r.contains(e.pointer.x, e.pointer.y);
+            const bool over = e.pointer.valid && r.contains(e.pointer.x, e.pointer.y);
+            if (over != hovered) invalidate();
+            hovered = over;
 
             if (dragging)
             {
@@ -53,6 +53,7 @@ public:
                         *scroll = x / track * maxScroll();
                     }
                 }
+                if (parent) parent->invalidate();
 
                 return true;
             }
@@ -123,18 +124,18 @@ public:
     }
 
 protected:
-    void onDraw() const override
+    void onDraw(CommandBuffer& out) const override
     {
         if (!visible || !enabled) return;
         const Rect r = worldBounds(), t = thumbRect(r);
 
-        roundedRectangle(r.x, r.y, r.w, r.h, radiusX, radiusY, theme().scrollTrack, true);
-        roundedRectangle(t.x, t.y, t.w, t.h, radiusX, radiusY,
-                         dragging
-                             ? theme().scrollActive
-                             : hovered || focused
-                             ? theme().scrollHover
-                             : theme().scrollThumb, true);
+        out.roundedRect(r.x, r.y, r.w, r.h, radiusX, radiusY, theme().scrollTrack, true);
+        out.roundedRect(t.x, t.y, t.w, t.h, radiusX, radiusY,
+                        dragging
+                            ? theme().scrollActive
+                            : hovered || focused
+                            ? theme().scrollHover
+                            : theme().scrollThumb, true);
     }
 
 private:
@@ -239,7 +240,7 @@ public:
     }
 
 protected:
-    void onDraw() const override
+    void onDraw(CommandBuffer& out) const override
     {
         if (!visible) return;
         if (content && content->visible)
@@ -259,16 +260,16 @@ protected:
             {
                 textInput->viewportScrollY = scrollY;
                 textInput->viewportH = clip.h;
+                textInput->viewport = clip;
             }
 
-            GX_SetScissor(static_cast<int>(clip.x), static_cast<int>(clip.y), static_cast<int>(clip.w),
-                          static_cast<int>(clip.h));
-            content->draw();
-            GX_SetScissor(0, 0, 640, 480);
+            out.pushScissor(clip.x, clip.y, clip.w, clip.h);
+            content->draw(out);
+            out.popScissor();
         }
 
-        if (barX && barX->visible) barX->draw();
-        if (barY && barY->visible) barY->draw();
+        if (barX && barX->visible) barX->draw(out);
+        if (barY && barY->visible) barY->draw(out);
     }
 
     void onUpdate(double) override
@@ -321,6 +322,14 @@ protected:
         }
 
         clampScroll(view.w, view.h, contentW, contentH);
+
+        // Keys, bar clicks and reveals all move the view through scrollX/scrollY.
+        if (scrollX != shownX || scrollY != shownY)
+        {
+            shownX = scrollX;
+            shownY = scrollY;
+            invalidate();
+        }
     }
 
     Widget* hitTest(const float px, const float py) override
@@ -350,6 +359,8 @@ protected:
     }
 
 private:
+    float shownX = 0.0f, shownY = 0.0f;
+
     void clampScroll(const float viewW, const float viewH, const float contentW, const float contentH)
     {
         if (!content)
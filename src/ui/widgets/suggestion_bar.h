@@ -0,0 +1,44 @@
+#pragma once
+
+#include "./layout.h"
+#include "./button.h"
+
+// A row of words to pick instead of typing them; one click hands the word to onPick.
+class SuggestionBar : public Box
+{
+public:
+    explicit SuggestionBar(const size_t slots = 6) : Box(BoxDir::Horizontal)
+    {
+        gap = 6.0f;
+        crossStretch = true;
+        for (size_t i = 0; i < slots; ++i)
+        {
+            Button* b = addChild<Button>();
+            b->visible = false;
+            b->onClick = [this, b] { if (onPick) onPick(b->text); };
+            buttons.push_back(b);
+        }
+    }
+
+    std::function<void(const std::string& word)> onPick;
+
+    [[nodiscard]] size_t slots() const { return buttons.size(); }
+
+    void setWords(const std::vector<std::string>& words)
+    {
+        for (size_t i = 0; i < buttons.size(); ++i)
+        {
+            Button* b = buttons[i];
+            const bool shown = i < words.size();
+            if (b->visible == shown && (!shown || b->text == words[i])) continue;
+
+            b->visible = shown;
+            b->text = shown ? words[i] : "";
+            b->hovered = b->pressed = false;
+            invalidate();
+        }
+    }
+
+private:
+    std::vector<Button*> buttons;
+};
@@ -2,6 +2,12 @@
 
 #include "../../editor/text.h"
 #include "../../editor/commands.h"
+#include "../../editor/buffer_search.h"
+#include "../../editor/block_index.h"
+#include "../../editor/row_map.h"
+#include "../../editor/wrap_cache.h"
+#include "../../editor/identifier_index.h"
+#include "../../debug/memory.h"
 
 class TextInput : public Widget
 {
@@ -10,32 +16,51 @@ public:
     {
         this->font = &font;
         focusable = true;
+        editor.cursor().setRows(&rowMap);
     }
 
     bool extendSelection = false;
+    std::string filePath;
     float emptyArea = 20.0f, viewportScrollY = 0.0f, viewportH = 0.0f;
+    Rect viewport = Rect::empty();
     std::function<void(float x, float y)> onContextMenu;
+    // Words completing the one before the caret, whenever the caret or the text moves.
+    std::function<void(const std::vector<std::string>& words)> onCompletions;
+    size_t completionCount = 6;
 
     [[nodiscard]] float getContentWidth() const
     {
+        if (wrapping) return 0.0f;
+
         float maxWidth = 0.0f;
-        for (const auto& line : editor.buffer().getLines()) maxWidth = std::max(maxWidth, font->textWidth(line));
+        const auto& lines = editor.buffer().getLines();
+        for (size_t i = 0; i < lines.size(); ++i)
+            if (!rowMap.hidden(i)) maxWidth = std::max(maxWidth, font->textWidth(lines[i]));
 
         return maxWidth;
     }
 
     [[nodiscard]] float getContentHeight() const
     {
-        return static_cast<float>(editor.buffer().getLines().size()) * font->textHeight() + emptyArea;
+        return static_cast<float>(editor.cursor().rowCount()) * font->textHeight() + emptyArea;
     }
 
+    [[nodiscard]] std::string getText() const { return editor.getText(); }
+    [[nodiscard]] std::string selectedText() const { return editor.getTextInRange(editor.selectionRange()); }
+    [[nodiscard]] TextEditor::Range selection() const { return editor.selectionRange(); }
+    [[nodiscard]] const TextBuffer& buffer() const { return editor.buffer(); }
+    [[nodiscard]] const BufferSearch& search() const { return matches; }
+    [[nodiscard]] const TextCursor& cursor() const { return editor.cursor(); }
+
     void loadFile(const std::string& path)
     {
+        MEMORY_SCOPE(EditorText);
         std::vector<uint8_t> data;
         if (!FileSystem::readFile(path, data)) return;
 
         editor.setText(std::string(data.begin(), data.end()));
         history.clear();
+        filePath = path;
 
         caretVisible = true;
         caretBlinkTimer = 0.0f;
@@ -44,6 +69,7 @@ public:
     void cutText()
     {
         if (!focused) return;
+        MEMORY_SCOPE(Undo);
         auto r = editor.selectionRange();
         if (r.start == r.end) return;
 
@@ -66,6 +92,7 @@ public:
     void pasteText()
     {
         if (!focused || clipboard.text.empty()) return;
+        MEMORY_SCOPE(Undo);
         if (auto r = editor.selectionRange(); r.start != r.end)
             history.execute(
                 editor, std::make_unique<DeleteCommand>(r.start, r.end, editor.getTextInRange(r),
@@ -77,6 +104,26 @@ public:
         caretBlinkTimer = 0.0f;
     }
 
+    void undo()
+    {
+        if (!history.canUndo()) return;
+
+        history.undo(editor);
+        caretVisible = true;
+        caretBlinkTimer = 0.0f;
+        invalidate();
+    }
+
+    void redo()
+    {
+        if (!history.canRedo()) return;
+
+        history.redo(editor);
+        caretVisible = true;
+        caretBlinkTimer = 0.0f;
+        invalidate();
+    }
+
     void selectAll()
     {
         if (!focused) return;
@@ -91,9 +138,184 @@ public:
         caretBlinkTimer = 0.0f;
     }
 
+    void select(const TextPos from, const TextPos to)
+    {
+        editor.cursor().setCursor(from);
+        editor.cursor().startSelection();
+        editor.cursor().setCursor(to, false);
+        editor.cursor().updateSelection();
+
+        caretVisible = true;
+        caretBlinkTimer = 0.0f;
+        invalidate();
+    }
+
+    // Highlights every match as the pattern is typed and selects the first one at or after `from`. Returns the
+    // match count so far; pattern searches of large buffers finish over the next frames.
+    size_t findIncremental(const std::string& pattern, const TextPos from,
+                           const Pattern::Syntax syntax = Pattern::Syntax::Literal, std::string* outError = nullptr)
+    {
+        MEMORY_SCOPE(EditorText);
+        if (matches.setPattern(pattern, editor.buffer(), syntax, outError)) invalidate();
+        matches.resume(editor.buffer(), SEARCH_SLICE_SECONDS);
+
+        if (BufferSearch::Hit hit; matches.next(from, true, hit)) selectMatch(hit);
+        else editor.cursor().setCursor(from);
+
+        return matches.count();
+    }
+
+    bool findNext(const bool forward = true)
+    {
+        matches.sync(editor.buffer());
+
+        const TextEditor::Range r = editor.selectionRange();
+        BufferSearch::Hit hit;
+        if (!matches.next(forward ? r.end : r.start, forward, hit)) return false;
+
+        selectMatch(hit);
+        return true;
+    }
+
+    // All matches of a literal search are replaced by one command, so a single undo restores them.
+    size_t replaceAll(const std::string& replacement)
+    {
+        if (!matches.active() || matches.syntax() != Pattern::Syntax::Literal ||
+            replacement.find('\n') != std::string::npos)
+            return 0;
+        MEMORY_SCOPE(Undo);
+        matches.sync(editor.buffer());
+
+        std::vector<ReplaceAllCommand::LineHits> hits;
+        size_t count = 0;
+        for (size_t i = 0; i < editor.buffer().lineCount(); ++i)
+        {
+            if (!matches.hasMatches(i)) continue;
+
+            auto& h = hits.emplace_back();
+            h.line = i;
+            matches.lineMatches(i, matchSpans);
+            for (const auto& span : matchSpans) h.cols.push_back(span.col);
+            count += h.cols.size();
+        }
+        if (hits.empty()) return 0;
+
+        history.execute(editor, std::make_unique<ReplaceAllCommand>(matches.pattern(), replacement, std::move(hits),
+                                                                    editor.cursorState()));
+        caretVisible = true;
+        caretBlinkTimer = 0.0f;
+        invalidate();
+
+        return count;
+    }
+
+    // Moves the caret to the partner of the bracket or block keyword it is on.
+    bool jumpToMatch()
+    {
+        syncStructure();
+
+        BlockIndex::Match m;
+        if (!blocks.match(editor.cursor().cursor(), m) || !m.paired) return false;
+
+        editor.cursor().setCursor({m.partner.line, m.partner.col});
+        caretVisible = true;
+        caretBlinkTimer = 0.0f;
+        invalidate();
+
+        return true;
+    }
+
+    // Known up front, like the runtime's globals, so they complete before the buffer uses them.
+    void addCompletionNames(const std::vector<std::string>& names) { identifiers.addNames(names); }
+
+    // Finishes the word before the caret as `word`, as one undoable insert.
+    bool complete(const std::string& word)
+    {
+        syncStructure();
+        const std::string_view prefix = wordBeforeCaret();
+        if (word.size() <= prefix.size() || word.compare(0, prefix.size(), prefix) != 0) return false;
+        MEMORY_SCOPE(Undo);
+
+        history.execute(editor, std::make_unique<InsertCommand>(editor.cursor().cursor(), word.substr(prefix.size()),
+                                                                editor.cursorState()));
+        caretVisible = true;
+        caretBlinkTimer = 0.0f;
+        invalidate();
+
+        return true;
+    }
+
+    [[nodiscard]] bool softWrap() const { return wrapping; }
+
+    // Wraps long lines at the widget's width instead of scrolling sideways; takes effect on the next update.
+    void setSoftWrap(const bool on)
+    {
+        if (on == wrapping) return;
+
+        wrapping = on;
+        if (!on)
+        {
+            wrap.clear();
+            rowMap.setWrap(nullptr);
+        }
+        invalidate();
+    }
+
+    // Folds the block opened on the caret's line, or else the innermost one around it; unfolds a folded header.
+    bool toggleFold()
+    {
+        syncStructure();
+
+        const size_t line = editor.cursor().cursor().line;
+        if (rowMap.unfold(line))
+        {
+            invalidate();
+            return true;
+        }
+
+        size_t header = line, end = blocks.blockEnd(line);
+        if (end == SIZE_MAX || end <= line + 1)
+        {
+            header = blocks.enclosing(line);
+            end = header == SIZE_MAX ? SIZE_MAX : blocks.blockEnd(header);
+        }
+        if (end == SIZE_MAX || !rowMap.fold(header, end)) return false;
+
+        if (header != line) editor.cursor().setCursor({header, editor.buffer().lineLength(header)});
+        invalidate();
+
+        return true;
+    }
+
+    void unfoldAll()
+    {
+        if (rowMap.empty()) return;
+
+        rowMap.unfoldAll();
+        invalidate();
+    }
+
+    // Unfolds whatever hides `line` and returns the row it is shown on.
+    size_t reveal(const size_t line)
+    {
+        syncStructure();
+        if (rowMap.reveal(line)) invalidate();
+
+        return editor.cursor().row(line);
+    }
+
+    void clearSearch()
+    {
+        if (!matches.active()) return;
+
+        matches.clear();
+        invalidate();
+    }
+
     void onKey(const char* key, const KeyAction action)
     {
         if (!focused) return;
+        MEMORY_SCOPE(Undo);
 
         const auto before = editor.cursorState();
         auto makeDeleteCmd = [&]() -> std::unique_ptr<EditCommand>
@@ -137,7 +359,7 @@ public:
             {
                 if (editor.cursor().hasSelection())history.execute(editor, makeDeleteCmd());
                 history.execute(
-                    editor, std::make_unique<InsertCommand>(editor.cursor().cursor(), "    ", editor.cursorState()));
+                    editor, std::make_unique<InsertCommand>(editor.cursor().cursor(), INDENT, editor.cursorState()));
 
                 break;
             }
@@ -193,6 +415,7 @@ public:
                 editor.cursor().updateSelection();
                 caretVisible = true;
                 caretBlinkTimer = 0.0f;
+                (parent ? parent : this)->invalidate();
 
                 return true;
             }
@@ -240,6 +463,10 @@ public:
                 return true;
             }
 
+            if (e.key == Input::Key::Left || e.key == Input::Key::Right || e.key == Input::Key::Up ||
+                e.key == Input::Key::Down)
+                syncStructure();
+
             if (e.key == Input::Key::Left)
             {
                 editor.cursor().moveLeft(extendSelection);
@@ -296,6 +523,22 @@ private:
     TextEditor editor;
     CommandHistory history;
     Clipboard clipboard;
+    BufferSearch matches;
+    BlockIndex blocks;
+    RowMap rowMap;
+    WrapCache wrap;
+    WrapCache::Advances advances = {};
+    const Font* advancesFont = nullptr;
+    bool wrapping = false;
+    IdentifierIndex identifiers;
+    std::vector<std::string> completions;
+    uint64_t completionVersion = 0;
+    TextPos completionCaret = {SIZE_MAX, 0};
+    BlockIndex::Match pair;
+    TextPos pairCaret = {SIZE_MAX, 0};
+    bool hasPair = false;
+    Rect shownCaret = Rect::empty();
+    bool selecting = false;
 
     double caretBlinkTimer = 0.0f;
     bool caretVisible = true, draggingSelection = false;
@@ -309,11 +552,15 @@ private:
         const float lineH = font ? font->textHeight() : 16.0f;
         if (lineH <= 0.0f) return {0, 0};
 
-        const size_t line = std::clamp(static_cast<size_t>(std::floor((py - r.y + viewportScrollY) / lineH)),
-                                       static_cast<size_t>(0), lines.size() - 1);
-        const std::string& s = lines[line];
-        if (!font || s.empty() || px - r.x <= 0.0f) return {line, 0};
+        size_t lineRow = 0, start = 0, end = 0;
+        const size_t line = editor.cursor().lineAt(static_cast<size_t>(std::max(0.0f, std::floor((py - r.y) / lineH))),
+                                                   &lineRow);
+        rowSpan(line, lineRow, start, end);
+        if (!font || start == end || px - r.x <= 0.0f) return {line, start};
 
+        // The end of a row that continues belongs to the next one.
+        const std::string_view s = std::string_view(lines[line]).substr(start, end - start);
+        const size_t last = end < lines[line].size() ? s.size() - 1 : s.size();
         if (hitTestLine != line || hitTestLineCache != s || hitTestPrefixWidths.size() != s.size() + 1)
         {
             hitTestLine = line;
@@ -330,9 +577,9 @@ private:
                 hitTestPrefixWidths[i + 1] = font->textWidth(temp);
             }
         }
-        if (px - r.x >= hitTestPrefixWidths.back()) return {line, s.size()};
+        if (px - r.x >= hitTestPrefixWidths[last]) return {line, start + last};
 
-        size_t low = 1, high = s.size();
+        size_t low = 1, high = last;
         while (low < high)
         {
             if (const size_t mid = (low + high) / 2; hitTestPrefixWidths[mid] < px - r.x) low = mid + 1;
@@ -342,85 +589,328 @@ private:
         const size_t col = std::max(low - 1, static_cast<size_t>(0));
         return {
             line,
-            std::abs(px - r.x - hitTestPrefixWidths[col]) <= std::abs(hitTestPrefixWidths[low] - (px - r.x)) ? col : low
+            start + (std::abs(px - r.x - hitTestPrefixWidths[col]) <= std::abs(hitTestPrefixWidths[low] - (px - r.x))
+                         ? col
+                         : low)
         };
     }
 
 protected:
-    void onDraw() const override
+    void onDraw(CommandBuffer& out) const override
     {
-        const Rect r = worldBounds().inset(10);
         const auto& lines = editor.buffer().getLines();
-        TextPos selStart = {}, selEnd = {};
-
-        if (editor.cursor().hasSelection())
+        if (lines.empty() || !font) return;
+
+        const Rect r = worldBounds().inset(10), view = viewport.w > 0.0f ? viewport : worldBounds();
+        const float lineH = font->textHeight(), originY = std::floor(r.y),
+                    top = std::max(0.0f, std::floor((view.y - originY) / lineH)),
+                    bottom = std::max(0.0f, std::ceil((view.y + view.h - originY) / lineH));
+        const size_t rows = editor.cursor().rowCount(), first = std::min(static_cast<size_t>(top), rows),
+                     last = std::clamp(static_cast<size_t>(bottom), first, rows);
+
+        // GX copies need an even origin and whole 4x4 texture tiles.
+        const float ax = std::ceil(view.x / 2.0f) * 2.0f, ay = std::ceil(view.y / 2.0f) * 2.0f;
+        const Rect area = {ax, ay, std::floor((view.x + view.w - ax) / 4.0f) * 4.0f,
+                           std::floor((view.y + view.h - ay) / 4.0f) * 4.0f};
+        const bool cacheable = area.w > 0.0f && area.h > 0.0f;
+        if (!cacheable || !cache.texture.image || cache.area != area || cache.originX != r.x ||
+            cache.theme != themeVersion())
+            cache.valid = false;
+        if (cacheable) out.pushScissor(area.x, area.y, area.w, area.h);
+
+        // Rows still on screen are shifted in from the cached copy; only exposed or changed rows are drawn again.
+        const float shift = originY - cache.originY;
+        if (cache.valid)
         {
-            selStart = editor.cursor().selectionStartPos();
-            selEnd = editor.cursor().selectionEndPos();
-        }
+            out.blit(cache.texture, area.x, area.y + shift, area.w, area.h);
 
-        const size_t lineCount = lines.size();
-        if (lineCount == 0) return;
-        const float lineH = font->textHeight();
+            const float end = originY + static_cast<float>(rows) * lineH;
+            if (originY > area.y) out.rect(area.x, area.y, area.w, originY - area.y, theme().panel);
+            if (end < area.y + area.h) out.rect(area.x, end, area.w, area.y + area.h - end, theme().panel);
+        }
 
-        const size_t startLine = std::clamp(static_cast<size_t>(std::floor(viewportScrollY / lineH)),
-                                            static_cast<size_t>(0), lineCount - 1),
-                     endLine = std::clamp(static_cast<size_t>(std::ceil((viewportScrollY + viewportH) / lineH)) + 1,
-                                          static_cast<size_t>(0), lineCount);
-        for (size_t i = startLine; i < endLine; ++i)
+        cache.next.clear();
+        for (size_t row = first; row < last; ++row)
         {
-            const float y = r.y + static_cast<float>(i) * font->textHeight() - viewportScrollY;
-            if (editor.cursor().hasSelection() && i >= selStart.line && i <= selEnd.line)
-            {
-                const size_t c0 = std::clamp(i == selStart.line ? selStart.col : 0, static_cast<size_t>(0),
-                                             lines[i].size()),
-                             c1 = std::clamp(i == selEnd.line ? selEnd.col : lines[i].size(), static_cast<size_t>(0),
-                                             lines[i].size());
-                if (c1 > c0)
-                {
-                    const float x0 = r.x + prefixWidthForLine(i, c0), x1 = r.x + prefixWidthForLine(i, c1);
-                    GRRLIB_Rectangle(x0, y, x1 - x0, font->textHeight(), theme().selection, true);
-                }
-            }
-
-            if (!lines[i].empty()) font->drawText(lines[i], r.x, y, theme().text);
+            size_t lineRow = 0;
+            const size_t line = editor.cursor().lineAt(row, &lineRow);
+            const float y = originY + static_cast<float>(row) * lineH;
+            const uint64_t signature = rowSignature(line, lineRow);
+            cache.next.push_back(signature);
+
+            if (cache.valid && cache.holds(row, signature, std::max(y, area.y) - shift,
+                                           std::min(y + lineH, area.y + area.h) - shift))
+                continue;
+            if (cache.valid) out.rect(area.x, y, area.w, lineH, theme().panel);
+            drawRow(out, line, lineRow, r.x, y);
         }
 
-        if (focused && caretVisible && !lines.empty())
+        if (cacheable && out.unclipped(area.x, area.y, area.w, area.h))
         {
-            TextPos c = editor.cursor().cursor();
-            c.line = std::clamp(c.line, static_cast<size_t>(0), lines.size() - 1);
-            c.col = std::clamp(c.col, static_cast<size_t>(0), lines[c.line].size());
+            out.capture(cache.texture, area.x, area.y, area.w, area.h);
+            cache.rows.swap(cache.next);
+            cache.area = area;
+            cache.originX = r.x;
+            cache.originY = originY;
+            cache.firstRow = first;
+            cache.theme = themeVersion();
+            cache.valid = true;
+        }
 
-            const float cx = r.x + prefixWidthForLine(c.line, c.col),
-                        cy = r.y + static_cast<float>(c.line) * font->textHeight() - viewportScrollY;
-            GRRLIB_Line(cx, cy, cx, cy + font->textHeight(), theme().accent);
+        if (focused && caretVisible)
+        {
+            const Rect c = caretRect();
+            out.line(c.x, c.y, c.x, c.y + c.h, theme().accent);
         }
+        if (cacheable) out.popScissor();
     }
 
     void onUpdate(const double dt) override
     {
+        if (matches.sync(editor.buffer())) invalidate();
+        if (matches.resume(editor.buffer(), SEARCH_SLICE_SECONDS)) invalidate();
+
+        // The caret is drawn over the cached rows, so moving it redraws where it was and where it is now.
+        if (const Rect c = focused && font ? caretRect() : Rect::empty(); c != shownCaret)
+        {
+            invalidate(shownCaret.inset(-1));
+            invalidate(c.inset(-1));
+            if (selecting || editor.cursor().hasSelection()) invalidate();
+
+            shownCaret = c;
+            selecting = editor.cursor().hasSelection();
+        }
+
+        // Pair highlight and guides are part of each row's signature, so only the rows they moved off or onto redraw.
+        const bool restructured = syncStructure();
+        if (rowMap.hidden(editor.cursor().cursor().line) && rowMap.reveal(editor.cursor().cursor().line)) invalidate();
+        if (restructured || editor.cursor().cursor() != pairCaret)
+        {
+            pairCaret = editor.cursor().cursor();
+            const bool had = hasPair;
+            hasPair = blocks.match(pairCaret, pair);
+            if (restructured || had || hasPair) invalidate();
+        }
+        if (onCompletions &&
+            (editor.buffer().version() != completionVersion || editor.cursor().cursor() != completionCaret))
+        {
+            completionVersion = editor.buffer().version();
+            completionCaret = editor.cursor().cursor();
+            identifiers.complete(wordBeforeCaret(), completionCount, completions);
+            onCompletions(completions);
+        }
+
         caretBlinkTimer += dt;
         if (caretBlinkTimer >= 0.5f)
         {
             caretBlinkTimer = 0.0f;
             caretVisible = !caretVisible;
+            if (focused && font) invalidate(caretRect().inset(-1));
         }
     }
 
 private:
+    struct ViewCache
+    {
+        RenderTexture texture;
+        Rect area = Rect::empty();
+        float originX = 0.0f, originY = 0.0f;
+        size_t firstRow = 0;
+        uint32_t theme = 0;
+        bool valid = false;
+        std::vector<uint64_t> rows, next;
+
+        // Whether the copy has row `row`, unchanged, across the captured span [top, bottom).
+        [[nodiscard]] bool holds(const size_t row, const uint64_t signature, const float top, const float bottom) const
+        {
+            return row >= firstRow && row - firstRow < rows.size() && rows[row - firstRow] == signature &&
+                top >= area.y && bottom <= area.y + area.h;
+        }
+    };
+
+    mutable ViewCache cache;
     mutable size_t hitTestLine = static_cast<size_t>(-1);
     mutable std::string hitTestLineCache;
     mutable std::vector<float> hitTestPrefixWidths;
+    static constexpr double SEARCH_SLICE_SECONDS = 0.002;
+    static constexpr const char* INDENT = "    ";
+    static constexpr size_t INDENT_COLUMNS = 4;
+    static constexpr const char* FOLD_MARKER = " ...";
+
+    mutable std::vector<BufferSearch::Span> matchSpans;
+
+    // Brings the block index, wrap points and rows up to date with the buffer and the widget's width; returns
+    // whether any of them changed.
+    bool syncStructure()
+    {
+        const bool restructured = blocks.sync(editor.buffer());
+        identifiers.sync(editor.buffer(), blocks);
+
+        size_t first = 0, last = 0;
+        bool rewrapped = false;
+        // Until it is laid out the widget has no width to wrap at.
+        if (const float width = worldBounds().inset(10).w; wrapping && font && width > 0.0f)
+        {
+            const bool relayout = wrap.configure(width, glyphAdvances());
+            rewrapped = wrap.sync(editor.buffer(), first, last);
+            if (relayout || rowMap.wrapping() != &wrap)
+            {
+                rowMap.setWrap(&wrap);
+                first = last = 0;
+            }
+            rewrapped = rewrapped || relayout;
+        }
+
+        if (rowMap.sync(editor.buffer(), blocks)) return true;
+        rowMap.rewrapped(first, last);
+
+        return restructured || rewrapped;
+    }
+
+    // The identifier the caret ends, up to the caret; empty inside a selection or a number.
+    [[nodiscard]] std::string_view wordBeforeCaret() const
+    {
+        const TextPos c = editor.cursor().cursor();
+        if (editor.cursor().hasSelection() || c.line >= editor.buffer().lineCount()) return {};
+
+        const std::string_view s = editor.buffer().getLines()[c.line];
+        const auto nameChar = [](const char ch) { return std::isalnum(static_cast<unsigned char>(ch)) || ch == '_'; };
+        const size_t end = std::min(c.col, s.size());
+        size_t start = end;
+        while (start > 0 && nameChar(s[start - 1])) --start;
+        if (start < end && std::isdigit(static_cast<unsigned char>(s[start]))) return {};
+
+        return s.substr(start, end - start);
+    }
 
-    float prefixWidthForLine(const size_t lineIndex, size_t col) const
+    // Advance of every byte in the editor font, which wrap points are measured with. UTF-8 lead bytes stand for a
+    // whole glyph and continuation bytes take no room.
+    const WrapCache::Advances& glyphAdvances()
+    {
+        if (advancesFont == font) return advances;
+
+        const float wide = font->textWidth("?");
+        for (size_t c = 0; c < advances.size(); ++c)
+            advances[c] = c < 0x80 ? font->textWidth(std::string(1, static_cast<char>(c))) : c >= 0xC0 ? wide : 0.0f;
+        advancesFont = font;
+
+        return advances;
+    }
+
+    // Columns [start, end) of `line` shown on its row `lineRow`.
+    void rowSpan(const size_t line, const size_t lineRow, size_t& start, size_t& end) const
+    {
+        const size_t length = editor.buffer().lineLength(line);
+        const WrapCache* w = editor.cursor().wrapping();
+
+        start = w ? w->rowStart(line, lineRow) : 0;
+        end = w ? w->rowEnd(line, lineRow, length) : length;
+    }
+
+    // Distance from the start of row `lineRow` of `line` to `col`, clamped to that row.
+    [[nodiscard]] float rowX(const size_t line, const size_t lineRow, const size_t col) const
+    {
+        if (!font || line >= editor.buffer().lineCount()) return 0.0f;
+
+        size_t start = 0, end = 0;
+        rowSpan(line, lineRow, start, end);
+
+        const std::string_view s = editor.buffer().getLines()[line];
+        return font->textWidth(s.substr(start, std::clamp(col, start, end) - start));
+    }
+
+    void selectMatch(const BufferSearch::Hit& hit) { select({hit.line, hit.col}, {hit.line, hit.col + hit.length}); }
+
+    [[nodiscard]] Rect caretRect() const
     {
         const auto& lines = editor.buffer().getLines();
-        if (!font || lineIndex >= lines.size()) return 0.0f;
+        if (lines.empty()) return Rect::empty();
+
+        TextPos c = editor.cursor().cursor();
+        c.line = std::clamp(c.line, static_cast<size_t>(0), lines.size() - 1);
+        c.col = std::clamp(c.col, static_cast<size_t>(0), lines[c.line].size());
+
+        const Rect r = worldBounds().inset(10);
+        const size_t row = editor.cursor().rowOf(c);
+        return {r.x + rowX(c.line, row - editor.cursor().row(c.line), c.col),
+                std::floor(r.y) + static_cast<float>(row) * font->textHeight(), 1.0f, font->textHeight()};
+    }
+
+    [[nodiscard]] bool selectionSpan(const size_t line, size_t& c0, size_t& c1) const
+    {
+        if (!editor.cursor().hasSelection()) return false;
+        const TextPos start = editor.cursor().selectionStartPos(), end = editor.cursor().selectionEndPos();
+        if (line < start.line || line > end.line) return false;
+
+        const size_t len = editor.buffer().lineLength(line);
+        c0 = std::min(line == start.line ? start.col : 0, len);
+        c1 = std::min(line == end.line ? end.col : len, len);
 
-        const auto& s = lines[lineIndex];
-        col = std::clamp(col, static_cast<size_t>(0), s.size());
+        return c1 > c0;
+    }
+
+    [[nodiscard]] uint64_t rowSignature(const size_t line, const size_t lineRow) const
+    {
+        uint64_t h = std::hash<std::string_view>{}(editor.buffer().getLines()[line]) + lineRow;
+        if (size_t c0 = 0, c1 = 0; selectionSpan(line, c0, c1))
+            h ^= (c0 + 1) * 0x9E3779B97F4A7C15ull ^ (c1 + 1) * 0xC2B2AE3D27D4EB4Full;
+        if (matches.hasMatches(line))
+            h = h * 31 + std::hash<std::string_view>{}(matches.pattern()) + static_cast<uint8_t>(matches.syntax());
+        if (const size_t depth = blocks.depth(line); depth > 0) h = h * 31 + depth;
+        if (rowMap.folded(line)) h = h * 31 + 0xF01D;
+        for (const BlockIndex::Span* span : pairSpans(line))
+            if (span) h = h * 31 + (span->col + 1) * (pair.paired && !pair.mismatched ? 1 : 2);
+
+        return h;
+    }
+
+    // The halves of the highlighted pair that sit on `line`.
+    [[nodiscard]] std::array<const BlockIndex::Span*, 2> pairSpans(const size_t line) const
+    {
+        return {hasPair && pair.at.line == line ? &pair.at : nullptr,
+                hasPair && pair.paired && pair.partner.line == line ? &pair.partner : nullptr};
+    }
+
+    void drawRow(CommandBuffer& out, const size_t line, const size_t lineRow, const float x, const float y) const
+    {
+        const std::string& s = editor.buffer().getLines()[line];
+        size_t start = 0, end = 0;
+        rowSpan(line, lineRow, start, end);
+
+        if (const size_t depth = blocks.depth(line); depth > 0 && lineRow == 0)
+        {
+            // One guide per enclosing block, stopping where the line's own text begins.
+            const size_t indent = s.find_first_not_of(' ');
+            const float unit = font->textWidth(INDENT);
+            for (size_t level = 0; level < depth && level * INDENT_COLUMNS < indent; ++level)
+            {
+                const float gx = std::floor(x + static_cast<float>(level) * unit);
+                out.line(gx, y, gx, y + font->textHeight(), theme().indentGuide);
+            }
+        }
+
+        // Spans are clipped to the columns this row shows.
+        const auto highlight = [&](const size_t c0, const size_t c1, const uint32_t color)
+        {
+            if (std::min(c1, end) <= std::max(c0, start)) return;
+
+            const float x0 = x + rowX(line, lineRow, c0), x1 = x + rowX(line, lineRow, c1);
+            out.rect(x0, y, x1 - x0, font->textHeight(), color);
+        };
+
+        for (const BlockIndex::Span* span : pairSpans(line))
+            if (span)
+                highlight(span->col, span->col + span->length,
+                          pair.paired && !pair.mismatched ? theme().bracketMatch : theme().bracketMismatch);
+        if (matches.hasMatches(line))
+        {
+            matches.lineMatches(line, matchSpans);
+            for (const auto& span : matchSpans) highlight(span.col, span.col + span.length, theme().match);
+        }
+        if (size_t c0 = 0, c1 = 0; selectionSpan(line, c0, c1)) highlight(c0, c1, theme().selection);
 
-        return font->textWidth(s.substr(0, col));
+        if (end > start) out.text(std::string_view(s).substr(start, end - start), x, y, theme().text, font);
+        if (end == s.size() && rowMap.folded(line))
+            out.text(FOLD_MARKER, x + rowX(line, lineRow, end), y, theme().textDisabled, font);
     }
 };
@@ -5,9 +5,11 @@
 #include <limits>
 
 #include "../theme.h"
+#include "../damage.h"
 #include "../../platform/platform.h"
 #include "../../gfx/font.h"
 #include "../../gfx/drawing.h"
+#include "../../gfx/command_buffer.h"
 
 struct LayoutParams
 {
@@ -29,6 +31,7 @@ public:
     std::vector<std::unique_ptr<Widget>> children;
     Font* font = nullptr;
     LayoutParams layout;
+    DamageRegion* damage = nullptr;
 
     template <typename T, typename... Args>
     T* addChild(Args&&... args)
@@ -61,17 +64,17 @@ public:
         for (const auto& c : children) c->update(dt);
     }
 
-    void draw() const
+    void draw(CommandBuffer& out) const
     {
         if (!visible) return;
 
-        onDraw();
-        for (const auto& c : children) c->draw();
+        onDraw(out);
+        for (const auto& c : children) c->draw(out);
 
         if (focused && showFocus)
         {
             const Rect r = worldBounds().inset(-2);
-            roundedRectangle(r.x, r.y, r.w, r.h, radiusX + 2, radiusY + 2, theme().focus, false);
+            out.roundedRect(r.x, r.y, r.w, r.h, radiusX + 2, radiusY + 2, theme().focus, false);
         }
     }
 
@@ -87,6 +90,23 @@ public:
         return r;
     }
 
+    // Queues `r` for redraw in the nearest ancestor that owns a damage region.
+    void invalidate(const Rect& r) const
+    {
+        for (const Widget* w = this; w; w = w->parent)
+            if (w->damage)
+            {
+                w->damage->add(r);
+                return;
+            }
+    }
+
+    // The margin covers the focus ring drawn around the bounds.
+    void invalidate() const
+    {
+        if (visible) invalidate(worldBounds().inset(-3));
+    }
+
     [[nodiscard]] Font* getFont() const { return font ? font : parent ? parent->getFont() : nullptr; }
     [[nodiscard]] virtual bool isFocusable() const { return focusable && visible && enabled; }
 
@@ -99,7 +119,7 @@ public:
     }
 
 protected:
-    virtual void onDraw() const
+    virtual void onDraw(CommandBuffer&) const
     {
     }
 